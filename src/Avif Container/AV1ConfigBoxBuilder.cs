@@ -21,18 +21,38 @@ namespace AvifFileType.AvifContainer
         /// Builds the <see cref="AV1ConfigBox"/> for the specified image.
         /// </summary>
         /// <param name="image">The image.</param>
+        /// <param name="bitDepth">The bit depth of the image, 8, 10 or 12.</param>
         /// <returns></returns>
-        public static AV1ConfigBox Build(CompressedAV1Image image)
+        public static AV1ConfigBox Build(CompressedAV1Image image, int bitDepth)
         {
             if (image is null)
             {
                 ExceptionUtil.ThrowArgumentNullException(nameof(image));
             }
 
+            return Build(image.Width, image.Height, image.Format, bitDepth);
+        }
+
+        /// <summary>
+        /// Builds the <see cref="AV1ConfigBox"/> for an image with the specified size and format.
+        /// </summary>
+        /// <param name="width">The image width.</param>
+        /// <param name="height">The image height.</param>
+        /// <param name="format">The image format.</param>
+        /// <param name="bitDepth">The bit depth of the image, 8, 10 or 12.</param>
+        /// <returns></returns>
+        /// <exception cref="ArgumentOutOfRangeException"><paramref name="bitDepth"/> is not 8, 10 or 12.</exception>
+        public static AV1ConfigBox Build(int width, int height, YUVChromaSubsampling format, int bitDepth)
+        {
+            if (bitDepth != 8 && bitDepth != 10 && bitDepth != 12)
+            {
+                ExceptionUtil.ThrowArgumentOutOfRangeException(nameof(bitDepth), "Must be 8, 10 or 12.");
+            }
+
             bool chromaSubsamplingX;
             bool chromaSubsamplingY;
 
-            switch (image.Format)
+            switch (format)
             {
                 case YUVChromaSubsampling.Subsampling400:
                 case YUVChromaSubsampling.Subsampling420:
@@ -51,25 +71,32 @@ namespace AvifFileType.AvifContainer
                     chromaSubsamplingY = false;
                     break;
                 default:
-                    throw new InvalidOperationException($"Unknown { nameof(YUVChromaSubsampling) } value: { image.Format }");
+                    throw new InvalidOperationException($"Unknown { nameof(YUVChromaSubsampling) } value: { format }");
             }
 
             return new AV1ConfigBox()
             {
-                SeqProfile = GetSeqProfile(image.Format),
-                SeqLevelIdx0 = GetSeqLevelIdx0(image),
+                SeqProfile = GetSeqProfile(format, bitDepth),
+                SeqLevelIdx0 = GetSeqLevelIdx0(width, height),
                 SeqTier0 = false,
-                HighBitDepth = false,
-                TwelveBit = false,
-                Monochrome = image.Format == YUVChromaSubsampling.Subsampling400,
+                HighBitDepth = bitDepth > 8,
+                TwelveBit = bitDepth == 12,
+                Monochrome = format == YUVChromaSubsampling.Subsampling400,
                 ChromaSubsamplingX = chromaSubsamplingX,
                 ChromaSubsamplingY = chromaSubsamplingY,
                 ChromaSamplePosition = ChromaSamplePosition.Unknown
             };
         }
 
-        private static SequenceProfile GetSeqProfile(YUVChromaSubsampling format)
+        private static SequenceProfile GetSeqProfile(YUVChromaSubsampling format, int bitDepth)
         {
+            // The main and high profiles are limited to 10 bits per sample, this matches the profile
+            // that the native encoder selects.
+            if (bitDepth == 12)
+            {
+                return SequenceProfile.Professional;
+            }
+
             switch (format)
             {
                 case YUVChromaSubsampling.Subsampling400:
@@ -85,10 +112,8 @@ namespace AvifFileType.AvifContainer
             }
         }
 
-        private static SequenceLevel GetSeqLevelIdx0(CompressedAV1Image image)
+        private static SequenceLevel GetSeqLevelIdx0(int width, int height)
         {
-            int width = image.Width;
-            int height = image.Height;
             long imageSize = (long)width * height;
 
             // These values are from the Annex A.3 table: https://aomediacodec.github.io/av1-spec/av1-spec.pdf
@@ -53,7 +53,7 @@ namespace AvifFileType.AvifContainer
             this.compatibleBrands = brands;
         }
 
-        public FileTypeBox(YUVChromaSubsampling chromaSubsampling)
+        public FileTypeBox(YUVChromaSubsampling chromaSubsampling, int bitDepth)
             : base(BoxTypes.FileType)
         {
             this.majorBrand = AvifBrands.AVIF;
@@ -65,15 +65,20 @@ namespace AvifFileType.AvifContainer
                 AvifBrands.MIAF
             };
 
-            switch (chromaSubsampling)
+            // The AVIF baseline and advanced profiles use the AV1 main and high profiles,
+            // which are limited to 10 bits per sample.
+            if (bitDepth <= 10)
             {
-                case YUVChromaSubsampling.Subsampling400:
-                case YUVChromaSubsampling.Subsampling420:
-                    compatibleBrands.Add(AvifBrands.MA1B);
-                    break;
-                case YUVChromaSubsampling.Subsampling444:
-                    compatibleBrands.Add(AvifBrands.MA1A);
-                    break;
+                switch (chromaSubsampling)
+                {
+                    case YUVChromaSubsampling.Subsampling400:
+                    case YUVChromaSubsampling.Subsampling420:
+                        compatibleBrands.Add(AvifBrands.MA1B);
+                        break;
+                    case YUVChromaSubsampling.Subsampling444:
+                        compatibleBrands.Add(AvifBrands.MA1A);
+                        break;
+                }
             }
             this.compatibleBrands = compatibleBrands;
         }
@@ -40,19 +40,21 @@ namespace AvifFileType.AvifContainer
             this.ChannelBitDepths = bitDepths;
         }
 
-        public PixelInformationBox(YUVChromaSubsampling chromaSubsampling)
+        public PixelInformationBox(YUVChromaSubsampling chromaSubsampling, int bitDepth)
             : base(0, 0, BoxTypes.PixelInformation)
         {
+            byte channelBitDepth = checked((byte)bitDepth);
+
             switch (chromaSubsampling)
             {
                 case YUVChromaSubsampling.Subsampling400:
-                    this.ChannelBitDepths = new byte[1] { 8 };
+                    this.ChannelBitDepths = new byte[1] { channelBitDepth };
                     break;
                 case YUVChromaSubsampling.Subsampling420:
                 case YUVChromaSubsampling.Subsampling422:
                 case YUVChromaSubsampling.Subsampling444:
                 case YUVChromaSubsampling.IdentityMatrix:
-                    this.ChannelBitDepths = new byte[3] { 8, 8, 8 };
+                    this.ChannelBitDepths = new byte[3] { channelBitDepth, channelBitDepth, channelBitDepth };
                     break;
                 default:
                     throw new InvalidEnumArgumentException(nameof(chromaSubsampling), (int)chromaSubsampling, typeof(YUVChromaSubsampling));
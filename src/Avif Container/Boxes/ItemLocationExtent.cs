@@ -19,6 +19,8 @@ namespace AvifFileType.AvifContainer
     {
         private long offsetWritePosition;
         private byte offsetSize;
+        private long lengthWritePosition;
+        private byte lengthSize;
 
         public ItemLocationExtent(in EndianBinaryReaderSegment reader, ItemLocationBox parent, ushort extentCount)
         {
@@ -80,6 +82,7 @@ namespace AvifFileType.AvifContainer
             this.Offset = 0;
             this.Length = length;
             this.offsetWritePosition = -1;
+            this.lengthWritePosition = -1;
         }
 
         public ItemLocationExtent(ulong offset, ulong length)
@@ -88,13 +91,14 @@ namespace AvifFileType.AvifContainer
             this.Offset = offset;
             this.Length = length;
             this.offsetWritePosition = -1;
+            this.lengthWritePosition = -1;
         }
 
         public ulong Index { get; }
 
         public ulong Offset { get; private set; }
 
-        public ulong Length { get; }
+        public ulong Length { get; private set; }
 
         public static int GetSize(ItemLocationBox parent)
         {
@@ -131,6 +135,36 @@ namespace AvifFileType.AvifContainer
             }
         }
 
+        public void WriteFinalLength(BigEndianBinaryWriter writer, ulong finalLength)
+        {
+            if (this.lengthWritePosition == -1)
+            {
+                ExceptionUtil.ThrowInvalidOperationException("The item locations must have been written before calling this method.");
+            }
+
+            if (this.lengthSize != 0)
+            {
+                long oldPosition = writer.Position;
+                writer.Position = this.lengthWritePosition;
+
+                switch (this.lengthSize)
+                {
+                    case 4:
+                        writer.Write((uint)finalLength);
+                        break;
+                    case 8:
+                        writer.Write(finalLength);
+                        break;
+                    default:
+                        throw new InvalidOperationException($"{ nameof(this.lengthSize) } must be 4 or 8, actual value: { this.lengthSize.ToString(CultureInfo.InvariantCulture) }");
+                }
+
+                writer.Position = oldPosition;
+
+                this.Length = finalLength;
+            }
+        }
+
         public void Write(BigEndianBinaryWriter writer, ItemLocationBox parent)
         {
             if (this.offsetWritePosition == -1)
@@ -170,6 +204,12 @@ namespace AvifFileType.AvifContainer
                     throw new InvalidOperationException($"OffsetSize must be 0, 4 or 8, actual value: { parent.OffsetSize.ToString(CultureInfo.InvariantCulture) }");
             }
 
+            if (this.lengthWritePosition == -1)
+            {
+                this.lengthWritePosition = writer.Position;
+                this.lengthSize = parent.LengthSize;
+            }
+
             switch (parent.LengthSize)
             {
                 case 0:
@@ -15,12 +15,66 @@ namespace AvifFileType.AvifContainer
     internal sealed class MediaDataBox
         : Box
     {
-        private readonly ulong dataLength;
+        private ulong dataLength;
+        private readonly bool lengthIsUnknown;
+        private long largeSizeWritePosition;
 
         public MediaDataBox(ulong length)
             : base(BoxTypes.MediaData)
         {
             this.dataLength = length;
+            this.lengthIsUnknown = false;
+            this.largeSizeWritePosition = -1;
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="MediaDataBox"/> class for content that has an unknown length.
+        /// </summary>
+        /// <remarks>
+        /// The box is always written using the 64-bit size field, the final size is written
+        /// by <see cref="WriteFinalLength(BigEndianBinaryWriter, ulong)"/> when all of the content has been written.
+        /// </remarks>
+        public MediaDataBox()
+            : base(BoxTypes.MediaData)
+        {
+            this.dataLength = 0;
+            this.lengthIsUnknown = true;
+            this.largeSizeWritePosition = -1;
+        }
+
+        public override void Write(BigEndianBinaryWriter writer)
+        {
+            if (this.lengthIsUnknown)
+            {
+                // A size value of 1 indicates that the 64-bit size follows the type field.
+                writer.Write(1U);
+                writer.Write(this.Type);
+                this.largeSizeWritePosition = writer.Position;
+                // Zero is written as a placeholder, the real size will be updated later.
+                writer.Write(0UL);
+            }
+            else
+            {
+                base.Write(writer);
+            }
+        }
+
+        public void WriteFinalLength(BigEndianBinaryWriter writer, ulong finalLength)
+        {
+            if (this.largeSizeWritePosition == -1)
+            {
+                ExceptionUtil.ThrowInvalidOperationException("The box header must have been written before calling this method.");
+            }
+
+            this.dataLength = finalLength;
+
+            long oldPosition = writer.Position;
+            writer.Position = this.largeSizeWritePosition;
+
+            // The 64-bit size includes the 16 byte box header.
+            writer.Write(base.GetTotalBoxSize() + sizeof(ulong) + finalLength);
+
+            writer.Position = oldPosition;
         }
 
         protected override ulong GetTotalBoxSize()
@@ -18,5 +18,6 @@ namespace AvifFileType.AvifContainer
         public static readonly FourCC ContentDescription = new FourCC('c', 'd', 's', 'c');
         public static readonly FourCC DerivedImage = new FourCC('d', 'i', 'm', 'g');
         public static readonly FourCC PremultipliedAlphaImage = new FourCC('p', 'r', 'e', 'm');
+        public static readonly FourCC Thumbnail = new FourCC('t', 'h', 'm', 'b');
     }
 }
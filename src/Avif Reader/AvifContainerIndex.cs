@@ -0,0 +1,281 @@
+﻿////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+using AvifFileType.AvifContainer;
+using PaintDotNet.AppModel;
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Text;
+
+namespace AvifFileType
+{
+    /// <summary>
+    /// The parsed container boxes of an AVIF file, the item locations, item properties and
+    /// image grid descriptors that are read before any of the image data.
+    /// </summary>
+    /// <remarks>
+    /// An index is immutable after it has been created, it can be shared by any number of
+    /// <see cref="AvifReader"/> instances that read the same version of the file.
+    /// </remarks>
+    internal sealed class AvifContainerIndex
+    {
+        private const uint SerializationVersion = 1;
+        private static readonly FourCC SerializationSignature = new FourCC('A', 'V', 'I', 'X');
+
+        private readonly byte[] fileTypeBoxBytes;
+        private readonly byte[] metaBoxBytes;
+        private readonly long metaBoxOffset;
+        private readonly Dictionary<uint, ImageGridDescriptor> imageGridDescriptors;
+
+        public AvifContainerIndex(AvifContainerIndexKey key,
+                                  FileTypeBox fileTypeBox,
+                                  byte[] fileTypeBoxBytes,
+                                  MetaBox metaBox,
+                                  byte[] metaBoxBytes,
+                                  long metaBoxOffset,
+                                  Dictionary<uint, ImageGridDescriptor> imageGridDescriptors)
+            : this(key, fileTypeBox, fileTypeBoxBytes, metaBox, metaBoxBytes, metaBoxOffset, 0, imageGridDescriptors)
+        {
+        }
+
+        private AvifContainerIndex(AvifContainerIndexKey key,
+                                   FileTypeBox fileTypeBox,
+                                   byte[] fileTypeBoxBytes,
+                                   MetaBox metaBox,
+                                   byte[] metaBoxBytes,
+                                   long metaBoxOffset,
+                                   long metaBoxPositionAdjustment,
+                                   Dictionary<uint, ImageGridDescriptor> imageGridDescriptors)
+        {
+            if (fileTypeBox is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(fileTypeBox));
+            }
+
+            if (fileTypeBoxBytes is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(fileTypeBoxBytes));
+            }
+
+            if (metaBox is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(metaBox));
+            }
+
+            if (metaBoxBytes is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(metaBoxBytes));
+            }
+
+            if (imageGridDescriptors is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(imageGridDescriptors));
+            }
+
+            this.Key = key;
+            this.FileTypeBox = fileTypeBox;
+            this.fileTypeBoxBytes = fileTypeBoxBytes;
+            this.MetaBox = metaBox;
+            this.metaBoxBytes = metaBoxBytes;
+            this.metaBoxOffset = metaBoxOffset;
+            this.MetaBoxPositionAdjustment = metaBoxPositionAdjustment;
+            this.imageGridDescriptors = imageGridDescriptors;
+        }
+
+        public AvifContainerIndexKey Key { get; }
+
+        public FileTypeBox FileTypeBox { get; }
+
+        public MetaBox MetaBox { get; }
+
+        /// <summary>
+        /// Gets the value that is added to the stream positions recorded in the <see cref="MetaBox"/> to get the file offset.
+        /// </summary>
+        /// <value>
+        /// Zero when the boxes were parsed from the file, or the file offset of the Meta box when the boxes were
+        /// parsed from serialized index data.
+        /// </value>
+        public long MetaBoxPositionAdjustment { get; }
+
+        /// <summary>
+        /// Reads an index that was written by <see cref="Serialize(Stream, IArrayPoolService)"/>.
+        /// </summary>
+        /// <param name="stream">The stream.</param>
+        /// <param name="arrayPool">The array pool.</param>
+        /// <returns>The index.</returns>
+        /// <exception cref="ArgumentNullException">
+        /// <paramref name="stream"/> is null.
+        /// -or-
+        /// <paramref name="arrayPool"/> is null.
+        /// </exception>
+        /// <exception cref="FormatException">The stream does not contain a valid index.</exception>
+        public static AvifContainerIndex Deserialize(Stream stream, IArrayPoolService arrayPool)
+        {
+            if (stream is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(stream));
+            }
+
+            if (arrayPool is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(arrayPool));
+            }
+
+            using (EndianBinaryReader reader = new EndianBinaryReader(stream, Endianess.Big, leaveOpen: true, arrayPool))
+            {
+                if (reader.ReadFourCC() != SerializationSignature)
+                {
+                    ExceptionUtil.ThrowFormatException("The stream does not contain an AVIF container index.");
+                }
+
+                uint version = reader.ReadUInt32();
+                if (version != SerializationVersion)
+                {
+                    ExceptionUtil.ThrowFormatException($"Unknown { nameof(AvifContainerIndex) } version: { version }.");
+                }
+
+                string path = Encoding.UTF8.GetString(ReadByteArray(reader));
+                long length = reader.ReadInt64();
+                DateTime lastWriteTimeUtc = new DateTime(reader.ReadInt64(), DateTimeKind.Utc);
+                long metaBoxOffset = reader.ReadInt64();
+                byte[] fileTypeBoxBytes = ReadByteArray(reader);
+                byte[] metaBoxBytes = ReadByteArray(reader);
+
+                int imageGridCount = reader.ReadInt32();
+                if (imageGridCount < 0)
+                {
+                    ExceptionUtil.ThrowFormatException("Invalid image grid descriptor count.");
+                }
+
+                Dictionary<uint, ImageGridDescriptor> imageGridDescriptors = new Dictionary<uint, ImageGridDescriptor>(imageGridCount);
+
+                for (int i = 0; i < imageGridCount; i++)
+                {
+                    uint itemId = reader.ReadUInt32();
+                    uint descriptorLength = reader.ReadUInt32();
+
+                    imageGridDescriptors[itemId] = new ImageGridDescriptor(reader, descriptorLength);
+                }
+
+                FileTypeBox fileTypeBox = ParseBox(fileTypeBoxBytes,
+                                                   BoxTypes.FileType,
+                                                   arrayPool,
+                                                   (in EndianBinaryReaderSegment segment, Box header) => new FileTypeBox(segment, header));
+                fileTypeBox.CheckForAvifCompatibility();
+
+                MetaBox metaBox = ParseBox(metaBoxBytes,
+                                           BoxTypes.Meta,
+                                           arrayPool,
+                                           (in EndianBinaryReaderSegment segment, Box header) => new MetaBox(segment, header));
+
+                return new AvifContainerIndex(new AvifContainerIndexKey(path, length, lastWriteTimeUtc),
+                                              fileTypeBox,
+                                              fileTypeBoxBytes,
+                                              metaBox,
+                                              metaBoxBytes,
+                                              metaBoxOffset,
+                                              metaBoxOffset,
+                                              imageGridDescriptors);
+            }
+        }
+
+        /// <summary>
+        /// Writes the index to the specified stream.
+        /// </summary>
+        /// <param name="stream">The stream.</param>
+        /// <param name="arrayPool">The array pool.</param>
+        /// <remarks>
+        /// The index is stored as the original FileType and Meta box data followed by the image grid descriptors,
+        /// the boxes are parsed again by <see cref="Deserialize(Stream, IArrayPoolService)"/> without reading the AVIF file.
+        /// </remarks>
+        /// <exception cref="ArgumentNullException">
+        /// <paramref name="stream"/> is null.
+        /// -or-
+        /// <paramref name="arrayPool"/> is null.
+        /// </exception>
+        public void Serialize(Stream stream, IArrayPoolService arrayPool)
+        {
+            if (stream is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(stream));
+            }
+
+            if (arrayPool is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(arrayPool));
+            }
+
+            using (BigEndianBinaryWriter writer = new BigEndianBinaryWriter(stream, leaveOpen: true, arrayPool))
+            {
+                writer.Write(SerializationSignature);
+                writer.Write(SerializationVersion);
+                WriteByteArray(writer, Encoding.UTF8.GetBytes(this.Key.Path));
+                writer.Write(this.Key.Length);
+                writer.Write(this.Key.LastWriteTimeUtc.Ticks);
+                writer.Write(this.metaBoxOffset);
+                WriteByteArray(writer, this.fileTypeBoxBytes);
+                WriteByteArray(writer, this.metaBoxBytes);
+
+                writer.Write(this.imageGridDescriptors.Count);
+                foreach (KeyValuePair<uint, ImageGridDescriptor> item in this.imageGridDescriptors)
+                {
+                    writer.Write(item.Key);
+                    writer.Write((uint)item.Value.GetSize());
+                    item.Value.Write(writer);
+                }
+            }
+        }
+
+        public bool TryGetImageGridDescriptor(uint itemId, out ImageGridDescriptor imageGridDescriptor)
+        {
+            return this.imageGridDescriptors.TryGetValue(itemId, out imageGridDescriptor);
+        }
+
+        private static TBox ParseBox<TBox>(byte[] bytes, FourCC requiredType, IArrayPoolService arrayPool, BoxParser<TBox> parser) where TBox : Box
+        {
+            using (EndianBinaryReader reader = new EndianBinaryReader(new MemoryStream(bytes, writable: false), Endianess.Big, arrayPool))
+            {
+                Box header = new Box(reader);
+
+                if (header.Type != requiredType)
+                {
+                    ExceptionUtil.ThrowFormatException($"The index does not contain a { requiredType } box.");
+                }
+
+                EndianBinaryReaderSegment segment = reader.CreateSegment(header.DataStartOffset, header.DataLength);
+
+                return parser(segment, header);
+            }
+        }
+
+        private static byte[] ReadByteArray(EndianBinaryReader reader)
+        {
+            int length = reader.ReadInt32();
+
+            if (length < 0)
+            {
+                ExceptionUtil.ThrowFormatException("Invalid index field length.");
+            }
+
+            return reader.ReadBytes(length);
+        }
+
+        private static void WriteByteArray(BigEndianBinaryWriter writer, byte[] bytes)
+        {
+            writer.Write(bytes.Length);
+            writer.Write(bytes);
+        }
+
+        private delegate TBox BoxParser<TBox>(in EndianBinaryReaderSegment segment, Box header) where TBox : Box;
+    }
+}
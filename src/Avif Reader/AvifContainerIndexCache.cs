@@ -0,0 +1,119 @@
+﻿////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+using System.Collections.Generic;
+
+namespace AvifFileType
+{
+    /// <summary>
+    /// A cache of the most recently used <see cref="AvifContainerIndex"/> instances.
+    /// </summary>
+    /// <remarks>
+    /// A single cache can be shared by the full image, region and thumbnail load methods in
+    /// <see cref="AvifFile"/>, only the first load of a file parses its container boxes.
+    /// This class is thread-safe.
+    /// </remarks>
+    internal sealed class AvifContainerIndexCache
+    {
+        private readonly int capacity;
+        private readonly Dictionary<AvifContainerIndexKey, LinkedListNode<AvifContainerIndex>> items;
+        private readonly LinkedList<AvifContainerIndex> mostRecentlyUsed;
+        private readonly object sync;
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="AvifContainerIndexCache"/> class.
+        /// </summary>
+        /// <param name="capacity">The maximum number of indexes that the cache can hold.</param>
+        /// <exception cref="System.ArgumentOutOfRangeException"><paramref name="capacity"/> is less than 1.</exception>
+        public AvifContainerIndexCache(int capacity)
+        {
+            if (capacity < 1)
+            {
+                ExceptionUtil.ThrowArgumentOutOfRangeException(nameof(capacity), "Must be >= 1.");
+            }
+
+            this.capacity = capacity;
+            this.items = new Dictionary<AvifContainerIndexKey, LinkedListNode<AvifContainerIndex>>(capacity);
+            this.mostRecentlyUsed = new LinkedList<AvifContainerIndex>();
+            this.sync = new object();
+        }
+
+        public int Count
+        {
+            get
+            {
+                lock (this.sync)
+                {
+                    return this.items.Count;
+                }
+            }
+        }
+
+        /// <summary>
+        /// Adds the specified index to the cache, replacing any existing index with the same key.
+        /// </summary>
+        /// <param name="index">The index.</param>
+        /// <exception cref="System.ArgumentNullException"><paramref name="index"/> is null.</exception>
+        public void Add(AvifContainerIndex index)
+        {
+            if (index is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(index));
+            }
+
+            lock (this.sync)
+            {
+                if (this.items.TryGetValue(index.Key, out LinkedListNode<AvifContainerIndex> existing))
+                {
+                    this.mostRecentlyUsed.Remove(existing);
+                    this.items.Remove(index.Key);
+                }
+                else if (this.items.Count == this.capacity)
+                {
+                    LinkedListNode<AvifContainerIndex> leastRecentlyUsed = this.mostRecentlyUsed.Last;
+
+                    this.mostRecentlyUsed.RemoveLast();
+                    this.items.Remove(leastRecentlyUsed.Value.Key);
+                }
+
+                this.items.Add(index.Key, this.mostRecentlyUsed.AddFirst(index));
+            }
+        }
+
+        public void Clear()
+        {
+            lock (this.sync)
+            {
+                this.items.Clear();
+                this.mostRecentlyUsed.Clear();
+            }
+        }
+
+        public bool TryGetIndex(AvifContainerIndexKey key, out AvifContainerIndex index)
+        {
+            lock (this.sync)
+            {
+                if (this.items.TryGetValue(key, out LinkedListNode<AvifContainerIndex> node))
+                {
+                    this.mostRecentlyUsed.Remove(node);
+                    this.mostRecentlyUsed.AddFirst(node);
+
+                    index = node.Value;
+                    return true;
+                }
+            }
+
+            index = null;
+            return false;
+        }
+    }
+}
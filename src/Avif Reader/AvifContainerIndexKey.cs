@@ -0,0 +1,122 @@
+﻿////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+using System;
+using System.IO;
+
+namespace AvifFileType
+{
+    /// <summary>
+    /// Identifies the version of a file that an <see cref="AvifContainerIndex"/> was created from.
+    /// </summary>
+    internal readonly struct AvifContainerIndexKey
+        : IEquatable<AvifContainerIndexKey>
+    {
+        public AvifContainerIndexKey(string path, long length, DateTime lastWriteTimeUtc)
+        {
+            if (path is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(path));
+            }
+
+            this.Path = path;
+            this.Length = length;
+            this.LastWriteTimeUtc = lastWriteTimeUtc;
+        }
+
+        public string Path { get; }
+
+        public long Length { get; }
+
+        public DateTime LastWriteTimeUtc { get; }
+
+        /// <summary>
+        /// Creates the key for the file that the stream reads from.
+        /// </summary>
+        /// <param name="stream">The stream.</param>
+        /// <param name="key">The key.</param>
+        /// <returns>
+        /// <see langword="true"/> if <paramref name="stream"/> is a <see cref="FileStream"/> that was opened
+        /// from a file path and the key was created; otherwise, <see langword="false"/>.
+        /// </returns>
+        public static bool TryCreate(Stream stream, out AvifContainerIndexKey key)
+        {
+            if (stream is FileStream fileStream)
+            {
+                try
+                {
+                    string name = fileStream.Name;
+
+                    // A FileStream that was created from a handle reports a placeholder name that is
+                    // not the path of the file, so it cannot be used to identify the file.
+                    if (!string.IsNullOrEmpty(name) && System.IO.Path.IsPathRooted(name) && File.Exists(name))
+                    {
+                        // A file that has been modified since the index was created will have a different length
+                        // or last write time, the index for the old version of the file is never used.
+                        string path = System.IO.Path.GetFullPath(name);
+
+                        key = new AvifContainerIndexKey(path, fileStream.Length, File.GetLastWriteTimeUtc(path));
+                        return true;
+                    }
+                }
+                catch (IOException)
+                {
+                }
+                catch (NotSupportedException)
+                {
+                }
+                catch (UnauthorizedAccessException)
+                {
+                }
+            }
+
+            key = default;
+            return false;
+        }
+
+        public override bool Equals(object obj)
+        {
+            return obj is AvifContainerIndexKey other && Equals(other);
+        }
+
+        public bool Equals(AvifContainerIndexKey other)
+        {
+            return this.Length == other.Length &&
+                   this.LastWriteTimeUtc == other.LastWriteTimeUtc &&
+                   string.Equals(this.Path, other.Path, StringComparison.OrdinalIgnoreCase);
+        }
+
+        public override int GetHashCode()
+        {
+            int hashCode = -1103555576;
+
+            unchecked
+            {
+                hashCode = (hashCode * -1521134295) + (this.Path != null ? StringComparer.OrdinalIgnoreCase.GetHashCode(this.Path) : 0);
+                hashCode = (hashCode * -1521134295) + this.Length.GetHashCode();
+                hashCode = (hashCode * -1521134295) + this.LastWriteTimeUtc.GetHashCode();
+            }
+
+            return hashCode;
+        }
+
+        public static bool operator ==(AvifContainerIndexKey left, AvifContainerIndexKey right)
+        {
+            return left.Equals(right);
+        }
+
+        public static bool operator !=(AvifContainerIndexKey left, AvifContainerIndexKey right)
+        {
+            return !(left == right);
+        }
+    }
+}
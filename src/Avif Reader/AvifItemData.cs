@@ -11,10 +11,12 @@
 ////////////////////////////////////////////////////////////////////////
 
 using AvifFileType.Interop;
+using Microsoft.Win32.SafeHandles;
 using PaintDotNet;
 using PaintDotNet.AppModel;
 using System;
 using System.IO;
+using System.IO.MemoryMappedFiles;
 using System.Runtime.CompilerServices;
 using System.Runtime.InteropServices;
 
@@ -23,7 +25,7 @@ namespace AvifFileType
     internal unsafe delegate void UseBufferPointerDelegate(byte* ptr, ulong length);
 
     internal abstract class AvifItemData
-        : IDisposable
+        : IDisposable, IPinnableBuffer
     {
         private bool disposed;
 
@@ -59,6 +61,22 @@ namespace AvifFileType
             UseBufferPointerImpl(action);
         }
 
+        /// <summary>
+        /// Pins the item data and gets the memory segments that contain it.
+        /// </summary>
+        /// <returns>The segments of the item data, in order.</returns>
+        internal CompressedTileData[] PinSegments()
+        {
+            VerifyNotDisposed();
+
+            return PinSegmentsImpl();
+        }
+
+        internal void UnpinSegments()
+        {
+            UnpinBuffer();
+        }
+
         protected virtual void Dispose(bool disposing)
         {
             this.disposed = true;
@@ -66,6 +84,22 @@ namespace AvifFileType
 
         protected abstract Stream GetStreamImpl();
 
+        protected virtual CompressedTileData[] PinSegmentsImpl()
+        {
+            return new CompressedTileData[]
+            {
+                new CompressedTileData
+                {
+                    data = PinBuffer(),
+                    size = new UIntPtr(this.Length)
+                }
+            };
+        }
+
+        protected abstract IntPtr PinBuffer();
+
+        protected abstract void UnpinBuffer();
+
         protected abstract unsafe void UseBufferPointerImpl(UseBufferPointerDelegate action);
 
         protected void VerifyNotDisposed()
@@ -75,12 +109,25 @@ namespace AvifFileType
                 ExceptionUtil.ThrowObjectDisposedException(GetType().Name);
             }
         }
+
+        IntPtr IPinnableBuffer.Pin()
+        {
+            VerifyNotDisposed();
+
+            return PinBuffer();
+        }
+
+        void IPinnableBuffer.Unpin()
+        {
+            UnpinBuffer();
+        }
     }
 
     internal sealed class ManagedAvifItemData
         : AvifItemData
     {
         private IArrayPoolBuffer<byte> bufferFromArrayPool;
+        private GCHandle gcHandle;
 
         public ManagedAvifItemData(int length, IArrayPoolService pool)
             : base()
@@ -89,6 +136,11 @@ namespace AvifFileType
             this.Length = (ulong)length;
         }
 
+        ~ManagedAvifItemData()
+        {
+            Dispose(false);
+        }
+
         internal byte[] GetBuffer()
         {
             VerifyNotDisposed();
@@ -103,6 +155,11 @@ namespace AvifFileType
                 DisposableUtil.Free(ref this.bufferFromArrayPool);
             }
 
+            if (this.gcHandle.IsAllocated)
+            {
+                this.gcHandle.Free();
+            }
+
             base.Dispose(disposing);
         }
 
@@ -111,6 +168,24 @@ namespace AvifFileType
             return new MemoryStream(this.bufferFromArrayPool.Array, 0, (int)this.Length, writable: false);
         }
 
+        protected override IntPtr PinBuffer()
+        {
+            if (!this.gcHandle.IsAllocated)
+            {
+                this.gcHandle = GCHandle.Alloc(this.bufferFromArrayPool.Array, GCHandleType.Pinned);
+            }
+
+            return this.gcHandle.AddrOfPinnedObject();
+        }
+
+        protected override void UnpinBuffer()
+        {
+            if (this.gcHandle.IsAllocated)
+            {
+                this.gcHandle.Free();
+            }
+        }
+
         protected override unsafe void UseBufferPointerImpl(UseBufferPointerDelegate action)
         {
             fixed (byte* ptr = this.bufferFromArrayPool.Array)
@@ -162,6 +237,15 @@ namespace AvifFileType
             return new UnmanagedMemoryStream(this.buffer, 0, checked((long)this.Length), FileAccess.Read);
         }
 
+        protected override IntPtr PinBuffer()
+        {
+            return this.buffer.DangerousGetHandle();
+        }
+
+        protected override void UnpinBuffer()
+        {
+        }
+
         protected override unsafe void UseBufferPointerImpl(UseBufferPointerDelegate action)
         {
             byte* ptr = null;
@@ -184,4 +268,177 @@ namespace AvifFileType
             }
         }
     }
+
+    internal sealed class MemoryMappedAvifItemData
+        : AvifItemData
+    {
+        private readonly SafeMemoryMappedViewHandle viewHandle;
+        private readonly ulong[] segmentOffsets;
+        private readonly ulong[] segmentLengths;
+        private unsafe byte* pinnedPointer;
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="MemoryMappedAvifItemData"/> class.
+        /// </summary>
+        /// <param name="view">The view of the file, it is owned by the caller and must not be disposed before this instance.</param>
+        /// <param name="fileOffset">The offset of the item data in the file.</param>
+        /// <param name="length">The length of the item data.</param>
+        /// <exception cref="ArgumentNullException"><paramref name="view"/> is null.</exception>
+        public MemoryMappedAvifItemData(MemoryMappedViewAccessor view, long fileOffset, ulong length)
+            : this(view, new long[] { fileOffset }, new ulong[] { length })
+        {
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="MemoryMappedAvifItemData"/> class for an item that is
+        /// stored in more than one segment of the file.
+        /// </summary>
+        /// <param name="view">The view of the file, it is owned by the caller and must not be disposed before this instance.</param>
+        /// <param name="fileOffsets">The offset of each segment in the file.</param>
+        /// <param name="lengths">The length of each segment.</param>
+        /// <exception cref="ArgumentNullException">
+        /// <paramref name="view"/> is null.
+        /// -or-
+        /// <paramref name="fileOffsets"/> is null.
+        /// -or-
+        /// <paramref name="lengths"/> is null.
+        /// </exception>
+        /// <exception cref="ArgumentException"><paramref name="fileOffsets"/> and <paramref name="lengths"/> have different lengths.</exception>
+        public MemoryMappedAvifItemData(MemoryMappedViewAccessor view, long[] fileOffsets, ulong[] lengths)
+            : base()
+        {
+            if (view is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(view));
+            }
+
+            if (fileOffsets is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(fileOffsets));
+            }
+
+            if (lengths is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(lengths));
+            }
+
+            if (fileOffsets.Length != lengths.Length || fileOffsets.Length == 0)
+            {
+                ExceptionUtil.ThrowArgumentException("The offset and length arrays must have the same number of items.");
+            }
+
+            this.viewHandle = view.SafeMemoryMappedViewHandle;
+            this.segmentOffsets = new ulong[fileOffsets.Length];
+            this.segmentLengths = (ulong[])lengths.Clone();
+
+            ulong totalLength = 0;
+
+            for (int i = 0; i < fileOffsets.Length; i++)
+            {
+                // The view may start before the requested file offset when the offset is not aligned
+                // to the system allocation granularity.
+                this.segmentOffsets[i] = checked((ulong)(view.PointerOffset + fileOffsets[i]));
+                totalLength = checked(totalLength + lengths[i]);
+            }
+
+            this.Length = totalLength;
+        }
+
+        ~MemoryMappedAvifItemData()
+        {
+            Dispose(false);
+        }
+
+        protected override void Dispose(bool disposing)
+        {
+            UnpinBuffer();
+
+            base.Dispose(disposing);
+        }
+
+        protected override Stream GetStreamImpl()
+        {
+            VerifySingleSegment();
+
+            // The UnmanagedMemoryStream class does not take ownership of the SafeBuffer.
+            return new UnmanagedMemoryStream(this.viewHandle, checked((long)this.segmentOffsets[0]), checked((long)this.Length), FileAccess.Read);
+        }
+
+        protected override unsafe IntPtr PinBuffer()
+        {
+            VerifySingleSegment();
+
+            return new IntPtr(AcquirePinnedPointer() + this.segmentOffsets[0]);
+        }
+
+        protected override unsafe CompressedTileData[] PinSegmentsImpl()
+        {
+            byte* ptr = AcquirePinnedPointer();
+
+            CompressedTileData[] segments = new CompressedTileData[this.segmentOffsets.Length];
+
+            for (int i = 0; i < segments.Length; i++)
+            {
+                segments[i].data = new IntPtr(ptr + this.segmentOffsets[i]);
+                segments[i].size = new UIntPtr(this.segmentLengths[i]);
+            }
+
+            return segments;
+        }
+
+        protected override unsafe void UnpinBuffer()
+        {
+            if (this.pinnedPointer != null)
+            {
+                this.pinnedPointer = null;
+                this.viewHandle.ReleasePointer();
+            }
+        }
+
+        protected override unsafe void UseBufferPointerImpl(UseBufferPointerDelegate action)
+        {
+            VerifySingleSegment();
+
+            byte* ptr = null;
+            RuntimeHelpers.PrepareDelegate(action);
+#if NET47
+            RuntimeHelpers.PrepareConstrainedRegions();
+#endif
+            try
+            {
+                this.viewHandle.AcquirePointer(ref ptr);
+
+                action(ptr + this.segmentOffsets[0], this.Length);
+            }
+            finally
+            {
+                if (ptr != null)
+                {
+                    this.viewHandle.ReleasePointer();
+                }
+            }
+        }
+
+        private unsafe byte* AcquirePinnedPointer()
+        {
+            if (this.pinnedPointer == null)
+            {
+                // The pointer keeps the view mapped until it is released.
+                byte* ptr = null;
+                this.viewHandle.AcquirePointer(ref ptr);
+                this.pinnedPointer = ptr;
+            }
+
+            return this.pinnedPointer;
+        }
+
+        private void VerifySingleSegment()
+        {
+            // Only the decoder can read an item that is stored in more than one segment.
+            if (this.segmentOffsets.Length > 1)
+            {
+                throw new InvalidOperationException("The item data is stored in more than one segment.");
+            }
+        }
+    }
 }
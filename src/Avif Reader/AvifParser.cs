@@ -16,6 +16,7 @@ using System;
 using System.Collections.Generic;
 using System.Diagnostics;
 using System.IO;
+using System.IO.MemoryMappedFiles;
 using System.Linq;
 
 namespace AvifFileType
@@ -25,14 +26,39 @@ namespace AvifFileType
         : IDisposable
     {
         private const ulong ManagedAvifItemDataMaxSize = 256 * 1024;
+        // Files with a larger Meta box, e.g. because it contains item data, are not indexed.
+        private const long IndexedMetaBoxMaxSize = 4 * 1024 * 1024;
 
         private FileTypeBox fileTypeBox;
         private MetaBox metaBox;
         private EndianBinaryReader reader;
         private readonly ulong fileLength;
+        private readonly AvifContainerIndex index;
+        private readonly long metaBoxPositionAdjustment;
         private readonly IArrayPoolService arrayPool;
+        private readonly FileStream fileStream;
+        private MemoryMappedFile memoryMappedFile;
+        private MemoryMappedViewAccessor memoryMappedView;
+        private bool memoryMappingFailed;
 
         public AvifParser(Stream stream, bool leaveOpen, IArrayPoolService arrayPool)
+            : this(stream, leaveOpen, arrayPool, null)
+        {
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="AvifParser"/> class.
+        /// </summary>
+        /// <param name="stream">The stream.</param>
+        /// <param name="leaveOpen">
+        /// <see langword="true"/> if the stream should be left open when the parser is disposed; otherwise, <see langword="false"/>.
+        /// </param>
+        /// <param name="arrayPool">The array pool.</param>
+        /// <param name="indexCache">
+        /// The cache that the container index of the file is read from and added to, or <see langword="null"/>
+        /// to always parse the container boxes. Only files that are read through a <see cref="FileStream"/> are cached.
+        /// </param>
+        public AvifParser(Stream stream, bool leaveOpen, IArrayPoolService arrayPool, AvifContainerIndexCache indexCache)
         {
             if (stream is null)
             {
@@ -40,13 +66,51 @@ namespace AvifFileType
             }
 
             this.arrayPool = arrayPool;
+            // Large items that are stored in a file are read through a memory-mapped view.
+            this.fileStream = stream as FileStream;
             this.reader = new EndianBinaryReader(stream, Endianess.Big, leaveOpen, arrayPool);
-            Parse();
             this.fileLength = (ulong)stream.Length;
+
+            if (indexCache != null && AvifContainerIndexKey.TryCreate(stream, out AvifContainerIndexKey key))
+            {
+                if (indexCache.TryGetIndex(key, out this.index))
+                {
+                    // The boxes were parsed when the file was first opened, the file is only read for the item data.
+                    this.fileTypeBox = this.index.FileTypeBox;
+                    this.metaBox = this.index.MetaBox;
+                    this.metaBoxPositionAdjustment = this.index.MetaBoxPositionAdjustment;
+                    CheckForRequiredBoxes();
+                }
+                else
+                {
+                    Parse();
+                    this.index = TryCreateIndex(key);
+                    if (this.index != null)
+                    {
+                        indexCache.Add(this.index);
+                    }
+                }
+            }
+            else
+            {
+                Parse();
+            }
         }
 
         public void Dispose()
         {
+            if (this.memoryMappedView != null)
+            {
+                this.memoryMappedView.Dispose();
+                this.memoryMappedView = null;
+            }
+
+            if (this.memoryMappedFile != null)
+            {
+                this.memoryMappedFile.Dispose();
+                this.memoryMappedFile = null;
+            }
+
             if (this.reader != null)
             {
                 this.reader.Dispose();
@@ -92,6 +156,43 @@ namespace AvifFileType
             return this.metaBox.PrimaryItem?.ItemId ?? 1;
         }
 
+        /// <summary>
+        /// Gets the smallest thumbnail of the primary item that is at least the specified size.
+        /// </summary>
+        /// <param name="primaryItemId">The primary item identifier.</param>
+        /// <param name="minimumSize">The minimum width or height of the thumbnail.</param>
+        /// <returns>The thumbnail item identifier, or 0 if the primary item does not have a thumbnail that is large enough.</returns>
+        public uint GetThumbnailItemId(uint primaryItemId, uint minimumSize)
+        {
+            uint thumbnailItemId = 0;
+            ulong thumbnailPixelCount = ulong.MaxValue;
+
+            foreach (IItemReferenceEntry entry in GetMatchingReferences(primaryItemId, ReferenceTypes.Thumbnail))
+            {
+                IItemInfoEntry itemInfo = TryGetItemInfoEntry(entry.FromItemId);
+
+                if (itemInfo is null || itemInfo.ItemType != ItemInfoEntryTypes.AV01 && itemInfo.ItemType != ItemInfoEntryTypes.ImageGrid)
+                {
+                    continue;
+                }
+
+                ImageSpatialExtentsBox extents = TryGetAssociatedItemProperty<ImageSpatialExtentsBox>(entry.FromItemId);
+
+                if (extents != null && Math.Max(extents.ImageWidth, extents.ImageHeight) >= minimumSize)
+                {
+                    ulong pixelCount = (ulong)extents.ImageWidth * extents.ImageHeight;
+
+                    if (pixelCount < thumbnailPixelCount)
+                    {
+                        thumbnailItemId = entry.FromItemId;
+                        thumbnailPixelCount = pixelCount;
+                    }
+                }
+            }
+
+            return thumbnailItemId;
+        }
+
         public void GetTransformationProperties(uint itemId,
                                                 out CleanApertureBox cleanAperture,
                                                 out ImageRotateBox imageRotate,
@@ -163,6 +264,20 @@ namespace AvifFileType
         }
 
         public AvifItemData ReadItemData(ItemLocationEntry entry)
+        {
+            return ReadItemData(entry, allowMultipleSegments: false);
+        }
+
+        /// <summary>
+        /// Reads the item data.
+        /// </summary>
+        /// <param name="entry">The item location entry.</param>
+        /// <param name="allowMultipleSegments">
+        /// <see langword="true"/> if the item data can be returned as separate segments when it is stored in more than one extent;
+        /// otherwise, <see langword="false"/>. The segments can only be read by the native decoder.
+        /// </param>
+        /// <returns>The item data.</returns>
+        public AvifItemData ReadItemData(ItemLocationEntry entry, bool allowMultipleSegments)
         {
             if (entry is null)
             {
@@ -178,6 +293,7 @@ namespace AvifFileType
                 this.reader.Position = offset;
 
                 ulong totalItemSize = entry.TotalItemSize;
+                MemoryMappedViewAccessor view;
 
                 if (totalItemSize <= ManagedAvifItemDataMaxSize)
                 {
@@ -195,6 +311,11 @@ namespace AvifFileType
                         managedItemData?.Dispose();
                     }
                 }
+                else if (entry.ConstructionMethod == ConstructionMethod.FileOffset && TryGetMemoryMappedView(out view))
+                {
+                    // The item data is passed to the decoder directly from the file view without being copied.
+                    data = new MemoryMappedAvifItemData(view, offset, totalItemSize);
+                }
                 else
                 {
                     UnmanagedAvifItemData unmanagedItemData = new UnmanagedAvifItemData(totalItemSize);
@@ -212,6 +333,13 @@ namespace AvifFileType
                     }
                 }
             }
+            else if (allowMultipleSegments
+                     && entry.TotalItemSize > ManagedAvifItemDataMaxSize
+                     && entry.ConstructionMethod == ConstructionMethod.FileOffset
+                     && TryGetMemoryMappedView(out MemoryMappedViewAccessor fileView))
+            {
+                data = CreateMemoryMappedItemData(entry, fileView);
+            }
             else
             {
                 data = ReadDataFromMultipleExtents(entry);
@@ -220,6 +348,38 @@ namespace AvifFileType
             return data;
         }
 
+        private MemoryMappedAvifItemData CreateMemoryMappedItemData(ItemLocationEntry entry, MemoryMappedViewAccessor view)
+        {
+            IReadOnlyList<ItemLocationExtent> extents = entry.Extents;
+            long[] offsets = new long[extents.Count];
+            ulong[] lengths = new ulong[extents.Count];
+            ulong remainingBytes = entry.TotalItemSize;
+
+            for (int i = 0; i < extents.Count; i++)
+            {
+                ItemLocationExtent extent = extents[i];
+
+                offsets[i] = CalculateExtentOffset(entry.BaseOffset, entry.ConstructionMethod, extent);
+                lengths[i] = extent.Length;
+
+                if (extent.Length > remainingBytes)
+                {
+                    throw new FormatException("The extent length is greater than the number of bytes remaining for the item.");
+                }
+
+                remainingBytes -= extent.Length;
+            }
+
+            if (remainingBytes > 0)
+            {
+                // This should never happen, the total item size is the sum of all the extent sizes.
+                throw new FormatException("The item has more data than was read from the extents.");
+            }
+
+            // The extents are passed to the decoder as separate segments without being joined.
+            return new MemoryMappedAvifItemData(view, offsets, lengths);
+        }
+
         public TProperty TryGetAssociatedItemProperty<TProperty>(uint itemId) where TProperty : class, IItemProperty
         {
             if (typeof(TProperty).IsAbstract)
@@ -350,7 +510,7 @@ namespace AvifFileType
                             throw new FormatException("The item has an invalid data box offset.");
                         }
 
-                        offset = (ulong)dataBox.Offset + extent.Offset;
+                        offset = (ulong)(dataBox.Offset + this.metaBoxPositionAdjustment) + extent.Offset;
 
                         if ((offset + extent.Length) > this.fileLength)
                         {
@@ -475,6 +635,15 @@ namespace AvifFileType
             CheckForRequiredBoxes();
         }
 
+        private byte[] ReadBoxBytes(Box box)
+        {
+            long startOffset = box.End - box.Size;
+
+            this.reader.Position = startOffset;
+
+            return this.reader.ReadBytes((int)box.Size);
+        }
+
         private AvifItemData ReadDataFromMultipleExtents(ItemLocationEntry entry)
         {
             AvifItemData data;
@@ -573,8 +742,102 @@ namespace AvifFileType
             return data;
         }
 
+        private bool TryGetMemoryMappedView(out MemoryMappedViewAccessor view)
+        {
+            if (this.memoryMappedView is null && this.fileStream != null && !this.memoryMappingFailed)
+            {
+                try
+                {
+#if NET47
+                    this.memoryMappedFile = MemoryMappedFile.CreateFromFile(this.fileStream,
+                                                                            null,
+                                                                            0,
+                                                                            MemoryMappedFileAccess.Read,
+                                                                            null,
+                                                                            HandleInheritability.None,
+                                                                            leaveOpen: true);
+#else
+                    this.memoryMappedFile = MemoryMappedFile.CreateFromFile(this.fileStream,
+                                                                            null,
+                                                                            0,
+                                                                            MemoryMappedFileAccess.Read,
+                                                                            HandleInheritability.None,
+                                                                            leaveOpen: true);
+#endif
+                    this.memoryMappedView = this.memoryMappedFile.CreateViewAccessor(0, 0, MemoryMappedFileAccess.Read);
+                }
+                catch (IOException)
+                {
+                    // The file could not be mapped, e.g. the process does not have enough address space
+                    // for the view, the item data will be copied from the stream instead.
+                    this.memoryMappingFailed = true;
+                }
+                catch (UnauthorizedAccessException)
+                {
+                    this.memoryMappingFailed = true;
+                }
+
+                if (this.memoryMappingFailed && this.memoryMappedFile != null)
+                {
+                    this.memoryMappedFile.Dispose();
+                    this.memoryMappedFile = null;
+                }
+            }
+
+            view = this.memoryMappedView;
+
+            return view != null;
+        }
+
+        private AvifContainerIndex TryCreateIndex(AvifContainerIndexKey key)
+        {
+            if (this.metaBox.Size > IndexedMetaBoxMaxSize)
+            {
+                return null;
+            }
+
+            Dictionary<uint, ImageGridDescriptor> imageGridDescriptors = new Dictionary<uint, ImageGridDescriptor>();
+
+            foreach (IItemInfoEntry entry in this.metaBox.ItemInfo.Entries)
+            {
+                if (entry.ItemType == ItemInfoEntryTypes.ImageGrid)
+                {
+                    try
+                    {
+                        ImageGridDescriptor gridDescriptor = TryGetImageGridDescriptor(entry.ItemId);
+
+                        if (gridDescriptor != null)
+                        {
+                            imageGridDescriptors[entry.ItemId] = gridDescriptor;
+                        }
+                    }
+                    catch (FormatException)
+                    {
+                        // An invalid grid descriptor is not stored in the index, it is read again when
+                        // the item is decoded so that the error is reported for the image that uses it.
+                    }
+                }
+            }
+
+            byte[] fileTypeBoxBytes = ReadBoxBytes(this.fileTypeBox);
+            byte[] metaBoxBytes = ReadBoxBytes(this.metaBox);
+
+            return new AvifContainerIndex(key,
+                                          this.fileTypeBox,
+                                          fileTypeBoxBytes,
+                                          this.metaBox,
+                                          metaBoxBytes,
+                                          this.metaBox.End - this.metaBox.Size,
+                                          imageGridDescriptors);
+        }
+
         private ImageGridDescriptor TryGetImageGridDescriptor(uint itemId)
         {
+            if (this.index != null && this.index.TryGetImageGridDescriptor(itemId, out ImageGridDescriptor cachedGridDescriptor))
+            {
+                return cachedGridDescriptor;
+            }
+
             IItemInfoEntry entry = TryGetItemInfoEntry(itemId);
 
             if (entry != null && entry.ItemType == ItemInfoEntryTypes.ImageGrid)
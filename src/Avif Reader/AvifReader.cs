@@ -35,6 +35,14 @@ namespace AvifFileType
         private readonly ImageGridInfo alphaGridInfo;
         private readonly IccProfileColorInformation iccProfileColorInformation;
         private readonly NclxColorInformation nclxColorInformation;
+        private readonly bool decodingThumbnailItem;
+        private SafeDecoderSessionHandle decoderSession;
+        private readonly bool ownsDecoderSession;
+        private uint downscaleShift;
+        private uint maxThreads;
+
+        // This must be kept in sync with MaxDecodeDownscaleShift in DecodedImageConverter.h.
+        private const int MaxDownscaleShift = 3;
 
         /// <summary>
         /// Initializes a new instance of the <see cref="AvifReader"/> class.
@@ -46,6 +54,81 @@ namespace AvifFileType
         /// <paramref name="arrayPool"/> is null.
         /// </exception>
         public AvifReader(Stream input, bool leaveOpen, PaintDotNet.AppModel.IArrayPoolService arrayPool)
+            : this(input, leaveOpen, arrayPool, 0)
+        {
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="AvifReader"/> class.
+        /// </summary>
+        /// <param name="parser">The parser.</param>
+        /// <param name="minimumThumbnailSize">
+        /// The minimum width or height of a thumbnail image that is read in place of the primary image,
+        /// a value of 0 always reads the primary image.
+        /// </param>
+        /// <exception cref="ArgumentNullException">
+        /// <paramref name="input"/> is null.
+        /// -or-
+        /// <paramref name="arrayPool"/> is null.
+        /// </exception>
+        public AvifReader(Stream input, bool leaveOpen, PaintDotNet.AppModel.IArrayPoolService arrayPool, uint minimumThumbnailSize)
+            : this(input, leaveOpen, arrayPool, minimumThumbnailSize, null)
+        {
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="AvifReader"/> class.
+        /// </summary>
+        /// <param name="parser">The parser.</param>
+        /// <param name="minimumThumbnailSize">
+        /// The minimum width or height of a thumbnail image that is read in place of the primary image,
+        /// a value of 0 always reads the primary image.
+        /// </param>
+        /// <param name="indexCache">
+        /// The cache that is used to skip parsing the container boxes when the same file is opened again,
+        /// or <see langword="null"/> to always parse the container boxes.
+        /// </param>
+        /// <exception cref="ArgumentNullException">
+        /// <paramref name="input"/> is null.
+        /// -or-
+        /// <paramref name="arrayPool"/> is null.
+        /// </exception>
+        public AvifReader(Stream input,
+                          bool leaveOpen,
+                          PaintDotNet.AppModel.IArrayPoolService arrayPool,
+                          uint minimumThumbnailSize,
+                          AvifContainerIndexCache indexCache)
+            : this(input, leaveOpen, arrayPool, minimumThumbnailSize, indexCache, null)
+        {
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="AvifReader"/> class.
+        /// </summary>
+        /// <param name="parser">The parser.</param>
+        /// <param name="minimumThumbnailSize">
+        /// The minimum width or height of a thumbnail image that is read in place of the primary image,
+        /// a value of 0 always reads the primary image.
+        /// </param>
+        /// <param name="indexCache">
+        /// The cache that is used to skip parsing the container boxes when the same file is opened again,
+        /// or <see langword="null"/> to always parse the container boxes.
+        /// </param>
+        /// <param name="decoderSession">
+        /// The decoder session that is shared with other readers, or <see langword="null"/> to use a session
+        /// that is owned by this reader. A shared session is not disposed when the reader is disposed.
+        /// </param>
+        /// <exception cref="ArgumentNullException">
+        /// <paramref name="input"/> is null.
+        /// -or-
+        /// <paramref name="arrayPool"/> is null.
+        /// </exception>
+        public AvifReader(Stream input,
+                          bool leaveOpen,
+                          PaintDotNet.AppModel.IArrayPoolService arrayPool,
+                          uint minimumThumbnailSize,
+                          AvifContainerIndexCache indexCache,
+                          SafeDecoderSessionHandle decoderSession)
         {
             if (input is null)
             {
@@ -59,8 +142,23 @@ namespace AvifFileType
 
             // The parser is initialized first because it will throw an exception
             // if the AVIF file is invalid or not supported.
-            this.parser = new AvifParser(input, leaveOpen, arrayPool);
+            this.parser = new AvifParser(input, leaveOpen, arrayPool, indexCache);
+            this.decoderSession = decoderSession;
+            this.ownsDecoderSession = decoderSession is null;
+            this.maxThreads = (uint)Environment.ProcessorCount;
             this.primaryItemId = this.parser.GetPrimaryItemId();
+            if (minimumThumbnailSize > 0)
+            {
+                // The thumbnail item is decoded using its own alpha image and item properties,
+                // the meta-data is only associated with the primary item.
+                uint thumbnailItemId = this.parser.GetThumbnailItemId(this.primaryItemId, minimumThumbnailSize);
+
+                if (thumbnailItemId != 0)
+                {
+                    this.primaryItemId = thumbnailItemId;
+                    this.decodingThumbnailItem = true;
+                }
+            }
             this.alphaItemId = this.parser.GetAlphaItemId(this.primaryItemId);
             this.parser.GetTransformationProperties(this.primaryItemId,
                                                     out this.cleanApertureBox,
@@ -105,6 +203,36 @@ namespace AvifFileType
 
         public ImageGridMetadata ImageGridMetadata { get; private set; }
 
+        /// <summary>
+        /// Gets or sets the maximum number of threads that are used to decode the image.
+        /// </summary>
+        /// <value>
+        /// The maximum number of threads, the default is <see cref="Environment.ProcessorCount"/>.
+        /// </value>
+        /// <exception cref="ArgumentOutOfRangeException">The value is less than 1.</exception>
+        public int MaxThreads
+        {
+            get => (int)this.maxThreads;
+            set
+            {
+                if (value < 1)
+                {
+                    ExceptionUtil.ThrowArgumentOutOfRangeException(nameof(value), "Must be >= 1.");
+                }
+
+                this.maxThreads = (uint)value;
+            }
+        }
+
+        /// <summary>
+        /// Gets or sets the statistics that the native decoder adds the statistics of each decode call to.
+        /// </summary>
+        /// <value>
+        /// The statistics of the images decoded by this reader, or <see langword="null"/> if they are not collected.
+        /// The default is <see langword="null"/>.
+        /// </value>
+        public InstrumentationStatistics Statistics { get; set; }
+
         public Surface Decode()
         {
             VerifyNotDisposed();
@@ -112,22 +240,67 @@ namespace AvifFileType
             EnsurePrimaryItemIsNotHidden();
             EnsureRequiredImagePropertiesAreSupported();
 
+            return DecodeImage();
+        }
+
+        /// <summary>
+        /// Decodes a reduced size copy of the image for a thumbnail.
+        /// </summary>
+        /// <param name="maxSize">The maximum width or height of the thumbnail.</param>
+        /// <returns>
+        /// The image downscaled by the largest power of two, up to 8, that keeps the longest side of the image
+        /// at least <paramref name="maxSize"/> pixels. The caller resamples it to the final thumbnail size.
+        /// </returns>
+        /// <exception cref="ArgumentOutOfRangeException"><paramref name="maxSize"/> is less than 1.</exception>
+        public Surface DecodeThumbnail(int maxSize)
+        {
+            if (maxSize < 1)
+            {
+                throw new ArgumentOutOfRangeException(nameof(maxSize));
+            }
+
+            VerifyNotDisposed();
+            EnsureCompressedImagesAreAV1();
+            EnsurePrimaryItemIsNotHidden();
+            EnsureRequiredImagePropertiesAreSupported();
+
+            // The image is downscaled when the YUV data is converted to BGRA, a full size copy of the image is never created.
+            this.downscaleShift = GetThumbnailDownscaleShift(maxSize);
+            try
+            {
+                return DecodeImage();
+            }
+            finally
+            {
+                this.downscaleShift = 0;
+            }
+        }
+
+        private Surface DecodeImage()
+        {
             Size colorSize = GetImageSize(this.primaryItemId, this.colorGridInfo, "color");
 
-            Surface surface = new Surface(colorSize);
+            Surface surface = new Surface(GetDownscaledSize(colorSize));
             bool disposeSurface = true;
 
             try
             {
-                ProcessColorImage(surface);
-                if (this.alphaItemId != 0)
+                if (CanDecodeColorAndAlphaTogether())
                 {
-                    ProcessAlphaImage(surface);
+                    ProcessColorAndAlphaImage(surface);
                 }
                 else
                 {
-                    // The AVIF file does not have an alpha channel.
-                    new UnaryPixelOps.SetAlphaChannelTo255().Apply(surface, surface.Bounds);
+                    ProcessColorImage(surface);
+                    if (this.alphaItemId != 0)
+                    {
+                        ProcessAlphaImage(surface);
+                    }
+                    else
+                    {
+                        // The AVIF file does not have an alpha channel.
+                        new UnaryPixelOps.SetAlphaChannelTo255().Apply(surface, surface.Bounds);
+                    }
                 }
                 ApplyImageTransforms(ref surface);
 
@@ -146,6 +319,74 @@ namespace AvifFileType
             return surface;
         }
 
+        /// <summary>
+        /// Decodes the specified region of the image.
+        /// </summary>
+        /// <param name="region">The region of the image to decode, after the image transforms have been applied.</param>
+        /// <returns>A surface containing the specified region of the image.</returns>
+        /// <remarks>
+        /// Only the image grid tiles that overlap the region are decoded, other images are decoded in full
+        /// and then cropped to the region.
+        /// </remarks>
+        /// <exception cref="ArgumentOutOfRangeException"><paramref name="region"/> is not within the image bounds.</exception>
+        public Surface DecodeRegion(Rectangle region)
+        {
+            VerifyNotDisposed();
+            EnsureCompressedImagesAreAV1();
+            EnsurePrimaryItemIsNotHidden();
+            EnsureRequiredImagePropertiesAreSupported();
+
+            Size colorSize = GetImageSize(this.primaryItemId, this.colorGridInfo, "color");
+            Size imageSize = ImageTransform.GetTransformedImageSize(colorSize, this.cleanApertureBox, this.imageRotateBox);
+
+            if (region.IsEmpty || !new Rectangle(Point.Empty, imageSize).Contains(region))
+            {
+                throw new ArgumentOutOfRangeException(nameof(region), "The region must be within the image bounds.");
+            }
+
+            Rectangle sourceRegion = ImageTransform.GetSourceRegion(region,
+                                                                    colorSize,
+                                                                    this.cleanApertureBox,
+                                                                    this.imageRotateBox,
+                                                                    this.imageMirrorBox);
+
+            Surface surface = null;
+            bool disposeSurface = true;
+
+            try
+            {
+                // The clean aperture can extend past the edges of the decoded image, the region is cropped
+                // from the full image when part of it is not covered by the image grid.
+                if (new Rectangle(Point.Empty, colorSize).Contains(sourceRegion)
+                    && CanDecodeImageGridRegion(out uint tileWidth, out uint tileHeight))
+                {
+                    surface = DecodeImageGridRegion(sourceRegion, tileWidth, tileHeight);
+                    ApplyRotateAndMirrorTransforms(ref surface);
+                }
+                else
+                {
+                    using (Surface fullImage = Decode())
+                    {
+                        surface = new Surface(region.Size);
+                        surface.CopySurface(fullImage, region);
+                    }
+                }
+
+                disposeSurface = false;
+            }
+            finally
+            {
+                // Free the surface if an exception was thrown when populating it.
+                if (disposeSurface)
+                {
+                    surface?.Dispose();
+                    surface = null;
+                }
+            }
+
+            return surface;
+        }
+
         public void Dispose()
         {
             if (!this.disposed)
@@ -153,9 +394,30 @@ namespace AvifFileType
                 this.disposed = true;
 
                 this.parser?.Dispose();
+
+                if (this.decoderSession != null)
+                {
+                    if (this.ownsDecoderSession)
+                    {
+                        this.decoderSession.Dispose();
+                    }
+                    this.decoderSession = null;
+                }
             }
         }
 
+        /// <summary>
+        /// Gets the size of the image before the image transforms are applied.
+        /// </summary>
+        /// <returns>The image size.</returns>
+        public Size GetImageSize()
+        {
+            VerifyNotDisposed();
+            EnsureCompressedImagesAreAV1();
+
+            return GetImageSize(this.primaryItemId, this.colorGridInfo, "color");
+        }
+
         public AvifItemData GetExifData()
         {
             VerifyNotDisposed();
@@ -232,9 +494,16 @@ namespace AvifFileType
 
             if (this.cleanApertureBox != null)
             {
-                ImageTransform.Crop(this.cleanApertureBox, ref surface);
+                Size imageSize = GetImageSize(this.primaryItemId, this.colorGridInfo, "color");
+
+                ImageTransform.Crop(this.cleanApertureBox, imageSize, (int)this.downscaleShift, ref surface);
             }
 
+            ApplyRotateAndMirrorTransforms(ref surface);
+        }
+
+        private void ApplyRotateAndMirrorTransforms(ref Surface surface)
+        {
             if (this.imageRotateBox != null)
             {
                 switch (this.imageRotateBox.Rotation)
@@ -271,6 +540,67 @@ namespace AvifFileType
             }
         }
 
+        private bool CanDecodeColorAndAlphaTogether()
+        {
+            if (this.alphaItemId == 0)
+            {
+                return false;
+            }
+
+            if (this.colorGridInfo is null)
+            {
+                return this.alphaGridInfo is null;
+            }
+
+            // The alpha image grid must use the same layout as the color image grid, each alpha tile
+            // is decoded into the same region of the output image as the color tile with the same index.
+            if (this.alphaGridInfo is null
+                || this.alphaGridInfo.TileColumnCount != this.colorGridInfo.TileColumnCount
+                || this.alphaGridInfo.TileRowCount != this.colorGridInfo.TileRowCount
+                || this.alphaGridInfo.ChildImageIds.Count != this.colorGridInfo.ChildImageIds.Count
+                || this.colorGridInfo.ChildImageIds.Count == 0)
+            {
+                return false;
+            }
+
+            ImageSpatialExtentsBox colorTileExtents = this.parser.TryGetAssociatedItemProperty<ImageSpatialExtentsBox>(this.colorGridInfo.ChildImageIds[0]);
+            ImageSpatialExtentsBox alphaTileExtents = this.parser.TryGetAssociatedItemProperty<ImageSpatialExtentsBox>(this.alphaGridInfo.ChildImageIds[0]);
+
+            return colorTileExtents != null
+                && alphaTileExtents != null
+                && colorTileExtents.ImageWidth == alphaTileExtents.ImageWidth
+                && colorTileExtents.ImageHeight == alphaTileExtents.ImageHeight;
+        }
+
+        private bool CanDecodeImageGridRegion(out uint tileWidth, out uint tileHeight)
+        {
+            tileWidth = 0;
+            tileHeight = 0;
+
+            if (this.colorGridInfo is null || this.colorGridInfo.ChildImageIds.Count == 0)
+            {
+                return false;
+            }
+
+            // The alpha image must be decoded from the same tiles as the color image.
+            if (this.alphaItemId != 0 && !CanDecodeColorAndAlphaTogether())
+            {
+                return false;
+            }
+
+            // The tile size is required to find the tiles that overlap the region before they are decoded.
+            ImageSpatialExtentsBox tileExtents = this.parser.TryGetAssociatedItemProperty<ImageSpatialExtentsBox>(this.colorGridInfo.ChildImageIds[0]);
+
+            if (tileExtents is null || tileExtents.ImageWidth == 0 || tileExtents.ImageHeight == 0)
+            {
+                return false;
+            }
+
+            tileWidth = tileExtents.ImageWidth;
+            tileHeight = tileExtents.ImageHeight;
+            return true;
+        }
+
         private void CheckImageItemType(uint itemId, ImageGridInfo gridInfo, string imageName, bool checkingGridChildren = false)
         {
             IItemInfoEntry entry = this.parser.TryGetItemInfoEntry(itemId);
@@ -352,18 +682,277 @@ namespace AvifFileType
 
         private void DecodeColorImage(uint itemId, DecodeInfo decodeInfo, CICPColorData? colorConversionInfo, Surface fullSurface)
         {
-            using (AvifItemData color = ReadColorImage(itemId))
+            using (AvifItemData color = ReadColorImage(itemId, allowMultipleSegments: true))
             {
-                AvifNative.DecompressColor(color, colorConversionInfo, decodeInfo, fullSurface);
+                AvifNative.DecompressColor(GetDecoderSession(), color, colorConversionInfo, decodeInfo, fullSurface, this.Statistics);
             }
         }
 
         private void DecodeAlphaImage(uint itemId, DecodeInfo decodeInfo, Surface fullSurface)
         {
-            using (AvifItemData alpha = ReadAlphaImage(itemId))
+            using (AvifItemData alpha = ReadAlphaImage(itemId, allowMultipleSegments: true))
+            {
+                AvifNative.DecompressAlpha(GetDecoderSession(), alpha, decodeInfo, fullSurface, this.Statistics);
+            }
+        }
+
+        private void DecodeAlphaTiles(IReadOnlyList<uint> itemIds,
+                                      int tileColumnCount,
+                                      int tileRowCount,
+                                      DecodeInfo decodeInfo,
+                                      Surface surface)
+        {
+            AvifItemData[] tiles = new AvifItemData[itemIds.Count];
+
+            try
+            {
+                // The tiles are stored from left to right then top to bottom.
+
+                for (int i = 0; i < tiles.Length; i++)
+                {
+                    tiles[i] = ReadAlphaImage(itemIds[i], allowMultipleSegments: false);
+                }
+
+                AvifNative.DecompressAlphaGrid(GetDecoderSession(),
+                                               tiles,
+                                               tileColumnCount,
+                                               tileRowCount,
+                                               decodeInfo,
+                                               surface,
+                                               this.Statistics);
+            }
+            finally
+            {
+                for (int i = 0; i < tiles.Length; i++)
+                {
+                    tiles[i]?.Dispose();
+                }
+            }
+        }
+
+        private void DecodeColorAndAlphaTiles(IReadOnlyList<uint> colorItemIds,
+                                              IReadOnlyList<uint> alphaItemIds,
+                                              int tileColumnCount,
+                                              int tileRowCount,
+                                              CICPColorData? colorInfo,
+                                              DecodeInfo colorDecodeInfo,
+                                              DecodeInfo alphaDecodeInfo,
+                                              bool unpremultiplyAlpha,
+                                              Surface surface)
+        {
+            AvifItemData[] colorTiles = new AvifItemData[colorItemIds.Count];
+            AvifItemData[] alphaTiles = new AvifItemData[alphaItemIds.Count];
+
+            try
+            {
+                // The tiles are stored from left to right then top to bottom.
+
+                for (int i = 0; i < colorTiles.Length; i++)
+                {
+                    colorTiles[i] = ReadColorImage(colorItemIds[i], allowMultipleSegments: false);
+                    alphaTiles[i] = ReadAlphaImage(alphaItemIds[i], allowMultipleSegments: false);
+                }
+
+                AvifNative.DecompressColorAlphaGrid(GetDecoderSession(),
+                                                    colorTiles,
+                                                    alphaTiles,
+                                                    tileColumnCount,
+                                                    tileRowCount,
+                                                    colorInfo,
+                                                    colorDecodeInfo,
+                                                    alphaDecodeInfo,
+                                                    unpremultiplyAlpha,
+                                                    surface,
+                                                    this.Statistics);
+            }
+            finally
+            {
+                for (int i = 0; i < colorTiles.Length; i++)
+                {
+                    colorTiles[i]?.Dispose();
+                    alphaTiles[i]?.Dispose();
+                }
+            }
+        }
+
+        private void DecodeColorTiles(IReadOnlyList<uint> itemIds,
+                                      int tileColumnCount,
+                                      int tileRowCount,
+                                      CICPColorData? colorInfo,
+                                      DecodeInfo decodeInfo,
+                                      Surface surface)
+        {
+            AvifItemData[] tiles = new AvifItemData[itemIds.Count];
+
+            try
+            {
+                // The tiles are stored from left to right then top to bottom.
+
+                for (int i = 0; i < tiles.Length; i++)
+                {
+                    tiles[i] = ReadColorImage(itemIds[i], allowMultipleSegments: false);
+                }
+
+                AvifNative.DecompressColorGrid(GetDecoderSession(),
+                                               tiles,
+                                               tileColumnCount,
+                                               tileRowCount,
+                                               colorInfo,
+                                               decodeInfo,
+                                               surface,
+                                               this.Statistics);
+            }
+            finally
+            {
+                for (int i = 0; i < tiles.Length; i++)
+                {
+                    tiles[i]?.Dispose();
+                }
+            }
+        }
+
+        private Surface DecodeImageGridRegion(Rectangle sourceRegion, uint tileWidth, uint tileHeight)
+        {
+            this.colorGridInfo.CheckAvailableTileCount();
+            if (this.alphaItemId != 0)
+            {
+                this.alphaGridInfo.CheckAvailableTileCount();
+            }
+
+            int firstColumn = (int)((uint)sourceRegion.Left / tileWidth);
+            int lastColumn = (int)((uint)(sourceRegion.Right - 1) / tileWidth);
+            int firstRow = (int)((uint)sourceRegion.Top / tileHeight);
+            int lastRow = (int)((uint)(sourceRegion.Bottom - 1) / tileHeight);
+
+            if (lastColumn >= this.colorGridInfo.TileColumnCount || lastRow >= this.colorGridInfo.TileRowCount)
+            {
+                ExceptionUtil.ThrowFormatException("The image grid tiles do not cover the entire output image.");
+            }
+
+            int tileColumnCount = lastColumn - firstColumn + 1;
+            int tileRowCount = lastRow - firstRow + 1;
+
+            uint[] colorItemIds = new uint[tileColumnCount * tileRowCount];
+            uint[] alphaItemIds = this.alphaItemId != 0 ? new uint[colorItemIds.Length] : null;
+
+            for (int row = 0; row < tileRowCount; row++)
+            {
+                for (int column = 0; column < tileColumnCount; column++)
+                {
+                    int index = (row * tileColumnCount) + column;
+                    int gridIndex = ((firstRow + row) * this.colorGridInfo.TileColumnCount) + firstColumn + column;
+
+                    colorItemIds[index] = this.colorGridInfo.ChildImageIds[gridIndex];
+                    if (alphaItemIds != null)
+                    {
+                        alphaItemIds[index] = this.alphaGridInfo.ChildImageIds[gridIndex];
+                    }
+                }
+            }
+
+            // The overlapping tiles are decoded into a surface that starts at the top left corner
+            // of the first tile, the tiles on the right and bottom edges are clipped to the image size.
+            long tilesLeft = (long)firstColumn * tileWidth;
+            long tilesTop = (long)firstRow * tileHeight;
+            int tilesWidth = (int)Math.Min(this.colorGridInfo.OutputWidth - tilesLeft, (long)tileColumnCount * tileWidth);
+            int tilesHeight = (int)Math.Min(this.colorGridInfo.OutputHeight - tilesTop, (long)tileRowCount * tileHeight);
+
+            // The expected tile size is set before decoding because the tile positions were computed from it.
+            DecodeInfo colorDecodeInfo = new DecodeInfo
+            {
+                expectedWidth = tileWidth,
+                expectedHeight = tileHeight,
+                maxConversionThreads = this.maxThreads,
+                maxDecoderThreads = this.maxThreads
+            };
+            CICPColorData? colorConversionInfo = GetColorConversionInfo();
+
+            Surface tiles = new Surface(tilesWidth, tilesHeight);
+            try
+            {
+                if (this.alphaItemId != 0)
+                {
+                    DecodeInfo alphaDecodeInfo = new DecodeInfo
+                    {
+                        expectedWidth = tileWidth,
+                        expectedHeight = tileHeight,
+                        maxConversionThreads = this.maxThreads,
+                        maxDecoderThreads = this.maxThreads
+                    };
+
+                    DecodeColorAndAlphaTiles(colorItemIds,
+                                             alphaItemIds,
+                                             tileColumnCount,
+                                             tileRowCount,
+                                             colorConversionInfo,
+                                             colorDecodeInfo,
+                                             alphaDecodeInfo,
+                                             this.parser.IsAlphaPremultiplied(this.primaryItemId, this.alphaItemId),
+                                             tiles);
+
+                    if (this.colorGridInfo.ChildImageIds.Count > 1)
+                    {
+                        CheckImageGridAndTileBounds(alphaDecodeInfo.expectedWidth,
+                                                    alphaDecodeInfo.expectedHeight,
+                                                    alphaDecodeInfo.chromaSubsampling,
+                                                    this.alphaGridInfo);
+                    }
+                }
+                else
+                {
+                    DecodeColorTiles(colorItemIds,
+                                     tileColumnCount,
+                                     tileRowCount,
+                                     colorConversionInfo,
+                                     colorDecodeInfo,
+                                     tiles);
+
+                    // The AVIF file does not have an alpha channel.
+                    new UnaryPixelOps.SetAlphaChannelTo255().Apply(tiles, tiles.Bounds);
+                }
+
+                // Skip the image grid validation if the image grid only has one tile.
+                // Some writers may use an image grid to crop a single image.
+                if (this.colorGridInfo.ChildImageIds.Count > 1)
+                {
+                    CheckImageGridAndTileBounds(colorDecodeInfo.expectedWidth,
+                                                colorDecodeInfo.expectedHeight,
+                                                colorDecodeInfo.chromaSubsampling,
+                                                this.colorGridInfo);
+                }
+
+                this.ImageGridMetadata = new ImageGridMetadata(this.colorGridInfo, colorDecodeInfo.expectedHeight, colorDecodeInfo.expectedWidth);
+                SetImageColorData(colorConversionInfo, colorDecodeInfo);
+
+                Rectangle regionInTiles = new Rectangle((int)(sourceRegion.X - tilesLeft),
+                                                        (int)(sourceRegion.Y - tilesTop),
+                                                        sourceRegion.Width,
+                                                        sourceRegion.Height);
+
+                if (regionInTiles != tiles.Bounds)
+                {
+                    Surface temp = new Surface(regionInTiles.Size);
+                    try
+                    {
+                        temp.CopySurface(tiles, regionInTiles);
+
+                        tiles.Dispose();
+                        tiles = temp;
+                        temp = null;
+                    }
+                    finally
+                    {
+                        temp?.Dispose();
+                    }
+                }
+            }
+            catch
             {
-                AvifNative.DecompressAlpha(alpha, decodeInfo, fullSurface);
+                tiles.Dispose();
+                throw;
             }
+
+            return tiles;
         }
 
         private void EnsureCompressedImagesAreAV1()
@@ -378,6 +967,12 @@ namespace AvifFileType
 
         private void EnsurePrimaryItemIsNotHidden()
         {
+            // Thumbnail items are allowed to be hidden.
+            if (this.decodingThumbnailItem)
+            {
+                return;
+            }
+
             IItemInfoEntry entry = this.parser.TryGetItemInfoEntry(this.primaryItemId);
 
             if (entry is null)
@@ -406,40 +1001,28 @@ namespace AvifFileType
             DecodeInfo decodeInfo = new DecodeInfo
             {
                 expectedWidth = 0,
-                expectedHeight = 0
+                expectedHeight = 0,
+                maxConversionThreads = this.maxThreads,
+                maxDecoderThreads = this.maxThreads,
+                downscaleShift = this.downscaleShift
             };
 
             IReadOnlyList<uint> childImageIds = this.alphaGridInfo.ChildImageIds;
-            bool firstTile = true;
 
-            // The tiles are encoded from top to bottom then left to right.
+            DecodeAlphaTiles(childImageIds,
+                             this.alphaGridInfo.TileColumnCount,
+                             this.alphaGridInfo.TileRowCount,
+                             decodeInfo,
+                             fullSurface);
 
-            for (int row = 0; row < this.alphaGridInfo.TileRowCount; row++)
+            // Skip the image grid validation if the image grid only has one tile.
+            // Some writers may use an image grid to crop a single image.
+            if (childImageIds.Count > 1)
             {
-                decodeInfo.tileRowIndex = (uint)row;
-                int startIndex = row * this.alphaGridInfo.TileColumnCount;
-
-                for (int col = 0; col < this.alphaGridInfo.TileColumnCount; col++)
-                {
-                    decodeInfo.tileColumnIndex = (uint)col;
-
-                    DecodeAlphaImage(childImageIds[startIndex + col], decodeInfo, fullSurface);
-
-                    if (firstTile)
-                    {
-                        firstTile = false;
-
-                        // Skip the image grid validation if the image grid only has one tile.
-                        // Some writers may use an image grid to crop a single image.
-                        if (childImageIds.Count > 1)
-                        {
-                            CheckImageGridAndTileBounds(decodeInfo.expectedWidth,
-                                                        decodeInfo.expectedHeight,
-                                                        decodeInfo.chromaSubsampling,
-                                                        this.alphaGridInfo);
-                        }
-                    }
-                }
+                CheckImageGridAndTileBounds(decodeInfo.expectedWidth,
+                                            decodeInfo.expectedHeight,
+                                            decodeInfo.chromaSubsampling,
+                                            this.alphaGridInfo);
             }
         }
 
@@ -449,44 +1032,70 @@ namespace AvifFileType
             DecodeInfo decodeInfo = new DecodeInfo
             {
                 expectedWidth = 0,
-                expectedHeight = 0
+                expectedHeight = 0,
+                maxConversionThreads = this.maxThreads,
+                maxDecoderThreads = this.maxThreads,
+                downscaleShift = this.downscaleShift
             };
 
             IReadOnlyList<uint> childImageIds = this.colorGridInfo.ChildImageIds;
-            bool firstTile = true;
 
-            // The tiles are encoded from top to bottom then left to right.
+            DecodeColorTiles(childImageIds,
+                             this.colorGridInfo.TileColumnCount,
+                             this.colorGridInfo.TileRowCount,
+                             colorInfo,
+                             decodeInfo,
+                             fullSurface);
 
-            for (int row = 0; row < this.colorGridInfo.TileRowCount; row++)
+            // Skip the image grid validation if the image grid only has one tile.
+            // Some writers may use an image grid to crop a single image.
+            if (childImageIds.Count > 1)
             {
-                decodeInfo.tileRowIndex = (uint)row;
-                int startIndex = row * this.colorGridInfo.TileColumnCount;
+                CheckImageGridAndTileBounds(decodeInfo.expectedWidth,
+                                            decodeInfo.expectedHeight,
+                                            decodeInfo.chromaSubsampling,
+                                            this.colorGridInfo);
+            }
+
+            this.ImageGridMetadata = new ImageGridMetadata(this.colorGridInfo, decodeInfo.expectedHeight, decodeInfo.expectedWidth);
+            SetImageColorData(colorInfo, decodeInfo);
+        }
 
-                for (int col = 0; col < this.colorGridInfo.TileColumnCount; col++)
+        private CICPColorData? GetColorConversionInfo()
+        {
+            CICPColorData? colorConversionInfo = null;
+            if (this.nclxColorInformation != null)
+            {
+                colorConversionInfo = new CICPColorData
                 {
-                    decodeInfo.tileColumnIndex = (uint)col;
+                    colorPrimaries = this.nclxColorInformation.ColorPrimaries,
+                    transferCharacteristics = this.nclxColorInformation.TransferCharacteristics,
+                    matrixCoefficients = this.nclxColorInformation.MatrixCoefficients,
+                    fullRange = this.nclxColorInformation.FullRange
+                };
+            }
 
-                    DecodeColorImage(childImageIds[startIndex + col], decodeInfo, colorInfo, fullSurface);
+            return colorConversionInfo;
+        }
 
-                    if (firstTile)
-                    {
-                        firstTile = false;
-
-                        // Skip the image grid validation if the image grid only has one tile.
-                        // Some writers may use an image grid to crop a single image.
-                        if (childImageIds.Count > 1)
-                        {
-                            CheckImageGridAndTileBounds(decodeInfo.expectedWidth,
-                                                        decodeInfo.expectedHeight,
-                                                        decodeInfo.chromaSubsampling,
-                                                        this.colorGridInfo);
-                        }
-                    }
-                }
+        private SafeDecoderSessionHandle GetDecoderSession()
+        {
+            // The decoder session is shared by the color and alpha images, it keeps the
+            // native AV1 decoders alive so that they can be reused for each image grid tile.
+            if (this.decoderSession is null)
+            {
+                this.decoderSession = AvifNative.CreateDecoderSession();
             }
 
-            this.ImageGridMetadata = new ImageGridMetadata(this.colorGridInfo, decodeInfo.expectedHeight, decodeInfo.expectedWidth);
-            SetImageColorData(colorInfo, decodeInfo);
+            return this.decoderSession;
+        }
+
+        private Size GetDownscaledSize(Size imageSize)
+        {
+            int scale = 1 << (int)this.downscaleShift;
+
+            return new Size((int)(((long)imageSize.Width + scale - 1) >> (int)this.downscaleShift),
+                            (int)(((long)imageSize.Height + scale - 1) >> (int)this.downscaleShift));
         }
 
         private Size GetImageSize(uint itemId, ImageGridInfo gridInfo, string imageName)
@@ -531,6 +1140,51 @@ namespace AvifFileType
             return new Size((int)width, (int)height);
         }
 
+        private uint GetThumbnailDownscaleShift(int maxSize)
+        {
+            Size imageSize = GetImageSize(this.primaryItemId, this.colorGridInfo, "color");
+            int longestSide = Math.Max(imageSize.Width, imageSize.Height);
+
+            int shift = 0;
+            while (shift < MaxDownscaleShift && (longestSide >> (shift + 1)) >= maxSize)
+            {
+                shift++;
+            }
+
+            // Each image grid tile must start on a pixel of the downscaled image,
+            // so the tile size must be a multiple of the downscale factor.
+            shift = Math.Min(shift, GetMaxTileDownscaleShift(this.colorGridInfo));
+            if (this.alphaItemId != 0)
+            {
+                shift = Math.Min(shift, GetMaxTileDownscaleShift(this.alphaGridInfo));
+            }
+
+            return (uint)shift;
+        }
+
+        private int GetMaxTileDownscaleShift(ImageGridInfo gridInfo)
+        {
+            if (gridInfo is null || gridInfo.ChildImageIds.Count <= 1)
+            {
+                return MaxDownscaleShift;
+            }
+
+            ImageSpatialExtentsBox tileExtents = this.parser.TryGetAssociatedItemProperty<ImageSpatialExtentsBox>(gridInfo.ChildImageIds[0]);
+
+            if (tileExtents is null)
+            {
+                return 0;
+            }
+
+            int shift = MaxDownscaleShift;
+            while (shift > 0 && ((tileExtents.ImageWidth | tileExtents.ImageHeight) & ((1U << shift) - 1)) != 0)
+            {
+                shift--;
+            }
+
+            return shift;
+        }
+
         private void ProcessAlphaImage(Surface fullSurface)
         {
             if (this.alphaGridInfo != null)
@@ -539,12 +1193,18 @@ namespace AvifFileType
             }
             else
             {
+                // The surface is smaller than the image when it is downscaled.
+                Size imageSize = GetImageSize(this.primaryItemId, this.colorGridInfo, "color");
+
                 DecodeInfo decodeInfo = new DecodeInfo
                 {
                     tileColumnIndex = 0,
                     tileRowIndex = 0,
-                    expectedWidth = (uint)fullSurface.Width,
-                    expectedHeight = (uint)fullSurface.Height
+                    expectedWidth = (uint)imageSize.Width,
+                    expectedHeight = (uint)imageSize.Height,
+                    maxConversionThreads = this.maxThreads,
+                    maxDecoderThreads = this.maxThreads,
+                    downscaleShift = this.downscaleShift
                 };
 
                 DecodeAlphaImage(this.alphaItemId, decodeInfo, fullSurface);
@@ -556,32 +1216,114 @@ namespace AvifFileType
             }
         }
 
-        private void ProcessColorImage(Surface fullSurface)
+        private void ProcessColorAndAlphaImage(Surface fullSurface)
         {
-            CICPColorData? colorConversionInfo = null;
-            if (this.nclxColorInformation != null)
+            CICPColorData? colorConversionInfo = GetColorConversionInfo();
+            bool unpremultiplyAlpha = this.parser.IsAlphaPremultiplied(this.primaryItemId, this.alphaItemId);
+
+            IReadOnlyList<uint> colorItemIds;
+            IReadOnlyList<uint> alphaItemIds;
+            int tileColumnCount;
+            int tileRowCount;
+            uint expectedWidth;
+            uint expectedHeight;
+
+            if (this.colorGridInfo != null)
             {
-                colorConversionInfo = new CICPColorData
+                this.colorGridInfo.CheckAvailableTileCount();
+                this.alphaGridInfo.CheckAvailableTileCount();
+
+                colorItemIds = this.colorGridInfo.ChildImageIds;
+                alphaItemIds = this.alphaGridInfo.ChildImageIds;
+                tileColumnCount = this.colorGridInfo.TileColumnCount;
+                tileRowCount = this.colorGridInfo.TileRowCount;
+                expectedWidth = 0;
+                expectedHeight = 0;
+            }
+            else
+            {
+                // A single image is decoded as an image grid with one tile.
+                Size imageSize = GetImageSize(this.primaryItemId, this.colorGridInfo, "color");
+
+                colorItemIds = new uint[] { this.primaryItemId };
+                alphaItemIds = new uint[] { this.alphaItemId };
+                tileColumnCount = 1;
+                tileRowCount = 1;
+                expectedWidth = (uint)imageSize.Width;
+                expectedHeight = (uint)imageSize.Height;
+            }
+
+            DecodeInfo colorDecodeInfo = new DecodeInfo
+            {
+                expectedWidth = expectedWidth,
+                expectedHeight = expectedHeight,
+                maxConversionThreads = this.maxThreads,
+                maxDecoderThreads = this.maxThreads,
+                downscaleShift = this.downscaleShift
+            };
+            DecodeInfo alphaDecodeInfo = new DecodeInfo
+            {
+                expectedWidth = expectedWidth,
+                expectedHeight = expectedHeight,
+                maxConversionThreads = this.maxThreads,
+                maxDecoderThreads = this.maxThreads,
+                downscaleShift = this.downscaleShift
+            };
+
+            DecodeColorAndAlphaTiles(colorItemIds,
+                                     alphaItemIds,
+                                     tileColumnCount,
+                                     tileRowCount,
+                                     colorConversionInfo,
+                                     colorDecodeInfo,
+                                     alphaDecodeInfo,
+                                     unpremultiplyAlpha,
+                                     fullSurface);
+
+            if (this.colorGridInfo != null)
+            {
+                // Skip the image grid validation if the image grid only has one tile.
+                // Some writers may use an image grid to crop a single image.
+                if (colorItemIds.Count > 1)
                 {
-                    colorPrimaries = this.nclxColorInformation.ColorPrimaries,
-                    transferCharacteristics = this.nclxColorInformation.TransferCharacteristics,
-                    matrixCoefficients = this.nclxColorInformation.MatrixCoefficients,
-                    fullRange = this.nclxColorInformation.FullRange
-                };
+                    CheckImageGridAndTileBounds(colorDecodeInfo.expectedWidth,
+                                                colorDecodeInfo.expectedHeight,
+                                                colorDecodeInfo.chromaSubsampling,
+                                                this.colorGridInfo);
+                    CheckImageGridAndTileBounds(alphaDecodeInfo.expectedWidth,
+                                                alphaDecodeInfo.expectedHeight,
+                                                alphaDecodeInfo.chromaSubsampling,
+                                                this.alphaGridInfo);
+                }
+
+                this.ImageGridMetadata = new ImageGridMetadata(this.colorGridInfo, colorDecodeInfo.expectedHeight, colorDecodeInfo.expectedWidth);
             }
 
+            SetImageColorData(colorConversionInfo, colorDecodeInfo);
+        }
+
+        private void ProcessColorImage(Surface fullSurface)
+        {
+            CICPColorData? colorConversionInfo = GetColorConversionInfo();
+
             if (this.colorGridInfo != null)
             {
                 FillColorImageGrid(colorConversionInfo, fullSurface);
             }
             else
             {
+                // The surface is smaller than the image when it is downscaled.
+                Size imageSize = GetImageSize(this.primaryItemId, this.colorGridInfo, "color");
+
                 DecodeInfo decodeInfo = new DecodeInfo
                 {
                     tileColumnIndex = 0,
                     tileRowIndex = 0,
-                    expectedWidth = (uint)fullSurface.Width,
-                    expectedHeight = (uint)fullSurface.Height
+                    expectedWidth = (uint)imageSize.Width,
+                    expectedHeight = (uint)imageSize.Height,
+                    maxConversionThreads = this.maxThreads,
+                    maxDecoderThreads = this.maxThreads,
+                    downscaleShift = this.downscaleShift
                 };
 
                 DecodeColorImage(this.primaryItemId, decodeInfo, colorConversionInfo, fullSurface);
@@ -589,7 +1331,7 @@ namespace AvifFileType
             }
         }
 
-        private AvifItemData ReadAlphaImage(uint itemId)
+        private AvifItemData ReadAlphaImage(uint itemId, bool allowMultipleSegments)
         {
             ItemLocationEntry entry = this.parser.TryGetItemLocation(itemId);
 
@@ -598,10 +1340,10 @@ namespace AvifFileType
                 ExceptionUtil.ThrowFormatException("The alpha image item location was not found.");
             }
 
-            return this.parser.ReadItemData(entry);
+            return this.parser.ReadItemData(entry, allowMultipleSegments);
         }
 
-        private AvifItemData ReadColorImage(uint itemId)
+        private AvifItemData ReadColorImage(uint itemId, bool allowMultipleSegments)
         {
             ItemLocationEntry entry = this.parser.TryGetItemLocation(itemId);
 
@@ -610,7 +1352,7 @@ namespace AvifFileType
                 ExceptionUtil.ThrowFormatException("The color image item location was not found.");
             }
 
-            return this.parser.ReadItemData(entry);
+            return this.parser.ReadItemData(entry, allowMultipleSegments);
         }
 
         private void SetImageColorData(CICPColorData? containerColorData, DecodeInfo decodeInfo)
@@ -19,45 +19,37 @@ namespace AvifFileType
 {
     internal static class ImageTransform
     {
-        internal static void Crop(CleanApertureBox cleanApertureBox, ref Surface surface)
+        /// <summary>
+        /// Crops the image to the clean aperture.
+        /// </summary>
+        /// <param name="cleanApertureBox">The clean aperture box.</param>
+        /// <param name="imageSize">The size of the decoded image.</param>
+        /// <param name="downscaleShift">The power of two that <paramref name="surface"/> was downscaled by.</param>
+        /// <param name="surface">The surface.</param>
+        internal static void Crop(CleanApertureBox cleanApertureBox, Size imageSize, int downscaleShift, ref Surface surface)
         {
             if (cleanApertureBox is null)
             {
                 ExceptionUtil.ThrowArgumentNullException(nameof(cleanApertureBox));
             }
 
-            if (cleanApertureBox.Width.Denominator == 0 ||
-                cleanApertureBox.Height.Denominator == 0 ||
-                cleanApertureBox.HorizontalOffset.Denominator == 0 ||
-                cleanApertureBox.VerticalOffset.Denominator == 0)
-            {
-                return;
-            }
+            Rectangle cropRect = GetCropRectangle(cleanApertureBox, imageSize);
 
-            int cropWidth = cleanApertureBox.Width.ToInt32();
-            int cropHeight = cleanApertureBox.Height.ToInt32();
-
-            if (cropWidth <= 0 || cropHeight <= 0)
+            if (!cropRect.IsEmpty)
             {
-                // Invalid crop width/height.
-                return;
-            }
-
-            double offsetX = cleanApertureBox.HorizontalOffset.ToDouble();
-            double offsetY = cleanApertureBox.VerticalOffset.ToDouble();
-
-            double pictureCenterX = offsetX + ((surface.Width - 1) / 2.0);
-            double pictureCenterY = offsetY + ((surface.Height - 1) / 2.0);
-
-            int cropRectX = (int)Math.Round(pictureCenterX - ((cropWidth - 1) / 2.0));
-            int cropRectY = (int)Math.Round(pictureCenterY - ((cropHeight - 1) / 2.0));
+                if (downscaleShift != 0)
+                {
+                    // The edges of the scaled crop rectangle include the partially covered pixels.
+                    int scale = 1 << downscaleShift;
+                    int left = cropRect.Left >> downscaleShift;
+                    int top = cropRect.Top >> downscaleShift;
+                    int right = (cropRect.Right + scale - 1) >> downscaleShift;
+                    int bottom = (cropRect.Bottom + scale - 1) >> downscaleShift;
 
-            Rectangle cropRect = new Rectangle(cropRectX, cropRectY, cropWidth, cropHeight);
+                    cropRect = Rectangle.FromLTRB(left, top, right, bottom);
+                }
 
-            // Check that the crop rectangle is within the surface bounds.
-            if (cropRect.IntersectsWith(surface.Bounds))
-            {
-                Surface temp = new Surface(cropWidth, cropHeight);
+                Surface temp = new Surface(cropRect.Width, cropRect.Height);
                 try
                 {
                     temp.CopySurface(surface, cropRect);
@@ -73,6 +65,115 @@ namespace AvifFileType
             }
         }
 
+        /// <summary>
+        /// Gets the size of the image after the crop and rotate transforms have been applied.
+        /// </summary>
+        /// <param name="imageSize">The size of the decoded image.</param>
+        /// <param name="cleanApertureBox">The clean aperture box, or <see langword="null"/>.</param>
+        /// <param name="imageRotateBox">The image rotate box, or <see langword="null"/>.</param>
+        /// <returns>The size of the transformed image.</returns>
+        internal static Size GetTransformedImageSize(Size imageSize, CleanApertureBox cleanApertureBox, ImageRotateBox imageRotateBox)
+        {
+            Size size = imageSize;
+
+            if (cleanApertureBox != null)
+            {
+                Rectangle cropRect = GetCropRectangle(cleanApertureBox, imageSize);
+
+                if (!cropRect.IsEmpty)
+                {
+                    size = cropRect.Size;
+                }
+            }
+
+            if (imageRotateBox != null
+                && (imageRotateBox.Rotation == ImageRotation.Rotate90CCW || imageRotateBox.Rotation == ImageRotation.Rotate270CCW))
+            {
+                size = new Size(size.Height, size.Width);
+            }
+
+            return size;
+        }
+
+        /// <summary>
+        /// Maps a region of the transformed image to the region of the decoded image that it is copied from.
+        /// </summary>
+        /// <param name="region">The region of the transformed image.</param>
+        /// <param name="imageSize">The size of the decoded image.</param>
+        /// <param name="cleanApertureBox">The clean aperture box, or <see langword="null"/>.</param>
+        /// <param name="imageRotateBox">The image rotate box, or <see langword="null"/>.</param>
+        /// <param name="imageMirrorBox">The image mirror box, or <see langword="null"/>.</param>
+        /// <returns>
+        /// The region of the decoded image, applying the rotate and mirror transforms to it produces <paramref name="region"/>.
+        /// </returns>
+        internal static Rectangle GetSourceRegion(Rectangle region,
+                                                  Size imageSize,
+                                                  CleanApertureBox cleanApertureBox,
+                                                  ImageRotateBox imageRotateBox,
+                                                  ImageMirrorBox imageMirrorBox)
+        {
+            Rectangle cropRect = Rectangle.Empty;
+
+            if (cleanApertureBox != null)
+            {
+                cropRect = GetCropRectangle(cleanApertureBox, imageSize);
+            }
+
+            Size croppedSize = cropRect.IsEmpty ? imageSize : cropRect.Size;
+            Size transformedSize = GetTransformedImageSize(imageSize, cleanApertureBox, imageRotateBox);
+
+            // The transforms are reversed in the opposite order that they are applied.
+            Rectangle sourceRegion = region;
+
+            if (imageMirrorBox != null)
+            {
+                switch (imageMirrorBox.MirrorDirection)
+                {
+                    case ImageMirrorDirection.Vertical:
+                        sourceRegion.Y = transformedSize.Height - sourceRegion.Bottom;
+                        break;
+                    case ImageMirrorDirection.Horizontal:
+                        sourceRegion.X = transformedSize.Width - sourceRegion.Right;
+                        break;
+                    default:
+                        throw new InvalidOperationException("Unknown ImageMirrorDirection value.");
+                }
+            }
+
+            if (imageRotateBox != null)
+            {
+                switch (imageRotateBox.Rotation)
+                {
+                    case ImageRotation.RotateNone:
+                        break;
+                    case ImageRotation.Rotate90CCW:
+                        sourceRegion = new Rectangle(croppedSize.Width - sourceRegion.Bottom,
+                                                     sourceRegion.X,
+                                                     sourceRegion.Height,
+                                                     sourceRegion.Width);
+                        break;
+                    case ImageRotation.Rotate180:
+                        sourceRegion = new Rectangle(croppedSize.Width - sourceRegion.Right,
+                                                     croppedSize.Height - sourceRegion.Bottom,
+                                                     sourceRegion.Width,
+                                                     sourceRegion.Height);
+                        break;
+                    case ImageRotation.Rotate270CCW:
+                        sourceRegion = new Rectangle(sourceRegion.Y,
+                                                     croppedSize.Height - sourceRegion.Right,
+                                                     sourceRegion.Height,
+                                                     sourceRegion.Width);
+                        break;
+                    default:
+                        throw new InvalidOperationException("Unknown ImageRotation value.");
+                }
+            }
+
+            sourceRegion.Offset(cropRect.Location);
+
+            return sourceRegion;
+        }
+
         internal static unsafe void FlipHorizontal(Surface surface)
         {
             int lastColumn = surface.Width - 1;
@@ -186,5 +287,44 @@ namespace AvifFileType
                 temp?.Dispose();
             }
         }
+
+        private static Rectangle GetCropRectangle(CleanApertureBox cleanApertureBox, Size imageSize)
+        {
+            if (cleanApertureBox.Width.Denominator == 0 ||
+                cleanApertureBox.Height.Denominator == 0 ||
+                cleanApertureBox.HorizontalOffset.Denominator == 0 ||
+                cleanApertureBox.VerticalOffset.Denominator == 0)
+            {
+                return Rectangle.Empty;
+            }
+
+            int cropWidth = cleanApertureBox.Width.ToInt32();
+            int cropHeight = cleanApertureBox.Height.ToInt32();
+
+            if (cropWidth <= 0 || cropHeight <= 0)
+            {
+                // Invalid crop width/height.
+                return Rectangle.Empty;
+            }
+
+            double offsetX = cleanApertureBox.HorizontalOffset.ToDouble();
+            double offsetY = cleanApertureBox.VerticalOffset.ToDouble();
+
+            double pictureCenterX = offsetX + ((imageSize.Width - 1) / 2.0);
+            double pictureCenterY = offsetY + ((imageSize.Height - 1) / 2.0);
+
+            int cropRectX = (int)Math.Round(pictureCenterX - ((cropWidth - 1) / 2.0));
+            int cropRectY = (int)Math.Round(pictureCenterY - ((cropHeight - 1) / 2.0));
+
+            Rectangle cropRect = new Rectangle(cropRectX, cropRectY, cropWidth, cropHeight);
+
+            // Check that the crop rectangle is within the image bounds.
+            if (!cropRect.IntersectsWith(new Rectangle(Point.Empty, imageSize)))
+            {
+                return Rectangle.Empty;
+            }
+
+            return cropRect;
+        }
     }
 }
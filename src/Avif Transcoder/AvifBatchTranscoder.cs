@@ -0,0 +1,489 @@
+﻿////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+using AvifFileType.Interop;
+using PaintDotNet;
+using PaintDotNet.AppModel;
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Drawing;
+using System.IO;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace AvifFileType
+{
+    /// <summary>
+    /// Re-encodes a batch of AVIF images using a pipeline of parse, decode, convert, encode and write stages.
+    /// </summary>
+    /// <remarks>
+    /// <para>
+    /// The stages are connected by bounded queues, so the decode stage of one image runs while other images are
+    /// being encoded or written. The native code of all stages draws its threads from a single <see cref="ThreadBudget"/>,
+    /// a small image only uses as many threads as it has work for and the remaining threads are used by the other images.
+    /// </para>
+    /// <para>
+    /// The decoder session is shared by every image and each encode worker reuses its own encoder session,
+    /// so the AV1 codecs and frame buffers are only created once for the batch.
+    /// The decoded image is encoded directly without rendering a copy of the document.
+    /// The compressed tiles of each image are held in memory until the image is written, the streaming writer
+    /// that is used for very large images by <see cref="AvifFile.Save"/> is not used.
+    /// </para>
+    /// </remarks>
+    internal sealed class AvifBatchTranscoder
+    {
+        // The native code splits the work into image grid tiles or AV1 tiles of about this size,
+        // an image is given one thread for each block of this many pixels.
+        private const long PixelsPerThread = 512 * 512;
+
+        private readonly AvifTranscodeOptions options;
+        private readonly int maxThreads;
+        private readonly int maxConcurrentImages;
+        private readonly IArrayPoolService arrayPool;
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="AvifBatchTranscoder"/> class.
+        /// </summary>
+        /// <param name="options">The encoder settings.</param>
+        /// <param name="arrayPool">The array pool.</param>
+        /// <exception cref="ArgumentNullException">
+        /// <paramref name="options"/> is null.
+        /// -or-
+        /// <paramref name="arrayPool"/> is null.
+        /// </exception>
+        public AvifBatchTranscoder(AvifTranscodeOptions options, IArrayPoolService arrayPool)
+            : this(options, Environment.ProcessorCount, Environment.ProcessorCount, arrayPool)
+        {
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="AvifBatchTranscoder"/> class.
+        /// </summary>
+        /// <param name="options">The encoder settings.</param>
+        /// <param name="maxThreads">The maximum number of threads that are used by all of the images.</param>
+        /// <param name="maxConcurrentImages">
+        /// The maximum number of images in the pipeline, this limits the memory that is used by the decoded images.
+        /// </param>
+        /// <param name="arrayPool">The array pool.</param>
+        /// <exception cref="ArgumentNullException">
+        /// <paramref name="options"/> is null.
+        /// -or-
+        /// <paramref name="arrayPool"/> is null.
+        /// </exception>
+        /// <exception cref="ArgumentOutOfRangeException">
+        /// <paramref name="maxThreads"/> is less than 1.
+        /// -or-
+        /// <paramref name="maxConcurrentImages"/> is less than 1.
+        /// </exception>
+        public AvifBatchTranscoder(AvifTranscodeOptions options, int maxThreads, int maxConcurrentImages, IArrayPoolService arrayPool)
+        {
+            if (options is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(options));
+            }
+
+            if (maxThreads < 1)
+            {
+                ExceptionUtil.ThrowArgumentOutOfRangeException(nameof(maxThreads), "Must be >= 1.");
+            }
+
+            if (maxConcurrentImages < 1)
+            {
+                ExceptionUtil.ThrowArgumentOutOfRangeException(nameof(maxConcurrentImages), "Must be >= 1.");
+            }
+
+            if (arrayPool is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(arrayPool));
+            }
+
+            this.options = options;
+            this.maxThreads = maxThreads;
+            this.maxConcurrentImages = maxConcurrentImages;
+            this.arrayPool = arrayPool;
+        }
+
+        /// <summary>
+        /// Transcodes the specified images.
+        /// </summary>
+        /// <param name="items">The images to transcode.</param>
+        /// <param name="cancellationToken">The cancellation token.</param>
+        /// <returns>The result of each image, in the same order as <paramref name="items"/>.</returns>
+        /// <remarks>
+        /// An error in one image does not stop the batch, the exception is stored in the result for that image
+        /// and any partially written output file is deleted.
+        /// </remarks>
+        /// <exception cref="ArgumentNullException"><paramref name="items"/> is null.</exception>
+        /// <exception cref="OperationCanceledException">The operation was canceled.</exception>
+        public IReadOnlyList<AvifTranscodeResult> Transcode(IReadOnlyList<AvifTranscodeItem> items, CancellationToken cancellationToken)
+        {
+            if (items is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(items));
+            }
+
+            using (TranscodeSession session = new TranscodeSession(this, items.Count, cancellationToken))
+            {
+                return session.Run(items);
+            }
+        }
+
+        private static int GetRequestedThreadCount(Size imageSize)
+        {
+            long pixelCount = (long)imageSize.Width * imageSize.Height;
+
+            return (int)Math.Min(int.MaxValue, Math.Max(1, (pixelCount + PixelsPerThread - 1) / PixelsPerThread));
+        }
+
+        private sealed class TranscodeJob
+            : IDisposable
+        {
+            public TranscodeJob(int index, AvifTranscodeItem item, bool collectStatistics)
+            {
+                this.Index = index;
+                this.Item = item;
+                this.Statistics = collectStatistics ? new InstrumentationStatistics() : null;
+            }
+
+            public int Index { get; }
+
+            public AvifTranscodeItem Item { get; }
+
+            // The images are decoded and encoded concurrently, so each image collects its own statistics.
+            public InstrumentationStatistics Statistics { get; }
+
+            public AvifReader Reader { get; set; }
+
+            public Document Document { get; set; }
+
+            public AvifSaveContext SaveContext { get; set; }
+
+            public void Dispose()
+            {
+                this.Reader?.Dispose();
+                this.Reader = null;
+                this.SaveContext?.Dispose();
+                this.SaveContext = null;
+                this.Document?.Dispose();
+                this.Document = null;
+            }
+        }
+
+        private sealed class TranscodeSession
+            : IDisposable
+        {
+            private readonly AvifBatchTranscoder transcoder;
+            private readonly CancellationToken cancellationToken;
+            private readonly AvifTranscodeResult[] results;
+            private readonly ThreadBudget threadBudget;
+            private readonly SemaphoreSlim imageSlots;
+            private readonly BlockingCollection<TranscodeJob> decodeQueue;
+            private readonly BlockingCollection<TranscodeJob> convertQueue;
+            private readonly BlockingCollection<TranscodeJob> encodeQueue;
+            private readonly BlockingCollection<TranscodeJob> writeQueue;
+            private readonly ConcurrentBag<SafeEncoderSessionHandle> encoderSessions;
+            private SafeDecoderSessionHandle decoderSession;
+
+            public TranscodeSession(AvifBatchTranscoder transcoder, int itemCount, CancellationToken cancellationToken)
+            {
+                this.transcoder = transcoder;
+                this.cancellationToken = cancellationToken;
+                this.results = new AvifTranscodeResult[itemCount];
+                this.threadBudget = new ThreadBudget(transcoder.maxThreads);
+                this.imageSlots = new SemaphoreSlim(transcoder.maxConcurrentImages, transcoder.maxConcurrentImages);
+                this.decodeQueue = new BlockingCollection<TranscodeJob>(transcoder.maxConcurrentImages);
+                this.convertQueue = new BlockingCollection<TranscodeJob>(transcoder.maxConcurrentImages);
+                this.encodeQueue = new BlockingCollection<TranscodeJob>(transcoder.maxConcurrentImages);
+                this.writeQueue = new BlockingCollection<TranscodeJob>(transcoder.maxConcurrentImages);
+                this.encoderSessions = new ConcurrentBag<SafeEncoderSessionHandle>();
+                this.decoderSession = AvifNative.CreateDecoderSession();
+            }
+
+            public void Dispose()
+            {
+                // Any images that were still queued when the batch was canceled are freed before the queues.
+                DisposeQueuedJobs(this.decodeQueue);
+                DisposeQueuedJobs(this.convertQueue);
+                DisposeQueuedJobs(this.encodeQueue);
+                DisposeQueuedJobs(this.writeQueue);
+
+                while (this.encoderSessions.TryTake(out SafeEncoderSessionHandle encoderSession))
+                {
+                    encoderSession.Dispose();
+                }
+
+                if (this.decoderSession != null)
+                {
+                    this.decoderSession.Dispose();
+                    this.decoderSession = null;
+                }
+
+                this.threadBudget.Dispose();
+                this.imageSlots.Dispose();
+            }
+
+            private static void DisposeQueuedJobs(BlockingCollection<TranscodeJob> queue)
+            {
+                while (queue.TryTake(out TranscodeJob job))
+                {
+                    job.Dispose();
+                }
+
+                queue.Dispose();
+            }
+
+            public AvifTranscodeResult[] Run(IReadOnlyList<AvifTranscodeItem> items)
+            {
+                // The parse and write stages are limited by the file system, the other stages
+                // use one worker for each image that can be processed concurrently.
+                int workerCount = Math.Min(this.transcoder.maxThreads, this.transcoder.maxConcurrentImages);
+
+                Task[] stages = new Task[]
+                {
+                    Task.Factory.StartNew(() => ParseFiles(items), this.cancellationToken, TaskCreationOptions.LongRunning, TaskScheduler.Default),
+                    StartStage(this.decodeQueue, this.convertQueue, workerCount, DecodeImage),
+                    StartStage(this.convertQueue, this.encodeQueue, workerCount, ConvertImage),
+                    StartStage(this.encodeQueue, this.writeQueue, workerCount, EncodeImage),
+                    StartStage(this.writeQueue, null, 1, WriteImage)
+                };
+
+                try
+                {
+                    Task.WaitAll(stages);
+                }
+                catch (AggregateException)
+                {
+                    this.cancellationToken.ThrowIfCancellationRequested();
+
+                    throw;
+                }
+
+                return this.results;
+            }
+
+            private void CompleteJob(TranscodeJob job, Exception error)
+            {
+                this.results[job.Index] = new AvifTranscodeResult(job.Item, error, job.Statistics);
+                job.Dispose();
+                this.imageSlots.Release();
+            }
+
+            private void ParseFiles(IReadOnlyList<AvifTranscodeItem> items)
+            {
+                try
+                {
+                    for (int i = 0; i < items.Count; i++)
+                    {
+                        this.imageSlots.Wait(this.cancellationToken);
+
+                        TranscodeJob job = new TranscodeJob(i, items[i], this.transcoder.options.CollectStatistics);
+
+                        try
+                        {
+                            FileStream input = new FileStream(job.Item.InputPath, FileMode.Open, FileAccess.Read, FileShare.Read);
+
+                            try
+                            {
+                                job.Reader = new AvifReader(input, leaveOpen: false, this.transcoder.arrayPool, 0, null, this.decoderSession);
+                                input = null;
+                            }
+                            finally
+                            {
+                                input?.Dispose();
+                            }
+                        }
+                        catch (Exception ex) when (!this.cancellationToken.IsCancellationRequested)
+                        {
+                            CompleteJob(job, ex);
+                            continue;
+                        }
+
+                        AddToQueue(this.decodeQueue, job);
+                    }
+                }
+                finally
+                {
+                    this.decodeQueue.CompleteAdding();
+                }
+            }
+
+            private Task StartStage(BlockingCollection<TranscodeJob> input,
+                                    BlockingCollection<TranscodeJob> output,
+                                    int workerCount,
+                                    Action<TranscodeJob> process)
+            {
+                Task[] workers = new Task[workerCount];
+
+                for (int i = 0; i < workers.Length; i++)
+                {
+                    workers[i] = Task.Factory.StartNew(ProcessJobs, this.cancellationToken, TaskCreationOptions.LongRunning, TaskScheduler.Default);
+                }
+
+                return Task.Factory.ContinueWhenAll(workers, completedWorkers =>
+                {
+                    output?.CompleteAdding();
+
+                    // Rethrows the first worker exception.
+                    Task.WaitAll(completedWorkers);
+                }, CancellationToken.None, TaskContinuationOptions.None, TaskScheduler.Default);
+
+                void ProcessJobs()
+                {
+                    foreach (TranscodeJob job in input.GetConsumingEnumerable(this.cancellationToken))
+                    {
+                        try
+                        {
+                            process(job);
+                        }
+                        catch (Exception ex) when (!this.cancellationToken.IsCancellationRequested)
+                        {
+                            CompleteJob(job, ex);
+                            continue;
+                        }
+                        catch
+                        {
+                            job.Dispose();
+                            throw;
+                        }
+
+                        if (output != null)
+                        {
+                            AddToQueue(output, job);
+                        }
+                        else
+                        {
+                            CompleteJob(job, null);
+                        }
+                    }
+                }
+            }
+
+            private void AddToQueue(BlockingCollection<TranscodeJob> queue, TranscodeJob job)
+            {
+                try
+                {
+                    queue.Add(job, this.cancellationToken);
+                }
+                catch
+                {
+                    job.Dispose();
+                    throw;
+                }
+            }
+
+            private void DecodeImage(TranscodeJob job)
+            {
+                AvifReader reader = job.Reader;
+
+                using (ThreadBudget.Lease lease = this.threadBudget.Acquire(GetRequestedThreadCount(reader.GetImageSize()),
+                                                                           this.cancellationToken))
+                {
+                    reader.MaxThreads = lease.ThreadCount;
+                    reader.Statistics = job.Statistics;
+                    job.Document = AvifFile.DecodeDocument(reader, this.transcoder.arrayPool);
+                }
+
+                // The input file is closed as soon as it has been decoded.
+                job.Reader = null;
+                reader.Dispose();
+            }
+
+            private void ConvertImage(TranscodeJob job)
+            {
+                AvifTranscodeOptions options = this.transcoder.options;
+                Document document = job.Document;
+
+                // A decoded document always has a single layer, so its surface is used as the image
+                // instead of rendering the document into a copy.
+                Surface image = ((BitmapLayer)document.Layers[0]).Surface;
+
+                using (ThreadBudget.Lease lease = this.threadBudget.Acquire(GetRequestedThreadCount(image.Size), this.cancellationToken))
+                {
+                    // The premultiplied alpha conversion can cause the colors to drift, so it is disabled for lossless encoding.
+                    job.SaveContext = AvifFile.PrepareImage(document,
+                                                            image,
+                                                            options.Quality,
+                                                            options.LosslessAlpha,
+                                                            options.CompressionSpeed,
+                                                            options.ChromaSubsampling,
+                                                            options.BitDepth,
+                                                            options.PreserveExistingTileSize,
+                                                            options.PremultipliedAlpha && options.Quality < 100,
+                                                            lease.ThreadCount);
+                }
+            }
+
+            private void EncodeImage(TranscodeJob job)
+            {
+                if (!this.encoderSessions.TryTake(out SafeEncoderSessionHandle encoderSession))
+                {
+                    encoderSession = AvifNative.CreateEncoderSession();
+                }
+
+                try
+                {
+                    using (ThreadBudget.Lease lease = this.threadBudget.Acquire(GetRequestedThreadCount(job.SaveContext.Image.Size),
+                                                                               this.cancellationToken))
+                    {
+                        uint progressDone = job.SaveContext.InitialProgressDone;
+
+                        AvifFile.CompressImage(job.SaveContext,
+                                               encoderSession,
+                                               lease.ThreadCount,
+                                               null,
+                                               ref progressDone,
+                                               this.transcoder.arrayPool,
+                                               job.Statistics);
+                    }
+                }
+                finally
+                {
+                    // The session is returned for the next image that is encoded by any of the workers.
+                    this.encoderSessions.Add(encoderSession);
+                }
+
+                // The decoded image is no longer needed once it has been compressed.
+                job.Document.Dispose();
+                job.Document = null;
+            }
+
+            private void WriteImage(TranscodeJob job)
+            {
+                string outputPath = job.Item.OutputPath;
+
+                try
+                {
+                    using (FileStream output = new FileStream(outputPath, FileMode.Create, FileAccess.Write, FileShare.None))
+                    {
+                        AvifFile.WriteImage(job.SaveContext, output, null, 0, this.transcoder.arrayPool);
+                    }
+                }
+                catch
+                {
+                    try
+                    {
+                        File.Delete(outputPath);
+                    }
+                    catch (IOException)
+                    {
+                    }
+                    catch (UnauthorizedAccessException)
+                    {
+                    }
+
+                    throw;
+                }
+            }
+        }
+    }
+}
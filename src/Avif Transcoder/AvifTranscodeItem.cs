@@ -0,0 +1,37 @@
+﻿////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+namespace AvifFileType
+{
+    internal sealed class AvifTranscodeItem
+    {
+        public AvifTranscodeItem(string inputPath, string outputPath)
+        {
+            if (inputPath is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(inputPath));
+            }
+
+            if (outputPath is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(outputPath));
+            }
+
+            this.InputPath = inputPath;
+            this.OutputPath = outputPath;
+        }
+
+        public string InputPath { get; }
+
+        public string OutputPath { get; }
+    }
+}
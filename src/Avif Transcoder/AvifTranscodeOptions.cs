@@ -0,0 +1,67 @@
+﻿////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+namespace AvifFileType
+{
+    /// <summary>
+    /// The encoder settings that are used for every image in a batch, the defaults match the save dialog.
+    /// </summary>
+    internal sealed class AvifTranscodeOptions
+    {
+        public AvifTranscodeOptions()
+        {
+            this.Quality = 85;
+            this.LosslessAlpha = true;
+            this.CompressionSpeed = CompressionSpeed.Fast;
+            this.ChromaSubsampling = YUVChromaSubsampling.Subsampling422;
+            this.BitDepth = EncoderBitDepth.EightBit;
+            this.PreserveExistingTileSize = true;
+            this.PremultipliedAlpha = false;
+        }
+
+        public int Quality { get; set; }
+
+        public bool LosslessAlpha { get; set; }
+
+        public CompressionSpeed CompressionSpeed { get; set; }
+
+        public YUVChromaSubsampling ChromaSubsampling { get; set; }
+
+        /// <summary>
+        /// Gets or sets the bit depth of the encoded images.
+        /// </summary>
+        /// <value>
+        /// The bit depth of the encoded images. This value is ignored when <see cref="Quality"/> is 100.
+        /// </value>
+        public EncoderBitDepth BitDepth { get; set; }
+
+        public bool PreserveExistingTileSize { get; set; }
+
+        /// <summary>
+        /// Gets or sets a value indicating whether the color is premultiplied by the alpha channel.
+        /// </summary>
+        /// <value>
+        /// <see langword="true"/> to premultiply the color; otherwise, <see langword="false"/>.
+        /// This value is ignored when <see cref="Quality"/> is 100.
+        /// </value>
+        public bool PremultipliedAlpha { get; set; }
+
+        /// <summary>
+        /// Gets or sets a value indicating whether the native statistics are collected for each image.
+        /// </summary>
+        /// <value>
+        /// <see langword="true"/> to collect the statistics in <see cref="AvifTranscodeResult.Statistics"/>;
+        /// otherwise, <see langword="false"/>. The default is <see langword="false"/>.
+        /// </value>
+        public bool CollectStatistics { get; set; }
+    }
+}
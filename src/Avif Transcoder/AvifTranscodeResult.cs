@@ -0,0 +1,53 @@
+﻿////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+using AvifFileType.Interop;
+using System;
+
+namespace AvifFileType
+{
+    internal sealed class AvifTranscodeResult
+    {
+        public AvifTranscodeResult(AvifTranscodeItem item, Exception error, InstrumentationStatistics statistics)
+        {
+            if (item is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(item));
+            }
+
+            this.Item = item;
+            this.Error = error;
+            this.Statistics = statistics;
+        }
+
+        public AvifTranscodeItem Item { get; }
+
+        /// <summary>
+        /// Gets the exception that stopped the image from being transcoded.
+        /// </summary>
+        /// <value>
+        /// The exception, or <see langword="null"/> if the image was transcoded.
+        /// </value>
+        public Exception Error { get; }
+
+        public bool Succeeded => this.Error is null;
+
+        /// <summary>
+        /// Gets the native statistics of the image.
+        /// </summary>
+        /// <value>
+        /// The statistics of the decode and encode calls for this image, or <see langword="null"/>
+        /// if <see cref="AvifTranscodeOptions.CollectStatistics"/> is <see langword="false"/>.
+        /// </value>
+        public InstrumentationStatistics Statistics { get; }
+    }
+}
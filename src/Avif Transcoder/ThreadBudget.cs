@@ -0,0 +1,97 @@
+﻿////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+using System;
+using System.Threading;
+
+namespace AvifFileType
+{
+    /// <summary>
+    /// Limits the total number of threads that are used by the native code across all of the images
+    /// that are processed concurrently.
+    /// </summary>
+    internal sealed class ThreadBudget
+        : IDisposable
+    {
+        private SemaphoreSlim availableThreads;
+
+        public ThreadBudget(int totalThreads)
+        {
+            if (totalThreads < 1)
+            {
+                ExceptionUtil.ThrowArgumentOutOfRangeException(nameof(totalThreads), "Must be >= 1.");
+            }
+
+            this.TotalThreads = totalThreads;
+            this.availableThreads = new SemaphoreSlim(totalThreads, totalThreads);
+        }
+
+        public int TotalThreads { get; }
+
+        /// <summary>
+        /// Reserves up to the specified number of threads, waiting until at least one thread is available.
+        /// </summary>
+        /// <param name="requestedThreads">The number of threads that the caller can use.</param>
+        /// <param name="cancellationToken">The cancellation token.</param>
+        /// <returns>The lease that returns the threads to the budget when it is disposed.</returns>
+        /// <remarks>
+        /// The caller is never blocked waiting for more than one thread, a large image that starts while
+        /// other images are using most of the budget is given the threads that are idle.
+        /// </remarks>
+        public Lease Acquire(int requestedThreads, CancellationToken cancellationToken)
+        {
+            this.availableThreads.Wait(cancellationToken);
+
+            int threadCount = 1;
+            int maxThreadCount = Math.Min(requestedThreads, this.TotalThreads);
+
+            while (threadCount < maxThreadCount && this.availableThreads.Wait(0))
+            {
+                threadCount++;
+            }
+
+            return new Lease(this, threadCount);
+        }
+
+        public void Dispose()
+        {
+            if (this.availableThreads != null)
+            {
+                this.availableThreads.Dispose();
+                this.availableThreads = null;
+            }
+        }
+
+        internal sealed class Lease
+            : IDisposable
+        {
+            private ThreadBudget budget;
+
+            public Lease(ThreadBudget budget, int threadCount)
+            {
+                this.budget = budget;
+                this.ThreadCount = threadCount;
+            }
+
+            public int ThreadCount { get; }
+
+            public void Dispose()
+            {
+                if (this.budget != null)
+                {
+                    this.budget.availableThreads.Release(this.ThreadCount);
+                    this.budget = null;
+                }
+            }
+        }
+    }
+}
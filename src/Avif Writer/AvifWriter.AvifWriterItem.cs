@@ -36,6 +36,10 @@ namespace AvifFileType
                 this.Id = id;
                 this.Name = name;
                 this.Image = image;
+                this.IsImageItem = true;
+                this.ImageWidth = image.Width;
+                this.ImageHeight = image.Height;
+                this.ImageFormat = image.Format;
                 this.IsAlphaImage = isAlphaImage;
                 this.DuplicateImageIndex = duplicateImageIndex;
                 this.ContentBytes = null;
@@ -44,6 +48,31 @@ namespace AvifFileType
                 this.ItemReferences = new List<ItemReferenceEntryBox>();
             }
 
+            private AvifWriterItem(uint id,
+                                   string name,
+                                   int width,
+                                   int height,
+                                   YUVChromaSubsampling format,
+                                   bool isAlphaImage,
+                                   int duplicateImageIndex)
+            {
+                this.Id = id;
+                this.Name = name;
+                this.Image = null;
+                this.IsImageItem = true;
+                this.ImageWidth = width;
+                this.ImageHeight = height;
+                this.ImageFormat = format;
+                this.IsAlphaImage = isAlphaImage;
+                this.DuplicateImageIndex = duplicateImageIndex;
+                this.ContentBytes = null;
+                this.ItemInfoEntry = new AV01ItemInfoEntryBox(id, name);
+                // The item length is not known until the image has been compressed, it will be updated
+                // when the image data is written to the media data box.
+                this.ItemLocation = new ItemLocationEntry(id, 0);
+                this.ItemReferences = new List<ItemReferenceEntryBox>();
+            }
+
             private AvifWriterItem(uint id, string name, byte[] contentBytes, ItemInfoEntryBox itemInfo)
             {
                 if (contentBytes is null)
@@ -59,6 +88,10 @@ namespace AvifFileType
                 this.Id = id;
                 this.Name = name;
                 this.Image = null;
+                this.IsImageItem = false;
+                this.ImageWidth = 0;
+                this.ImageHeight = 0;
+                this.ImageFormat = default;
                 this.IsAlphaImage = false;
                 this.DuplicateImageIndex = -1;
                 this.ContentBytes = contentBytes;
@@ -77,6 +110,10 @@ namespace AvifFileType
                 this.Id = id;
                 this.Name = name;
                 this.Image = null;
+                this.IsImageItem = false;
+                this.ImageWidth = 0;
+                this.ImageHeight = 0;
+                this.ImageFormat = default;
                 this.IsAlphaImage = false;
                 this.DuplicateImageIndex = -1;
                 this.ContentBytes = null;
@@ -89,8 +126,23 @@ namespace AvifFileType
 
             public string Name { get; }
 
+            /// <summary>
+            /// Gets the compressed image.
+            /// </summary>
+            /// <value>
+            /// The compressed image, or <see langword="null"/> if the item is not an image or
+            /// the image data is written to the media data box as it is compressed.
+            /// </value>
             public CompressedAV1Image Image { get; }
 
+            public bool IsImageItem { get; }
+
+            public int ImageWidth { get; }
+
+            public int ImageHeight { get; }
+
+            public YUVChromaSubsampling ImageFormat { get; }
+
             public bool IsAlphaImage { get; }
 
             public int DuplicateImageIndex { get; }
@@ -128,6 +180,17 @@ namespace AvifFileType
                 return new AvifWriterItem(itemId, name, image, isAlphaImage, duplicateImageIndex);
             }
 
+            public static AvifWriterItem CreateFromStreamedImage(uint itemId,
+                                                                 string name,
+                                                                 int width,
+                                                                 int height,
+                                                                 YUVChromaSubsampling format,
+                                                                 bool isAlphaImage,
+                                                                 int duplicateImageIndex)
+            {
+                return new AvifWriterItem(itemId, name, width, height, format, isAlphaImage, duplicateImageIndex);
+            }
+
             public static AvifWriterItem CreateFromImageGrid(uint itemId, string name, ulong dataBoxOffset, ulong length)
             {
                 return new AvifWriterItem(itemId, name, dataBoxOffset, length);
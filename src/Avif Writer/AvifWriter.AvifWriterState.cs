@@ -30,6 +30,7 @@ namespace AvifFileType
             private readonly List<AvifWriterItem> items;
             private readonly Dictionary<int, int> duplicateAlphaTiles;
             private readonly Dictionary<int, int> duplicateColorTiles;
+            private readonly YUVChromaSubsampling streamedColorImageFormat;
 
             public AvifWriterState(IReadOnlyList<CompressedAV1Image> colorImages,
                                    IReadOnlyList<CompressedAV1Image> alphaImages,
@@ -55,7 +56,8 @@ namespace AvifFileType
                 }
 
                 this.ImageGrid = imageGridMetadata;
-                this.items = new List<AvifWriterItem>(GetItemCount(colorImages, alphaImages, metadata));
+                this.IsStreaming = false;
+                this.items = new List<AvifWriterItem>(GetItemCount(colorImages.Count, alphaImages != null, metadata));
                 this.duplicateAlphaTiles = new Dictionary<int, int>(homogeneousTiles.DuplicateAlphaTileMap.Count);
                 this.duplicateColorTiles = new Dictionary<int, int>(homogeneousTiles.DuplicateColorTileMap.Count);
                 DeduplicateColorTiles(colorImages, homogeneousTiles, arrayPool);
@@ -65,13 +67,63 @@ namespace AvifFileType
                     DeduplicateAlphaTiles(alphaImages, homogeneousTiles, arrayPool);
                 }
 
-                Initialize(colorImages, alphaImages, premultipliedAlpha, imageGridMetadata, metadata, arrayPool);
+                Initialize(colorImages, alphaImages, alphaImages != null, premultipliedAlpha, imageGridMetadata, metadata, arrayPool);
+            }
+
+            public AvifWriterState(ImageGridMetadata imageGridMetadata,
+                                   YUVChromaSubsampling colorImageFormat,
+                                   bool hasAlpha,
+                                   HomogeneousTileInfo homogeneousTiles,
+                                   bool premultipliedAlpha,
+                                   AvifMetadata metadata,
+                                   IArrayPoolService arrayPool)
+            {
+                if (imageGridMetadata is null)
+                {
+                    ExceptionUtil.ThrowArgumentNullException(nameof(imageGridMetadata));
+                }
+
+                if (homogeneousTiles is null)
+                {
+                    ExceptionUtil.ThrowArgumentNullException(nameof(homogeneousTiles));
+                }
+
+                if (metadata is null)
+                {
+                    ExceptionUtil.ThrowArgumentNullException(nameof(metadata));
+                }
+
+                if (arrayPool is null)
+                {
+                    ExceptionUtil.ThrowArgumentNullException(nameof(arrayPool));
+                }
+
+                this.ImageGrid = imageGridMetadata;
+                this.IsStreaming = true;
+                this.streamedColorImageFormat = colorImageFormat;
+                this.items = new List<AvifWriterItem>(GetItemCount(imageGridMetadata.TileCount, hasAlpha, metadata));
+                // The compressed image data is not available when the meta box is created, so only the
+                // homogeneous tiles can be de-duplicated.
+                this.duplicateColorTiles = new Dictionary<int, int>(homogeneousTiles.DuplicateColorTileMap);
+                this.duplicateAlphaTiles = hasAlpha ? new Dictionary<int, int>(homogeneousTiles.DuplicateAlphaTileMap)
+                                                    : new Dictionary<int, int>();
+
+                Initialize(null, null, hasAlpha, premultipliedAlpha, imageGridMetadata, metadata, arrayPool);
             }
 
             public uint AlphaItemId { get; private set; }
 
             public ImageGridMetadata ImageGrid { get; }
 
+            /// <summary>
+            /// Gets a value indicating whether the image data is written to the media data box as it is compressed.
+            /// </summary>
+            /// <value>
+            /// <see langword="true"/> if the image data is written to the media data box as it is compressed;
+            /// otherwise, <see langword="false"/>.
+            /// </value>
+            public bool IsStreaming { get; }
+
             public ItemDataBox ItemDataBox { get; private set; }
 
             public IReadOnlyList<AvifWriterItem> Items => this.items;
@@ -133,68 +185,7 @@ namespace AvifFileType
                     return;
                 }
 
-                using (IArrayPoolBuffer<int> duplicateTileSearchSpace = GetDuplicateTileSearchSpace(alphaImages,
-                                                                                                    homogeneousTiles.HomogeneousAlphaTiles,
-                                                                                                    arrayPool))
-                {
-                    for (int i = 0; i < duplicateTileSearchSpace.Count; i++)
-                    {
-                        int firstTileIndex = duplicateTileSearchSpace[i];
-
-                        if (this.duplicateAlphaTiles.ContainsKey(firstTileIndex))
-                        {
-                            continue;
-                        }
-
-                        CompressedAV1Data firstImageData = alphaImages[firstTileIndex].Data;
-                        IPinnableBuffer firstPinnable = firstImageData;
-
-                        IntPtr firstBuffer = IntPtr.Zero;
-                        try
-                        {
-                            for (int j = i + 1; j < duplicateTileSearchSpace.Count; j++)
-                            {
-                                int secondTileIndex = duplicateTileSearchSpace[j];
-
-                                if (this.duplicateAlphaTiles.ContainsKey(secondTileIndex))
-                                {
-                                    continue;
-                                }
-
-                                CompressedAV1Data secondImageData = alphaImages[secondTileIndex].Data;
-
-                                if (firstImageData.ByteLength == secondImageData.ByteLength)
-                                {
-                                    IPinnableBuffer secondPinnable = secondImageData;
-
-                                    if (firstBuffer == IntPtr.Zero)
-                                    {
-                                        firstBuffer = firstPinnable.Pin();
-                                    }
-                                    IntPtr secondBuffer = secondPinnable.Pin();
-                                    try
-                                    {
-                                        if (AvifNative.MemoryBlocksAreEqual(firstBuffer, secondBuffer, firstImageData.ByteLength))
-                                        {
-                                            this.duplicateAlphaTiles.Add(secondTileIndex, firstTileIndex);
-                                        }
-                                    }
-                                    finally
-                                    {
-                                        secondPinnable.Unpin();
-                                    }
-                                }
-                            }
-                        }
-                        finally
-                        {
-                            if (firstBuffer != IntPtr.Zero)
-                            {
-                                firstPinnable.Unpin();
-                            }
-                        }
-                    }
-                }
+                DeduplicateCompressedTiles(alphaImages, homogeneousTiles.HomogeneousAlphaTiles, this.duplicateAlphaTiles, arrayPool);
             }
 
             private void DeduplicateColorTiles(
@@ -217,68 +208,97 @@ namespace AvifFileType
                     return;
                 }
 
-                using (IArrayPoolBuffer<int> duplicateTileSearchSpace = GetDuplicateTileSearchSpace(colorImages,
-                                                                                                    homogeneousTiles.HomogeneousColorTiles,
+                DeduplicateCompressedTiles(colorImages, homogeneousTiles.HomogeneousColorTiles, this.duplicateColorTiles, arrayPool);
+            }
+
+            private static void DeduplicateCompressedTiles(IReadOnlyList<CompressedAV1Image> images,
+                                                           HashSet<int> homogeneousTiles,
+                                                           Dictionary<int, int> duplicateTiles,
+                                                           IArrayPoolService arrayPool)
+            {
+                using (IArrayPoolBuffer<int> duplicateTileSearchSpace = GetDuplicateTileSearchSpace(images,
+                                                                                                    homogeneousTiles,
                                                                                                     arrayPool))
                 {
+                    // The compressed data of each tile is hashed once, only the tiles that have the same hash as
+                    // an earlier tile need to be compared.
+                    // Tiles that have the same hash but different data are kept as separate candidates, so that the
+                    // later tiles are compared with each of them.
+                    Dictionary<ulong, List<int>> tilesWithHash = new Dictionary<ulong, List<int>>(duplicateTileSearchSpace.Count);
+
                     for (int i = 0; i < duplicateTileSearchSpace.Count; i++)
                     {
-                        int firstTileIndex = duplicateTileSearchSpace[i];
+                        int tileIndex = duplicateTileSearchSpace[i];
 
-                        if (this.duplicateColorTiles.ContainsKey(firstTileIndex))
+                        if (duplicateTiles.ContainsKey(tileIndex))
                         {
                             continue;
                         }
 
-                        CompressedAV1Data firstImageData = colorImages[firstTileIndex].Data;
-                        IPinnableBuffer firstPinnable = firstImageData;
+                        CompressedAV1Data imageData = images[tileIndex].Data;
+                        IPinnableBuffer pinnable = imageData;
 
-                        IntPtr firstBuffer = IntPtr.Zero;
+                        IntPtr buffer = pinnable.Pin();
                         try
                         {
-                            for (int j = i + 1; j < duplicateTileSearchSpace.Count; j++)
+                            ulong hash = AvifNative.HashMemoryBlock(buffer, imageData.ByteLength);
+
+                            if (tilesWithHash.TryGetValue(hash, out List<int> candidateTiles))
                             {
-                                int secondTileIndex = duplicateTileSearchSpace[j];
+                                int duplicateTileIndex = FindMatchingCompressedTile(images, candidateTiles, buffer, imageData.ByteLength);
 
-                                if (this.duplicateColorTiles.ContainsKey(secondTileIndex))
+                                if (duplicateTileIndex >= 0)
                                 {
-                                    continue;
+                                    duplicateTiles.Add(tileIndex, duplicateTileIndex);
                                 }
-
-                                CompressedAV1Data secondImageData = colorImages[secondTileIndex].Data;
-
-                                if (firstImageData.ByteLength == secondImageData.ByteLength)
+                                else
                                 {
-                                    IPinnableBuffer secondPinnable = secondImageData;
-
-                                    if (firstBuffer == IntPtr.Zero)
-                                    {
-                                        firstBuffer = firstPinnable.Pin();
-                                    }
-                                    IntPtr secondBuffer = secondPinnable.Pin();
-                                    try
-                                    {
-                                        if (AvifNative.MemoryBlocksAreEqual(firstBuffer, secondBuffer, firstImageData.ByteLength))
-                                        {
-                                            this.duplicateColorTiles.Add(secondTileIndex, firstTileIndex);
-                                        }
-                                    }
-                                    finally
-                                    {
-                                        secondPinnable.Unpin();
-                                    }
+                                    candidateTiles.Add(tileIndex);
                                 }
                             }
+                            else
+                            {
+                                tilesWithHash.Add(hash, new List<int>(1) { tileIndex });
+                            }
                         }
                         finally
                         {
-                            if (firstBuffer != IntPtr.Zero)
+                            pinnable.Unpin();
+                        }
+                    }
+                }
+            }
+
+            private static int FindMatchingCompressedTile(IReadOnlyList<CompressedAV1Image> images,
+                                                          List<int> candidateTiles,
+                                                          IntPtr buffer,
+                                                          ulong length)
+            {
+                for (int i = 0; i < candidateTiles.Count; i++)
+                {
+                    int candidateTileIndex = candidateTiles[i];
+                    CompressedAV1Data candidateData = images[candidateTileIndex].Data;
+
+                    if (candidateData.ByteLength == length)
+                    {
+                        IPinnableBuffer candidatePinnable = candidateData;
+
+                        IntPtr candidateBuffer = candidatePinnable.Pin();
+                        try
+                        {
+                            if (AvifNative.MemoryBlocksAreEqual(candidateBuffer, buffer, length))
                             {
-                                firstPinnable.Unpin();
+                                return candidateTileIndex;
                             }
                         }
+                        finally
+                        {
+                            candidatePinnable.Unpin();
+                        }
                     }
                 }
+
+                return -1;
             }
 
             private static IArrayPoolBuffer<int> GetDuplicateTileSearchSpace(IReadOnlyList<CompressedAV1Image> images,
@@ -304,6 +324,7 @@ namespace AvifFileType
 
             private void Initialize(IReadOnlyList<CompressedAV1Image> colorImages,
                                     IReadOnlyList<CompressedAV1Image> alphaImages,
+                                    bool hasAlpha,
                                     bool premultipliedAlpha,
                                     ImageGridMetadata imageGridMetadata,
                                     AvifMetadata metadata,
@@ -313,7 +334,7 @@ namespace AvifFileType
 
                 if (imageGridMetadata != null)
                 {
-                    result = InitializeFromImageGrid(colorImages, alphaImages, premultipliedAlpha, imageGridMetadata);
+                    result = InitializeFromImageGrid(colorImages, alphaImages, hasAlpha, premultipliedAlpha, imageGridMetadata);
                     this.ItemDataBox = CreateItemDataBox(imageGridMetadata, arrayPool);
                 }
                 else
@@ -356,19 +377,21 @@ namespace AvifFileType
 
             private ImageStateInfo InitializeFromImageGrid(IReadOnlyList<CompressedAV1Image> colorImages,
                                                            IReadOnlyList<CompressedAV1Image> alphaImages,
+                                                           bool hasAlpha,
                                                            bool premultipliedAlpha,
                                                            ImageGridMetadata imageGridMetadata)
             {
                 ulong mediaDataBoxContentSize = 0;
                 uint itemId = FirstItemId;
+                int tileCount = imageGridMetadata.TileCount;
 
-                List<uint> colorImageIds = new List<uint>(colorImages.Count);
-                List<uint> alphaImageIds = alphaImages != null ? new List<uint>(alphaImages.Count) : null;
+                List<uint> colorImageIds = new List<uint>(tileCount);
+                List<uint> alphaImageIds = hasAlpha ? new List<uint>(tileCount) : null;
 
-                List<int> mediaDataBoxColorItemIndexes = new List<int>(colorImages.Count);
-                List<int> mediaBoxAlphaItemIndexes = new List<int>(alphaImages != null ? alphaImages.Count : 0);
+                List<int> mediaDataBoxColorItemIndexes = new List<int>(tileCount);
+                List<int> mediaBoxAlphaItemIndexes = new List<int>(hasAlpha ? tileCount : 0);
 
-                for (int i = 0; i < colorImages.Count; i++)
+                for (int i = 0; i < tileCount; i++)
                 {
                     int duplicateImageIndex;
                     int duplicateColorImageIndex = -1;
@@ -378,20 +401,19 @@ namespace AvifFileType
                         duplicateColorImageIndex = mediaDataBoxColorItemIndexes[duplicateImageIndex];
                     }
 
-                    CompressedAV1Image color = colorImages[i];
-                    AvifWriterItem colorItem = AvifWriterItem.CreateFromImage(itemId, null, color, false, duplicateColorImageIndex);
+                    AvifWriterItem colorItem = CreateImageGridTileItem(itemId, colorImages, i, false, duplicateColorImageIndex);
                     itemId++;
                     colorImageIds.Add(colorItem.Id);
 
                     mediaDataBoxColorItemIndexes.Add(this.items.Count);
                     this.items.Add(colorItem);
 
-                    if (duplicateColorImageIndex == -1)
+                    if (duplicateColorImageIndex == -1 && colorItem.Image != null)
                     {
-                        mediaDataBoxContentSize += color.Data.ByteLength;
+                        mediaDataBoxContentSize += colorItem.Image.Data.ByteLength;
                     }
 
-                    if (alphaImages != null)
+                    if (hasAlpha)
                     {
                         int duplicateAlphaImageIndex = -1;
 
@@ -400,8 +422,7 @@ namespace AvifFileType
                             duplicateAlphaImageIndex = mediaBoxAlphaItemIndexes[duplicateImageIndex];
                         }
 
-                        CompressedAV1Image alpha = alphaImages[i];
-                        AvifWriterItem alphaItem = AvifWriterItem.CreateFromImage(itemId, null, alpha, true, duplicateAlphaImageIndex);
+                        AvifWriterItem alphaItem = CreateImageGridTileItem(itemId, alphaImages, i, true, duplicateAlphaImageIndex);
                         itemId++;
                         alphaItem.ItemReferences.Add(new ItemReferenceEntryBox(alphaItem.Id, ReferenceTypes.AuxiliaryImage, colorItem.Id));
 
@@ -416,9 +437,9 @@ namespace AvifFileType
                         mediaBoxAlphaItemIndexes.Add(this.items.Count);
                         this.items.Add(alphaItem);
 
-                        if (duplicateAlphaImageIndex == -1)
+                        if (duplicateAlphaImageIndex == -1 && alphaItem.Image != null)
                         {
-                            mediaDataBoxContentSize += alpha.Data.ByteLength;
+                            mediaDataBoxContentSize += alphaItem.Image.Data.ByteLength;
                         }
                     }
                 }
@@ -442,7 +463,7 @@ namespace AvifFileType
                 this.PrimaryItemId = colorGridItem.Id;
                 this.items.Add(colorGridItem);
 
-                if (alphaImages != null)
+                if (hasAlpha)
                 {
                     // The ImageGridDescriptor is shared between the color and alpha image.
                     AvifWriterItem alphaGridItem = AvifWriterItem.CreateFromImageGrid(itemId, "Alpha", 0, gridDescriptorLength);
@@ -467,6 +488,30 @@ namespace AvifFileType
                 return new ImageStateInfo(mediaDataBoxContentSize, itemId);
             }
 
+            private AvifWriterItem CreateImageGridTileItem(uint itemId,
+                                                           IReadOnlyList<CompressedAV1Image> images,
+                                                           int tileIndex,
+                                                           bool isAlphaImage,
+                                                           int duplicateImageIndex)
+            {
+                if (this.IsStreaming)
+                {
+                    YUVChromaSubsampling format = isAlphaImage ? YUVChromaSubsampling.Subsampling400 : this.streamedColorImageFormat;
+
+                    return AvifWriterItem.CreateFromStreamedImage(itemId,
+                                                                  null,
+                                                                  (int)this.ImageGrid.TileImageWidth,
+                                                                  (int)this.ImageGrid.TileImageHeight,
+                                                                  format,
+                                                                  isAlphaImage,
+                                                                  duplicateImageIndex);
+                }
+                else
+                {
+                    return AvifWriterItem.CreateFromImage(itemId, null, images[tileIndex], isAlphaImage, duplicateImageIndex);
+                }
+            }
+
             private ImageStateInfo InitializeFromSingleImage(CompressedAV1Image color, CompressedAV1Image alpha, bool premultipliedAlpha)
             {
                 ulong mediaDataBoxContentSize = color.Data.ByteLength;
@@ -506,21 +551,21 @@ namespace AvifFileType
                 return new ImageStateInfo(mediaDataBoxContentSize, itemId);
             }
 
-            private static int GetItemCount(IReadOnlyList<CompressedAV1Image> colorImages, IReadOnlyList<CompressedAV1Image> alphaImages, AvifMetadata metadata)
+            private static int GetItemCount(int colorImageCount, bool hasAlpha, AvifMetadata metadata)
             {
                 int count;
 
-                if (colorImages.Count == 1)
+                if (colorImageCount == 1)
                 {
                     count = 1;
                 }
                 else
                 {
                     // Add one item for the grid image.
-                    count = 1 + colorImages.Count;
+                    count = 1 + colorImageCount;
                 }
 
-                if (alphaImages != null)
+                if (hasAlpha)
                 {
                     // The color and alpha lists will always have the same number of images.
                     count *= 2;
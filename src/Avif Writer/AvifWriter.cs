@@ -25,6 +25,7 @@ namespace AvifFileType
         private readonly MetaBox metaBox;
         private readonly IReadOnlyList<ColorInformationBox> colorInformationBoxes;
         private readonly bool colorImageIsGrayscale;
+        private readonly int bitDepth;
         private readonly IArrayPoolService arrayPool;
 
         private readonly ProgressEventHandler progressCallback;
@@ -38,6 +39,7 @@ namespace AvifFileType
                           AvifMetadata metadata,
                           ImageGridMetadata imageGridMetadata,
                           YUVChromaSubsampling chromaSubsampling,
+                          int bitDepth,
                           IReadOnlyList<ColorInformationBox> colorInformationBoxes,
                           ProgressEventHandler progressEventHandler,
                           uint progressDone,
@@ -53,11 +55,12 @@ namespace AvifFileType
                                              arrayPool);
             this.arrayPool = arrayPool;
             this.colorImageIsGrayscale = chromaSubsampling == YUVChromaSubsampling.Subsampling400;
+            this.bitDepth = bitDepth;
             this.colorInformationBoxes = colorInformationBoxes ?? System.Array.Empty<ColorInformationBox>();
             this.progressCallback = progressEventHandler;
             this.progressDone = progressDone;
             this.progressTotal = progressTotal;
-            this.fileTypeBox = new FileTypeBox(chromaSubsampling);
+            this.fileTypeBox = new FileTypeBox(chromaSubsampling, bitDepth);
             this.metaBox = new MetaBox(this.state.PrimaryItemId,
                                        this.state.Items.Count,
                                        this.state.MediaDataBoxContentSize > uint.MaxValue,
@@ -65,8 +68,73 @@ namespace AvifFileType
             PopulateMetaBox();
         }
 
+        /// <summary>
+        /// Initializes a new instance of the <see cref="AvifWriter"/> class that writes the image grid
+        /// tiles to the media data box as they are compressed.
+        /// </summary>
+        /// <remarks>
+        /// The meta box is written before any of the tiles are compressed, it uses placeholder values for
+        /// the tile offsets and lengths which are updated after each tile has been written.
+        /// This requires a seekable output stream.
+        /// </remarks>
+        public AvifWriter(ImageGridMetadata imageGridMetadata,
+                          bool hasAlpha,
+                          HomogeneousTileInfo homogeneousTiles,
+                          bool premultipliedAlpha,
+                          AvifMetadata metadata,
+                          YUVChromaSubsampling chromaSubsampling,
+                          int bitDepth,
+                          IReadOnlyList<ColorInformationBox> colorInformationBoxes,
+                          ProgressEventHandler progressEventHandler,
+                          uint progressDone,
+                          uint progressTotal,
+                          IArrayPoolService arrayPool)
+        {
+            this.state = new AvifWriterState(imageGridMetadata,
+                                             chromaSubsampling,
+                                             hasAlpha,
+                                             homogeneousTiles,
+                                             premultipliedAlpha,
+                                             metadata,
+                                             arrayPool);
+            this.arrayPool = arrayPool;
+            this.colorImageIsGrayscale = chromaSubsampling == YUVChromaSubsampling.Subsampling400;
+            this.bitDepth = bitDepth;
+            this.colorInformationBoxes = colorInformationBoxes ?? System.Array.Empty<ColorInformationBox>();
+            this.progressCallback = progressEventHandler;
+            this.progressDone = progressDone;
+            this.progressTotal = progressTotal;
+            this.fileTypeBox = new FileTypeBox(chromaSubsampling, bitDepth);
+            // The final size of the media data box is not known until all of the
+            // tiles have been compressed, so the 64-bit offsets are always used.
+            this.metaBox = new MetaBox(this.state.PrimaryItemId,
+                                       this.state.Items.Count,
+                                       true,
+                                       this.state.ItemDataBox);
+            PopulateMetaBox();
+        }
+
+        /// <summary>
+        /// Compresses a range of the image grid tiles.
+        /// </summary>
+        /// <param name="firstTileIndex">The index of the first tile to compress.</param>
+        /// <param name="tileCount">The number of tiles to compress.</param>
+        /// <param name="progressDone">The progress done value.</param>
+        /// <param name="colorImages">The compressed color images, duplicate tiles are <see langword="null"/>.</param>
+        /// <param name="alphaImages">The compressed alpha images, duplicate tiles are <see langword="null"/>.</param>
+        public delegate void CompressImageGridTiles(int firstTileIndex,
+                                                    int tileCount,
+                                                    ref uint progressDone,
+                                                    out CompressedAV1Image[] colorImages,
+                                                    out CompressedAV1Image[] alphaImages);
+
         public void WriteTo(Stream stream)
         {
+            if (this.state.IsStreaming)
+            {
+                ExceptionUtil.ThrowInvalidOperationException("The streaming writer requires a tile compression callback.");
+            }
+
             using (BigEndianBinaryWriter writer = new BigEndianBinaryWriter(stream, true, this.arrayPool))
             {
                 this.fileTypeBox.Write(writer);
@@ -96,6 +164,85 @@ namespace AvifFileType
             }
         }
 
+        /// <summary>
+        /// Writes the image to the specified stream, compressing the image grid tiles one row at a time.
+        /// </summary>
+        /// <param name="stream">The stream.</param>
+        /// <param name="compressTiles">The callback that compresses the image grid tiles.</param>
+        /// <remarks>
+        /// Each row of tiles is written to the media data box and released as soon as it has been compressed,
+        /// this limits the amount of compressed data that is held in memory to a single row of tiles.
+        /// </remarks>
+        public void WriteTo(Stream stream, CompressImageGridTiles compressTiles)
+        {
+            if (compressTiles is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(compressTiles));
+            }
+
+            if (!this.state.IsStreaming)
+            {
+                ExceptionUtil.ThrowInvalidOperationException("The writer was not created in streaming mode.");
+            }
+
+            using (BigEndianBinaryWriter writer = new BigEndianBinaryWriter(stream, true, this.arrayPool))
+            {
+                this.fileTypeBox.Write(writer);
+                this.metaBox.Write(writer);
+
+                MediaDataBox mediaDataBox = new MediaDataBox();
+                mediaDataBox.Write(writer);
+
+                long mediaDataStartPosition = writer.Position;
+
+                // The meta data is written first to improve efficiency for readers that want to use it
+                // without reading the image data.
+                // The alpha image tiles in each row are written before the color image tiles, this
+                // keeps the alpha data ahead of the color data it applies to when the image is streamed.
+                WriteMediaDataBoxItems(writer, this.state.MediaDataBoxMetadataItemIndexes);
+
+                ImageGridMetadata imageGrid = this.state.ImageGrid;
+                int tileColumnCount = imageGrid.TileColumnCount;
+
+                for (int row = 0; row < imageGrid.TileRowCount; row++)
+                {
+                    int firstTileIndex = row * tileColumnCount;
+
+                    CompressedAV1Image[] colorImages = null;
+                    CompressedAV1Image[] alphaImages = null;
+
+                    try
+                    {
+                        compressTiles(firstTileIndex, tileColumnCount, ref this.progressDone, out colorImages, out alphaImages);
+
+                        if (this.state.AlphaItemId != 0)
+                        {
+                            WriteStreamedImageGridTiles(writer, this.state.MediaDataBoxAlphaItemIndexes, firstTileIndex, alphaImages);
+                        }
+                        WriteStreamedImageGridTiles(writer, this.state.MediaDataBoxColorItemIndexes, firstTileIndex, colorImages);
+                    }
+                    finally
+                    {
+                        DisposeImages(colorImages);
+                        DisposeImages(alphaImages);
+                    }
+                }
+
+                mediaDataBox.WriteFinalLength(writer, (ulong)(writer.Position - mediaDataStartPosition));
+            }
+        }
+
+        private static void DisposeImages(CompressedAV1Image[] images)
+        {
+            if (images != null)
+            {
+                for (int i = 0; i < images.Length; i++)
+                {
+                    images[i]?.Dispose();
+                }
+            }
+        }
+
         private void PopulateItemInfos()
         {
             IReadOnlyList<AvifWriterItem> items = this.state.Items;
@@ -155,11 +302,11 @@ namespace AvifFileType
             for (int i = 0; i < items.Count; i++)
             {
                 AvifWriterItem item = items[i];
-                if (item.Image != null)
+                if (item.IsImageItem)
                 {
                     if (imageSpatialExtentsAssociationIndex == 0)
                     {
-                        itemPropertiesBox.AddProperty(new ImageSpatialExtentsBox((uint)item.Image.Width, (uint)item.Image.Height));
+                        itemPropertiesBox.AddProperty(new ImageSpatialExtentsBox((uint)item.ImageWidth, (uint)item.ImageHeight));
                         imageSpatialExtentsAssociationIndex = propertyAssociationIndex;
                         propertyAssociationIndex++;
                     }
@@ -177,7 +324,7 @@ namespace AvifFileType
 
                     if (colorAv1ConfigAssociationIndex == 0 || item.IsAlphaImage && alphaAv1ConfigAssociationIndex == 0)
                     {
-                        itemPropertiesBox.AddProperty(AV1ConfigBoxBuilder.Build(item.Image));
+                        itemPropertiesBox.AddProperty(AV1ConfigBoxBuilder.Build(item.ImageWidth, item.ImageHeight, item.ImageFormat, this.bitDepth));
                         if (this.colorImageIsGrayscale)
                         {
                             colorAv1ConfigAssociationIndex = alphaAv1ConfigAssociationIndex = propertyAssociationIndex;
@@ -198,7 +345,7 @@ namespace AvifFileType
 
                     if (colorPixelInformationAssociationIndex == 0 || item.IsAlphaImage && alphaPixelInformationAssociationIndex == 0)
                     {
-                        itemPropertiesBox.AddProperty(new PixelInformationBox(item.Image.Format));
+                        itemPropertiesBox.AddProperty(new PixelInformationBox(item.ImageFormat, this.bitDepth));
                         if (this.colorImageIsGrayscale)
                         {
                             colorPixelInformationAssociationIndex = alphaPixelInformationAssociationIndex = propertyAssociationIndex;
@@ -289,6 +436,48 @@ namespace AvifFileType
             PopulateItemReferences();
         }
 
+        private void WriteStreamedImageGridTiles(BigEndianBinaryWriter writer,
+                                                 IReadOnlyList<int> itemIndexes,
+                                                 int firstTileIndex,
+                                                 CompressedAV1Image[] images)
+        {
+            IReadOnlyList<AvifWriterItem> items = this.state.Items;
+
+            for (int i = 0; i < images.Length; i++)
+            {
+                AvifWriterItem item = items[itemIndexes[firstTileIndex + i]];
+
+                // We only ever write items with a single extent.
+                ItemLocationExtent extent = item.ItemLocation.Extents[0];
+
+                if (item.DuplicateImageIndex >= 0)
+                {
+                    // The duplicate tiles always refer to a tile that has already been written.
+                    ItemLocationExtent existingExtent = items[item.DuplicateImageIndex].ItemLocation.Extents[0];
+
+                    extent.WriteFinalOffset(writer, existingExtent.Offset);
+                    extent.WriteFinalLength(writer, existingExtent.Length);
+                }
+                else
+                {
+                    CompressedAV1Image image = images[i];
+
+                    if (image is null)
+                    {
+                        ExceptionUtil.ThrowInvalidOperationException($"The compressed image for tile { firstTileIndex + i } is missing.");
+                    }
+
+                    extent.WriteFinalOffset(writer, (ulong)writer.Position);
+                    extent.WriteFinalLength(writer, image.Data.ByteLength);
+
+                    image.Data.Write(writer);
+                }
+
+                this.progressDone++;
+                this.progressCallback?.Invoke(this, new ProgressEventArgs(((double)this.progressDone / this.progressTotal) * 100.0));
+            }
+        }
+
         private void WriteMediaDataBoxItems(BigEndianBinaryWriter writer, IReadOnlyList<int> itemIndexes)
         {
             IReadOnlyList<AvifWriterItem> items = this.state.Items;
@@ -19,7 +19,6 @@ using PaintDotNet.Imaging;
 using PaintDotNet.Rendering;
 using System;
 using System.Collections.Generic;
-using System.ComponentModel;
 using System.Drawing;
 using System.IO;
 
@@ -32,42 +31,119 @@ namespace AvifFileType
         // This value is no longer written, but it is retained to
         // allow the data to be read from existing PDN files.
         private const string NclxMetadataName = "AvifNclxData";
+        // Image grids that are at least this size write each row of tiles to the file as soon as it
+        // has been compressed, instead of keeping all of the compressed tiles in memory.
+        private const long StreamingWriterMinimumPixelCount = 8192L * 8192L;
 
         public static Document Load(Stream input, IArrayPoolService arrayPool)
+        {
+            return Load(input, arrayPool, null);
+        }
+
+        /// <summary>
+        /// Loads the image.
+        /// </summary>
+        /// <param name="input">The input stream.</param>
+        /// <param name="arrayPool">The array pool.</param>
+        /// <param name="indexCache">
+        /// The cache that is used to skip parsing the container boxes when the same file is opened again,
+        /// or <see langword="null"/> to always parse the container boxes.
+        /// </param>
+        /// <returns>The loaded document.</returns>
+        public static Document Load(Stream input, IArrayPoolService arrayPool, AvifContainerIndexCache indexCache)
         {
             if (arrayPool is null)
             {
                 ExceptionUtil.ThrowArgumentNullException(nameof(arrayPool));
             }
 
-            Document doc = null;
+            using (AvifReader reader = new AvifReader(input, leaveOpen: true, arrayPool, 0, indexCache))
+            {
+                return DecodeDocument(reader, arrayPool);
+            }
+        }
 
-            using (AvifReader reader = new AvifReader(input, leaveOpen: true, arrayPool))
+        /// <summary>
+        /// Loads the specified region of the image, only the image grid tiles that overlap the region are decoded.
+        /// </summary>
+        /// <param name="input">The input stream.</param>
+        /// <param name="region">The region of the image to load.</param>
+        /// <param name="arrayPool">The array pool.</param>
+        /// <returns>A surface containing the specified region of the image.</returns>
+        public static Surface LoadRegion(Stream input, Rectangle region, IArrayPoolService arrayPool)
+        {
+            return LoadRegion(input, region, arrayPool, null);
+        }
+
+        /// <summary>
+        /// Loads the specified region of the image, only the image grid tiles that overlap the region are decoded.
+        /// </summary>
+        /// <param name="input">The input stream.</param>
+        /// <param name="region">The region of the image to load.</param>
+        /// <param name="arrayPool">The array pool.</param>
+        /// <param name="indexCache">
+        /// The cache that is used to skip parsing the container boxes when the same file is opened again,
+        /// or <see langword="null"/> to always parse the container boxes.
+        /// </param>
+        /// <returns>A surface containing the specified region of the image.</returns>
+        public static Surface LoadRegion(Stream input, Rectangle region, IArrayPoolService arrayPool, AvifContainerIndexCache indexCache)
+        {
+            if (arrayPool is null)
             {
-                Surface surface = null;
-                bool disposeSurface = true;
+                ExceptionUtil.ThrowArgumentNullException(nameof(arrayPool));
+            }
 
-                try
-                {
-                    surface = reader.Decode();
+            using (AvifReader reader = new AvifReader(input, leaveOpen: true, arrayPool, 0, indexCache))
+            {
+                return reader.DecodeRegion(region);
+            }
+        }
 
-                    doc = new Document(surface.Width, surface.Height);
+        /// <summary>
+        /// Loads a reduced size copy of the image for a thumbnail, a thumbnail image stored in
+        /// the file is used when it is at least <paramref name="maxSize"/> pixels.
+        /// </summary>
+        /// <param name="input">The input stream.</param>
+        /// <param name="maxSize">The maximum width or height of the thumbnail.</param>
+        /// <param name="arrayPool">The array pool.</param>
+        /// <returns>
+        /// A surface containing the image downscaled by a power of two, the caller resamples it to the final thumbnail size.
+        /// </returns>
+        public static Surface LoadThumbnail(Stream input, int maxSize, IArrayPoolService arrayPool)
+        {
+            return LoadThumbnail(input, maxSize, arrayPool, null);
+        }
 
-                    AddAvifMetadataToDocument(doc, reader, arrayPool);
+        /// <summary>
+        /// Loads a reduced size copy of the image for a thumbnail, a thumbnail image stored in
+        /// the file is used when it is at least <paramref name="maxSize"/> pixels.
+        /// </summary>
+        /// <param name="input">The input stream.</param>
+        /// <param name="maxSize">The maximum width or height of the thumbnail.</param>
+        /// <param name="arrayPool">The array pool.</param>
+        /// <param name="indexCache">
+        /// The cache that is used to skip parsing the container boxes when the same file is opened again,
+        /// or <see langword="null"/> to always parse the container boxes.
+        /// </param>
+        /// <returns>
+        /// A surface containing the image downscaled by a power of two, the caller resamples it to the final thumbnail size.
+        /// </returns>
+        public static Surface LoadThumbnail(Stream input, int maxSize, IArrayPoolService arrayPool, AvifContainerIndexCache indexCache)
+        {
+            if (maxSize < 1)
+            {
+                throw new ArgumentOutOfRangeException(nameof(maxSize));
+            }
 
-                    doc.Layers.Add(Layer.CreateBackgroundLayer(surface, takeOwnership: true));
-                    disposeSurface = false;
-                }
-                finally
-                {
-                    if (disposeSurface)
-                    {
-                        surface?.Dispose();
-                    }
-                }
+            if (arrayPool is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(arrayPool));
             }
 
-            return doc;
+            using (AvifReader reader = new AvifReader(input, leaveOpen: true, arrayPool, (uint)maxSize, indexCache))
+            {
+                return reader.DecodeThumbnail(maxSize);
+            }
         }
 
         public static void Save(Document document,
@@ -76,6 +152,7 @@ namespace AvifFileType
                          bool losslessAlpha,
                          CompressionSpeed compressionSpeed,
                          YUVChromaSubsampling chromaSubsampling,
+                         EncoderBitDepth bitDepth,
                          bool preserveExistingTileSize,
                          bool premultipliedAlpha,
                          Surface scratchSurface,
@@ -92,7 +169,132 @@ namespace AvifFileType
                 document.Render(args, true);
             }
 
-            bool grayscale = IsGrayscaleImage(scratchSurface);
+            int maxThreads = Environment.ProcessorCount;
+
+            using (AvifSaveContext context = PrepareImage(document,
+                                                          scratchSurface,
+                                                          quality,
+                                                          losslessAlpha,
+                                                          compressionSpeed,
+                                                          chromaSubsampling,
+                                                          bitDepth,
+                                                          preserveExistingTileSize,
+                                                          premultipliedAlpha,
+                                                          maxThreads))
+            {
+                uint progressDone = context.InitialProgressDone;
+
+                if (progressDone > 0)
+                {
+                    progressCallback?.Invoke(null, new ProgressEventArgs(((double)progressDone / context.ProgressTotal) * 100.0, true));
+                }
+
+                // The encoder session allows the tiles that have the same size to reuse the AV1 encoder,
+                // instead of creating a new encoder for each tile.
+                using (SafeEncoderSessionHandle encoderSession = AvifNative.CreateEncoderSession())
+                {
+                    if (UseStreamingWriter(context.ImageGridMetadata))
+                    {
+                        WriteImageWhileCompressing(context, output, encoderSession, maxThreads, progressCallback, progressDone, arrayPool);
+                        return;
+                    }
+
+                    CompressImage(context, encoderSession, maxThreads, progressCallback, ref progressDone, arrayPool, null);
+                }
+
+                WriteImage(context, output, progressCallback, progressDone, arrayPool);
+            }
+        }
+
+        /// <summary>
+        /// Decodes the image and its meta-data into a new document.
+        /// </summary>
+        /// <param name="reader">The reader.</param>
+        /// <param name="arrayPool">The array pool.</param>
+        /// <returns>The decoded document.</returns>
+        internal static Document DecodeDocument(AvifReader reader, IArrayPoolService arrayPool)
+        {
+            Document doc = null;
+            Surface surface = null;
+            bool disposeSurface = true;
+
+            try
+            {
+                surface = reader.Decode();
+
+                doc = new Document(surface.Width, surface.Height);
+
+                AddAvifMetadataToDocument(doc, reader, arrayPool);
+
+                doc.Layers.Add(Layer.CreateBackgroundLayer(surface, takeOwnership: true));
+                disposeSurface = false;
+            }
+            finally
+            {
+                if (disposeSurface)
+                {
+                    surface?.Dispose();
+                }
+            }
+
+            return doc;
+        }
+
+        /// <summary>
+        /// Analyzes the image and selects the encoder options, this is the first stage of saving an image.
+        /// </summary>
+        /// <param name="document">The document that provides the meta-data and saved tile layout.</param>
+        /// <param name="image">The flattened image.</param>
+        /// <param name="bitDepth">The bit depth of the encoded image, lossless images are always encoded at 8 bits per sample.</param>
+        /// <param name="maxThreads">The maximum number of threads that are used to analyze the image.</param>
+        /// <returns>The state that is passed to the compress and write stages.</returns>
+        internal static AvifSaveContext PrepareImage(Document document,
+                                                     Surface image,
+                                                     int quality,
+                                                     bool losslessAlpha,
+                                                     CompressionSpeed compressionSpeed,
+                                                     YUVChromaSubsampling chromaSubsampling,
+                                                     EncoderBitDepth bitDepth,
+                                                     bool preserveExistingTileSize,
+                                                     bool premultipliedAlpha,
+                                                     int maxThreads)
+        {
+            // The tile layout only depends on the YUV format when an existing tile size is preserved,
+            // so the tiles are analyzed using the layout of the color YUV format and the analysis is
+            // repeated in the rare case that the gray-scale layout is different.
+            YUVChromaSubsampling colorYUVFormat = quality == 100 ? YUVChromaSubsampling.IdentityMatrix : chromaSubsampling;
+            // The lossless Identity matrix encoding keeps the 8-bit samples of the image.
+            EncoderBitDepth encodedBitDepth = quality == 100 ? EncoderBitDepth.EightBit : bitDepth;
+
+            ImageGridMetadata imageGridMetadata = TryGetImageGridMetadata(document,
+                                                                          compressionSpeed,
+                                                                          encodedBitDepth,
+                                                                          colorYUVFormat,
+                                                                          preserveExistingTileSize,
+                                                                          maxThreads);
+            Rectangle[] windowRectangles = GetTileWindowRectangles(imageGridMetadata, document);
+
+            // The gray-scale, transparency and homogeneous tile checks are performed in a single pass.
+            TileAnalysis[] tileAnalysis = AvifNative.AnalyzeImageTiles(image, windowRectangles, maxThreads);
+
+            bool grayscale = IsGrayscaleImage(tileAnalysis);
+
+            if (grayscale)
+            {
+                ImageGridMetadata grayscaleImageGridMetadata = TryGetImageGridMetadata(document,
+                                                                                       compressionSpeed,
+                                                                                       encodedBitDepth,
+                                                                                       YUVChromaSubsampling.Subsampling400,
+                                                                                       preserveExistingTileSize,
+                                                                                       maxThreads);
+
+                if (!TileLayoutsAreEqual(imageGridMetadata, grayscaleImageGridMetadata))
+                {
+                    imageGridMetadata = grayscaleImageGridMetadata;
+                    windowRectangles = GetTileWindowRectangles(imageGridMetadata, document);
+                    tileAnalysis = AvifNative.AnalyzeImageTiles(image, windowRectangles, maxThreads);
+                }
+            }
 
             AvifMetadata metadata = CreateAvifMetadata(document);
             EncoderOptions options = new EncoderOptions
@@ -103,7 +305,11 @@ namespace AvifFileType
                 // YUV 4:0:0 is always used for gray-scale images because it
                 // produces the smallest file size with no quality loss.
                 yuvFormat = grayscale ? YUVChromaSubsampling.Subsampling400 : chromaSubsampling,
-                maxThreads = Environment.ProcessorCount
+                maxThreads = maxThreads,
+                maxConversionThreads = maxThreads,
+                bitDepth = (uint)encodedBitDepth,
+                // The Fast preset trades some compression efficiency for a shorter encoding time.
+                reducedIntraTools = compressionSpeed == CompressionSpeed.Fast
             };
 
             // Use BT.709 with sRGB transfer characteristics as the default.
@@ -151,20 +357,13 @@ namespace AvifFileType
                 }
             }
 
-            ImageGridMetadata imageGridMetadata = TryGetImageGridMetadata(document,
-                                                                          options.compressionSpeed,
-                                                                          options.yuvFormat,
-                                                                          preserveExistingTileSize);
-
-            bool hasTransparency = HasTransparency(scratchSurface);
+            bool hasTransparency = HasTransparency(tileAnalysis);
 
-            if (hasTransparency && premultipliedAlpha)
-            {
-                scratchSurface.ConvertToPremultipliedAlpha();
-            }
+            // The color is premultiplied by the native code as it is converted to YUV, this avoids
+            // reading and writing the whole image in a separate pass.
+            options.premultiplyAlpha = hasTransparency && premultipliedAlpha;
 
-            CompressedAV1ImageCollection colorImages = new CompressedAV1ImageCollection(imageGridMetadata?.TileCount ?? 1);
-            CompressedAV1ImageCollection alphaImages = hasTransparency ? new CompressedAV1ImageCollection(colorImages.Capacity) : null;
+            int tileCount = imageGridMetadata?.TileCount ?? 1;
 
             // Progress is reported at the following stages:
             // 1. Before compressing the color image
@@ -176,139 +375,194 @@ namespace AvifFileType
 
             uint progressDone = 0;
             uint progressTotal = hasTransparency ? 6U : 3U;
-            if (colorImages.Capacity > 1)
+            if (tileCount > 1)
             {
-                progressTotal *= (uint)colorImages.Capacity;
+                progressTotal *= (uint)tileCount;
             }
 
+            HomogeneousTileInfo homogeneousTileInfo = GetHomogeneousTileInfo(image,
+                                                                              windowRectangles,
+                                                                              tileAnalysis,
+                                                                              hasTransparency,
+                                                                              hasTransparency && premultipliedAlpha,
+                                                                              maxThreads);
+
+            // Homogeneous (single color) tiles will be compressed once and any subsequent tiles will reuse
+            // the compressed data from the first tile.
+            // This can significantly reduce the compression time for images that contain large areas of a
+            // single color.
+            int duplicateTileCount = homogeneousTileInfo.DuplicateColorTileMap.Count;
+            if (hasTransparency)
+            {
+                duplicateTileCount += homogeneousTileInfo.DuplicateAlphaTileMap.Count;
+            }
+
+            progressDone += 2U * (uint)duplicateTileCount;
+
+            return new AvifSaveContext(document,
+                                       image,
+                                       imageGridMetadata,
+                                       windowRectangles,
+                                       metadata,
+                                       options,
+                                       colorConversionInfo,
+                                       hasTransparency,
+                                       premultipliedAlpha,
+                                       homogeneousTileInfo,
+                                       progressDone,
+                                       progressTotal);
+        }
+
+        /// <summary>
+        /// Compresses the color and alpha images, this is the second stage of saving an image.
+        /// </summary>
+        /// <param name="context">The state that was created by <see cref="PrepareImage"/>.</param>
+        /// <param name="encoderSession">The encoder session, it must not be used by more than one thread at a time.</param>
+        /// <param name="maxThreads">The maximum number of threads that are used to compress the image.</param>
+        /// <param name="statistics">The statistics that the native encoder adds to, or <see langword="null"/>.</param>
+        internal static void CompressImage(AvifSaveContext context,
+                                           SafeEncoderSessionHandle encoderSession,
+                                           int maxThreads,
+                                           ProgressEventHandler progressCallback,
+                                           ref uint progressDone,
+                                           IArrayPoolService arrayPool,
+                                           InstrumentationStatistics statistics)
+        {
+            CompressedAV1ImageCollection colorImages = context.ColorImages;
+            CompressedAV1ImageCollection alphaImages = context.AlphaImages;
+            HomogeneousTileInfo homogeneousTileInfo = context.HomogeneousTileInfo;
+
+            CompressedAV1Image[] compressedColorTiles = null;
+            CompressedAV1Image[] compressedAlphaTiles = null;
+
             try
             {
-                Rectangle[] windowRectangles = GetTileWindowRectangles(imageGridMetadata, document);
-                HomogeneousTileInfo homogeneousTileInfo = GetHomogeneousTileInfo(scratchSurface, windowRectangles, hasTransparency);
+                // The tiles are compressed concurrently, the progress callback is serialized by the native code.
+                AvifNative.CompressImageGrid(encoderSession,
+                                             context.Image,
+                                             context.WindowRectangles,
+                                             homogeneousTileInfo,
+                                             context.HasTransparency,
+                                             GetEncoderOptions(context, maxThreads),
+                                             CreateCompressionProgressCallback(progressCallback),
+                                             arrayPool,
+                                             ref progressDone,
+                                             context.ProgressTotal,
+                                             context.ColorConversionInfo,
+                                             statistics,
+                                             out compressedColorTiles,
+                                             out compressedAlphaTiles);
 
                 for (int i = 0; i < colorImages.Capacity; i++)
                 {
-                    // Homogeneous (single color) tiles will be compressed once and any subsequent tiles will reuse
-                    // the compressed data from the first tile.
-                    // This can significantly reduce the compression time for images that contain large areas of a
-                    // single color.
                     if (homogeneousTileInfo.DuplicateColorTileMap.TryGetValue(i, out int duplicateTileIndex))
                     {
                         colorImages.Add(colorImages[duplicateTileIndex]);
-
-                        progressDone += 2U;
-                        progressCallback?.Invoke(null, new ProgressEventArgs(((double)progressDone / progressTotal) * 100.0, true));
                     }
                     else
                     {
-                        CompressedAV1Image color = null;
-
-                        try
-                        {
-                            Rectangle windowRect = windowRectangles[i];
-                            using (Surface window = scratchSurface.CreateWindow(windowRect))
-                            {
-                                AvifNative.CompressColorImage(window,
-                                                              options,
-                                                              ReportCompressionProgress,
-                                                              arrayPool,
-                                                              ref progressDone,
-                                                              progressTotal,
-                                                              colorConversionInfo,
-                                                              out color);
-                            }
-
-                            colorImages.Add(color);
-                            color = null;
-                        }
-                        finally
-                        {
-                            color?.Dispose();
-                        }
+                        colorImages.Add(compressedColorTiles[i]);
+                        compressedColorTiles[i] = null;
                     }
 
-                    if (hasTransparency)
+                    if (context.HasTransparency)
                     {
                         if (homogeneousTileInfo.DuplicateAlphaTileMap.TryGetValue(i, out duplicateTileIndex))
                         {
                             alphaImages.Add(alphaImages[duplicateTileIndex]);
-
-                            progressDone += 2U;
-                            progressCallback?.Invoke(null, new ProgressEventArgs(((double)progressDone / progressTotal) * 100.0, true));
                         }
                         else
                         {
-                            CompressedAV1Image alpha = null;
-
-                            try
-                            {
-                                Rectangle windowRect = windowRectangles[i];
-                                using (Surface window = scratchSurface.CreateWindow(windowRect))
-                                {
-                                    AvifNative.CompressAlphaImage(window,
-                                                                  options,
-                                                                  ReportCompressionProgress,
-                                                                  arrayPool,
-                                                                  ref progressDone,
-                                                                  progressTotal,
-                                                                  out alpha);
-                                }
-
-                                alphaImages.Add(alpha);
-                                alpha = null;
-                            }
-                            finally
-                            {
-                                alpha?.Dispose();
-                            }
+                            alphaImages.Add(compressedAlphaTiles[i]);
+                            compressedAlphaTiles[i] = null;
                         }
                     }
                 }
-
-                List<ColorInformationBox> colorInformationBoxes = new List<ColorInformationBox>(2);
-
-                byte[] iccProfileBytes = metadata.GetICCProfileBytesReadOnly();
-                if (iccProfileBytes != null && iccProfileBytes.Length > 0)
-                {
-                    colorInformationBoxes.Add(new IccProfileColorInformation(iccProfileBytes));
-                }
-
-                colorInformationBoxes.Add(new NclxColorInformation(colorConversionInfo.colorPrimaries,
-                                                                   colorConversionInfo.transferCharacteristics,
-                                                                   colorConversionInfo.matrixCoefficients,
-                                                                   colorConversionInfo.fullRange));
-
-                AvifWriter writer = new AvifWriter(colorImages,
-                                                   alphaImages,
-                                                   homogeneousTileInfo,
-                                                   premultipliedAlpha,
-                                                   metadata,
-                                                   imageGridMetadata,
-                                                   options.yuvFormat,
-                                                   colorInformationBoxes,
-                                                   progressCallback,
-                                                   progressDone,
-                                                   progressTotal,
-                                                   arrayPool);
-                writer.WriteTo(output);
             }
             finally
             {
-                colorImages?.Dispose();
-                alphaImages?.Dispose();
+                DisposeCompressedImages(compressedColorTiles);
+                DisposeCompressedImages(compressedAlphaTiles);
             }
+        }
 
-            bool ReportCompressionProgress(uint done, uint total)
+        /// <summary>
+        /// Writes the compressed images to the output stream, this is the last stage of saving an image.
+        /// </summary>
+        /// <param name="context">The state that was passed to <see cref="CompressImage"/>.</param>
+        /// <param name="output">The output stream.</param>
+        internal static void WriteImage(AvifSaveContext context,
+                                        Stream output,
+                                        ProgressEventHandler progressCallback,
+                                        uint progressDone,
+                                        IArrayPoolService arrayPool)
+        {
+            AvifWriter writer = new AvifWriter(context.ColorImages,
+                                               context.AlphaImages,
+                                               context.HomogeneousTileInfo,
+                                               context.PremultipliedAlpha,
+                                               context.Metadata,
+                                               context.ImageGridMetadata,
+                                               context.Options.yuvFormat,
+                                               (int)context.Options.bitDepth,
+                                               CreateColorInformationBoxes(context.Metadata, context.ColorConversionInfo),
+                                               progressCallback,
+                                               progressDone,
+                                               context.ProgressTotal,
+                                               arrayPool);
+            writer.WriteTo(output);
+        }
+
+        private static void WriteImageWhileCompressing(AvifSaveContext context,
+                                                       Stream output,
+                                                       SafeEncoderSessionHandle encoderSession,
+                                                       int maxThreads,
+                                                       ProgressEventHandler progressCallback,
+                                                       uint progressDone,
+                                                       IArrayPoolService arrayPool)
+        {
+            EncoderOptions options = GetEncoderOptions(context, maxThreads);
+            AvifProgressCallback avifProgress = CreateCompressionProgressCallback(progressCallback);
+
+            AvifWriter streamingWriter = new AvifWriter(context.ImageGridMetadata,
+                                                        context.HasTransparency,
+                                                        context.HomogeneousTileInfo,
+                                                        context.PremultipliedAlpha,
+                                                        context.Metadata,
+                                                        options.yuvFormat,
+                                                        (int)options.bitDepth,
+                                                        CreateColorInformationBoxes(context.Metadata, context.ColorConversionInfo),
+                                                        progressCallback,
+                                                        progressDone,
+                                                        context.ProgressTotal,
+                                                        arrayPool);
+
+            // Each row of tiles is compressed concurrently and written to the file before the next row
+            // is compressed, the progress callback is serialized by the native code.
+            streamingWriter.WriteTo(output, CompressTiles);
+
+            void CompressTiles(int firstTileIndex,
+                               int tileCount,
+                               ref uint tileProgressDone,
+                               out CompressedAV1Image[] compressedColorTiles,
+                               out CompressedAV1Image[] compressedAlphaTiles)
             {
-                try
-                {
-                    progressCallback?.Invoke(null, new ProgressEventArgs(((double)done / total) * 100.0, true));
-                    return true;
-                }
-                catch (OperationCanceledException)
-                {
-                    return false;
-                }
+                AvifNative.CompressImageGrid(encoderSession,
+                                             context.Image,
+                                             context.WindowRectangles,
+                                             firstTileIndex,
+                                             tileCount,
+                                             context.HomogeneousTileInfo,
+                                             context.HasTransparency,
+                                             options,
+                                             avifProgress,
+                                             arrayPool,
+                                             ref tileProgressDone,
+                                             context.ProgressTotal,
+                                             context.ColorConversionInfo,
+                                             null,
+                                             out compressedColorTiles,
+                                             out compressedAlphaTiles);
             }
         }
 
@@ -433,6 +687,55 @@ namespace AvifFileType
             return new AvifMetadata(exifBytes, iccProfileBytes, xmpBytes);
         }
 
+        private static List<ColorInformationBox> CreateColorInformationBoxes(AvifMetadata metadata, CICPColorData colorConversionInfo)
+        {
+            List<ColorInformationBox> colorInformationBoxes = new List<ColorInformationBox>(2);
+
+            byte[] iccProfileBytes = metadata.GetICCProfileBytesReadOnly();
+            if (iccProfileBytes != null && iccProfileBytes.Length > 0)
+            {
+                colorInformationBoxes.Add(new IccProfileColorInformation(iccProfileBytes));
+            }
+
+            colorInformationBoxes.Add(new NclxColorInformation(colorConversionInfo.colorPrimaries,
+                                                               colorConversionInfo.transferCharacteristics,
+                                                               colorConversionInfo.matrixCoefficients,
+                                                               colorConversionInfo.fullRange));
+
+            return colorInformationBoxes;
+        }
+
+        private static AvifProgressCallback CreateCompressionProgressCallback(ProgressEventHandler progressCallback)
+        {
+            return ReportCompressionProgress;
+
+            bool ReportCompressionProgress(uint done, uint total)
+            {
+                try
+                {
+                    progressCallback?.Invoke(null, new ProgressEventArgs(((double)done / total) * 100.0, true));
+                    return true;
+                }
+                catch (OperationCanceledException)
+                {
+                    return false;
+                }
+            }
+        }
+
+        private static EncoderOptions GetEncoderOptions(AvifSaveContext context, int maxThreads)
+        {
+            EncoderOptions options = context.Options;
+            options.maxThreads = maxThreads;
+            options.maxConversionThreads = maxThreads;
+            // A large image that is not split into a grid uses AV1 tiles to encode in parallel, the
+            // thread count is only known at this point because the batch transcoder leases the threads.
+            options.enableInternalTiling = context.ImageGridMetadata is null
+                                           && EncoderCostModel.UsesInternalTiling(context.Image.Width, context.Image.Height, maxThreads);
+
+            return options;
+        }
+
         private static Dictionary<MetadataKey, MetadataEntry> GetExifMetadataFromDocument(Document doc)
         {
             Dictionary<MetadataKey, MetadataEntry> items = null;
@@ -483,7 +786,84 @@ namespace AvifFileType
             return items;
         }
 
-        private static HomogeneousTileInfo GetHomogeneousTileInfo(Surface surface, Rectangle[] tileRects, bool includeAlphaTiles)
+        /// <summary>
+        /// Adds the tiles that repeat the pixels of an earlier multi-color tile to the duplicate tile maps.
+        /// </summary>
+        private static void AddRepeatedTiles(Surface surface,
+                                             Rectangle[] tileRects,
+                                             bool includeAlphaTiles,
+                                             Dictionary<int, int> duplicateColorTileMap,
+                                             HashSet<int> homogeneousColorTiles,
+                                             Dictionary<int, int> duplicateAlphaTileMap,
+                                             int maxThreads)
+        {
+            if (homogeneousColorTiles.Count == tileRects.Length)
+            {
+                return;
+            }
+
+            ulong[] tileHashes = AvifNative.HashImageTiles(surface, tileRects, maxThreads);
+            // Tiles that have the same hash but different pixels are kept as separate candidates,
+            // so that the later tiles are compared with each of them.
+            Dictionary<ulong, List<int>> tilesWithHash = new Dictionary<ulong, List<int>>(tileRects.Length - homogeneousColorTiles.Count);
+
+            for (int i = 0; i < tileRects.Length; i++)
+            {
+                // The single color tiles have already been de-duplicated.
+                if (homogeneousColorTiles.Contains(i))
+                {
+                    continue;
+                }
+
+                ulong hash = tileHashes[i];
+
+                if (tilesWithHash.TryGetValue(hash, out List<int> candidateTiles))
+                {
+                    int duplicateTileIndex = FindMatchingTile(surface, tileRects, candidateTiles, tileRects[i]);
+
+                    if (duplicateTileIndex >= 0)
+                    {
+                        duplicateColorTileMap.Add(i, duplicateTileIndex);
+
+                        // A tile with a single alpha value may already refer to an earlier tile.
+                        if (includeAlphaTiles && !duplicateAlphaTileMap.ContainsKey(i))
+                        {
+                            duplicateAlphaTileMap.Add(i, duplicateTileIndex);
+                        }
+                    }
+                    else
+                    {
+                        candidateTiles.Add(i);
+                    }
+                }
+                else
+                {
+                    tilesWithHash.Add(hash, new List<int>(1) { i });
+                }
+            }
+        }
+
+        private static int FindMatchingTile(Surface surface, Rectangle[] tileRects, List<int> candidateTiles, Rectangle tileRect)
+        {
+            for (int i = 0; i < candidateTiles.Count; i++)
+            {
+                int candidateTileIndex = candidateTiles[i];
+
+                if (TilePixelsAreEqual(surface, tileRects[candidateTileIndex], tileRect))
+                {
+                    return candidateTileIndex;
+                }
+            }
+
+            return -1;
+        }
+
+        private static HomogeneousTileInfo GetHomogeneousTileInfo(Surface surface,
+                                                                  Rectangle[] tileRects,
+                                                                  TileAnalysis[] tileAnalysis,
+                                                                  bool includeAlphaTiles,
+                                                                  bool colorIsPremultiplied,
+                                                                  int maxThreads)
         {
             Dictionary<int, int> duplicateColorTileMap = new Dictionary<int, int>();
             HashSet<int> homogeneousColorTiles = new HashSet<int>();
@@ -497,7 +877,9 @@ namespace AvifFileType
 
                 for (int i = 0; i < tileRects.Length; i++)
                 {
-                    if (IsHomogeneousColorTile(surface, tileRects[i], out uint firstPixelBgr))
+                    TileAnalysis analysis = tileAnalysis[i];
+
+                    if (IsHomogeneousColorTile(surface, tileRects[i], analysis, colorIsPremultiplied, out uint firstPixelBgr))
                     {
                         homogeneousColorTiles.Add(i);
 
@@ -513,10 +895,12 @@ namespace AvifFileType
 
                     if (includeAlphaTiles)
                     {
-                        if (IsHomogeneousAlphaTile(surface, tileRects[i], out byte firstPixelAlpha))
+                        if (analysis.isHomogeneousAlpha)
                         {
                             homogeneousAlphaTiles.Add(i);
 
+                            byte firstPixelAlpha = (byte)(analysis.firstPixel >> 24);
+
                             if (homogeneousAlphaTileCache.TryGetValue(firstPixelAlpha, out int duplicateTileIndex))
                             {
                                 duplicateAlphaTileMap.Add(i, duplicateTileIndex);
@@ -528,6 +912,8 @@ namespace AvifFileType
                         }
                     }
                 }
+
+                AddRepeatedTiles(surface, tileRects, includeAlphaTiles, duplicateColorTileMap, homogeneousColorTiles, duplicateAlphaTileMap, maxThreads);
             }
 
             return new HomogeneousTileInfo(duplicateColorTileMap,
@@ -536,6 +922,17 @@ namespace AvifFileType
                                            homogeneousAlphaTiles);
         }
 
+        private static void DisposeCompressedImages(CompressedAV1Image[] images)
+        {
+            if (images != null)
+            {
+                for (int i = 0; i < images.Length; i++)
+                {
+                    images[i]?.Dispose();
+                }
+            }
+        }
+
         private static Rectangle[] GetTileWindowRectangles(ImageGridMetadata imageGridMetadata, Document document)
         {
             Rectangle[] rects;
@@ -571,210 +968,122 @@ namespace AvifFileType
             return rects;
         }
 
-        private static unsafe bool HasTransparency(Surface surface)
+        private static bool HasTransparency(TileAnalysis[] tileAnalysis)
         {
-            for (int y = 0; y < surface.Height; y++)
+            for (int i = 0; i < tileAnalysis.Length; i++)
             {
-                ColorBgra* ptr = surface.GetRowAddressUnchecked(y);
-                ColorBgra* ptrEnd = ptr + surface.Width;
-
-                while (ptr < ptrEnd)
+                if (tileAnalysis[i].hasTransparency)
                 {
-                    if (ptr->A < 255)
-                    {
-                        return true;
-                    }
-
-                    ptr++;
+                    return true;
                 }
             }
 
             return false;
         }
 
-        private static unsafe bool IsGrayscaleImage(Surface surface)
+        private static bool IsGrayscaleImage(TileAnalysis[] tileAnalysis)
         {
-            for (int y = 0; y < surface.Height; y++)
+            for (int i = 0; i < tileAnalysis.Length; i++)
             {
-                ColorBgra* ptr = surface.GetRowAddressUnchecked(y);
-                ColorBgra* ptrEnd = ptr + surface.Width;
-
-                while (ptr < ptrEnd)
+                if (!tileAnalysis[i].isGrayscale)
                 {
-                    if (!(ptr->R == ptr->G && ptr->G == ptr->B))
-                    {
-                        return false;
-                    }
-                    ptr++;
+                    return false;
                 }
             }
 
             return true;
         }
 
-        private static unsafe bool IsHomogeneousAlphaTile(Surface surface, Rectangle roi, out byte firstPixelAlpha)
+        private static bool IsHomogeneousColorTile(Surface surface,
+                                                   Rectangle roi,
+                                                   TileAnalysis analysis,
+                                                   bool colorIsPremultiplied,
+                                                   out uint firstPixelBgr)
         {
-            firstPixelAlpha = surface[roi.Left, roi.Top].A;
+            bool homogeneous;
+
+            firstPixelBgr = 0;
 
-            for (int y = roi.Top; y < roi.Bottom; y++)
+            if (colorIsPremultiplied)
             {
-                ColorBgra* ptr = surface.GetPointAddressUnchecked(roi.Left, y);
+                // The image is not premultiplied, the native code premultiplies the color when it is compressed.
+                // A tile is homogeneous after premultiplication if all of its pixels were the same,
+                // if every pixel is fully transparent or if every pixel has a black color.
+                homogeneous = (analysis.isHomogeneousColor && (analysis.isHomogeneousAlpha || (analysis.firstPixel & 0x00ffffff) == 0))
+                              || (analysis.isHomogeneousAlpha && (analysis.firstPixel & 0xff000000) == 0);
 
-                for (int x = roi.Left; x < roi.Right; x++)
+                if (homogeneous)
                 {
-                    if (ptr->A != firstPixelAlpha)
-                    {
-                        return false;
-                    }
-
-                    ptr++;
+                    firstPixelBgr = PremultiplyColor(surface[roi.Left, roi.Top]);
                 }
             }
-
-            return true;
-        }
-
-        private static unsafe bool IsHomogeneousColorTile(Surface surface, Rectangle roi, out uint firstPixelBgr)
-        {
-            firstPixelBgr = surface[roi.Left, roi.Top].Bgra & 0x00ffffff;
-
-            for (int y = roi.Top; y < roi.Bottom; y++)
+            else
             {
-                ColorBgra* ptr = surface.GetPointAddressUnchecked(roi.Left, y);
+                homogeneous = analysis.isHomogeneousColor;
 
-                for (int x = roi.Left; x < roi.Right; x++)
+                if (homogeneous)
                 {
-                    if ((ptr->Bgra & 0x00ffffff) != firstPixelBgr)
-                    {
-                        return false;
-                    }
-
-                    ptr++;
+                    firstPixelBgr = surface[roi.Left, roi.Top].Bgra & 0x00ffffff;
                 }
             }
 
-            return true;
+            return homogeneous;
         }
 
-        private static ImageGridMetadata TryCalculateBestTileSize(
-            Document document,
-            CompressionSpeed compressionSpeed)
+        /// <summary>
+        /// Premultiplies the color channels using the same rounding as the native code.
+        /// </summary>
+        /// <param name="color">The color.</param>
+        /// <returns>The premultiplied color channels in BGR order.</returns>
+        private static uint PremultiplyColor(ColorBgra color)
         {
-            // Although the HEIF specification (ISO/IEC 23008-12:2017) allows an image grid to have up to 256 tiles
-            // in each direction (65536 total), the ISO base media file format (ISO/IEC 14496-12:2015) limits
-            // an item reference box to 65535 items.
-            // Because of this we limit the maximum number of tiles to 250.
-            //
-            // While this would result in the image using 62500 tiles in the worst case, it allows
-            // memory usage to be minimized when encoding extremely wide and/or tall images.
-            //
-            // For example, a 65536x65536 pixel image would use a 128x128 grid of 512x512 pixel tiles.
-            const int MaxTileCount = 250;
-            // The MIAF specification (ISO/IEC 23000-22:2019) requires that the tile size be at least 64x64 pixels.
-            const int MinTileSize = 64;
-
-            int maxTileSize;
-
-            switch (compressionSpeed)
-            {
-                case CompressionSpeed.Fast:
-                    maxTileSize = 512;
-                    break;
-                case CompressionSpeed.Medium:
-                    maxTileSize = 1280;
-                    break;
-                case CompressionSpeed.Slow:
-                    maxTileSize = 1920;
-                    break;
-                case CompressionSpeed.VerySlow:
-                    // Tiles are not used for the very slow compression speed.
-                    return null;
-                default:
-                    throw new InvalidEnumArgumentException(nameof(compressionSpeed), (int)compressionSpeed, typeof(CompressionSpeed));
-            }
-
-            int bestTileColumnCount = 1;
-            int bestTileWidth = document.Width;
-            int bestTileRowCount = 1;
-            int bestTileHeight = document.Height;
-
-            if (document.Width > maxTileSize)
-            {
-                for (int tileColumnCount = 2; tileColumnCount <= MaxTileCount; tileColumnCount++)
-                {
-                    int tileWidth = document.Width / tileColumnCount;
+            uint alpha = color.A;
 
-                    if (tileWidth < MinTileSize)
-                    {
-                        break;
-                    }
+            uint b = ((color.B * alpha) + 127) / 255;
+            uint g = ((color.G * alpha) + 127) / 255;
+            uint r = ((color.R * alpha) + 127) / 255;
 
-                    if ((tileWidth & 1) == 0 && (tileWidth * tileColumnCount) == document.Width)
-                    {
-                        bestTileWidth = tileWidth;
-                        bestTileColumnCount = tileColumnCount;
+            return b | (g << 8) | (r << 16);
+        }
 
-                        if (tileWidth <= maxTileSize)
-                        {
-                            break;
-                        }
-                    }
-                }
-            }
+        private static unsafe bool TilePixelsAreEqual(Surface surface, Rectangle first, Rectangle second)
+        {
+            ulong rowLengthInBytes = (ulong)first.Width * (ulong)sizeof(ColorBgra);
 
-            if (document.Height > maxTileSize)
+            for (int y = 0; y < first.Height; y++)
             {
-                if (document.Width == document.Height)
-                {
-                    // Square images use the same number of horizontal and vertical tiles.
-                    bestTileHeight = bestTileWidth;
-                    bestTileRowCount = bestTileColumnCount;
-                }
-                else
-                {
-                    for (int tileRowCount = 2; tileRowCount <= MaxTileCount; tileRowCount++)
-                    {
-                        int tileHeight = document.Height / tileRowCount;
-
-                        if (tileHeight < MinTileSize)
-                        {
-                            break;
-                        }
+                IntPtr firstRow = new IntPtr(surface.GetPointAddressUnchecked(first.X, first.Y + y));
+                IntPtr secondRow = new IntPtr(surface.GetPointAddressUnchecked(second.X, second.Y + y));
 
-                        if ((tileHeight & 1) == 0 && (tileHeight * tileRowCount) == document.Height)
-                        {
-                            bestTileHeight = tileHeight;
-                            bestTileRowCount = tileRowCount;
-
-                            if (tileHeight <= maxTileSize)
-                            {
-                                break;
-                            }
-                        }
-                    }
+                if (!AvifNative.MemoryBlocksAreEqual(firstRow, secondRow, rowLengthInBytes))
+                {
+                    return false;
                 }
             }
 
-            ImageGridMetadata metadata = null;
+            return true;
+        }
 
-            if (bestTileColumnCount > 1 || bestTileRowCount > 1)
+        private static bool TileLayoutsAreEqual(ImageGridMetadata first, ImageGridMetadata second)
+        {
+            if (first is null || second is null)
             {
-                metadata = new ImageGridMetadata(bestTileColumnCount,
-                                                 bestTileRowCount,
-                                                 (uint)document.Height,
-                                                 (uint)document.Width,
-                                                 (uint)bestTileHeight,
-                                                 (uint)bestTileWidth);
+                return first is null && second is null;
             }
 
-            return metadata;
+            return first.TileColumnCount == second.TileColumnCount
+                && first.TileRowCount == second.TileRowCount
+                && first.TileImageWidth == second.TileImageWidth
+                && first.TileImageHeight == second.TileImageHeight;
         }
 
         private static ImageGridMetadata TryGetImageGridMetadata(
             Document document,
             CompressionSpeed compressionSpeed,
+            EncoderBitDepth bitDepth,
             YUVChromaSubsampling yuvFormat,
-            bool preserveExistingTileSize)
+            bool preserveExistingTileSize,
+            int maxThreads)
         {
             ImageGridMetadata metadata = null;
 
@@ -802,12 +1111,27 @@ namespace AvifFileType
 
                     if (metadata is null)
                     {
-                        metadata = TryCalculateBestTileSize(document, compressionSpeed);
+                        metadata = TileGridPlanner.TryPlanImageGrid(document.Width,
+                                                                    document.Height,
+                                                                    compressionSpeed,
+                                                                    bitDepth,
+                                                                    maxThreads);
                     }
                 }
             }
 
             return metadata;
         }
+
+        private static bool UseStreamingWriter(ImageGridMetadata imageGridMetadata)
+        {
+            // The streaming writer compresses one row of tiles at a time, so it is only used
+            // for large images where the memory savings outweigh the reduced concurrency and
+            // the loss of the deduplication of identical compressed tiles. The duplicate tiles
+            // that are found before compression are still skipped by the streaming writer.
+            return imageGridMetadata != null
+                && imageGridMetadata.TileRowCount > 1
+                && (long)imageGridMetadata.OutputWidth * imageGridMetadata.OutputHeight >= StreamingWriterMinimumPixelCount;
+        }
     }
 }
@@ -37,7 +37,8 @@ namespace AvifFileType
             GitHubLink,
             PreserveExistingTileSize,
             PremultipliedAlpha,
-            LosslessAlphaCompression
+            LosslessAlphaCompression,
+            BitDepth
         }
 
         /// <summary>
@@ -95,6 +96,7 @@ namespace AvifFileType
                 new BooleanProperty(PropertyNames.LosslessAlphaCompression, true),
                 StaticListChoiceProperty.CreateForEnum(PropertyNames.CompressionSpeed, CompressionSpeed.Fast),
                 CreateChromaSubsampling(),
+                StaticListChoiceProperty.CreateForEnum(PropertyNames.BitDepth, EncoderBitDepth.EightBit),
                 new BooleanProperty(PropertyNames.PreserveExistingTileSize, true),
                 new BooleanProperty(PropertyNames.PremultipliedAlpha, false),
                 new UriProperty(PropertyNames.ForumLink, new Uri("https://forums.getpaint.net/topic/116233-avif-filetype")),
@@ -112,6 +114,10 @@ namespace AvifFileType
                                                                  100,
                                                                  false),
                 new ReadOnlyBoundToValueRule<int, Int32Property>(PropertyNames.LosslessAlphaCompression,
+                                                                 PropertyNames.Quality,
+                                                                 100,
+                                                                 false),
+                new ReadOnlyBoundToValueRule<int, Int32Property>(PropertyNames.BitDepth,
                                                                  PropertyNames.Quality,
                                                                  100,
                                                                  false)
@@ -165,6 +171,12 @@ namespace AvifFileType
             subsamplingPCI.SetValueDisplayName(YUVChromaSubsampling.Subsampling422, this.strings.GetString("ChromaSubsampling_422_DisplayName"));
             subsamplingPCI.SetValueDisplayName(YUVChromaSubsampling.Subsampling444, this.strings.GetString("ChromaSubsampling_444_DisplayName"));
 
+            PropertyControlInfo bitDepthPCI = configUI.FindControlForPropertyName(PropertyNames.BitDepth);
+            bitDepthPCI.ControlProperties[ControlInfoPropertyNames.DisplayName].Value = this.strings.GetString("BitDepth_DisplayName");
+            bitDepthPCI.SetValueDisplayName(EncoderBitDepth.EightBit, this.strings.GetString("BitDepth_8_DisplayName"));
+            bitDepthPCI.SetValueDisplayName(EncoderBitDepth.TenBit, this.strings.GetString("BitDepth_10_DisplayName"));
+            bitDepthPCI.SetValueDisplayName(EncoderBitDepth.TwelveBit, this.strings.GetString("BitDepth_12_DisplayName"));
+
             PropertyControlInfo preserveExistingTileSizePCI = configUI.FindControlForPropertyName(PropertyNames.PreserveExistingTileSize);
             preserveExistingTileSizePCI.ControlProperties[ControlInfoPropertyNames.DisplayName].Value = string.Empty;
             preserveExistingTileSizePCI.ControlProperties[ControlInfoPropertyNames.Description].Value = this.strings.GetString("PreserveExistingTileSize_Description");
@@ -192,6 +204,7 @@ namespace AvifFileType
             int quality = token.GetProperty<Int32Property>(PropertyNames.Quality).Value;
             CompressionSpeed compressionSpeed = (CompressionSpeed)token.GetProperty(PropertyNames.CompressionSpeed).Value;
             YUVChromaSubsampling chromaSubsampling = (YUVChromaSubsampling)token.GetProperty(PropertyNames.YUVChromaSubsampling).Value;
+            EncoderBitDepth bitDepth = (EncoderBitDepth)token.GetProperty(PropertyNames.BitDepth).Value;
             bool preserveExistingTileSize = token.GetProperty<BooleanProperty>(PropertyNames.PreserveExistingTileSize).Value;
 
             // The premultiplied alpha conversion can cause the colors to drift, so it is disabled for lossless encoding.
@@ -204,6 +217,7 @@ namespace AvifFileType
                           losslessAlpha,
                           compressionSpeed,
                           chromaSubsampling,
+                          bitDepth,
                           preserveExistingTileSize,
                           premultipliedAlpha,
                           scratchSurface,
@@ -14,6 +14,8 @@ using AvifFileType.Interop;
 using PaintDotNet;
 using PaintDotNet.AppModel;
 using System;
+using System.Collections.Generic;
+using System.Drawing;
 using System.Runtime.ExceptionServices;
 #if !NET47
 using System.Runtime.InteropServices;
@@ -23,14 +25,21 @@ namespace AvifFileType
 {
     internal static class AvifNative
     {
-        public static void CompressAlphaImage(Surface surface,
+        public static void CompressAlphaImage(SafeEncoderSessionHandle session,
+                                              Surface surface,
                                               EncoderOptions options,
                                               AvifProgressCallback avifProgress,
                                               IArrayPoolService arrayPool,
                                               ref uint progressDone,
                                               uint progressTotal,
+                                              InstrumentationStatistics statistics,
                                               out CompressedAV1Image alpha)
         {
+            if (session is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(session));
+            }
+
             BitmapData bitmapData = new BitmapData
             {
                 scan0 = surface.Scan0.Pointer,
@@ -54,11 +63,13 @@ namespace AvifFileType
                 if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
 #endif
                 {
-                    status = AvifNative_64.CompressAlphaImage(ref bitmapData,
+                    status = AvifNative_64.CompressAlphaImage(session,
+                                                              ref bitmapData,
                                                               options,
                                                               progressContext,
                                                               outputAllocDelegate,
-                                                              out alphaImage);
+                                                              out alphaImage,
+                                                              statistics);
                 }
 #if NET47
                 else if (IntPtr.Size == 4)
@@ -66,20 +77,24 @@ namespace AvifFileType
                 else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
 #endif
                 {
-                    status = AvifNative_86.CompressAlphaImage(ref bitmapData,
+                    status = AvifNative_86.CompressAlphaImage(session,
+                                                              ref bitmapData,
                                                               options,
                                                               progressContext,
                                                               outputAllocDelegate,
-                                                              out alphaImage);
+                                                              out alphaImage,
+                                                              statistics);
                 }
 #if !NET47
                 else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
                 {
-                    status = AvifNative_ARM64.CompressAlphaImage(ref bitmapData,
+                    status = AvifNative_ARM64.CompressAlphaImage(session,
+                                                                 ref bitmapData,
                                                                  options,
                                                                  progressContext,
                                                                  outputAllocDelegate,
-                                                                 out alphaImage);
+                                                                 out alphaImage,
+                                                                 statistics);
                 }
 #endif
                 else
@@ -101,15 +116,22 @@ namespace AvifFileType
             GC.KeepAlive(avifProgress);
         }
 
-        public static void CompressColorImage(Surface surface,
+        public static void CompressColorImage(SafeEncoderSessionHandle session,
+                                              Surface surface,
                                               EncoderOptions options,
                                               AvifProgressCallback avifProgress,
                                               IArrayPoolService arrayPool,
                                               ref uint progressDone,
                                               uint progressTotal,
                                               CICPColorData colorInfo,
+                                              InstrumentationStatistics statistics,
                                               out CompressedAV1Image color)
         {
+            if (session is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(session));
+            }
+
             BitmapData bitmapData = new BitmapData
             {
                 scan0 = surface.Scan0.Pointer,
@@ -133,12 +155,14 @@ namespace AvifFileType
                 if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
 #endif
                 {
-                    status = AvifNative_64.CompressColorImage(ref bitmapData,
+                    status = AvifNative_64.CompressColorImage(session,
+                                                              ref bitmapData,
                                                               options,
                                                               progressContext,
                                                               ref colorInfo,
                                                               outputAllocDelegate,
-                                                              out colorImage);
+                                                              out colorImage,
+                                                              statistics);
                 }
 #if NET47
                 else if (IntPtr.Size == 4)
@@ -146,22 +170,26 @@ namespace AvifFileType
                 else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
 #endif
                 {
-                    status = AvifNative_86.CompressColorImage(ref bitmapData,
+                    status = AvifNative_86.CompressColorImage(session,
+                                                              ref bitmapData,
                                                               options,
                                                               progressContext,
                                                               ref colorInfo,
                                                               outputAllocDelegate,
-                                                              out colorImage);
+                                                              out colorImage,
+                                                              statistics);
                 }
 #if !NET47
                 else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
                 {
-                    status = AvifNative_ARM64.CompressColorImage(ref bitmapData,
+                    status = AvifNative_ARM64.CompressColorImage(session,
+                                                                 ref bitmapData,
                                                                  options,
                                                                  progressContext,
                                                                  ref colorInfo,
                                                                  outputAllocDelegate,
-                                                                 out colorImage);
+                                                                 out colorImage,
+                                                                 statistics);
                 }
 #endif
                 else
@@ -183,11 +211,302 @@ namespace AvifFileType
             GC.KeepAlive(avifProgress);
         }
 
-        public static void DecompressColor(AvifItemData colorImage,
+        public static void CompressImageGrid(SafeEncoderSessionHandle session,
+                                             Surface surface,
+                                             Rectangle[] tileRectangles,
+                                             HomogeneousTileInfo homogeneousTileInfo,
+                                             bool encodeAlpha,
+                                             EncoderOptions options,
+                                             AvifProgressCallback avifProgress,
+                                             IArrayPoolService arrayPool,
+                                             ref uint progressDone,
+                                             uint progressTotal,
+                                             CICPColorData colorInfo,
+                                             InstrumentationStatistics statistics,
+                                             out CompressedAV1Image[] colorImages,
+                                             out CompressedAV1Image[] alphaImages)
+        {
+            if (tileRectangles is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(tileRectangles));
+            }
+
+            CompressImageGrid(session,
+                              surface,
+                              tileRectangles,
+                              0,
+                              tileRectangles.Length,
+                              homogeneousTileInfo,
+                              encodeAlpha,
+                              options,
+                              avifProgress,
+                              arrayPool,
+                              ref progressDone,
+                              progressTotal,
+                              colorInfo,
+                              statistics,
+                              out colorImages,
+                              out alphaImages);
+        }
+
+        /// <summary>
+        /// Compresses a range of the image grid tiles.
+        /// </summary>
+        /// <remarks>
+        /// The output arrays are indexed relative to <paramref name="firstTileIndex"/>, the duplicate
+        /// tiles in <paramref name="homogeneousTileInfo"/> are looked up using the absolute tile index.
+        /// </remarks>
+        public static unsafe void CompressImageGrid(SafeEncoderSessionHandle session,
+                                                    Surface surface,
+                                                    Rectangle[] tileRectangles,
+                                                    int firstTileIndex,
+                                                    int tileCount,
+                                                    HomogeneousTileInfo homogeneousTileInfo,
+                                                    bool encodeAlpha,
+                                                    EncoderOptions options,
+                                                    AvifProgressCallback avifProgress,
+                                                    IArrayPoolService arrayPool,
+                                                    ref uint progressDone,
+                                                    uint progressTotal,
+                                                    CICPColorData colorInfo,
+                                                    InstrumentationStatistics statistics,
+                                                    out CompressedAV1Image[] colorImages,
+                                                    out CompressedAV1Image[] alphaImages)
+        {
+            if (session is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(session));
+            }
+
+            if (tileRectangles is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(tileRectangles));
+            }
+
+            if (homogeneousTileInfo is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(homogeneousTileInfo));
+            }
+
+            if (firstTileIndex < 0 || tileCount <= 0 || tileCount > tileRectangles.Length - firstTileIndex)
+            {
+                ExceptionUtil.ThrowArgumentOutOfRangeException(nameof(tileCount));
+            }
+
+            TileEncodeInfo[] tiles = new TileEncodeInfo[tileCount];
+
+            for (int i = 0; i < tiles.Length; i++)
+            {
+                int tileIndex = firstTileIndex + i;
+                Rectangle tileRect = tileRectangles[tileIndex];
+
+                tiles[i] = new TileEncodeInfo
+                {
+                    image = new BitmapData
+                    {
+                        scan0 = new IntPtr(surface.GetPointAddressUnchecked(tileRect.X, tileRect.Y)),
+                        width = (uint)tileRect.Width,
+                        height = (uint)tileRect.Height,
+                        stride = (uint)surface.Stride
+                    },
+                    // Duplicate tiles reuse the compressed data from the first tile.
+                    encodeColor = !homogeneousTileInfo.DuplicateColorTileMap.ContainsKey(tileIndex),
+                    encodeAlpha = encodeAlpha && !homogeneousTileInfo.DuplicateAlphaTileMap.ContainsKey(tileIndex)
+                };
+            }
+
+            ProgressContext progressContext = new ProgressContext(avifProgress, progressDone, progressTotal);
+
+            using (CompressedAV1DataAllocator allocator = new CompressedAV1DataAllocator(encodeAlpha ? tileCount * 2 : tileCount, arrayPool))
+            {
+                IntPtr[] nativeColorImages = new IntPtr[tileCount];
+                IntPtr[] nativeAlphaImages = encodeAlpha ? new IntPtr[tileCount] : null;
+
+                CompressedAV1OutputAlloc outputAllocDelegate = new CompressedAV1OutputAlloc(allocator.Allocate);
+                EncoderStatus status = EncoderStatus.Ok;
+
+#if NET47
+                if (IntPtr.Size == 8)
+#else
+                if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+#endif
+                {
+                    status = AvifNative_64.CompressImageGrid(session,
+                                                             tiles,
+                                                             (uint)tileCount,
+                                                             options,
+                                                             progressContext,
+                                                             ref colorInfo,
+                                                             outputAllocDelegate,
+                                                             nativeColorImages,
+                                                             nativeAlphaImages,
+                                                             statistics);
+                }
+#if NET47
+                else if (IntPtr.Size == 4)
+#else
+                else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+#endif
+                {
+                    status = AvifNative_86.CompressImageGrid(session,
+                                                             tiles,
+                                                             (uint)tileCount,
+                                                             options,
+                                                             progressContext,
+                                                             ref colorInfo,
+                                                             outputAllocDelegate,
+                                                             nativeColorImages,
+                                                             nativeAlphaImages,
+                                                             statistics);
+                }
+#if !NET47
+                else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+                {
+                    status = AvifNative_ARM64.CompressImageGrid(session,
+                                                                tiles,
+                                                                (uint)tileCount,
+                                                                options,
+                                                                progressContext,
+                                                                ref colorInfo,
+                                                                outputAllocDelegate,
+                                                                nativeColorImages,
+                                                                nativeAlphaImages,
+                                                                statistics);
+                }
+#endif
+                else
+                {
+                    throw new PlatformNotSupportedException();
+                }
+
+                GC.KeepAlive(outputAllocDelegate);
+
+                if (status != EncoderStatus.Ok)
+                {
+                    HandleError(status, allocator.ExceptionInfo);
+                }
+
+                colorImages = new CompressedAV1Image[tileCount];
+                alphaImages = encodeAlpha ? new CompressedAV1Image[tileCount] : null;
+
+                for (int i = 0; i < tileCount; i++)
+                {
+                    Rectangle tileRect = tileRectangles[firstTileIndex + i];
+
+                    if (nativeColorImages[i] != IntPtr.Zero)
+                    {
+                        colorImages[i] = new CompressedAV1Image(allocator.GetCompressedAV1Data(nativeColorImages[i]),
+                                                                tileRect.Width,
+                                                                tileRect.Height,
+                                                                options.yuvFormat);
+                    }
+
+                    if (encodeAlpha && nativeAlphaImages[i] != IntPtr.Zero)
+                    {
+                        alphaImages[i] = new CompressedAV1Image(allocator.GetCompressedAV1Data(nativeAlphaImages[i]),
+                                                                tileRect.Width,
+                                                                tileRect.Height,
+                                                                YUVChromaSubsampling.Subsampling400);
+                    }
+                }
+            }
+
+            progressDone = progressContext.progressDone;
+            GC.KeepAlive(avifProgress);
+        }
+
+        public static SafeEncoderSessionHandle CreateEncoderSession()
+        {
+            SafeEncoderSessionHandle session;
+
+#if NET47
+            if (IntPtr.Size == 8)
+#else
+            if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+#endif
+            {
+                session = AvifNative_64.CreateEncoderSession();
+            }
+#if NET47
+            else if (IntPtr.Size == 4)
+#else
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+#endif
+            {
+                session = AvifNative_86.CreateEncoderSession();
+            }
+#if !NET47
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+            {
+                session = AvifNative_ARM64.CreateEncoderSession();
+            }
+#endif
+            else
+            {
+                throw new PlatformNotSupportedException();
+            }
+
+            if (session.IsInvalid)
+            {
+                session.Dispose();
+                throw new OutOfMemoryException();
+            }
+
+            return session;
+        }
+
+        public static SafeDecoderSessionHandle CreateDecoderSession()
+        {
+            SafeDecoderSessionHandle session;
+
+#if NET47
+            if (IntPtr.Size == 8)
+#else
+            if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+#endif
+            {
+                session = AvifNative_64.CreateDecoderSession();
+            }
+#if NET47
+            else if (IntPtr.Size == 4)
+#else
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+#endif
+            {
+                session = AvifNative_86.CreateDecoderSession();
+            }
+#if !NET47
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+            {
+                session = AvifNative_ARM64.CreateDecoderSession();
+            }
+#endif
+            else
+            {
+                throw new PlatformNotSupportedException();
+            }
+
+            if (session.IsInvalid)
+            {
+                session.Dispose();
+                throw new OutOfMemoryException();
+            }
+
+            return session;
+        }
+
+        public static void DecompressColor(SafeDecoderSessionHandle session,
+                                           AvifItemData colorImage,
                                            CICPColorData? colorConversionInfo,
                                            DecodeInfo decodeInfo,
-                                           Surface fullSurface)
+                                           Surface fullSurface,
+                                           InstrumentationStatistics statistics)
         {
+            if (session is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(session));
+            }
+
             if (colorImage is null)
             {
                 ExceptionUtil.ThrowArgumentNullException(nameof(colorImage));
@@ -205,104 +524,118 @@ namespace AvifFileType
 
             DecoderStatus status = DecoderStatus.Ok;
 
-            unsafe
+            try
             {
-                colorImage.UseBufferPointer((ptr, length) =>
+                CompressedTileData[] segments = colorImage.PinSegments();
+
+                BitmapData bitmapData = new BitmapData
                 {
-                    BitmapData bitmapData = new BitmapData
-                    {
-                        scan0 = fullSurface.Scan0.Pointer,
-                        width = (uint)fullSurface.Width,
-                        height = (uint)fullSurface.Height,
-                        stride = (uint)fullSurface.Stride
-                    };
-                    UIntPtr colorImageSize = new UIntPtr(length);
-
-                    if (colorConversionInfo.HasValue)
-                    {
-                        CICPColorData colorData = colorConversionInfo.Value;
+                    scan0 = fullSurface.Scan0.Pointer,
+                    width = (uint)fullSurface.Width,
+                    height = (uint)fullSurface.Height,
+                    stride = (uint)fullSurface.Stride
+                };
+
+                if (colorConversionInfo.HasValue)
+                {
+                    CICPColorData colorData = colorConversionInfo.Value;
 
 #if NET47
-                        if (IntPtr.Size == 8)
+                    if (IntPtr.Size == 8)
 #else
-                        if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+                    if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
 #endif
-                        {
-                            status = AvifNative_64.DecompressColorImage(ptr,
-                                                                        colorImageSize,
-                                                                        ref colorData,
-                                                                        decodeInfo,
-                                                                        ref bitmapData);
-                        }
+                    {
+                        status = AvifNative_64.DecompressColorImageSegments(session,
+                                                                            segments,
+                                                                            (uint)segments.Length,
+                                                                            ref colorData,
+                                                                            decodeInfo,
+                                                                            ref bitmapData,
+                                                                            statistics);
+                    }
 #if NET47
-                        else if (IntPtr.Size == 4)
+                    else if (IntPtr.Size == 4)
 #else
-                        else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+                    else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
 #endif
-                        {
-                            status = AvifNative_86.DecompressColorImage(ptr,
-                                                                        colorImageSize,
-                                                                        ref colorData,
-                                                                        decodeInfo,
-                                                                        ref bitmapData);
-                        }
+                    {
+                        status = AvifNative_86.DecompressColorImageSegments(session,
+                                                                            segments,
+                                                                            (uint)segments.Length,
+                                                                            ref colorData,
+                                                                            decodeInfo,
+                                                                            ref bitmapData,
+                                                                            statistics);
+                    }
 #if !NET47
-                        else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
-                        {
-                            status = AvifNative_ARM64.DecompressColorImage(ptr,
-                                                                           colorImageSize,
-                                                                           ref colorData,
-                                                                           decodeInfo,
-                                                                           ref bitmapData);
-                        }
-#endif
-                        else
-                        {
-                            throw new PlatformNotSupportedException();
-                        }
+                    else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+                    {
+                        status = AvifNative_ARM64.DecompressColorImageSegments(session,
+                                                                               segments,
+                                                                               (uint)segments.Length,
+                                                                               ref colorData,
+                                                                               decodeInfo,
+                                                                               ref bitmapData,
+                                                                               statistics);
                     }
+#endif
                     else
                     {
+                        throw new PlatformNotSupportedException();
+                    }
+                }
+                else
+                {
 #if NET47
-                        if (IntPtr.Size == 8)
+                    if (IntPtr.Size == 8)
 #else
-                        if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+                    if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
 #endif
-                        {
-                            status = AvifNative_64.DecompressColorImage(ptr,
-                                                                        colorImageSize,
-                                                                        IntPtr.Zero,
-                                                                        decodeInfo,
-                                                                        ref bitmapData);
-                        }
+                    {
+                        status = AvifNative_64.DecompressColorImageSegments(session,
+                                                                            segments,
+                                                                            (uint)segments.Length,
+                                                                            IntPtr.Zero,
+                                                                            decodeInfo,
+                                                                            ref bitmapData,
+                                                                            statistics);
+                    }
 #if NET47
-                        else if (IntPtr.Size == 4)
+                    else if (IntPtr.Size == 4)
 #else
-                        else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+                    else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
 #endif
-                        {
-                            status = AvifNative_86.DecompressColorImage(ptr,
-                                                                        colorImageSize,
-                                                                        IntPtr.Zero,
-                                                                        decodeInfo,
-                                                                        ref bitmapData);
-                        }
+                    {
+                        status = AvifNative_86.DecompressColorImageSegments(session,
+                                                                            segments,
+                                                                            (uint)segments.Length,
+                                                                            IntPtr.Zero,
+                                                                            decodeInfo,
+                                                                            ref bitmapData,
+                                                                            statistics);
+                    }
 #if !NET47
-                        else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
-                        {
-                            status = AvifNative_ARM64.DecompressColorImage(ptr,
-                                                                           colorImageSize,
-                                                                           IntPtr.Zero,
-                                                                           decodeInfo,
-                                                                           ref bitmapData);
-                        }
+                    else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+                    {
+                        status = AvifNative_ARM64.DecompressColorImageSegments(session,
+                                                                               segments,
+                                                                               (uint)segments.Length,
+                                                                               IntPtr.Zero,
+                                                                               decodeInfo,
+                                                                               ref bitmapData,
+                                                                               statistics);
+                    }
 #endif
-                        else
-                        {
-                            throw new PlatformNotSupportedException();
-                        }
+                    else
+                    {
+                        throw new PlatformNotSupportedException();
                     }
-                });
+                }
+            }
+            finally
+            {
+                colorImage.UnpinSegments();
             }
 
             if (status != DecoderStatus.Ok)
@@ -311,10 +644,17 @@ namespace AvifFileType
             }
         }
 
-        public static void DecompressAlpha(AvifItemData alphaImage,
+        public static void DecompressAlpha(SafeDecoderSessionHandle session,
+                                           AvifItemData alphaImage,
                                            DecodeInfo decodeInfo,
-                                           Surface fullSurface)
+                                           Surface fullSurface,
+                                           InstrumentationStatistics statistics)
         {
+            if (session is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(session));
+            }
+
             if (alphaImage is null)
             {
                 ExceptionUtil.ThrowArgumentNullException(nameof(alphaImage));
@@ -332,56 +672,63 @@ namespace AvifFileType
 
             DecoderStatus status = DecoderStatus.Ok;
 
-            unsafe
+            try
             {
-                alphaImage.UseBufferPointer((ptr, length) =>
-                    {
-                        BitmapData bitmapData = new BitmapData
-                        {
-                            scan0 = fullSurface.Scan0.Pointer,
-                            width = (uint)fullSurface.Width,
-                            height = (uint)fullSurface.Height,
-                            stride = (uint)fullSurface.Stride
-                        };
+                CompressedTileData[] segments = alphaImage.PinSegments();
 
-                        UIntPtr alphaImageSize = new UIntPtr(length);
+                BitmapData bitmapData = new BitmapData
+                {
+                    scan0 = fullSurface.Scan0.Pointer,
+                    width = (uint)fullSurface.Width,
+                    height = (uint)fullSurface.Height,
+                    stride = (uint)fullSurface.Stride
+                };
 
 #if NET47
-                        if (IntPtr.Size == 8)
+                if (IntPtr.Size == 8)
 #else
-                        if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+                if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
 #endif
-                        {
-                            status = AvifNative_64.DecompressAlphaImage(ptr,
-                                                                        alphaImageSize,
+                {
+                    status = AvifNative_64.DecompressAlphaImageSegments(session,
+                                                                        segments,
+                                                                        (uint)segments.Length,
                                                                         decodeInfo,
-                                                                        ref bitmapData);
-                        }
+                                                                        ref bitmapData,
+                                                                        statistics);
+                }
 #if NET47
-                        else if (IntPtr.Size == 4)
+                else if (IntPtr.Size == 4)
 #else
-                        else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+                else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
 #endif
-                        {
-                            status = AvifNative_86.DecompressAlphaImage(ptr,
-                                                                        alphaImageSize,
+                {
+                    status = AvifNative_86.DecompressAlphaImageSegments(session,
+                                                                        segments,
+                                                                        (uint)segments.Length,
                                                                         decodeInfo,
-                                                                        ref bitmapData);
-                        }
+                                                                        ref bitmapData,
+                                                                        statistics);
+                }
 #if !NET47
-                        else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
-                        {
-                            status = AvifNative_ARM64.DecompressAlphaImage(ptr,
-                                                                           alphaImageSize,
+                else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+                {
+                    status = AvifNative_ARM64.DecompressAlphaImageSegments(session,
+                                                                           segments,
+                                                                           (uint)segments.Length,
                                                                            decodeInfo,
-                                                                           ref bitmapData);
-                        }
+                                                                           ref bitmapData,
+                                                                           statistics);
+                }
 #endif
-                        else
-                        {
-                            throw new PlatformNotSupportedException();
-                        }
-                    });
+                else
+                {
+                    throw new PlatformNotSupportedException();
+                }
+            }
+            finally
+            {
+                alphaImage.UnpinSegments();
             }
 
             if (status != DecoderStatus.Ok)
@@ -390,38 +737,832 @@ namespace AvifFileType
             }
         }
 
-        public static bool MemoryBlocksAreEqual(IntPtr buffer1, IntPtr buffer2, ulong length)
+        public static void DecompressColorGrid(SafeDecoderSessionHandle session,
+                                               IReadOnlyList<AvifItemData> tiles,
+                                               int tileColumnCount,
+                                               int tileRowCount,
+                                               CICPColorData? colorConversionInfo,
+                                               DecodeInfo decodeInfo,
+                                               Surface fullSurface,
+                                               InstrumentationStatistics statistics)
         {
-            bool result;
+            if (session is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(session));
+            }
 
-#if NET47
-            if (IntPtr.Size == 8)
-#else
-            if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
-#endif
+            if (tiles is null)
             {
-                result = AvifNative_64.MemoryBlocksAreEqual(buffer1, buffer2, new UIntPtr(length));
+                ExceptionUtil.ThrowArgumentNullException(nameof(tiles));
             }
-#if NET47
-            else if (IntPtr.Size == 4)
-#else
-            else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
-#endif
+
+            if (decodeInfo is null)
             {
-                result = AvifNative_86.MemoryBlocksAreEqual(buffer1, buffer2, new UIntPtr(length));
+                ExceptionUtil.ThrowArgumentNullException(nameof(decodeInfo));
             }
-#if !NET47
-            else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+
+            if (fullSurface is null)
             {
-                result = AvifNative_ARM64.MemoryBlocksAreEqual(buffer1, buffer2, new UIntPtr(length));
+                ExceptionUtil.ThrowArgumentNullException(nameof(fullSurface));
             }
-#endif
-            else
+
+            if (tiles.Count != tileColumnCount * tileRowCount)
             {
-                throw new PlatformNotSupportedException();
+                ExceptionUtil.ThrowArgumentException("The tile count does not match the image grid size.");
             }
 
-            return result;
+            DecoderStatus status = DecoderStatus.Ok;
+            CompressedTileData[] tileData = new CompressedTileData[tiles.Count];
+            int pinnedTileCount = 0;
+
+            try
+            {
+                for (int i = 0; i < tileData.Length; i++)
+                {
+                    AvifItemData tile = tiles[i];
+
+                    tileData[i].data = ((IPinnableBuffer)tile).Pin();
+                    tileData[i].size = new UIntPtr(tile.Length);
+                    pinnedTileCount++;
+                }
+
+                BitmapData bitmapData = new BitmapData
+                {
+                    scan0 = fullSurface.Scan0.Pointer,
+                    width = (uint)fullSurface.Width,
+                    height = (uint)fullSurface.Height,
+                    stride = (uint)fullSurface.Stride
+                };
+
+                if (colorConversionInfo.HasValue)
+                {
+                    CICPColorData colorData = colorConversionInfo.Value;
+
+#if NET47
+                    if (IntPtr.Size == 8)
+#else
+                    if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+#endif
+                    {
+                        status = AvifNative_64.DecompressColorImageGrid(session,
+                                                                        tileData,
+                                                                        (uint)tileColumnCount,
+                                                                        (uint)tileRowCount,
+                                                                        ref colorData,
+                                                                        decodeInfo,
+                                                                        ref bitmapData,
+                                                                        statistics);
+                    }
+#if NET47
+                    else if (IntPtr.Size == 4)
+#else
+                    else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+#endif
+                    {
+                        status = AvifNative_86.DecompressColorImageGrid(session,
+                                                                        tileData,
+                                                                        (uint)tileColumnCount,
+                                                                        (uint)tileRowCount,
+                                                                        ref colorData,
+                                                                        decodeInfo,
+                                                                        ref bitmapData,
+                                                                        statistics);
+                    }
+#if !NET47
+                    else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+                    {
+                        status = AvifNative_ARM64.DecompressColorImageGrid(session,
+                                                                           tileData,
+                                                                           (uint)tileColumnCount,
+                                                                           (uint)tileRowCount,
+                                                                           ref colorData,
+                                                                           decodeInfo,
+                                                                           ref bitmapData,
+                                                                           statistics);
+                    }
+#endif
+                    else
+                    {
+                        throw new PlatformNotSupportedException();
+                    }
+                }
+                else
+                {
+#if NET47
+                    if (IntPtr.Size == 8)
+#else
+                    if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+#endif
+                    {
+                        status = AvifNative_64.DecompressColorImageGrid(session,
+                                                                        tileData,
+                                                                        (uint)tileColumnCount,
+                                                                        (uint)tileRowCount,
+                                                                        IntPtr.Zero,
+                                                                        decodeInfo,
+                                                                        ref bitmapData,
+                                                                        statistics);
+                    }
+#if NET47
+                    else if (IntPtr.Size == 4)
+#else
+                    else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+#endif
+                    {
+                        status = AvifNative_86.DecompressColorImageGrid(session,
+                                                                        tileData,
+                                                                        (uint)tileColumnCount,
+                                                                        (uint)tileRowCount,
+                                                                        IntPtr.Zero,
+                                                                        decodeInfo,
+                                                                        ref bitmapData,
+                                                                        statistics);
+                    }
+#if !NET47
+                    else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+                    {
+                        status = AvifNative_ARM64.DecompressColorImageGrid(session,
+                                                                           tileData,
+                                                                           (uint)tileColumnCount,
+                                                                           (uint)tileRowCount,
+                                                                           IntPtr.Zero,
+                                                                           decodeInfo,
+                                                                           ref bitmapData,
+                                                                           statistics);
+                    }
+#endif
+                    else
+                    {
+                        throw new PlatformNotSupportedException();
+                    }
+                }
+            }
+            finally
+            {
+                for (int i = 0; i < pinnedTileCount; i++)
+                {
+                    ((IPinnableBuffer)tiles[i]).Unpin();
+                }
+            }
+
+            if (status != DecoderStatus.Ok)
+            {
+                HandleError(status);
+            }
+        }
+
+        public static void DecompressAlphaGrid(SafeDecoderSessionHandle session,
+                                               IReadOnlyList<AvifItemData> tiles,
+                                               int tileColumnCount,
+                                               int tileRowCount,
+                                               DecodeInfo decodeInfo,
+                                               Surface fullSurface,
+                                               InstrumentationStatistics statistics)
+        {
+            if (session is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(session));
+            }
+
+            if (tiles is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(tiles));
+            }
+
+            if (decodeInfo is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(decodeInfo));
+            }
+
+            if (fullSurface is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(fullSurface));
+            }
+
+            if (tiles.Count != tileColumnCount * tileRowCount)
+            {
+                ExceptionUtil.ThrowArgumentException("The tile count does not match the image grid size.");
+            }
+
+            DecoderStatus status = DecoderStatus.Ok;
+            CompressedTileData[] tileData = new CompressedTileData[tiles.Count];
+            int pinnedTileCount = 0;
+
+            try
+            {
+                for (int i = 0; i < tileData.Length; i++)
+                {
+                    AvifItemData tile = tiles[i];
+
+                    tileData[i].data = ((IPinnableBuffer)tile).Pin();
+                    tileData[i].size = new UIntPtr(tile.Length);
+                    pinnedTileCount++;
+                }
+
+                BitmapData bitmapData = new BitmapData
+                {
+                    scan0 = fullSurface.Scan0.Pointer,
+                    width = (uint)fullSurface.Width,
+                    height = (uint)fullSurface.Height,
+                    stride = (uint)fullSurface.Stride
+                };
+
+#if NET47
+                if (IntPtr.Size == 8)
+#else
+                if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+#endif
+                {
+                    status = AvifNative_64.DecompressAlphaImageGrid(session,
+                                                                    tileData,
+                                                                    (uint)tileColumnCount,
+                                                                    (uint)tileRowCount,
+                                                                    decodeInfo,
+                                                                    ref bitmapData,
+                                                                    statistics);
+                }
+#if NET47
+                else if (IntPtr.Size == 4)
+#else
+                else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+#endif
+                {
+                    status = AvifNative_86.DecompressAlphaImageGrid(session,
+                                                                    tileData,
+                                                                    (uint)tileColumnCount,
+                                                                    (uint)tileRowCount,
+                                                                    decodeInfo,
+                                                                    ref bitmapData,
+                                                                    statistics);
+                }
+#if !NET47
+                else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+                {
+                    status = AvifNative_ARM64.DecompressAlphaImageGrid(session,
+                                                                       tileData,
+                                                                       (uint)tileColumnCount,
+                                                                       (uint)tileRowCount,
+                                                                       decodeInfo,
+                                                                       ref bitmapData,
+                                                                       statistics);
+                }
+#endif
+                else
+                {
+                    throw new PlatformNotSupportedException();
+                }
+            }
+            finally
+            {
+                for (int i = 0; i < pinnedTileCount; i++)
+                {
+                    ((IPinnableBuffer)tiles[i]).Unpin();
+                }
+            }
+
+            if (status != DecoderStatus.Ok)
+            {
+                HandleError(status);
+            }
+        }
+
+        public static void DecompressColorAlphaGrid(SafeDecoderSessionHandle session,
+                                                    IReadOnlyList<AvifItemData> colorTiles,
+                                                    IReadOnlyList<AvifItemData> alphaTiles,
+                                                    int tileColumnCount,
+                                                    int tileRowCount,
+                                                    CICPColorData? colorConversionInfo,
+                                                    DecodeInfo colorDecodeInfo,
+                                                    DecodeInfo alphaDecodeInfo,
+                                                    bool unpremultiplyAlpha,
+                                                    Surface fullSurface,
+                                                    InstrumentationStatistics statistics)
+        {
+            if (session is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(session));
+            }
+
+            if (colorTiles is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(colorTiles));
+            }
+
+            if (alphaTiles is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(alphaTiles));
+            }
+
+            if (colorDecodeInfo is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(colorDecodeInfo));
+            }
+
+            if (alphaDecodeInfo is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(alphaDecodeInfo));
+            }
+
+            if (fullSurface is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(fullSurface));
+            }
+
+            if (colorTiles.Count != tileColumnCount * tileRowCount || alphaTiles.Count != colorTiles.Count)
+            {
+                ExceptionUtil.ThrowArgumentException("The tile count does not match the image grid size.");
+            }
+
+            DecoderStatus status = DecoderStatus.Ok;
+            CompressedTileData[] colorTileData = new CompressedTileData[colorTiles.Count];
+            CompressedTileData[] alphaTileData = new CompressedTileData[alphaTiles.Count];
+            int pinnedColorTileCount = 0;
+            int pinnedAlphaTileCount = 0;
+
+            try
+            {
+                for (int i = 0; i < colorTileData.Length; i++)
+                {
+                    AvifItemData tile = colorTiles[i];
+
+                    colorTileData[i].data = ((IPinnableBuffer)tile).Pin();
+                    colorTileData[i].size = new UIntPtr(tile.Length);
+                    pinnedColorTileCount++;
+                }
+
+                for (int i = 0; i < alphaTileData.Length; i++)
+                {
+                    AvifItemData tile = alphaTiles[i];
+
+                    alphaTileData[i].data = ((IPinnableBuffer)tile).Pin();
+                    alphaTileData[i].size = new UIntPtr(tile.Length);
+                    pinnedAlphaTileCount++;
+                }
+
+                BitmapData bitmapData = new BitmapData
+                {
+                    scan0 = fullSurface.Scan0.Pointer,
+                    width = (uint)fullSurface.Width,
+                    height = (uint)fullSurface.Height,
+                    stride = (uint)fullSurface.Stride
+                };
+
+                if (colorConversionInfo.HasValue)
+                {
+                    CICPColorData colorData = colorConversionInfo.Value;
+
+#if NET47
+                    if (IntPtr.Size == 8)
+#else
+                    if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+#endif
+                    {
+                        status = AvifNative_64.DecompressColorAlphaImageGrid(session,
+                                                                             colorTileData,
+                                                                             alphaTileData,
+                                                                             (uint)tileColumnCount,
+                                                                             (uint)tileRowCount,
+                                                                             ref colorData,
+                                                                             colorDecodeInfo,
+                                                                             alphaDecodeInfo,
+                                                                             unpremultiplyAlpha,
+                                                                             ref bitmapData,
+                                                                             statistics);
+                    }
+#if NET47
+                    else if (IntPtr.Size == 4)
+#else
+                    else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+#endif
+                    {
+                        status = AvifNative_86.DecompressColorAlphaImageGrid(session,
+                                                                             colorTileData,
+                                                                             alphaTileData,
+                                                                             (uint)tileColumnCount,
+                                                                             (uint)tileRowCount,
+                                                                             ref colorData,
+                                                                             colorDecodeInfo,
+                                                                             alphaDecodeInfo,
+                                                                             unpremultiplyAlpha,
+                                                                             ref bitmapData,
+                                                                             statistics);
+                    }
+#if !NET47
+                    else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+                    {
+                        status = AvifNative_ARM64.DecompressColorAlphaImageGrid(session,
+                                                                                colorTileData,
+                                                                                alphaTileData,
+                                                                                (uint)tileColumnCount,
+                                                                                (uint)tileRowCount,
+                                                                                ref colorData,
+                                                                                colorDecodeInfo,
+                                                                                alphaDecodeInfo,
+                                                                                unpremultiplyAlpha,
+                                                                                ref bitmapData,
+                                                                                statistics);
+                    }
+#endif
+                    else
+                    {
+                        throw new PlatformNotSupportedException();
+                    }
+                }
+                else
+                {
+#if NET47
+                    if (IntPtr.Size == 8)
+#else
+                    if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+#endif
+                    {
+                        status = AvifNative_64.DecompressColorAlphaImageGrid(session,
+                                                                             colorTileData,
+                                                                             alphaTileData,
+                                                                             (uint)tileColumnCount,
+                                                                             (uint)tileRowCount,
+                                                                             IntPtr.Zero,
+                                                                             colorDecodeInfo,
+                                                                             alphaDecodeInfo,
+                                                                             unpremultiplyAlpha,
+                                                                             ref bitmapData,
+                                                                             statistics);
+                    }
+#if NET47
+                    else if (IntPtr.Size == 4)
+#else
+                    else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+#endif
+                    {
+                        status = AvifNative_86.DecompressColorAlphaImageGrid(session,
+                                                                             colorTileData,
+                                                                             alphaTileData,
+                                                                             (uint)tileColumnCount,
+                                                                             (uint)tileRowCount,
+                                                                             IntPtr.Zero,
+                                                                             colorDecodeInfo,
+                                                                             alphaDecodeInfo,
+                                                                             unpremultiplyAlpha,
+                                                                             ref bitmapData,
+                                                                             statistics);
+                    }
+#if !NET47
+                    else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+                    {
+                        status = AvifNative_ARM64.DecompressColorAlphaImageGrid(session,
+                                                                                colorTileData,
+                                                                                alphaTileData,
+                                                                                (uint)tileColumnCount,
+                                                                                (uint)tileRowCount,
+                                                                                IntPtr.Zero,
+                                                                                colorDecodeInfo,
+                                                                                alphaDecodeInfo,
+                                                                                unpremultiplyAlpha,
+                                                                                ref bitmapData,
+                                                                                statistics);
+                    }
+#endif
+                    else
+                    {
+                        throw new PlatformNotSupportedException();
+                    }
+                }
+            }
+            finally
+            {
+                for (int i = 0; i < pinnedColorTileCount; i++)
+                {
+                    ((IPinnableBuffer)colorTiles[i]).Unpin();
+                }
+
+                for (int i = 0; i < pinnedAlphaTileCount; i++)
+                {
+                    ((IPinnableBuffer)alphaTiles[i]).Unpin();
+                }
+            }
+
+            if (status != DecoderStatus.Ok)
+            {
+                HandleError(status);
+            }
+        }
+
+        public static bool MemoryBlocksAreEqual(IntPtr buffer1, IntPtr buffer2, ulong length)
+        {
+            bool result;
+
+#if NET47
+            if (IntPtr.Size == 8)
+#else
+            if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+#endif
+            {
+                result = AvifNative_64.MemoryBlocksAreEqual(buffer1, buffer2, new UIntPtr(length));
+            }
+#if NET47
+            else if (IntPtr.Size == 4)
+#else
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+#endif
+            {
+                result = AvifNative_86.MemoryBlocksAreEqual(buffer1, buffer2, new UIntPtr(length));
+            }
+#if !NET47
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+            {
+                result = AvifNative_ARM64.MemoryBlocksAreEqual(buffer1, buffer2, new UIntPtr(length));
+            }
+#endif
+            else
+            {
+                throw new PlatformNotSupportedException();
+            }
+
+            return result;
+        }
+
+        /// <summary>
+        /// Computes the grayscale, transparency and homogeneous color/alpha state of each tile in a single pass.
+        /// </summary>
+        public static TileAnalysis[] AnalyzeImageTiles(Surface surface, Rectangle[] tileRectangles, int maxThreads)
+        {
+            if (surface is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(surface));
+            }
+
+            if (tileRectangles is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(tileRectangles));
+            }
+
+            BitmapData[] tiles = CreateTileBitmapData(surface, tileRectangles);
+            TileAnalysis[] results = new TileAnalysis[tiles.Length];
+            EncoderStatus status;
+
+#if NET47
+            if (IntPtr.Size == 8)
+#else
+            if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+#endif
+            {
+                status = AvifNative_64.AnalyzeImageTiles(tiles, (uint)tiles.Length, (uint)maxThreads, results);
+            }
+#if NET47
+            else if (IntPtr.Size == 4)
+#else
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+#endif
+            {
+                status = AvifNative_86.AnalyzeImageTiles(tiles, (uint)tiles.Length, (uint)maxThreads, results);
+            }
+#if !NET47
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+            {
+                status = AvifNative_ARM64.AnalyzeImageTiles(tiles, (uint)tiles.Length, (uint)maxThreads, results);
+            }
+#endif
+            else
+            {
+                throw new PlatformNotSupportedException();
+            }
+
+            GC.KeepAlive(surface);
+
+            if (status != EncoderStatus.Ok)
+            {
+                HandleError(status, null);
+            }
+
+            return results;
+        }
+
+        /// <summary>
+        /// Computes a hash of the BGRA pixels in each tile.
+        /// </summary>
+        /// <remarks>
+        /// The hashes are only used to find candidate duplicates, the caller must compare the tiles to confirm a match.
+        /// </remarks>
+        public static ulong[] HashImageTiles(Surface surface, Rectangle[] tileRectangles, int maxThreads)
+        {
+            if (surface is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(surface));
+            }
+
+            if (tileRectangles is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(tileRectangles));
+            }
+
+            BitmapData[] tiles = CreateTileBitmapData(surface, tileRectangles);
+            ulong[] hashes = new ulong[tiles.Length];
+            EncoderStatus status;
+
+#if NET47
+            if (IntPtr.Size == 8)
+#else
+            if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+#endif
+            {
+                status = AvifNative_64.HashImageTiles(tiles, (uint)tiles.Length, (uint)maxThreads, hashes);
+            }
+#if NET47
+            else if (IntPtr.Size == 4)
+#else
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+#endif
+            {
+                status = AvifNative_86.HashImageTiles(tiles, (uint)tiles.Length, (uint)maxThreads, hashes);
+            }
+#if !NET47
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+            {
+                status = AvifNative_ARM64.HashImageTiles(tiles, (uint)tiles.Length, (uint)maxThreads, hashes);
+            }
+#endif
+            else
+            {
+                throw new PlatformNotSupportedException();
+            }
+
+            GC.KeepAlive(surface);
+
+            if (status != EncoderStatus.Ok)
+            {
+                HandleError(status, null);
+            }
+
+            return hashes;
+        }
+
+        /// <summary>
+        /// Computes a hash of the specified memory block.
+        /// </summary>
+        /// <remarks>
+        /// The hash is only used to find candidate duplicates, the caller must compare the data to confirm a match.
+        /// </remarks>
+        public static ulong HashMemoryBlock(IntPtr buffer, ulong length)
+        {
+            ulong result;
+
+#if NET47
+            if (IntPtr.Size == 8)
+#else
+            if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+#endif
+            {
+                result = AvifNative_64.HashMemoryBlock(buffer, new UIntPtr(length));
+            }
+#if NET47
+            else if (IntPtr.Size == 4)
+#else
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+#endif
+            {
+                result = AvifNative_86.HashMemoryBlock(buffer, new UIntPtr(length));
+            }
+#if !NET47
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+            {
+                result = AvifNative_ARM64.HashMemoryBlock(buffer, new UIntPtr(length));
+            }
+#endif
+            else
+            {
+                throw new PlatformNotSupportedException();
+            }
+
+            return result;
+        }
+
+        /// <summary>
+        /// Enables or disables the native instrumentation statistics.
+        /// </summary>
+        /// <param name="enabled"><c>true</c> to collect the statistics; otherwise, <c>false</c>.</param>
+        /// <remarks>
+        /// The process-wide statistics include every image that is encoded or decoded by the process,
+        /// the statistics of a single encode or decode call are collected with the statistics parameter of that call.
+        /// </remarks>
+        public static void SetInstrumentationEnabled(bool enabled)
+        {
+#if NET47
+            if (IntPtr.Size == 8)
+#else
+            if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+#endif
+            {
+                AvifNative_64.SetInstrumentationEnabled(enabled);
+            }
+#if NET47
+            else if (IntPtr.Size == 4)
+#else
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+#endif
+            {
+                AvifNative_86.SetInstrumentationEnabled(enabled);
+            }
+#if !NET47
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+            {
+                AvifNative_ARM64.SetInstrumentationEnabled(enabled);
+            }
+#endif
+            else
+            {
+                throw new PlatformNotSupportedException();
+            }
+        }
+
+        /// <summary>
+        /// Resets the native instrumentation statistics to zero.
+        /// </summary>
+        public static void ResetInstrumentationStatistics()
+        {
+#if NET47
+            if (IntPtr.Size == 8)
+#else
+            if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+#endif
+            {
+                AvifNative_64.ResetInstrumentationStatistics();
+            }
+#if NET47
+            else if (IntPtr.Size == 4)
+#else
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+#endif
+            {
+                AvifNative_86.ResetInstrumentationStatistics();
+            }
+#if !NET47
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+            {
+                AvifNative_ARM64.ResetInstrumentationStatistics();
+            }
+#endif
+            else
+            {
+                throw new PlatformNotSupportedException();
+            }
+        }
+
+        /// <summary>
+        /// Gets the native instrumentation statistics.
+        /// </summary>
+        /// <returns>The statistics that have been collected since the last reset.</returns>
+        public static InstrumentationStatistics GetInstrumentationStatistics()
+        {
+            InstrumentationStatistics statistics = new InstrumentationStatistics();
+
+#if NET47
+            if (IntPtr.Size == 8)
+#else
+            if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+#endif
+            {
+                AvifNative_64.GetInstrumentationStatistics(statistics);
+            }
+#if NET47
+            else if (IntPtr.Size == 4)
+#else
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+#endif
+            {
+                AvifNative_86.GetInstrumentationStatistics(statistics);
+            }
+#if !NET47
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+            {
+                AvifNative_ARM64.GetInstrumentationStatistics(statistics);
+            }
+#endif
+            else
+            {
+                throw new PlatformNotSupportedException();
+            }
+
+            return statistics;
+        }
+
+        private static unsafe BitmapData[] CreateTileBitmapData(Surface surface, Rectangle[] tileRectangles)
+        {
+            BitmapData[] tiles = new BitmapData[tileRectangles.Length];
+
+            for (int i = 0; i < tiles.Length; i++)
+            {
+                Rectangle tileRect = tileRectangles[i];
+
+                tiles[i] = new BitmapData
+                {
+                    scan0 = new IntPtr(surface.GetPointAddressUnchecked(tileRect.X, tileRect.Y)),
+                    width = (uint)tileRect.Width,
+                    height = (uint)tileRect.Height,
+                    stride = (uint)surface.Stride
+                };
+            }
+
+            return tiles;
         }
 
         private static void HandleError(EncoderStatus status, ExceptionDispatchInfo exceptionDispatchInfo)
@@ -448,6 +1589,8 @@ namespace AvifFileType
                         throw new FormatException("The AV1 encode failed.");
                     case EncoderStatus.UserCancelled:
                         throw new OperationCanceledException();
+                    case EncoderStatus.UnsupportedBitDepth:
+                        throw new FormatException("The image bit depth is not supported by the encoder.");
                     default:
                         throw new FormatException("An unknown error occurred when encoding the image.");
                 }
@@ -480,6 +1623,8 @@ namespace AvifFileType
                     throw new FormatException("The YUV format is not supported by the decoder.");
                 case DecoderStatus.TileFormatMismatch:
                     throw new FormatException("The color image tiles must use the same YUV format and bit depth.");
+                case DecoderStatus.UnsupportedDownscaleFactor:
+                    throw new FormatException("The image cannot be downscaled by the requested factor.");
                 default:
                     throw new FormatException("An unknown error occurred when decoding the image.");
             }
@@ -13,20 +13,38 @@
 #include "AvifNative.h"
 #include "AV1Decoder.h"
 #include "DecodedImageConverter.h"
+#include "DecoderSession.h"
+#include "ImageGridDecoder.h"
+#include "Instrumentation.h"
+#include "ParallelFor.h"
 #include "ScopedAOMCodec.h"
 #include <aom/aom_decoder.h>
 #include <aom/aomdx.h>
 #include <aom/aom_image.h>
+#include <algorithm>
+#include <string.h>
 
 namespace
 {
+    YUVLookupTableCache* GetLookupTableCache(DecoderSession* session) noexcept
+    {
+        return session ? session->GetLookupTableCache() : nullptr;
+    }
+
     DecoderStatus DecodeAV1Image(
         aom_codec_ctx_t* codec,
         const uint8_t* compressedImage,
         size_t compressedImageSize,
         aom_image_t** decodedImage)
     {
-        const aom_codec_err_t error = aom_codec_decode(codec, compressedImage, compressedImageSize, nullptr);
+        aom_codec_err_t error;
+
+        {
+            Instrumentation::ScopedTimer timer(Instrumentation::Counter::DecodeTime);
+
+            error = aom_codec_decode(codec, compressedImage, compressedImageSize, nullptr);
+        }
+
         if (error != AOM_CODEC_OK)
         {
             *decodedImage = nullptr;
@@ -50,30 +68,179 @@ namespace
         }
         else
         {
+            Instrumentation::Increment(Instrumentation::Counter::ImagesDecoded);
             return DecoderStatus::Ok;
         }
     }
 
-    class ScopedAOMDecoder : public ScopedAOMCodec
+    // Gets the compressed image as one contiguous buffer, an image that is stored in more than
+    // one segment is copied into the input buffer of the decoder.
+    DecoderStatus GetContiguousImageData(
+        PooledAOMDecoder& codec,
+        const CompressedTileData* segments,
+        uint32_t segmentCount,
+        const uint8_t** data,
+        size_t* size)
     {
-    public:
-        ScopedAOMDecoder() : ScopedAOMCodec()
+        if (!segments || segmentCount == 0)
+        {
+            return DecoderStatus::NullParameter;
+        }
+
+        if (segmentCount == 1)
+        {
+            if (!segments[0].data || !segments[0].size)
+            {
+                return DecoderStatus::NullParameter;
+            }
+
+            *data = segments[0].data;
+            *size = segments[0].size;
+            return DecoderStatus::Ok;
+        }
+
+        size_t totalSize = 0;
+
+        for (uint32_t i = 0; i < segmentCount; i++)
         {
-            aom_codec_iface_t* iface = aom_codec_av1_dx();
-            throw_on_error(aom_codec_dec_init(&codec, iface, nullptr, 0));
-            initialized = true;
+            if (!segments[i].data || !segments[i].size)
+            {
+                return DecoderStatus::NullParameter;
+            }
+
+            if (segments[i].size > (SIZE_MAX - totalSize))
+            {
+                return DecoderStatus::OutOfMemory;
+            }
+
+            totalSize += segments[i].size;
         }
-    };
+
+        uint8_t* buffer = codec.GetInputBuffer(totalSize);
+        size_t offset = 0;
+
+        for (uint32_t i = 0; i < segmentCount; i++)
+        {
+            memcpy(buffer + offset, segments[i].data, segments[i].size);
+            offset += segments[i].size;
+        }
+
+        *data = buffer;
+        *size = totalSize;
+        return DecoderStatus::Ok;
+    }
+
+    // Decodes an AV1 image and checks that it is the expected size, the image is owned by the decoder.
+    DecoderStatus DecodeAV1Tile(
+        PooledAOMDecoder& codec,
+        const CompressedTileData* segments,
+        uint32_t segmentCount,
+        const DecodeInfo* decodeInfo,
+        DecoderStatus sizeMismatchStatus,
+        aom_image_t** decodedImage)
+    {
+        const uint8_t* compressedImage = nullptr;
+        size_t compressedImageSize = 0;
+
+        DecoderStatus status = GetContiguousImageData(codec, segments, segmentCount, &compressedImage, &compressedImageSize);
+
+        if (status != DecoderStatus::Ok)
+        {
+            return status;
+        }
+
+        status = DecodeAV1Image(codec.get(), compressedImage, compressedImageSize, decodedImage);
+
+        if (status != DecoderStatus::Ok)
+        {
+            codec.Discard();
+            return status;
+        }
+
+        // The expected width/height will be zero for the first tile in an image grid.
+        if ((decodeInfo->expectedWidth != 0 && (*decodedImage)->d_w != decodeInfo->expectedWidth) ||
+            (decodeInfo->expectedHeight != 0 && (*decodedImage)->d_h != decodeInfo->expectedHeight))
+        {
+            return sizeMismatchStatus;
+        }
+
+        return DecoderStatus::Ok;
+    }
+
+    DecoderStatus DecodeColorAlphaTile(
+        DecoderSession* session,
+        const CompressedTileData& colorTile,
+        const CompressedTileData& alphaTile,
+        const CICPColorData* colorInfo,
+        DecodeInfo* colorDecodeInfo,
+        DecodeInfo* alphaDecodeInfo,
+        bool unpremultiplyAlpha,
+        BitmapData* outputImage)
+    {
+        DecoderStatus status = DecoderStatus::Ok;
+
+        try
+        {
+            // Both images stay in their decoders until the tile has been converted.
+            PooledAOMDecoder colorCodec(session, colorDecodeInfo);
+            aom_image_t* colorImage = nullptr;
+
+            status = DecodeAV1Tile(colorCodec,
+                                   &colorTile,
+                                   1,
+                                   colorDecodeInfo,
+                                   DecoderStatus::ColorSizeMismatch,
+                                   &colorImage);
+
+            if (status == DecoderStatus::Ok)
+            {
+                PooledAOMDecoder alphaCodec(session, alphaDecodeInfo);
+                aom_image_t* alphaImage = nullptr;
+
+                status = DecodeAV1Tile(alphaCodec,
+                                       &alphaTile,
+                                       1,
+                                       alphaDecodeInfo,
+                                       DecoderStatus::AlphaSizeMismatch,
+                                       &alphaImage);
+
+                if (status == DecoderStatus::Ok)
+                {
+                    Instrumentation::ScopedTimer timer(Instrumentation::Counter::DecodedImageConversionTime);
+
+                    status = ConvertColorAlphaImage(colorImage,
+                                                    colorInfo,
+                                                    colorDecodeInfo,
+                                                    alphaImage,
+                                                    alphaDecodeInfo,
+                                                    unpremultiplyAlpha,
+                                                    GetLookupTableCache(session),
+                                                    outputImage);
+                }
+            }
+        }
+        catch (const std::bad_alloc&)
+        {
+            status = DecoderStatus::OutOfMemory;
+        }
+        catch (const codec_init_error&)
+        {
+            status = DecoderStatus::CodecInitFailed;
+        }
+
+        return status;
+    }
 }
 
 DecoderStatus DecodeColorImage(
-    const uint8_t* compressedColorImage,
-    size_t compressedColorImageSize,
+    DecoderSession* session,
+    const CompressedTileData* segments,
+    uint32_t segmentCount,
     const CICPColorData* colorInfo,
     DecodeInfo* decodeInfo,
     BitmapData* decodedImage)
 {
-    if (!compressedColorImage || !compressedColorImageSize || !decodedImage)
+    if (!segments || !segmentCount || !decodeInfo || !decodedImage)
     {
         return DecoderStatus::NullParameter;
     }
@@ -82,29 +249,24 @@ DecoderStatus DecodeColorImage(
 
     try
     {
-        ScopedAOMDecoder codec;
+        PooledAOMDecoder codec(session, decodeInfo);
 
         // The image is owned by the decoder.
 
         aom_image_t* aomImage = nullptr;
 
-        status = DecodeAV1Image(codec.get(),
-                                compressedColorImage,
-                                compressedColorImageSize,
-                                &aomImage);
+        status = DecodeAV1Tile(codec,
+                               segments,
+                               segmentCount,
+                               decodeInfo,
+                               DecoderStatus::ColorSizeMismatch,
+                               &aomImage);
 
         if (status == DecoderStatus::Ok)
         {
-            // The expected width/height will be zero for the first tile in an image grid.
-            if (decodeInfo->expectedWidth != 0 && aomImage->d_w != decodeInfo->expectedWidth ||
-                decodeInfo->expectedHeight != 0 && aomImage->d_h != decodeInfo->expectedHeight)
-            {
-                status = DecoderStatus::ColorSizeMismatch;
-            }
-            else
-            {
-                status = ConvertColorImage(aomImage, colorInfo, decodeInfo, decodedImage);
-            }
+            Instrumentation::ScopedTimer timer(Instrumentation::Counter::DecodedImageConversionTime);
+
+            status = ConvertColorImage(aomImage, colorInfo, decodeInfo, GetLookupTableCache(session), decodedImage);
         }
     }
     catch (const std::bad_alloc&)
@@ -120,12 +282,13 @@ DecoderStatus DecodeColorImage(
 }
 
 DecoderStatus DecodeAlphaImage(
-    const uint8_t* compressedAlphaImage,
-    size_t compressedAlphaImageSize,
+    DecoderSession* session,
+    const CompressedTileData* segments,
+    uint32_t segmentCount,
     DecodeInfo* decodeInfo,
     BitmapData* outputImage)
 {
-    if (!compressedAlphaImage || !compressedAlphaImageSize || !outputImage)
+    if (!segments || !segmentCount || !decodeInfo || !outputImage)
     {
         return DecoderStatus::NullParameter;
     }
@@ -134,29 +297,24 @@ DecoderStatus DecodeAlphaImage(
 
     try
     {
-        ScopedAOMDecoder codec;
+        PooledAOMDecoder codec(session, decodeInfo);
 
         // The image is owned by the decoder.
 
         aom_image_t* aomImage = nullptr;
 
-        status = DecodeAV1Image(codec.get(),
-                                compressedAlphaImage,
-                                compressedAlphaImageSize,
-                                &aomImage);
+        status = DecodeAV1Tile(codec,
+                               segments,
+                               segmentCount,
+                               decodeInfo,
+                               DecoderStatus::AlphaSizeMismatch,
+                               &aomImage);
 
         if (status == DecoderStatus::Ok)
         {
-            // The expected width/height will be zero for the first tile in an image grid.
-            if (decodeInfo->expectedWidth != 0 && aomImage->d_w != decodeInfo->expectedWidth ||
-                decodeInfo->expectedHeight != 0 && aomImage->d_h != decodeInfo->expectedHeight)
-            {
-                status = DecoderStatus::AlphaSizeMismatch;
-            }
-            else
-            {
-                status = ConvertAlphaImage(aomImage, decodeInfo, outputImage);
-            }
+            Instrumentation::ScopedTimer timer(Instrumentation::Counter::DecodedImageConversionTime);
+
+            status = ConvertAlphaImage(aomImage, decodeInfo, GetLookupTableCache(session), outputImage);
         }
     }
     catch (const std::bad_alloc&)
@@ -170,3 +328,87 @@ DecoderStatus DecodeAlphaImage(
 
     return status;
 }
+
+DecoderStatus DecodeColorImageGrid(
+    DecoderSession* session,
+    const CompressedTileData* tiles,
+    uint32_t tileColumnCount,
+    uint32_t tileRowCount,
+    const CICPColorData* colorInfo,
+    DecodeInfo* decodeInfo,
+    BitmapData* outputImage)
+{
+    if (!tiles)
+    {
+        return DecoderStatus::NullParameter;
+    }
+
+    return DecodeImageGrid(
+        tileColumnCount,
+        tileRowCount,
+        decodeInfo,
+        nullptr,
+        [=](uint32_t tileIndex, DecodeInfo* tileInfo, DecodeInfo*)
+        {
+            return DecodeColorImage(session, &tiles[tileIndex], 1, colorInfo, tileInfo, outputImage);
+        });
+}
+
+DecoderStatus DecodeAlphaImageGrid(
+    DecoderSession* session,
+    const CompressedTileData* tiles,
+    uint32_t tileColumnCount,
+    uint32_t tileRowCount,
+    DecodeInfo* decodeInfo,
+    BitmapData* outputImage)
+{
+    if (!tiles)
+    {
+        return DecoderStatus::NullParameter;
+    }
+
+    return DecodeImageGrid(
+        tileColumnCount,
+        tileRowCount,
+        decodeInfo,
+        nullptr,
+        [=](uint32_t tileIndex, DecodeInfo* tileInfo, DecodeInfo*)
+        {
+            return DecodeAlphaImage(session, &tiles[tileIndex], 1, tileInfo, outputImage);
+        });
+}
+
+DecoderStatus DecodeColorAlphaImageGrid(
+    DecoderSession* session,
+    const CompressedTileData* colorTiles,
+    const CompressedTileData* alphaTiles,
+    uint32_t tileColumnCount,
+    uint32_t tileRowCount,
+    const CICPColorData* colorInfo,
+    DecodeInfo* colorDecodeInfo,
+    DecodeInfo* alphaDecodeInfo,
+    bool unpremultiplyAlpha,
+    BitmapData* outputImage)
+{
+    if (!colorTiles || !alphaTiles || !alphaDecodeInfo || !outputImage)
+    {
+        return DecoderStatus::NullParameter;
+    }
+
+    return DecodeImageGrid(
+        tileColumnCount,
+        tileRowCount,
+        colorDecodeInfo,
+        alphaDecodeInfo,
+        [=](uint32_t tileIndex, DecodeInfo* colorTileInfo, DecodeInfo* alphaTileInfo)
+        {
+            return DecodeColorAlphaTile(session,
+                                        colorTiles[tileIndex],
+                                        alphaTiles[tileIndex],
+                                        colorInfo,
+                                        colorTileInfo,
+                                        alphaTileInfo,
+                                        unpremultiplyAlpha,
+                                        outputImage);
+        });
+}
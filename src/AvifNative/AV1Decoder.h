@@ -14,15 +14,48 @@
 
 #include "AvifNative.h"
 
+// The segments are decoded as one contiguous AV1 image.
 DecoderStatus DecodeColorImage(
-    const uint8_t* compressedColorImage,
-    size_t compressedColorImageSize,
+    DecoderSession* session,
+    const CompressedTileData* segments,
+    uint32_t segmentCount,
     const CICPColorData* colorInfo,
     DecodeInfo* decodeInfo,
     BitmapData* outputImage);
 
+// The segments are decoded as one contiguous AV1 image.
 DecoderStatus DecodeAlphaImage(
-    const uint8_t* compressedAlphaImage,
-    size_t compressedAlphaImageSize,
+    DecoderSession* session,
+    const CompressedTileData* segments,
+    uint32_t segmentCount,
     DecodeInfo* decodeInfo,
     BitmapData* outputImage);
+
+DecoderStatus DecodeColorImageGrid(
+    DecoderSession* session,
+    const CompressedTileData* tiles,
+    uint32_t tileColumnCount,
+    uint32_t tileRowCount,
+    const CICPColorData* colorInfo,
+    DecodeInfo* decodeInfo,
+    BitmapData* outputImage);
+
+DecoderStatus DecodeAlphaImageGrid(
+    DecoderSession* session,
+    const CompressedTileData* tiles,
+    uint32_t tileColumnCount,
+    uint32_t tileRowCount,
+    DecodeInfo* decodeInfo,
+    BitmapData* outputImage);
+
+DecoderStatus DecodeColorAlphaImageGrid(
+    DecoderSession* session,
+    const CompressedTileData* colorTiles,
+    const CompressedTileData* alphaTiles,
+    uint32_t tileColumnCount,
+    uint32_t tileRowCount,
+    const CICPColorData* colorInfo,
+    DecodeInfo* colorDecodeInfo,
+    DecodeInfo* alphaDecodeInfo,
+    bool unpremultiplyAlpha,
+    BitmapData* outputImage);
@@ -38,14 +38,110 @@
 
 #include "AV1Encoder.h"
 #include "AvifNative.h"
+#include "ChromaSubsampling.h"
+#include "Instrumentation.h"
 #include "Memory.h"
+#include "ParallelFor.h"
 #include "ScopedAOMCodec.h"
 #include "aom/aomcx.h"
 #include "aom/aom_encoder.h"
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace
 {
+    // An image that reuses its plane buffer, the buffer is only reallocated when a larger image is requested.
+    // This avoids allocating a new image for every tile in an image grid.
+    class PooledAOMImage
+    {
+    public:
+        PooledAOMImage() : buffer(), bufferSize(0), image()
+        {
+        }
+
+        PooledAOMImage(const PooledAOMImage&) = delete;
+        PooledAOMImage& operator=(const PooledAOMImage&) = delete;
+
+        // Returns an image with the specified format and size, or nullptr if the plane buffer could not be allocated.
+        // The image is valid until the next call.
+        aom_image_t* Get(aom_img_fmt_t format, uint32_t width, uint32_t height) noexcept
+        {
+            if (!buffer && !Allocate(1))
+            {
+                return nullptr;
+            }
+
+            // aom_img_wrap does not access the image data, so the plane layout can be checked
+            // against the current buffer before it is used.
+            if (!aom_img_wrap(&image, format, width, height, planeAlignment, GetAlignedBuffer()))
+            {
+                return nullptr;
+            }
+
+            const size_t requiredSize = GetRequiredSize();
+
+            if (requiredSize > bufferSize)
+            {
+                if (!Allocate(requiredSize) ||
+                    !aom_img_wrap(&image, format, width, height, planeAlignment, GetAlignedBuffer()))
+                {
+                    return nullptr;
+                }
+            }
+
+            return &image;
+        }
+
+    private:
+        static constexpr unsigned int planeAlignment = 16;
+
+        bool Allocate(size_t size) noexcept
+        {
+            buffer.reset();
+            bufferSize = 0;
+
+            try
+            {
+                buffer = std::make_unique<uint8_t[]>(size + planeAlignment - 1);
+                bufferSize = size;
+
+                Instrumentation::AddBytesAllocated(size + planeAlignment - 1);
+            }
+            catch (const std::bad_alloc&)
+            {
+                return false;
+            }
+
+            return true;
+        }
+
+        uint8_t* GetAlignedBuffer() const noexcept
+        {
+            const uintptr_t address = reinterpret_cast<uintptr_t>(buffer.get());
+            const uintptr_t alignedAddress = (address + planeAlignment - 1) & ~static_cast<uintptr_t>(planeAlignment - 1);
+
+            return buffer.get() + (alignedAddress - address);
+        }
+
+        // The V plane is the last plane in the buffer.
+        size_t GetRequiredSize() const noexcept
+        {
+            const uintptr_t start = reinterpret_cast<uintptr_t>(image.img_data);
+            const uintptr_t vPlane = reinterpret_cast<uintptr_t>(image.planes[AOM_PLANE_V]);
+            const size_t vPlaneHeight = (static_cast<size_t>(image.h) + image.y_chroma_shift) >> image.y_chroma_shift;
+
+            return static_cast<size_t>(vPlane - start) + (vPlaneHeight * static_cast<size_t>(image.stride[AOM_PLANE_V]));
+        }
+
+        std::unique_ptr<uint8_t[]> buffer;
+        size_t bufferSize;
+        aom_image_t image;
+    };
+
     struct AvifEncoderOptions
     {
         enum class ImageType
@@ -58,12 +154,23 @@ namespace
         int quality;
         int cpuUsed;
         int usage;
+        bool internalTiling;
+        bool reducedIntraTools;
+        uint32_t bitDepth;
+
+        AvifEncoderOptions()
+            : threadCount(0), quality(0), cpuUsed(0), usage(0), internalTiling(false), reducedIntraTools(false), bitDepth(8)
+        {
+        }
 
         AvifEncoderOptions(const EncoderOptions* options, ImageType imageType)
         {
             threadCount = ClampThreadCount(options->maxThreads);
             quality = ConvertQualityToAOMRange(options, imageType);
             usage = AOM_USAGE_ALL_INTRA;
+            internalTiling = options->enableInternalTiling;
+            reducedIntraTools = options->reducedIntraTools;
+            bitDepth = options->bitDepth == 0 ? 8 : options->bitDepth;
 
             switch (options->compressionSpeed)
             {
@@ -150,8 +257,12 @@ namespace
     public:
         ScopedAOMEncoder(aom_codec_iface_t* iface, const aom_codec_enc_cfg* cfg) : ScopedAOMCodec()
         {
-            throw_on_error(aom_codec_enc_init(&codec, iface, cfg, 0));
+            const aom_codec_flags_t flags = cfg->g_bit_depth > AOM_BITS_8 ? AOM_CODEC_USE_HIGHBITDEPTH : 0;
+
+            throw_on_error(aom_codec_enc_init(&codec, iface, cfg, flags));
             initialized = true;
+
+            Instrumentation::Increment(Instrumentation::Counter::EncoderInitCount);
         }
 
         void ConfigureEncoderOptions(
@@ -176,8 +287,17 @@ namespace
             throw_on_error(aom_codec_control(&codec, AV1E_SET_MATRIX_COEFFICIENTS, frame->mc));
             throw_on_error(aom_codec_control(&codec, AV1E_SET_COLOR_RANGE, frame->range));
             throw_on_error(aom_codec_control(&codec, AV1E_SET_FRAME_PARALLEL_DECODING, 0));
-            throw_on_error(aom_codec_control(&codec, AV1E_SET_TILE_COLUMNS, 0));
-            throw_on_error(aom_codec_control(&codec, AV1E_SET_TILE_ROWS, 0));
+
+            int tileColumnsLog2 = 0;
+            int tileRowsLog2 = 0;
+
+            if (encodeOptions.internalTiling)
+            {
+                GetInternalTileLayout(cfg->g_threads, frame->d_w, frame->d_h, tileColumnsLog2, tileRowsLog2);
+            }
+
+            throw_on_error(aom_codec_control(&codec, AV1E_SET_TILE_COLUMNS, tileColumnsLog2));
+            throw_on_error(aom_codec_control(&codec, AV1E_SET_TILE_ROWS, tileRowsLog2));
             if (cfg->g_threads > 1)
             {
                 throw_on_error(aom_codec_control(&codec, AV1E_SET_ROW_MT, 1));
@@ -186,154 +306,696 @@ namespace
             {
                 throw_on_error(aom_codec_control(&codec, AV1E_SET_ROW_MT, 0));
             }
+
+            if (encodeOptions.reducedIntraTools)
+            {
+                // These tools are only searched by the slower speed settings of the real-time and
+                // all intra modes, they increase the encoding time far more than they reduce the file size.
+                throw_on_error(aom_codec_control(&codec, AV1E_SET_ENABLE_TPL_MODEL, 0));
+                throw_on_error(aom_codec_control(&codec, AV1E_SET_ENABLE_RESTORATION, 0));
+                throw_on_error(aom_codec_control(&codec, AV1E_SET_ENABLE_AB_PARTITIONS, 0));
+                throw_on_error(aom_codec_control(&codec, AV1E_SET_ENABLE_1TO4_PARTITIONS, 0));
+                throw_on_error(aom_codec_control(&codec, AV1E_SET_ENABLE_FILTER_INTRA, 0));
+            }
+        }
+
+    private:
+        // Selects the number of AV1 tiles so that each encoder thread can work on its own tile,
+        // the tile count is limited so that the tiles are large enough to compress efficiently.
+        static void GetInternalTileLayout(
+            unsigned int threadCount,
+            unsigned int width,
+            unsigned int height,
+            int& tileColumnsLog2,
+            int& tileRowsLog2)
+        {
+            // Smaller tiles reduce the compression efficiency more than they reduce the encoding time.
+            constexpr unsigned int minTileSize = 256;
+            // See MAX_TILE_COLS and MAX_TILE_ROWS in the AV1 specification.
+            constexpr int maxTileLog2 = 6;
+
+            tileColumnsLog2 = 0;
+            tileRowsLog2 = 0;
+
+            while ((1u << (tileColumnsLog2 + tileRowsLog2)) < threadCount)
+            {
+                const unsigned int tileWidth = width >> tileColumnsLog2;
+                const unsigned int tileHeight = height >> tileRowsLog2;
+
+                const bool canSplitColumns = tileColumnsLog2 < maxTileLog2 && tileWidth >= minTileSize * 2;
+                const bool canSplitRows = tileRowsLog2 < maxTileLog2 && tileHeight >= minTileSize * 2;
+
+                // The larger tile dimension is split first to keep the tiles close to square.
+                if (canSplitColumns && (tileWidth >= tileHeight || !canSplitRows))
+                {
+                    tileColumnsLog2++;
+                }
+                else if (canSplitRows)
+                {
+                    tileRowsLog2++;
+                }
+                else
+                {
+                    break;
+                }
+            }
         }
     };
 
-    EncoderStatus DoOnePass(
+    // Serializes the callbacks that are shared by the images which are encoded concurrently.
+    // The progress is counted with atomic operations and the progress callback is invoked at
+    // a bounded rate by whichever thread reports progress first, the other threads do not wait
+    // for the callback. The final step always waits for the callback so that it is never dropped,
+    // and a step that is older than the last reported step is not reported.
+    // A cancellation that is returned by the callback is seen by every thread the next time it
+    // checks the cancellation flag.
+    class EncoderCallbacks
+    {
+    public:
+        EncoderCallbacks(ProgressContext* progressContext, CompressedAV1OutputAlloc outputAllocator)
+            : progressContext(progressContext),
+              outputAllocator(outputAllocator),
+              progressDone(progressContext->progressDone),
+              cancelled(false),
+              progressMutex(),
+              allocationMutex(),
+              lastProgressReport(),
+              lastReportedProgress(progressContext->progressDone)
+        {
+        }
+
+        EncoderCallbacks(const EncoderCallbacks&) = delete;
+        EncoderCallbacks& operator=(const EncoderCallbacks&) = delete;
+
+        ~EncoderCallbacks()
+        {
+            // The caller continues counting progress from the number of steps that were completed.
+            progressContext->progressDone = progressDone.load(std::memory_order_relaxed);
+        }
+
+        bool IsCancelled() const noexcept
+        {
+            return cancelled.load(std::memory_order_relaxed);
+        }
+
+        // Returns false if the user has canceled the operation.
+        bool ReportProgress() noexcept
+        {
+            const uint32_t done = progressDone.fetch_add(1, std::memory_order_relaxed) + 1;
+
+            if (IsCancelled())
+            {
+                return false;
+            }
+
+            const bool finalStep = done >= progressContext->progressTotal;
+
+            std::unique_lock<std::mutex> lock(progressMutex, std::defer_lock);
+
+            if (finalStep)
+            {
+                lock.lock();
+            }
+            else
+            {
+                lock.try_lock();
+            }
+
+            // Another thread may have reported a later step while this thread was waiting.
+            if (lock.owns_lock() && done > lastReportedProgress)
+            {
+                const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+                if (done == 1 ||
+                    finalStep ||
+                    now - lastProgressReport >= minimumProgressInterval)
+                {
+                    lastProgressReport = now;
+                    lastReportedProgress = done;
+
+                    Instrumentation::ScopedTimer timer(Instrumentation::Counter::ProgressCallbackTime);
+                    Instrumentation::Increment(Instrumentation::Counter::ProgressCallbackCount);
+
+                    if (!progressContext->progressCallback(done, progressContext->progressTotal))
+                    {
+                        cancelled.store(true, std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            return !IsCancelled();
+        }
+
+        void* Allocate(size_t sizeInBytes)
+        {
+            std::lock_guard<std::mutex> lock(allocationMutex);
+
+            Instrumentation::AddBytesAllocated(sizeInBytes);
+
+            return outputAllocator(sizeInBytes);
+        }
+
+    private:
+        static constexpr std::chrono::milliseconds minimumProgressInterval = std::chrono::milliseconds(50);
+
+        ProgressContext* progressContext;
+        CompressedAV1OutputAlloc outputAllocator;
+        std::atomic<uint32_t> progressDone;
+        std::atomic<bool> cancelled;
+        std::mutex progressMutex;
+        std::mutex allocationMutex;
+        std::chrono::steady_clock::time_point lastProgressReport;
+        uint32_t lastReportedProgress;
+    };
+
+    EncoderStatus InitializeEncoderConfig(
         aom_codec_iface_t* iface,
-        const aom_codec_enc_cfg* cfg,
         const AvifEncoderOptions& encodeOptions,
-        ProgressContext* progressContext,
         const aom_image_t* frame,
-        CompressedAV1OutputAlloc outputAllocator,
-        void** output)
+        aom_codec_enc_cfg* aom_cfg)
+    {
+        if (aom_codec_enc_config_default(iface, aom_cfg, encodeOptions.usage) != AOM_CODEC_OK)
+        {
+            return EncoderStatus::CodecInitFailed;
+        }
+
+        aom_cfg->g_limit = 1;
+        aom_cfg->g_w = frame->d_w;
+        aom_cfg->g_h = frame->d_h;
+        aom_cfg->g_timebase.num = 1;
+        aom_cfg->g_timebase.den = 24;
+        aom_cfg->rc_end_usage = AOM_Q;
+        aom_cfg->rc_min_quantizer = aom_cfg->rc_max_quantizer = encodeOptions.quality;
+        aom_cfg->g_threads = encodeOptions.threadCount;
+        aom_cfg->g_usage = encodeOptions.usage;
+        aom_cfg->monochrome = frame->monochrome;
+        aom_cfg->g_bit_depth = static_cast<aom_bit_depth_t>(encodeOptions.bitDepth);
+        aom_cfg->g_input_bit_depth = encodeOptions.bitDepth;
+        // Setting g_lag_in_frames to 0 is required when using the all intra encoding mode.
+        aom_cfg->g_lag_in_frames = 0;
+
+        // Set the profile to use based on the frame format.
+        // See Annex A.2 in the AV1 Specification:
+        // https://aomediacodec.github.io/av1-spec/av1-spec.pdf
+        switch (frame->fmt & ~AOM_IMG_FMT_HIGHBITDEPTH)
+        {
+        case AOM_IMG_FMT_I420:
+            aom_cfg->g_profile = 0;
+            break;
+        case AOM_IMG_FMT_I422:
+            aom_cfg->g_profile = 2;
+            break;
+        case AOM_IMG_FMT_I444:
+            aom_cfg->g_profile = 1;
+            break;
+
+        default:
+            return EncoderStatus::UnknownYUVFormat;
+        }
+
+        // The main and high profiles are limited to 10 bits per sample.
+        if (encodeOptions.bitDepth == 12)
+        {
+            aom_cfg->g_profile = 2;
+        }
+
+        aom_cfg->g_pass = AOM_RC_ONE_PASS;
+
+        return EncoderStatus::Ok;
+    }
+
+    // Encodes a single still frame.
+    // The encoder cannot be used for any other frames when encoderFlushed is set to true.
+    EncoderStatus EncodeFrame(
+        aom_codec_ctx_t* codec,
+        aom_codec_pts_t pts,
+        EncoderCallbacks& callbacks,
+        const aom_image_t* frame,
+        void** output,
+        bool& encoderFlushed)
     {
         EncoderStatus status = EncoderStatus::Ok;
+        encoderFlushed = false;
+
+        aom_codec_err_t encodeError;
 
-        try
         {
-            ScopedAOMEncoder codec(iface, cfg);
-            codec.ConfigureEncoderOptions(cfg, encodeOptions, frame);
+            Instrumentation::ScopedTimer timer(Instrumentation::Counter::EncodeTime);
 
-            aom_codec_err_t encodeError = aom_codec_encode(codec.get(), frame, 0, 1, 0);
+            // Every frame is encoded as a key frame so that it can be decoded independently of
+            // any other frames that were previously encoded with the same encoder.
+            encodeError = aom_codec_encode(codec, frame, pts, 1, AOM_EFLAG_FORCE_KF);
+        }
 
-            if (encodeError == AOM_CODEC_OK)
+        if (encodeError == AOM_CODEC_OK)
+        {
+            aom_codec_iter_t iter = nullptr;
+
+            while (true)
             {
-                aom_codec_iter_t iter = nullptr;
-                bool flushed = false;
+                const aom_codec_cx_pkt_t* pkt = aom_codec_get_cx_data(codec, &iter);
 
-                while (true)
+                if (pkt == nullptr)
                 {
-                    const aom_codec_cx_pkt_t* pkt = aom_codec_get_cx_data(codec.get(), &iter);
+                    if (encoderFlushed)
+                    {
+                        status = EncoderStatus::EncodeFailed;
+                        break;
+                    }
 
-                    if (pkt == nullptr)
                     {
-                        if (flushed)
-                        {
-                            status = EncoderStatus::EncodeFailed;
-                            break;
-                        }
+                        Instrumentation::ScopedTimer timer(Instrumentation::Counter::EncodeTime);
 
-                        encodeError = aom_codec_encode(codec.get(), nullptr, 0, 1, 0);
-                        if (encodeError != AOM_CODEC_OK)
-                        {
-                            status = encodeError == AOM_CODEC_MEM_ERROR ? EncoderStatus::OutOfMemory : EncoderStatus::EncodeFailed;
-                            break;
-                        }
-                        flushed = true;
+                        encodeError = aom_codec_encode(codec, nullptr, 0, 1, 0);
                     }
-                    else if (pkt->kind == AOM_CODEC_CX_FRAME_PKT)
+
+                    if (encodeError != AOM_CODEC_OK)
                     {
-                        if (progressContext->progressCallback(++progressContext->progressDone, progressContext->progressTotal))
+                        status = encodeError == AOM_CODEC_MEM_ERROR ? EncoderStatus::OutOfMemory : EncoderStatus::EncodeFailed;
+                        break;
+                    }
+                    encoderFlushed = true;
+                }
+                else if (pkt->kind == AOM_CODEC_CX_FRAME_PKT)
+                {
+                    if (callbacks.ReportProgress())
+                    {
+                        Instrumentation::ScopedTimer timer(Instrumentation::Counter::OutputCopyTime);
+
+                        *output = callbacks.Allocate(pkt->data.frame.sz);
+                        if (*output)
                         {
-                            *output = outputAllocator(pkt->data.frame.sz);
-                            if (*output)
-                            {
-                                memcpy_s(*output, pkt->data.frame.sz, pkt->data.frame.buf, pkt->data.frame.sz);
-                            }
-                            else
-                            {
-                                status = EncoderStatus::OutOfMemory;
-                            }
+                            memcpy_s(*output, pkt->data.frame.sz, pkt->data.frame.buf, pkt->data.frame.sz);
                         }
                         else
                         {
-                            status = EncoderStatus::UserCancelled;
+                            status = EncoderStatus::OutOfMemory;
                         }
-                        break;
                     }
+                    else
+                    {
+                        status = EncoderStatus::UserCancelled;
+                    }
+                    break;
+                }
+            }
+        }
+        else
+        {
+            status = encodeError == AOM_CODEC_MEM_ERROR ? EncoderStatus::OutOfMemory : EncoderStatus::EncodeFailed;
+        }
+
+        return status;
+    }
+
+    bool EncoderOptionsAreEqual(const AvifEncoderOptions& first, const AvifEncoderOptions& second)
+    {
+        return first.threadCount == second.threadCount &&
+               first.quality == second.quality &&
+               first.cpuUsed == second.cpuUsed &&
+               first.usage == second.usage &&
+               first.internalTiling == second.internalTiling &&
+               first.reducedIntraTools == second.reducedIntraTools &&
+               first.bitDepth == second.bitDepth;
+    }
+
+    bool FrameFormatsAreEqual(const aom_image_t* first, const aom_image_t* second)
+    {
+        return first->d_w == second->d_w &&
+               first->d_h == second->d_h &&
+               first->fmt == second->fmt &&
+               first->bit_depth == second->bit_depth &&
+               first->monochrome == second->monochrome &&
+               first->cp == second->cp &&
+               first->tc == second->tc &&
+               first->mc == second->mc &&
+               first->range == second->range;
+    }
+
+    // Caches an AV1 encoder for the color and alpha images, the tiles in an image grid normally
+    // share the same size and settings so the encoder setup only needs to be performed once.
+    class TileEncoder
+    {
+    public:
+        TileEncoder() : encoders(), pooledImage(), pooledAlphaImage()
+        {
+        }
+
+        TileEncoder(const TileEncoder&) = delete;
+        TileEncoder& operator=(const TileEncoder&) = delete;
+
+        // Returns an image that is used to pass the converted tile to the encoder.
+        // The image is valid until the next call.
+        aom_image_t* GetImage(aom_img_fmt_t format, uint32_t width, uint32_t height) noexcept
+        {
+            return pooledImage.Get(format, width, height);
+        }
+
+        // Returns a second image that holds the alpha channel when the color and alpha of a tile
+        // are converted together, the image is valid until the next call.
+        aom_image_t* GetAlphaImage(aom_img_fmt_t format, uint32_t width, uint32_t height) noexcept
+        {
+            return pooledAlphaImage.Get(format, width, height);
+        }
+
+        EncoderStatus Encode(
+            const aom_image* image,
+            AvifEncoderOptions::ImageType imageType,
+            const AvifEncoderOptions& options,
+            EncoderCallbacks& callbacks,
+            void** compressedImage)
+        {
+            CachedEncoder& cached = encoders[static_cast<size_t>(imageType)];
+
+            EncoderStatus status = EncoderStatus::Ok;
+
+            try
+            {
+                if (!cached.encoder || !cached.IsCompatible(options, image))
+                {
+                    cached.Reset();
+
+                    aom_codec_iface_t* iface = aom_codec_av1_cx();
+
+                    status = InitializeEncoderConfig(iface, options, image, &cached.cfg);
+                    if (status != EncoderStatus::Ok)
+                    {
+                        return status;
+                    }
+
+                    std::unique_ptr<ScopedAOMEncoder> encoder = std::make_unique<ScopedAOMEncoder>(iface, &cached.cfg);
+                    encoder->ConfigureEncoderOptions(&cached.cfg, options, image);
+
+                    cached.encoder = std::move(encoder);
+                    cached.options = options;
+                    cached.format = *image;
+                    cached.nextPts = 0;
+                }
+
+                bool encoderFlushed = false;
+
+                status = EncodeFrame(cached.encoder->get(),
+                                     cached.nextPts++,
+                                     callbacks,
+                                     image,
+                                     compressedImage,
+                                     encoderFlushed);
+
+                if (status == EncoderStatus::Ok)
+                {
+                    Instrumentation::Increment(Instrumentation::Counter::ImagesEncoded);
+                }
+
+                if (status != EncoderStatus::Ok || encoderFlushed)
+                {
+                    // The encoder cannot be reused after it has been flushed or an error occurred.
+                    cached.Reset();
                 }
             }
+            catch (const std::bad_alloc&)
+            {
+                cached.Reset();
+                status = EncoderStatus::OutOfMemory;
+            }
+            catch (const codec_init_error&)
+            {
+                cached.Reset();
+                status = EncoderStatus::CodecInitFailed;
+            }
+
+            return status;
+        }
+
+    private:
+        struct CachedEncoder
+        {
+            std::unique_ptr<ScopedAOMEncoder> encoder;
+            aom_codec_enc_cfg cfg;
+            AvifEncoderOptions options;
+            // Only the image format properties are used, the image data pointers are not valid.
+            aom_image_t format;
+            aom_codec_pts_t nextPts;
+
+            CachedEncoder() : encoder(), cfg(), options(), format(), nextPts(0)
+            {
+            }
+
+            bool IsCompatible(const AvifEncoderOptions& newOptions, const aom_image_t* frame) const
+            {
+                return EncoderOptionsAreEqual(options, newOptions) && FrameFormatsAreEqual(&format, frame);
+            }
+
+            void Reset() noexcept
+            {
+                encoder.reset();
+            }
+        };
+
+        std::array<CachedEncoder, 2> encoders;
+        PooledAOMImage pooledImage;
+        PooledAOMImage pooledAlphaImage;
+    };
+}
+
+// Each thread that encodes images concurrently uses its own TileEncoder.
+struct EncoderSession
+{
+public:
+    EncoderSession() : tileEncoders()
+    {
+    }
+
+    EncoderSession(const EncoderSession&) = delete;
+    EncoderSession& operator=(const EncoderSession&) = delete;
+
+    // Ensures that at least count encoders are available.
+    void EnsureTileEncoderCount(size_t count)
+    {
+        while (tileEncoders.size() < count)
+        {
+            tileEncoders.push_back(std::make_unique<TileEncoder>());
+        }
+    }
+
+    TileEncoder& GetTileEncoder(size_t index)
+    {
+        return *tileEncoders[index];
+    }
+
+private:
+    std::vector<std::unique_ptr<TileEncoder>> tileEncoders;
+};
+
+namespace
+{
+    uint32_t GetConversionThreadCount(const EncoderOptions* options)
+    {
+        return options->maxConversionThreads > 1 ? static_cast<uint32_t>(options->maxConversionThreads) : 1;
+    }
+
+    bool IsSupportedImageFormat(const BitmapData* image, const AvifEncoderOptions& options)
+    {
+        return (image->pixelFormat == BitmapPixelFormat::Bgra32 || image->pixelFormat == BitmapPixelFormat::Bgra64) &&
+               (options.bitDepth == 8 || options.bitDepth == 10 || options.bitDepth == 12);
+    }
+
+    EncoderStatus GetAOMImageFormat(
+        AvifEncoderOptions::ImageType imageType,
+        YUVChromaSubsampling yuvFormat,
+        uint32_t bitDepth,
+        aom_img_fmt& aomFormat)
+    {
+        if (imageType == AvifEncoderOptions::ImageType::Color)
+        {
+            switch (yuvFormat)
+            {
+            case YUVChromaSubsampling::Subsampling400:
+            case YUVChromaSubsampling::Subsampling420:
+                aomFormat = AOM_IMG_FMT_I420;
+                break;
+            case YUVChromaSubsampling::Subsampling422:
+                aomFormat = AOM_IMG_FMT_I422;
+                break;
+            case YUVChromaSubsampling::Subsampling444:
+            case YUVChromaSubsampling::IdentityMatrix:
+                aomFormat = AOM_IMG_FMT_I444;
+                break;
+            default:
+                return EncoderStatus::UnknownYUVFormat;
+            }
+        }
+        else
+        {
+            // Chroma sub-sampling does not matter for the alpha channel
+            // YUV 4:0:0 would be a better format for the alpha image than YUV 4:2:0,
+            // but it appears that libaom does not currently support it.
+            aomFormat = AOM_IMG_FMT_I420;
+        }
+
+        if (bitDepth > 8)
+        {
+            aomFormat = static_cast<aom_img_fmt>(aomFormat | AOM_IMG_FMT_HIGHBITDEPTH);
+        }
+
+        return EncoderStatus::Ok;
+    }
+
+    EncoderStatus CompressTileImage(
+        TileEncoder& encoder,
+        const BitmapData* image,
+        AvifEncoderOptions::ImageType imageType,
+        const AvifEncoderOptions& options,
+        YUVChromaSubsampling yuvFormat,
+        const CICPColorData& colorInfo,
+        bool premultiplyAlpha,
+        uint32_t conversionThreadCount,
+        EncoderCallbacks& callbacks,
+        void** compressedImage)
+    {
+        if (!IsSupportedImageFormat(image, options))
+        {
+            return EncoderStatus::UnsupportedBitDepth;
+        }
+
+        if (!callbacks.ReportProgress())
+        {
+            return EncoderStatus::UserCancelled;
+        }
+
+        aom_img_fmt aomFormat;
+
+        EncoderStatus status = GetAOMImageFormat(imageType, yuvFormat, options.bitDepth, aomFormat);
+        if (status != EncoderStatus::Ok)
+        {
+            return status;
+        }
+
+        // The image planes are owned by the encoder and reused for the next image.
+        aom_image_t* frame = encoder.GetImage(aomFormat, image->width, image->height);
+
+        if (!frame)
+        {
+            return EncoderStatus::OutOfMemory;
+        }
+
+        // The high bit depth formats store each sample in 16 bits, the converters scale
+        // the samples to the range of the encoded bit depth.
+        frame->bit_depth = options.bitDepth;
+
+        {
+            Instrumentation::ScopedTimer timer(Instrumentation::Counter::ColorConversionTime);
+
+            if (imageType == AvifEncoderOptions::ImageType::Color)
+            {
+                status = ConvertColorToAOMImage(image, colorInfo, yuvFormat, premultiplyAlpha, conversionThreadCount, frame);
+            }
             else
             {
-                status = encodeError == AOM_CODEC_MEM_ERROR ? EncoderStatus::OutOfMemory : EncoderStatus::EncodeFailed;
+                ConvertAlphaToAOMImage(image, conversionThreadCount, frame);
             }
         }
-        catch (const std::bad_alloc&)
+
+        if (status != EncoderStatus::Ok)
         {
-            status = EncoderStatus::OutOfMemory;
+            return status;
         }
-        catch (const codec_init_error&)
+
+        // Another image may have been canceled while this image was being converted.
+        if (callbacks.IsCancelled())
         {
-            status = EncoderStatus::CodecInitFailed;
+            return EncoderStatus::UserCancelled;
         }
 
-        return status;
+        return encoder.Encode(frame, imageType, options, callbacks, compressedImage);
     }
 
-    EncoderStatus EncodeAOMImage(
-        aom_codec_iface_t* iface,
-        const AvifEncoderOptions& encodeOptions,
-        ProgressContext* progressContext,
-        const aom_image_t* frame,
-        CompressedAV1OutputAlloc outputAllocator,
-        void** outputImage)
+    // Compresses the color and alpha images of a tile that uses premultiplied alpha, the color and alpha
+    // are converted in a single pass over the tile before the images are encoded.
+    EncoderStatus CompressTileColorAndAlphaImages(
+        TileEncoder& encoder,
+        const BitmapData* image,
+        const AvifEncoderOptions& colorOptions,
+        const AvifEncoderOptions& alphaOptions,
+        YUVChromaSubsampling yuvFormat,
+        const CICPColorData& colorInfo,
+        uint32_t conversionThreadCount,
+        EncoderCallbacks& callbacks,
+        void** compressedColorImage,
+        void** compressedAlphaImage)
     {
-        aom_codec_enc_cfg_t aom_cfg;
+        if (!IsSupportedImageFormat(image, colorOptions))
+        {
+            return EncoderStatus::UnsupportedBitDepth;
+        }
 
-        if (aom_codec_enc_config_default(iface, &aom_cfg, encodeOptions.usage) != AOM_CODEC_OK)
+        // Report the progress step that is performed before each of the images is compressed.
+        if (!callbacks.ReportProgress() || !callbacks.ReportProgress())
         {
-            return EncoderStatus::CodecInitFailed;
+            return EncoderStatus::UserCancelled;
         }
 
-        aom_cfg.g_limit = 1;
-        aom_cfg.g_w = frame->d_w;
-        aom_cfg.g_h = frame->d_h;
-        aom_cfg.g_timebase.num = 1;
-        aom_cfg.g_timebase.den = 24;
-        aom_cfg.rc_end_usage = AOM_Q;
-        aom_cfg.rc_min_quantizer = aom_cfg.rc_max_quantizer = encodeOptions.quality;
-        aom_cfg.g_threads = encodeOptions.threadCount;
-        aom_cfg.g_usage = encodeOptions.usage;
-        aom_cfg.monochrome = frame->monochrome;
-        // Setting g_lag_in_frames to 0 is required when using the all intra encoding mode.
-        aom_cfg.g_lag_in_frames = 0;
+        aom_img_fmt colorFormat;
+        aom_img_fmt alphaFormat;
 
-        // Set the profile to use based on the frame format.
-        // See Annex A.2 in the AV1 Specification:
-        // https://aomediacodec.github.io/av1-spec/av1-spec.pdf
-        switch (frame->fmt)
+        EncoderStatus status = GetAOMImageFormat(AvifEncoderOptions::ImageType::Color, yuvFormat, colorOptions.bitDepth, colorFormat);
+        if (status != EncoderStatus::Ok)
         {
-        case AOM_IMG_FMT_I420:
-            aom_cfg.g_profile = 0;
-            break;
-        case AOM_IMG_FMT_I422:
-            aom_cfg.g_profile = 2;
-            break;
-        case AOM_IMG_FMT_I444:
-            aom_cfg.g_profile = 1;
-            break;
+            return status;
+        }
 
-        default:
-            return EncoderStatus::UnknownYUVFormat;
+        status = GetAOMImageFormat(AvifEncoderOptions::ImageType::Alpha, yuvFormat, alphaOptions.bitDepth, alphaFormat);
+        if (status != EncoderStatus::Ok)
+        {
+            return status;
+        }
+
+        aom_image_t* colorFrame = encoder.GetImage(colorFormat, image->width, image->height);
+        aom_image_t* alphaFrame = encoder.GetAlphaImage(alphaFormat, image->width, image->height);
+
+        if (!colorFrame || !alphaFrame)
+        {
+            return EncoderStatus::OutOfMemory;
+        }
+
+        colorFrame->bit_depth = colorOptions.bitDepth;
+        alphaFrame->bit_depth = alphaOptions.bitDepth;
+
+        {
+            Instrumentation::ScopedTimer timer(Instrumentation::Counter::ColorConversionTime);
+
+            status = ConvertPremultipliedColorAndAlphaToAOMImages(image, colorInfo, yuvFormat, conversionThreadCount, colorFrame, alphaFrame);
         }
 
-        aom_cfg.g_pass = AOM_RC_ONE_PASS;
+        if (status != EncoderStatus::Ok)
+        {
+            return status;
+        }
+
+        if (callbacks.IsCancelled())
+        {
+            return EncoderStatus::UserCancelled;
+        }
+
+        status = encoder.Encode(colorFrame, AvifEncoderOptions::ImageType::Color, colorOptions, callbacks, compressedColorImage);
+        if (status != EncoderStatus::Ok)
+        {
+            return status;
+        }
 
-        EncoderStatus error = DoOnePass(iface, &aom_cfg, encodeOptions, progressContext, frame,
-                                        outputAllocator, outputImage);
-        return error;
+        return encoder.Encode(alphaFrame, AvifEncoderOptions::ImageType::Alpha, alphaOptions, callbacks, compressedAlphaImage);
     }
 
-    EncoderStatus CompressAOMImage(
-        const aom_image* image,
+    EncoderStatus CompressImage(
+        EncoderSession* session,
+        const BitmapData* image,
         AvifEncoderOptions::ImageType imageType,
         const EncoderOptions* encodeOptions,
         ProgressContext* progressContext,
+        const CICPColorData& colorInfo,
         CompressedAV1OutputAlloc outputAllocator,
         void** compressedImage)
     {
-        if (!outputAllocator)
+        if (!image || !encodeOptions || !progressContext || !outputAllocator)
         {
             return EncoderStatus::NullParameter;
         }
@@ -348,46 +1010,265 @@ namespace
         }
 
         AvifEncoderOptions options(encodeOptions, imageType);
+        EncoderCallbacks callbacks(progressContext, outputAllocator);
 
-        aom_codec_iface_t* iface = aom_codec_av1_cx();
+        try
+        {
+            // Use a temporary session when the caller does not provide one.
+            std::unique_ptr<EncoderSession> temporarySession;
+
+            if (!session)
+            {
+                temporarySession = std::make_unique<EncoderSession>();
+                session = temporarySession.get();
+            }
 
-        if (!progressContext->progressCallback(++progressContext->progressDone, progressContext->progressTotal))
+            session->EnsureTileEncoderCount(1);
+
+            return CompressTileImage(
+                session->GetTileEncoder(0),
+                image,
+                imageType,
+                options,
+                encodeOptions->yuvFormat,
+                colorInfo,
+                encodeOptions->premultiplyAlpha,
+                GetConversionThreadCount(encodeOptions),
+                callbacks,
+                compressedImage);
+        }
+        catch (const std::bad_alloc&)
         {
-            return EncoderStatus::UserCancelled;
+            return EncoderStatus::OutOfMemory;
+        }
+    }
+
+    uint32_t GetConcurrentEncoderCount(uint32_t imageCount, uint32_t totalThreadCount)
+    {
+        // Each encoder uses the square root of the total thread count, libaom does not scale well
+        // above a few threads on the image sizes that are used for the grid tiles.
+        uint32_t encoderCount = 1;
+
+        while ((encoderCount + 1) * (encoderCount + 1) <= totalThreadCount)
+        {
+            encoderCount++;
         }
 
-        return EncodeAOMImage(iface, options, progressContext, image, outputAllocator, compressedImage);
+        return GetWorkerThreadCount(imageCount, encoderCount);
     }
+
+    struct GridImage
+    {
+        uint32_t tileIndex;
+        AvifEncoderOptions::ImageType imageType;
+        // The alpha image of the tile is converted and compressed with the color image.
+        bool includesAlpha;
+    };
+}
+
+EncoderSession* CreateAV1EncoderSession()
+{
+    try
+    {
+        return new EncoderSession();
+    }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+
+void DestroyAV1EncoderSession(EncoderSession* session)
+{
+    delete session;
 }
 
 EncoderStatus CompressAOMColorImage(
-    const aom_image* color,
+    EncoderSession* session,
+    const BitmapData* image,
     const EncoderOptions* encodeOptions,
     ProgressContext* progressContext,
+    const CICPColorData& colorInfo,
     CompressedAV1OutputAlloc outputAllocator,
     void** compressedColorImage)
 {
-    return CompressAOMImage(
-        color,
+    return CompressImage(
+        session,
+        image,
         AvifEncoderOptions::ImageType::Color,
         encodeOptions,
         progressContext,
+        colorInfo,
         outputAllocator,
         compressedColorImage);
 }
 
 EncoderStatus CompressAOMAlphaImage(
-    const aom_image* alpha,
+    EncoderSession* session,
+    const BitmapData* image,
     const EncoderOptions* encodeOptions,
     ProgressContext* progressContext,
     CompressedAV1OutputAlloc outputAllocator,
     void** compressedAlphaImage)
 {
-    return CompressAOMImage(
-        alpha,
+    // The color information is not used when encoding the alpha image.
+    const CICPColorData unusedColorInfo{};
+
+    return CompressImage(
+        session,
+        image,
         AvifEncoderOptions::ImageType::Alpha,
         encodeOptions,
         progressContext,
+        unusedColorInfo,
         outputAllocator,
         compressedAlphaImage);
 }
+
+EncoderStatus CompressAOMImageGrid(
+    EncoderSession* session,
+    const TileEncodeInfo* tiles,
+    uint32_t tileCount,
+    const EncoderOptions* encodeOptions,
+    ProgressContext* progressContext,
+    const CICPColorData& colorInfo,
+    CompressedAV1OutputAlloc outputAllocator,
+    void** compressedColorImages,
+    void** compressedAlphaImages)
+{
+    if (!tiles || tileCount == 0 || !encodeOptions || !progressContext || !outputAllocator || !compressedColorImages)
+    {
+        return EncoderStatus::NullParameter;
+    }
+
+    try
+    {
+        uint32_t separateImageCount = 0;
+        uint32_t combinedTileCount = 0;
+
+        for (uint32_t i = 0; i < tileCount; i++)
+        {
+            compressedColorImages[i] = nullptr;
+
+            if (compressedAlphaImages)
+            {
+                compressedAlphaImages[i] = nullptr;
+            }
+            else if (tiles[i].encodeAlpha)
+            {
+                return EncoderStatus::NullParameter;
+            }
+
+            separateImageCount += static_cast<uint32_t>(tiles[i].encodeColor) + static_cast<uint32_t>(tiles[i].encodeAlpha);
+
+            if (tiles[i].encodeColor && tiles[i].encodeAlpha)
+            {
+                combinedTileCount++;
+            }
+        }
+
+        if (separateImageCount == 0)
+        {
+            return EncoderStatus::Ok;
+        }
+
+        const uint32_t totalThreadCount = encodeOptions->maxThreads > 0 ? static_cast<uint32_t>(encodeOptions->maxThreads) : 1;
+
+        // The premultiplied color and the alpha of a tile are converted in one pass when that does not
+        // reduce the number of images that can be encoded at the same time, otherwise the premultiplication
+        // is performed while converting the color image and the alpha image is converted on its own.
+        const bool combineColorAndAlpha = encodeOptions->premultiplyAlpha &&
+                                          combinedTileCount > 0 &&
+                                          GetConcurrentEncoderCount(separateImageCount - combinedTileCount, totalThreadCount) ==
+                                          GetConcurrentEncoderCount(separateImageCount, totalThreadCount);
+
+        std::vector<GridImage> images;
+        images.reserve(separateImageCount);
+
+        // The color and alpha images of a tile are queued next to each other, this allows them to be
+        // encoded at the same time.
+        for (uint32_t i = 0; i < tileCount; i++)
+        {
+            const bool combined = combineColorAndAlpha && tiles[i].encodeColor && tiles[i].encodeAlpha;
+
+            if (tiles[i].encodeColor)
+            {
+                images.push_back({ i, AvifEncoderOptions::ImageType::Color, combined });
+            }
+
+            if (tiles[i].encodeAlpha && !combined)
+            {
+                images.push_back({ i, AvifEncoderOptions::ImageType::Alpha, false });
+            }
+        }
+
+        const uint32_t imageCount = static_cast<uint32_t>(images.size());
+        const uint32_t encoderCount = GetConcurrentEncoderCount(imageCount, totalThreadCount);
+
+        // Split the thread budget between the encoders that run at the same time.
+        EncoderOptions tileEncodeOptions = *encodeOptions;
+        tileEncodeOptions.maxThreads = static_cast<int32_t>(totalThreadCount / encoderCount);
+
+        // The images already use all of the threads when more than one is encoded at a time,
+        // so each image is converted on the thread that encodes it.
+        const uint32_t conversionThreadCount = encoderCount > 1 ? 1 : GetConversionThreadCount(encodeOptions);
+
+        const AvifEncoderOptions colorOptions(&tileEncodeOptions, AvifEncoderOptions::ImageType::Color);
+        const AvifEncoderOptions alphaOptions(&tileEncodeOptions, AvifEncoderOptions::ImageType::Alpha);
+
+        std::unique_ptr<EncoderSession> temporarySession;
+
+        if (!session)
+        {
+            temporarySession = std::make_unique<EncoderSession>();
+            session = temporarySession.get();
+        }
+
+        session->EnsureTileEncoderCount(encoderCount);
+
+        EncoderCallbacks callbacks(progressContext, outputAllocator);
+        Instrumentation::ScopedParallelTimer parallelTimer(encoderCount);
+
+        return ParallelForWithWorkerIndex<EncoderStatus>(
+            imageCount,
+            encoderCount,
+            [&](uint32_t workerIndex, uint32_t index)
+            {
+                Instrumentation::ScopedTimer workTimer(Instrumentation::Counter::ParallelWorkTime);
+
+                const GridImage& item = images[index];
+                const bool isColor = item.imageType == AvifEncoderOptions::ImageType::Color;
+
+                if (item.includesAlpha)
+                {
+                    return CompressTileColorAndAlphaImages(
+                        session->GetTileEncoder(workerIndex),
+                        &tiles[item.tileIndex].image,
+                        colorOptions,
+                        alphaOptions,
+                        encodeOptions->yuvFormat,
+                        colorInfo,
+                        conversionThreadCount,
+                        callbacks,
+                        &compressedColorImages[item.tileIndex],
+                        &compressedAlphaImages[item.tileIndex]);
+                }
+
+                return CompressTileImage(
+                    session->GetTileEncoder(workerIndex),
+                    &tiles[item.tileIndex].image,
+                    item.imageType,
+                    isColor ? colorOptions : alphaOptions,
+                    encodeOptions->yuvFormat,
+                    colorInfo,
+                    encodeOptions->premultiplyAlpha,
+                    conversionThreadCount,
+                    callbacks,
+                    isColor ? &compressedColorImages[item.tileIndex] : &compressedAlphaImages[item.tileIndex]);
+            });
+    }
+    catch (const std::bad_alloc&)
+    {
+        return EncoderStatus::OutOfMemory;
+    }
+}
@@ -13,26 +13,43 @@
 #pragma once
 
 #include "AvifNative.h"
-#include "aom/aom_image.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif // __cplusplus
 
+EncoderSession* CreateAV1EncoderSession();
+
+void DestroyAV1EncoderSession(EncoderSession* session);
+
 EncoderStatus CompressAOMColorImage(
-    const aom_image* color,
+    EncoderSession* session,
+    const BitmapData* image,
     const EncoderOptions* encodeOptions,
     ProgressContext* progressContext,
+    const CICPColorData& colorInfo,
     CompressedAV1OutputAlloc outputAllocator,
     void** compressedColorImage);
 
 EncoderStatus CompressAOMAlphaImage(
-    const aom_image* alpha,
+    EncoderSession* session,
+    const BitmapData* image,
     const EncoderOptions* encodeOptions,
     ProgressContext* progressContext,
     CompressedAV1OutputAlloc outputAllocator,
     void** compressedAlphaImage);
 
+EncoderStatus CompressAOMImageGrid(
+    EncoderSession* session,
+    const TileEncodeInfo* tiles,
+    uint32_t tileCount,
+    const EncoderOptions* encodeOptions,
+    ProgressContext* progressContext,
+    const CICPColorData& colorInfo,
+    CompressedAV1OutputAlloc outputAllocator,
+    void** compressedColorImages,
+    void** compressedAlphaImages);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
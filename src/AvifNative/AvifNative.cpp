@@ -12,123 +12,322 @@
 
 #include "AvifNative.h"
 #include "Memory.h"
-#include "ChromaSubsampling.h"
 #include "AV1Decoder.h"
 #include "AV1Encoder.h"
-#include "aom/aom_image.h"
+#include "ChromaSubsampling.h"
+#include "DecodedImageConverter.h"
+#include "DecoderSession.h"
+#include "ImageAnalysis.h"
+#include "Instrumentation.h"
+#include "ParallelFor.h"
+#include "TileHash.h"
 #include <memory>
 
-namespace AvifNative
+DecoderSession* __stdcall CreateDecoderSession()
 {
-    namespace details
+    try
     {
-        struct aom_image_deleter
-        {
-            void operator()(aom_image* img) noexcept
-            {
-                if (img)
-                {
-                    aom_img_free(img);
-                }
-            }
-        };
+        return new DecoderSession();
     }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
 
-    typedef std::unique_ptr<aom_image, details::aom_image_deleter> ScopedAOMImage;
+void __stdcall DestroyDecoderSession(DecoderSession* session)
+{
+    delete session;
 }
 
 DecoderStatus __stdcall DecompressColorImage(
+    DecoderSession* session,
     const uint8_t* compressedColorImage,
     size_t compressedColorImageSize,
     const CICPColorData* colorInfo,
     DecodeInfo* decodeInfo,
-    BitmapData* outputImage)
+    BitmapData* outputImage,
+    InstrumentationStatistics* statistics)
 {
+    Instrumentation::CallScope instrumentation(statistics);
+
+    const CompressedTileData segment{ compressedColorImage, compressedColorImageSize };
+
     return DecodeColorImage(
-        compressedColorImage,
-        compressedColorImageSize,
+        session,
+        &segment,
+        1,
         colorInfo,
         decodeInfo,
         outputImage);
 }
 
 DecoderStatus __stdcall DecompressAlphaImage(
+    DecoderSession* session,
     const uint8_t* compressedAlphaImage,
     size_t compressedAlphaImageSize,
     DecodeInfo* decodeInfo,
-    BitmapData* outputImage)
+    BitmapData* outputImage,
+    InstrumentationStatistics* statistics)
 {
+    Instrumentation::CallScope instrumentation(statistics);
+
+    const CompressedTileData segment{ compressedAlphaImage, compressedAlphaImageSize };
+
     return DecodeAlphaImage(
-        compressedAlphaImage,
-        compressedAlphaImageSize,
+        session,
+        &segment,
+        1,
+        decodeInfo,
+        outputImage);
+}
+
+DecoderStatus __stdcall DecompressColorImageSegments(
+    DecoderSession* session,
+    const CompressedTileData* segments,
+    uint32_t segmentCount,
+    const CICPColorData* colorInfo,
+    DecodeInfo* decodeInfo,
+    BitmapData* outputImage,
+    InstrumentationStatistics* statistics)
+{
+    Instrumentation::CallScope instrumentation(statistics);
+
+    return DecodeColorImage(
+        session,
+        segments,
+        segmentCount,
+        colorInfo,
         decodeInfo,
         outputImage);
 }
 
+DecoderStatus __stdcall DecompressAlphaImageSegments(
+    DecoderSession* session,
+    const CompressedTileData* segments,
+    uint32_t segmentCount,
+    DecodeInfo* decodeInfo,
+    BitmapData* outputImage,
+    InstrumentationStatistics* statistics)
+{
+    Instrumentation::CallScope instrumentation(statistics);
+
+    return DecodeAlphaImage(
+        session,
+        segments,
+        segmentCount,
+        decodeInfo,
+        outputImage);
+}
+
+DecoderStatus __stdcall DecompressColorImageGrid(
+    DecoderSession* session,
+    const CompressedTileData* tiles,
+    uint32_t tileColumnCount,
+    uint32_t tileRowCount,
+    const CICPColorData* colorInfo,
+    DecodeInfo* decodeInfo,
+    BitmapData* outputImage,
+    InstrumentationStatistics* statistics)
+{
+    Instrumentation::CallScope instrumentation(statistics);
+
+    return DecodeColorImageGrid(
+        session,
+        tiles,
+        tileColumnCount,
+        tileRowCount,
+        colorInfo,
+        decodeInfo,
+        outputImage);
+}
+
+DecoderStatus __stdcall DecompressAlphaImageGrid(
+    DecoderSession* session,
+    const CompressedTileData* tiles,
+    uint32_t tileColumnCount,
+    uint32_t tileRowCount,
+    DecodeInfo* decodeInfo,
+    BitmapData* outputImage,
+    InstrumentationStatistics* statistics)
+{
+    Instrumentation::CallScope instrumentation(statistics);
+
+    return DecodeAlphaImageGrid(
+        session,
+        tiles,
+        tileColumnCount,
+        tileRowCount,
+        decodeInfo,
+        outputImage);
+}
+
+DecoderStatus __stdcall DecompressColorAlphaImageGrid(
+    DecoderSession* session,
+    const CompressedTileData* colorTiles,
+    const CompressedTileData* alphaTiles,
+    uint32_t tileColumnCount,
+    uint32_t tileRowCount,
+    const CICPColorData* colorInfo,
+    DecodeInfo* colorDecodeInfo,
+    DecodeInfo* alphaDecodeInfo,
+    bool unpremultiplyAlpha,
+    BitmapData* outputImage,
+    InstrumentationStatistics* statistics)
+{
+    Instrumentation::CallScope instrumentation(statistics);
+
+    return DecodeColorAlphaImageGrid(
+        session,
+        colorTiles,
+        alphaTiles,
+        tileColumnCount,
+        tileRowCount,
+        colorInfo,
+        colorDecodeInfo,
+        alphaDecodeInfo,
+        unpremultiplyAlpha,
+        outputImage);
+}
+
+EncoderSession* __stdcall CreateEncoderSession()
+{
+    return CreateAV1EncoderSession();
+}
+
+void __stdcall DestroyEncoderSession(EncoderSession* session)
+{
+    DestroyAV1EncoderSession(session);
+}
+
 EncoderStatus __stdcall CompressColorImage(
+    EncoderSession* session,
     const BitmapData* image,
     const EncoderOptions* encodeOptions,
     ProgressContext* progressContext,
     const CICPColorData& colorInfo,
     CompressedAV1OutputAlloc outputAllocator,
-    void** compressedColorImage)
+    void** compressedColorImage,
+    InstrumentationStatistics* statistics)
 {
-    if (!image || !encodeOptions || !progressContext || !outputAllocator || !compressedColorImage)
-    {
-        return EncoderStatus::NullParameter;
-    }
-
-    const YUVChromaSubsampling yuvFormat = encodeOptions->yuvFormat;
+    Instrumentation::CallScope instrumentation(statistics);
 
-    aom_img_fmt aomFormat;
-    switch (yuvFormat)
-    {
-    case YUVChromaSubsampling::Subsampling400:
-    case YUVChromaSubsampling::Subsampling420:
-        aomFormat = AOM_IMG_FMT_I420;
-        break;
-    case YUVChromaSubsampling::Subsampling422:
-        aomFormat = AOM_IMG_FMT_I422;
-        break;
-    case YUVChromaSubsampling::Subsampling444:
-    case YUVChromaSubsampling::IdentityMatrix:
-        aomFormat = AOM_IMG_FMT_I444;
-        break;
-    default:
-        return EncoderStatus::UnknownYUVFormat;
-    }
-
-    AvifNative::ScopedAOMImage color(ConvertColorToAOMImage(image, colorInfo, yuvFormat, aomFormat));
-    if (!color)
-    {
-        return EncoderStatus::OutOfMemory;
-    }
-
-    return CompressAOMColorImage(color.get(), encodeOptions, progressContext, outputAllocator, compressedColorImage);
+    return CompressAOMColorImage(
+        session,
+        image,
+        encodeOptions,
+        progressContext,
+        colorInfo,
+        outputAllocator,
+        compressedColorImage);
 }
 
 EncoderStatus __stdcall CompressAlphaImage(
+    EncoderSession* session,
     const BitmapData* image,
     const EncoderOptions* encodeOptions,
     ProgressContext* progressContext,
     CompressedAV1OutputAlloc outputAllocator,
-    void** compressedAlphaImage)
+    void** compressedAlphaImage,
+    InstrumentationStatistics* statistics)
+{
+    Instrumentation::CallScope instrumentation(statistics);
+
+    return CompressAOMAlphaImage(
+        session,
+        image,
+        encodeOptions,
+        progressContext,
+        outputAllocator,
+        compressedAlphaImage);
+}
+
+EncoderStatus __stdcall CompressImageGrid(
+    EncoderSession* session,
+    const TileEncodeInfo* tiles,
+    uint32_t tileCount,
+    const EncoderOptions* encodeOptions,
+    ProgressContext* progressContext,
+    const CICPColorData& colorInfo,
+    CompressedAV1OutputAlloc outputAllocator,
+    void** compressedColorImages,
+    void** compressedAlphaImages,
+    InstrumentationStatistics* statistics)
+{
+    Instrumentation::CallScope instrumentation(statistics);
+
+    return CompressAOMImageGrid(
+        session,
+        tiles,
+        tileCount,
+        encodeOptions,
+        progressContext,
+        colorInfo,
+        outputAllocator,
+        compressedColorImages,
+        compressedAlphaImages);
+}
+
+bool __stdcall MemoryBlocksAreEqual(const void* buffer1, const void* buffer2, size_t size)
 {
-    if (!image || !encodeOptions || !progressContext || !outputAllocator || !compressedAlphaImage)
+    return std::memcmp(buffer1, buffer2, size) == 0;
+}
+
+EncoderStatus __stdcall HashImageTiles(
+    const BitmapData* tiles,
+    uint32_t tileCount,
+    uint32_t maxThreads,
+    uint64_t* hashes)
+{
+    if (!tiles || !hashes)
     {
         return EncoderStatus::NullParameter;
     }
 
-    AvifNative::ScopedAOMImage alpha(ConvertAlphaToAOMImage(image));
-    if (!alpha)
-    {
-        return EncoderStatus::OutOfMemory;
-    }
+    return ParallelFor<EncoderStatus>(
+        tileCount,
+        GetWorkerThreadCount(tileCount, maxThreads),
+        [&](uint32_t index)
+        {
+            hashes[index] = HashBitmapPixels(tiles[index]);
 
-    return CompressAOMAlphaImage(alpha.get(), encodeOptions, progressContext, outputAllocator, compressedAlphaImage);
+            return EncoderStatus::Ok;
+        });
 }
 
-bool __stdcall MemoryBlocksAreEqual(const void* buffer1, const void* buffer2, size_t size)
+uint64_t __stdcall HashMemoryBlock(const void* buffer, size_t size)
 {
-    return std::memcmp(buffer1, buffer2, size) == 0;
+    return HashBuffer(buffer, size);
+}
+
+EncoderStatus __stdcall AnalyzeImageTiles(
+    const BitmapData* tiles,
+    uint32_t tileCount,
+    uint32_t maxThreads,
+    TileAnalysis* results)
+{
+    return AnalyzeTiles(tiles, tileCount, maxThreads, results);
+}
+
+bool __stdcall VerifyImageConverters()
+{
+    return VerifyDecodedImageRowConverters() && VerifyColorToYUVRowConverters();
+}
+
+void __stdcall SetInstrumentationEnabled(bool enabled)
+{
+    Instrumentation::SetEnabled(enabled);
+}
+
+void __stdcall ResetInstrumentationStatistics()
+{
+    Instrumentation::Reset();
+}
+
+void __stdcall GetInstrumentationStatistics(InstrumentationStatistics* statistics)
+{
+    if (statistics)
+    {
+        Instrumentation::GetStatistics(*statistics);
+    }
 }
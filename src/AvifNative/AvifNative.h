@@ -47,7 +47,8 @@ extern "C" {
         UnknownYUVFormat,
         CodecInitFailed,
         EncodeFailed,
-        UserCancelled
+        UserCancelled,
+        UnsupportedBitDepth
     };
 
     enum class DecoderStatus
@@ -62,7 +63,17 @@ extern "C" {
         TileNclxProfileMismatch,
         UnsupportedBitDepth,
         UnknownYUVFormat,
-        TileFormatMismatch
+        TileFormatMismatch,
+        UnsupportedDownscaleFactor
+    };
+
+    // This must be kept in sync with BitmapPixelFormat.cs
+    enum class BitmapPixelFormat
+    {
+        // 8 bits per channel, the pixels are stored as ColorBgra.
+        Bgra32,
+        // 16 bits per channel, the pixels are stored as ColorBgra64.
+        Bgra64
     };
 
     // This must be kept in sync with EncoderOptions.cs
@@ -73,6 +84,17 @@ extern "C" {
         CompressionSpeed compressionSpeed;
         YUVChromaSubsampling yuvFormat;
         int32_t maxThreads;
+        // The maximum number of threads used to convert the image to YUV, values less than 2 use the calling thread.
+        int32_t maxConversionThreads;
+        // Allows the encoder to split the image into AV1 tiles that are encoded in parallel,
+        // the tile layout is chosen from the thread count and the image size.
+        bool enableInternalTiling;
+        // Disables the intra coding tools that have the highest cost relative to their compression gain.
+        bool reducedIntraTools;
+        // The bit depth of the AV1 image, 8, 10 or 12. Zero selects 8.
+        uint32_t bitDepth;
+        // Premultiplies the color by the alpha channel when the color image is converted to YUV.
+        bool premultiplyAlpha;
     };
 
     struct CICPColorData
@@ -92,14 +114,25 @@ extern "C" {
         YUVChromaSubsampling chromaSubsampling;
         uint32_t bitDepth;
         CICPColorData firstTileColorData;
+        // The maximum number of threads used to convert the decoded image, values less than 2 use the calling thread.
+        uint32_t maxConversionThreads;
+        // The decoded image is downscaled by a factor of (1 << downscaleShift) when it is converted to BGRA,
+        // the output image must be the downscaled size. The maximum value is 3.
+        uint32_t downscaleShift;
+        // The maximum number of threads used by the AV1 decoder, values less than 2 decode on the calling thread.
+        // The threads are split between the tiles of an image grid that are decoded at the same time.
+        uint32_t maxDecoderThreads;
     };
 
+    // This must be kept in sync with BitmapData.cs
     struct BitmapData
     {
         uint8_t* scan0;
         uint32_t width;
         uint32_t height;
         uint32_t stride;
+        // The image analysis functions only support Bgra32 images.
+        BitmapPixelFormat pixelFormat;
     };
 
     struct ColorBgra
@@ -110,6 +143,21 @@ extern "C" {
         uint8_t a;
     };
 
+    struct ColorBgra64
+    {
+        uint16_t b;
+        uint16_t g;
+        uint16_t r;
+        uint16_t a;
+    };
+
+    // This must be kept in sync with CompressedTileData.cs
+    struct CompressedTileData
+    {
+        const uint8_t* data;
+        size_t size;
+    };
+
     typedef bool(__stdcall* ProgressProc)(uint32_t done, uint32_t total);
 
     struct ProgressContext
@@ -119,41 +167,230 @@ extern "C" {
         uint32_t progressTotal;
     };
 
+    // This must be kept in sync with TileEncodeInfo.cs
+    struct TileEncodeInfo
+    {
+        BitmapData image;
+        // Tiles that are duplicates of a previous tile do not need to be encoded.
+        bool encodeColor;
+        bool encodeAlpha;
+    };
+
+    // This must be kept in sync with TileAnalysis.cs
+    struct TileAnalysis
+    {
+        // The first pixel of the tile, stored as a little-endian BGRA value.
+        uint32_t firstPixel;
+        // All of the pixels have the same B, G and R values.
+        bool isGrayscale;
+        // At least one pixel has an alpha value that is less than 255.
+        bool hasTransparency;
+        // All of the pixels have the same B, G and R values as the first pixel.
+        bool isHomogeneousColor;
+        // All of the pixels have the same alpha value as the first pixel.
+        bool isHomogeneousAlpha;
+    };
+
+    // This must be kept in sync with InstrumentationStatistics.cs
+    // The times are in nanoseconds, the statistics include every image that was encoded or decoded
+    // by the calls that they were collected for.
+    struct InstrumentationStatistics
+    {
+        // The time spent converting the BGRA images to YUV before they are encoded.
+        uint64_t colorConversionTime;
+        // The time spent in aom_codec_encode.
+        uint64_t encodeTime;
+        // The time spent allocating the output buffers and copying the compressed data into them.
+        uint64_t outputCopyTime;
+        // The time spent in the progress callback.
+        uint64_t progressCallbackTime;
+        uint64_t progressCallbackCount;
+        // The time spent in aom_codec_decode.
+        uint64_t decodeTime;
+        // The time spent converting the decoded YUV images to BGRA.
+        uint64_t decodedImageConversionTime;
+        // The size of the output buffers, encoder image planes and decoder frame buffers that were allocated.
+        uint64_t bytesAllocated;
+        uint64_t encoderInitCount;
+        uint64_t decoderInitCount;
+        uint64_t imagesEncoded;
+        uint64_t imagesDecoded;
+        // The elapsed time of the image grid tiles that are encoded or decoded in parallel.
+        uint64_t parallelElapsedTime;
+        // The sum of the time that each worker thread spent encoding or decoding tiles.
+        uint64_t parallelWorkTime;
+        // The elapsed time multiplied by the number of worker threads, parallelWorkTime / parallelThreadTime
+        // is the thread utilization.
+        uint64_t parallelThreadTime;
+    };
+
     typedef void*(__stdcall* CompressedAV1OutputAlloc)(size_t sizeInBytes);
 
+    // An opaque handle to the decoder state that is shared between the images decoded by a caller.
+    struct DecoderSession;
+
+    __declspec(dllexport) DecoderSession* __stdcall CreateDecoderSession();
+
+    __declspec(dllexport) void __stdcall DestroyDecoderSession(DecoderSession* session);
+
     __declspec(dllexport) DecoderStatus __stdcall DecompressColorImage(
+        DecoderSession* session,
         const uint8_t* compressedColorImage,
         size_t compressedColorImageSize,
         const CICPColorData* colorInfo,
         DecodeInfo* decodeInfo,
-        BitmapData* outputImage);
+        BitmapData* outputImage,
+        InstrumentationStatistics* statistics);
 
     __declspec(dllexport) DecoderStatus __stdcall DecompressAlphaImage(
+        DecoderSession* session,
         const uint8_t* compressedAlphaImage,
         size_t compressedAlphaImageSize,
         DecodeInfo* decodeInfo,
-        BitmapData* outputImage);
+        BitmapData* outputImage,
+        InstrumentationStatistics* statistics);
+
+    // The segments contain the parts of an image that is stored in more than one extent,
+    // they are decoded as if they were one contiguous buffer.
+    __declspec(dllexport) DecoderStatus __stdcall DecompressColorImageSegments(
+        DecoderSession* session,
+        const CompressedTileData* segments,
+        uint32_t segmentCount,
+        const CICPColorData* colorInfo,
+        DecodeInfo* decodeInfo,
+        BitmapData* outputImage,
+        InstrumentationStatistics* statistics);
 
+    // The segments contain the parts of an image that is stored in more than one extent,
+    // they are decoded as if they were one contiguous buffer.
+    __declspec(dllexport) DecoderStatus __stdcall DecompressAlphaImageSegments(
+        DecoderSession* session,
+        const CompressedTileData* segments,
+        uint32_t segmentCount,
+        DecodeInfo* decodeInfo,
+        BitmapData* outputImage,
+        InstrumentationStatistics* statistics);
+
+    // The tiles are stored from left to right then top to bottom.
+    __declspec(dllexport) DecoderStatus __stdcall DecompressColorImageGrid(
+        DecoderSession* session,
+        const CompressedTileData* tiles,
+        uint32_t tileColumnCount,
+        uint32_t tileRowCount,
+        const CICPColorData* colorInfo,
+        DecodeInfo* decodeInfo,
+        BitmapData* outputImage,
+        InstrumentationStatistics* statistics);
+
+    // The tiles are stored from left to right then top to bottom.
+    __declspec(dllexport) DecoderStatus __stdcall DecompressAlphaImageGrid(
+        DecoderSession* session,
+        const CompressedTileData* tiles,
+        uint32_t tileColumnCount,
+        uint32_t tileRowCount,
+        DecodeInfo* decodeInfo,
+        BitmapData* outputImage,
+        InstrumentationStatistics* statistics);
+
+    // The color and alpha tiles are stored from left to right then top to bottom, each alpha tile
+    // is converted into the output image together with the color tile at the same index.
+    // The color is un-premultiplied if unpremultiplyAlpha is true.
+    __declspec(dllexport) DecoderStatus __stdcall DecompressColorAlphaImageGrid(
+        DecoderSession* session,
+        const CompressedTileData* colorTiles,
+        const CompressedTileData* alphaTiles,
+        uint32_t tileColumnCount,
+        uint32_t tileRowCount,
+        const CICPColorData* colorInfo,
+        DecodeInfo* colorDecodeInfo,
+        DecodeInfo* alphaDecodeInfo,
+        bool unpremultiplyAlpha,
+        BitmapData* outputImage,
+        InstrumentationStatistics* statistics);
+
+    // An opaque handle to the encoder state that is shared between the images encoded by a caller.
+    // A session must not be used by more than one thread at a time.
+    struct EncoderSession;
+
+    __declspec(dllexport) EncoderSession* __stdcall CreateEncoderSession();
+
+    __declspec(dllexport) void __stdcall DestroyEncoderSession(EncoderSession* session);
+
+    // The session parameter is optional, when it is null a new encoder will be created for the image.
     __declspec(dllexport) EncoderStatus __stdcall CompressColorImage(
+        EncoderSession* session,
         const BitmapData* bitmap,
         const EncoderOptions* encodeOptions,
         ProgressContext* progressContext,
         const CICPColorData& colorInfo,
         CompressedAV1OutputAlloc outputAllocator,
-        void** compressedColorImage);
+        void** compressedColorImage,
+        InstrumentationStatistics* statistics);
 
+    // The session parameter is optional, when it is null a new encoder will be created for the image.
     __declspec(dllexport) EncoderStatus __stdcall CompressAlphaImage(
+        EncoderSession* session,
         const BitmapData* bitmap,
         const EncoderOptions* encodeOptions,
         ProgressContext* progressContext,
         CompressedAV1OutputAlloc outputAllocator,
-        void** compressedAlphaImage);
+        void** compressedAlphaImage,
+        InstrumentationStatistics* statistics);
+
+    // The tiles are stored from left to right then top to bottom.
+    // The tile images are encoded concurrently and the compressed data for each tile is placed at
+    // the same index in the output arrays, tiles that are not encoded will have a null output.
+    // The compressedAlphaImages parameter is optional if no tile has encodeAlpha set.
+    __declspec(dllexport) EncoderStatus __stdcall CompressImageGrid(
+        EncoderSession* session,
+        const TileEncodeInfo* tiles,
+        uint32_t tileCount,
+        const EncoderOptions* encodeOptions,
+        ProgressContext* progressContext,
+        const CICPColorData& colorInfo,
+        CompressedAV1OutputAlloc outputAllocator,
+        void** compressedColorImages,
+        void** compressedAlphaImages,
+        InstrumentationStatistics* statistics);
 
     __declspec(dllexport) bool __stdcall MemoryBlocksAreEqual(
         const void* buffer1,
         const void* buffer2,
         size_t size);
 
+    // Computes a hash of the BGRA pixels in each tile, the tiles are hashed concurrently.
+    // The hashes are only used to find candidate duplicates, callers must compare the tiles to confirm a match.
+    __declspec(dllexport) EncoderStatus __stdcall HashImageTiles(
+        const BitmapData* tiles,
+        uint32_t tileCount,
+        uint32_t maxThreads,
+        uint64_t* hashes);
+
+    // The hash is only used to find candidate duplicates, callers must compare the data to confirm a match.
+    __declspec(dllexport) uint64_t __stdcall HashMemoryBlock(
+        const void* buffer,
+        size_t size);
+
+    // Computes the grayscale, transparency and homogeneous color/alpha state of each tile in a single pass.
+    // The tiles are split into row bands that are analyzed concurrently.
+    __declspec(dllexport) EncoderStatus __stdcall AnalyzeImageTiles(
+        const BitmapData* tiles,
+        uint32_t tileCount,
+        uint32_t maxThreads,
+        TileAnalysis* results);
+
+    // A diagnostic function that checks that the vectorized image converters produce the same output as the scalar code.
+    __declspec(dllexport) bool __stdcall VerifyImageConverters();
+
+    // The encode and decode functions add the statistics of the call to their optional statistics parameter.
+    // The process-wide totals are disabled by default, when they are enabled the statistics of every call are
+    // also added to the totals.
+    __declspec(dllexport) void __stdcall SetInstrumentationEnabled(bool enabled);
+
+    __declspec(dllexport) void __stdcall ResetInstrumentationStatistics();
+
+    __declspec(dllexport) void __stdcall GetInstrumentationStatistics(InstrumentationStatistics* statistics);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
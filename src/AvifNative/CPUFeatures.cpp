@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "CPUFeatures.h"
+
+#if defined(_M_IX86) || defined(_M_X64)
+#include <intrin.h>
+
+namespace
+{
+    struct CPUFeatures
+    {
+        bool sse41;
+        bool avx2;
+
+        CPUFeatures() : sse41(false), avx2(false)
+        {
+            int info[4];
+
+            __cpuid(info, 0);
+            const int maxFunctionId = info[0];
+
+            if (maxFunctionId >= 1)
+            {
+                __cpuid(info, 1);
+
+                sse41 = (info[2] & (1 << 19)) != 0;
+
+                const bool osUsesXSave = (info[2] & (1 << 27)) != 0;
+                const bool avx = (info[2] & (1 << 28)) != 0;
+
+                if (osUsesXSave && avx && maxFunctionId >= 7)
+                {
+                    // The OS must save the XMM and YMM registers on a context switch.
+                    const unsigned long long xcr0 = _xgetbv(0);
+
+                    if ((xcr0 & 0x6) == 0x6)
+                    {
+                        __cpuidex(info, 7, 0);
+
+                        avx2 = (info[1] & (1 << 5)) != 0;
+                    }
+                }
+            }
+        }
+    };
+
+    const CPUFeatures& GetCPUFeatures()
+    {
+        static const CPUFeatures features;
+
+        return features;
+    }
+}
+
+bool HasSSE41()
+{
+    return GetCPUFeatures().sse41;
+}
+
+bool HasAVX2()
+{
+    return GetCPUFeatures().avx2;
+}
+#endif
@@ -0,0 +1,20 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#if defined(_M_IX86) || defined(_M_X64)
+bool HasSSE41();
+
+// Returns true if both the CPU and OS support AVX2.
+bool HasAVX2();
+#endif
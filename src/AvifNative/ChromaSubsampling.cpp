@@ -40,9 +40,14 @@
 #include <stdint.h>
 #include <math.h>
 #include "ChromaSubsampling.h"
+#include "ColorToYUVRowConverters.h"
+#include "CPUFeatures.h"
 #include "Memory.h"
+#include "ParallelFor.h"
 #include "YUVConversionHelpers.h"
 #include <array>
+#include <limits>
+#include <vector>
 
 namespace
 {
@@ -72,7 +77,8 @@ namespace
         return floorf(v + 0.5f);
     }
 
-    uint8_t yuvToUNorm(YuvChannel chan, float v)
+    template <typename TSample>
+    TSample yuvToUNorm(YuvChannel chan, float v, float maxSample)
     {
         if (chan != YuvChannel::Y)
         {
@@ -88,7 +94,7 @@ namespace
             v = 1.0f;
         }
 
-        return static_cast<uint8_t>(avifRoundf(v * 255.0f));
+        return static_cast<TSample>(avifRoundf(v * maxSample));
     }
 
     uint32_t GetUVHeight(uint32_t imageHeight, aom_img_fmt_t aomFormat)
@@ -125,30 +131,155 @@ namespace
         return table;
     }
 
-    void ColorToIdentity8(
+    static constexpr std::array<float, 256> uint8ToFloatTable = BuildUint8ToFloatLookupTable();
+
+    // Unpacks a channel into normalized float.
+    float ChannelToFloat(uint8_t value)
+    {
+        return uint8ToFloatTable[value];
+    }
+
+    float ChannelToFloat(uint16_t value)
+    {
+        return static_cast<float>(value) / 65535.0f;
+    }
+
+    // Scales a channel value to the range of the output samples.
+    template <typename TSample, typename TChannel>
+    TSample ScaleChannel(TChannel value, uint32_t maxSample)
+    {
+        constexpr uint32_t maxChannel = std::numeric_limits<TChannel>::max();
+
+        if (maxSample == maxChannel)
+        {
+            return static_cast<TSample>(value);
+        }
+
+        return static_cast<TSample>(((static_cast<uint32_t>(value) * maxSample) + (maxChannel / 2)) / maxChannel);
+    }
+
+    uint32_t GetMaxSample(uint32_t bitDepth)
+    {
+        return (1U << bitDepth) - 1;
+    }
+
+    // The Identity matrix and monochrome converters copy or scale the channel values, the vectorized
+    // converters are used for the 8-bit images and for the 16-bit per channel images that are encoded
+    // at 10 or 12 bits, the other combinations return zero.
+    uint32_t ConvertIdentityRowVectorized(
+        const ColorToYUVRowConverters& rowConverters,
+        const ColorBgra* srcPtr,
+        uint32_t width,
+        uint32_t,
+        uint8_t* yPtr,
+        uint8_t* uPtr,
+        uint8_t* vPtr)
+    {
+        return rowConverters.identity ? rowConverters.identity(srcPtr, width, yPtr, uPtr, vPtr) : 0;
+    }
+
+    uint32_t ConvertIdentityRowVectorized(
+        const ColorToYUVRowConverters& rowConverters,
+        const ColorBgra64* srcPtr,
+        uint32_t width,
+        uint32_t maxSample,
+        uint16_t* yPtr,
+        uint16_t* uPtr,
+        uint16_t* vPtr)
+    {
+        if (!rowConverters.identityHighBitDepth || maxSample >= 65535)
+        {
+            return 0;
+        }
+
+        return rowConverters.identityHighBitDepth(srcPtr, width, maxSample, yPtr, uPtr, vPtr);
+    }
+
+    template <typename TPixel, typename TSample>
+    uint32_t ConvertIdentityRowVectorized(
+        const ColorToYUVRowConverters&,
+        const TPixel*,
+        uint32_t,
+        uint32_t,
+        TSample*,
+        TSample*,
+        TSample*)
+    {
+        return 0;
+    }
+
+    uint32_t ConvertMonoRowVectorized(
+        const ColorToYUVRowConverters& rowConverters,
+        const ColorBgra* srcPtr,
+        uint32_t width,
+        uint32_t,
+        uint8_t* yPtr)
+    {
+        return rowConverters.mono ? rowConverters.mono(srcPtr, width, yPtr) : 0;
+    }
+
+    uint32_t ConvertMonoRowVectorized(
+        const ColorToYUVRowConverters& rowConverters,
+        const ColorBgra64* srcPtr,
+        uint32_t width,
+        uint32_t maxSample,
+        uint16_t* yPtr)
+    {
+        if (!rowConverters.monoHighBitDepth || maxSample >= 65535)
+        {
+            return 0;
+        }
+
+        return rowConverters.monoHighBitDepth(srcPtr, width, maxSample, yPtr);
+    }
+
+    template <typename TPixel, typename TSample>
+    uint32_t ConvertMonoRowVectorized(
+        const ColorToYUVRowConverters&,
+        const TPixel*,
+        uint32_t,
+        uint32_t,
+        TSample*)
+    {
+        return 0;
+    }
+
+    template <typename TPixel, typename TSample>
+    void ColorToIdentity(
         const BitmapData* bgraImage,
-        uint8_t* yPlane,
+        uint32_t bitDepth,
+        const ColorToYUVRowConverters& rowConverters,
+        TSample* yPlane,
         size_t yPlaneStride,
-        uint8_t* uPlane,
+        TSample* uPlane,
         size_t uPlaneStride,
-        uint8_t* vPlane,
+        TSample* vPlane,
         size_t vPlaneStride)
     {
+        const uint32_t maxSample = GetMaxSample(bitDepth);
+
         for (size_t y = 0; y < bgraImage->height; ++y)
         {
-            const ColorBgra* src = reinterpret_cast<const ColorBgra*>(bgraImage->scan0 + (y * bgraImage->stride));
-            uint8_t* dstY = &yPlane[y * yPlaneStride];
-            uint8_t* dstU = &uPlane[y * uPlaneStride];
-            uint8_t* dstV = &vPlane[y * vPlaneStride];
+            const TPixel* src = reinterpret_cast<const TPixel*>(bgraImage->scan0 + (y * bgraImage->stride));
+            TSample* dstY = &yPlane[y * yPlaneStride];
+            TSample* dstU = &uPlane[y * uPlaneStride];
+            TSample* dstV = &vPlane[y * vPlaneStride];
+
+            const uint32_t startX = ConvertIdentityRowVectorized(rowConverters, src, bgraImage->width, maxSample, dstY, dstU, dstV);
+
+            src += startX;
+            dstY += startX;
+            dstU += startX;
+            dstV += startX;
 
-            for (size_t x = 0; x < bgraImage->width; ++x)
+            for (size_t x = startX; x < bgraImage->width; ++x)
             {
                 // RGB -> Identity GBR conversion
                 // Formulas 41-43 from https://www.itu.int/rec/T-REC-H.273-201612-I/en
 
-                *dstY = src->g;
-                *dstU = src->b;
-                *dstV = src->r;
+                *dstY = ScaleChannel<TSample>(src->g, maxSample);
+                *dstU = ScaleChannel<TSample>(src->b, maxSample);
+                *dstV = ScaleChannel<TSample>(src->r, maxSample);
 
                 ++src;
                 ++dstY;
@@ -158,17 +289,130 @@ namespace
         }
     }
 
-    void ColorToYUV8(
+    RGBToYUVRowConstants GetRowConstants(const YUVCoefficiants& yuvCoefficiants, uint32_t bitDepth)
+    {
+        const float kr = yuvCoefficiants.kr;
+        const float kg = yuvCoefficiants.kg;
+        const float kb = yuvCoefficiants.kb;
+
+        RGBToYUVRowConstants constants{};
+        constants.kr = kr;
+        constants.kg = kg;
+        constants.kb = kb;
+        constants.uDivisor = 2 * (1 - kb);
+        constants.vDivisor = 2 * (1 - kr);
+        constants.maxSample = static_cast<float>(GetMaxSample(bitDepth));
+
+        return constants;
+    }
+
+    // Converts the start of a 4:4:4 or 4:2:2 row with the vectorized converters and returns the number
+    // of pixels that were converted, the pixel and sample types without a vectorized converter return zero.
+    uint32_t ConvertRowVectorized(
+        const ColorToYUVRowConverters& rowConverters,
+        YUVChromaSubsampling yuvFormat,
+        const ColorBgra* srcPtr,
+        uint32_t width,
+        const RGBToYUVRowConstants& constants,
+        uint8_t* yPtr,
+        uint8_t* uPtr,
+        uint8_t* vPtr)
+    {
+        const ColorToYUV444RowProc rowConverter = yuvFormat == YUVChromaSubsampling::Subsampling444 ? rowConverters.yuv444 : rowConverters.yuv422;
+
+        return rowConverter ? rowConverter(srcPtr, width, constants, yPtr, uPtr, vPtr) : 0;
+    }
+
+    uint32_t ConvertRowVectorized(
+        const ColorToYUVRowConverters& rowConverters,
+        YUVChromaSubsampling yuvFormat,
+        const ColorBgra64* srcPtr,
+        uint32_t width,
+        const RGBToYUVRowConstants& constants,
+        uint16_t* yPtr,
+        uint16_t* uPtr,
+        uint16_t* vPtr)
+    {
+        const ColorToYUV444HighBitDepthRowProc rowConverter = yuvFormat == YUVChromaSubsampling::Subsampling444 ? rowConverters.yuv444HighBitDepth : rowConverters.yuv422HighBitDepth;
+
+        return rowConverter ? rowConverter(srcPtr, width, constants, yPtr, uPtr, vPtr) : 0;
+    }
+
+    template <typename TPixel, typename TSample>
+    uint32_t ConvertRowVectorized(
+        const ColorToYUVRowConverters&,
+        YUVChromaSubsampling,
+        const TPixel*,
+        uint32_t,
+        const RGBToYUVRowConstants&,
+        TSample*,
+        TSample*,
+        TSample*)
+    {
+        return 0;
+    }
+
+    uint32_t ConvertRows420Vectorized(
+        const ColorToYUVRowConverters& rowConverters,
+        const ColorBgra* srcPtr0,
+        const ColorBgra* srcPtr1,
+        uint32_t width,
+        const RGBToYUVRowConstants& constants,
+        uint8_t* yPtr0,
+        uint8_t* yPtr1,
+        uint8_t* uPtr,
+        uint8_t* vPtr)
+    {
+        return rowConverters.yuv420 ? rowConverters.yuv420(srcPtr0, srcPtr1, width, constants, yPtr0, yPtr1, uPtr, vPtr) : 0;
+    }
+
+    uint32_t ConvertRows420Vectorized(
+        const ColorToYUVRowConverters& rowConverters,
+        const ColorBgra64* srcPtr0,
+        const ColorBgra64* srcPtr1,
+        uint32_t width,
+        const RGBToYUVRowConstants& constants,
+        uint16_t* yPtr0,
+        uint16_t* yPtr1,
+        uint16_t* uPtr,
+        uint16_t* vPtr)
+    {
+        return rowConverters.yuv420HighBitDepth ? rowConverters.yuv420HighBitDepth(srcPtr0, srcPtr1, width, constants, yPtr0, yPtr1, uPtr, vPtr) : 0;
+    }
+
+    template <typename TPixel, typename TSample>
+    uint32_t ConvertRows420Vectorized(
+        const ColorToYUVRowConverters&,
+        const TPixel*,
+        const TPixel*,
+        uint32_t,
+        const RGBToYUVRowConstants&,
+        TSample*,
+        TSample*,
+        TSample*,
+        TSample*)
+    {
+        return 0;
+    }
+
+    template <typename TPixel, typename TSample, YUVChromaSubsampling yuvFormat>
+    void ColorToYUV(
         const BitmapData* bgraImage,
         const CICPColorData& colorInfo,
-        YUVChromaSubsampling yuvFormat,
-        uint8_t* yPlane,
+        uint32_t bitDepth,
+        const ColorToYUVRowConverters& rowConverters,
+        TSample* yPlane,
         size_t yPlaneStride,
-        uint8_t* uPlane,
+        TSample* uPlane,
         size_t uPlaneStride,
-        uint8_t* vPlane,
+        TSample* vPlane,
         size_t vPlaneStride)
     {
+        static_assert(yuvFormat == YUVChromaSubsampling::Subsampling420 ||
+                      yuvFormat == YUVChromaSubsampling::Subsampling422 ||
+                      yuvFormat == YUVChromaSubsampling::Subsampling444,
+                      "yuvFormat must be 4:2:0, 4:2:2 or 4:4:4.");
+
         YUVCoefficiants yuvCoefficiants;
         GetYUVCoefficiants(colorInfo, yuvCoefficiants);
 
@@ -176,16 +420,57 @@ namespace
         const float kg = yuvCoefficiants.kg;
         const float kb = yuvCoefficiants.kb;
 
+        const RGBToYUVRowConstants rowConstants = GetRowConstants(yuvCoefficiants, bitDepth);
+        const float maxSample = rowConstants.maxSample;
+
         YUVBlock yuvBlock[2][2];
         ColorRgb24Float rgbPixel;
 
-        static constexpr std::array<float, 256> uint8ToFloatTable = BuildUint8ToFloatLookupTable();
-
         for (size_t imageY = 0; imageY < bgraImage->height; imageY += 2)
         {
             const size_t blockHeight = (imageY + 1) < bgraImage->height ? 2 : 1;
 
-            for (size_t imageX = 0; imageX < bgraImage->width; imageX += 2)
+            // The vectorized converters process the start of the rows, the remaining pixels
+            // are converted using the 2x2 blocks below.
+            size_t startX = 0;
+
+            if constexpr (yuvFormat == YUVChromaSubsampling::Subsampling420)
+            {
+                if (blockHeight == 2)
+                {
+                    const size_t uvY = imageY >> 1;
+
+                    startX = ConvertRows420Vectorized(
+                        rowConverters,
+                        reinterpret_cast<const TPixel*>(bgraImage->scan0 + (imageY * bgraImage->stride)),
+                        reinterpret_cast<const TPixel*>(bgraImage->scan0 + ((imageY + 1) * bgraImage->stride)),
+                        bgraImage->width,
+                        rowConstants,
+                        &yPlane[imageY * yPlaneStride],
+                        &yPlane[(imageY + 1) * yPlaneStride],
+                        &uPlane[uvY * uPlaneStride],
+                        &vPlane[uvY * vPlaneStride]);
+                }
+            }
+            else
+            {
+                for (size_t blockY = 0; blockY < blockHeight; ++blockY)
+                {
+                    const size_t y = imageY + blockY;
+
+                    startX = ConvertRowVectorized(
+                        rowConverters,
+                        yuvFormat,
+                        reinterpret_cast<const TPixel*>(bgraImage->scan0 + (y * bgraImage->stride)),
+                        bgraImage->width,
+                        rowConstants,
+                        &yPlane[y * yPlaneStride],
+                        &uPlane[y * uPlaneStride],
+                        &vPlane[y * vPlaneStride]);
+                }
+            }
+
+            for (size_t imageX = startX; imageX < bgraImage->width; imageX += 2)
             {
                 const size_t blockWidth = (imageX + 1) < bgraImage->width ? 2 : 1;
 
@@ -199,11 +484,11 @@ namespace
 
                         // Unpack RGB into normalized float
 
-                        const ColorBgra* pixel = reinterpret_cast<const ColorBgra*>(bgraImage->scan0 + (y * bgraImage->stride) + (x * sizeof(ColorBgra)));
+                        const TPixel* pixel = reinterpret_cast<const TPixel*>(bgraImage->scan0 + (y * bgraImage->stride) + (x * sizeof(TPixel)));
 
-                        rgbPixel.r = uint8ToFloatTable[pixel->r];
-                        rgbPixel.g = uint8ToFloatTable[pixel->g];
-                        rgbPixel.b = uint8ToFloatTable[pixel->b];
+                        rgbPixel.r = ChannelToFloat(pixel->r);
+                        rgbPixel.g = ChannelToFloat(pixel->g);
+                        rgbPixel.b = ChannelToFloat(pixel->b);
 
                         // RGB -> YUV conversion
                         float Y = (kr * rgbPixel.r) + (kg * rgbPixel.g) + (kb * rgbPixel.b);
@@ -211,19 +496,19 @@ namespace
                         yuvBlock[blockX][blockY].u = (rgbPixel.b - Y) / (2 * (1 - kb));
                         yuvBlock[blockX][blockY].v = (rgbPixel.r - Y) / (2 * (1 - kr));
 
-                        yPlane[x + (y * yPlaneStride)] = yuvToUNorm(YuvChannel::Y, yuvBlock[blockX][blockY].y);
+                        yPlane[x + (y * yPlaneStride)] = yuvToUNorm<TSample>(YuvChannel::Y, yuvBlock[blockX][blockY].y, maxSample);
 
-                        if (yuvFormat == YUVChromaSubsampling::Subsampling444)
+                        if constexpr (yuvFormat == YUVChromaSubsampling::Subsampling444)
                         {
                             // YUV444, full chroma
-                            uPlane[x + (y * uPlaneStride)] = yuvToUNorm(YuvChannel::U, yuvBlock[blockX][blockY].u);
-                            vPlane[x + (y * vPlaneStride)] = yuvToUNorm(YuvChannel::V, yuvBlock[blockX][blockY].v);
+                            uPlane[x + (y * uPlaneStride)] = yuvToUNorm<TSample>(YuvChannel::U, yuvBlock[blockX][blockY].u, maxSample);
+                            vPlane[x + (y * vPlaneStride)] = yuvToUNorm<TSample>(YuvChannel::V, yuvBlock[blockX][blockY].v, maxSample);
                         }
                     }
                 }
 
                 // Populate any subsampled channels with averages from the 2x2 block
-                if (yuvFormat == YUVChromaSubsampling::Subsampling420)
+                if constexpr (yuvFormat == YUVChromaSubsampling::Subsampling420)
                 {
                     // YUV420, average 4 samples (2x2)
 
@@ -244,10 +529,10 @@ namespace
                     size_t x = imageX >> 1;
                     size_t y = imageY >> 1;
 
-                    uPlane[x + (y * uPlaneStride)] = yuvToUNorm(YuvChannel::U, avgU);
-                    vPlane[x + (y * vPlaneStride)] = yuvToUNorm(YuvChannel::V, avgV);
+                    uPlane[x + (y * uPlaneStride)] = yuvToUNorm<TSample>(YuvChannel::U, avgU, maxSample);
+                    vPlane[x + (y * vPlaneStride)] = yuvToUNorm<TSample>(YuvChannel::V, avgV, maxSample);
                 }
-                else if (yuvFormat == YUVChromaSubsampling::Subsampling422)
+                else if constexpr (yuvFormat == YUVChromaSubsampling::Subsampling422)
                 {
                     // YUV422, average 2 samples (1x2), twice
 
@@ -265,27 +550,37 @@ namespace
                         size_t x = imageX >> 1;
                         size_t y = imageY + blockY;
 
-                        uPlane[x + (y * uPlaneStride)] = yuvToUNorm(YuvChannel::U, avgU);
-                        vPlane[x + (y * vPlaneStride)] = yuvToUNorm(YuvChannel::V, avgV);
+                        uPlane[x + (y * uPlaneStride)] = yuvToUNorm<TSample>(YuvChannel::U, avgU, maxSample);
+                        vPlane[x + (y * vPlaneStride)] = yuvToUNorm<TSample>(YuvChannel::V, avgV, maxSample);
                     }
                 }
             }
         }
     }
 
-    void MonoToY8(
+    template <typename TPixel, typename TSample>
+    void MonoToY(
         const BitmapData* bgraImage,
-        uint8_t* yPlane,
+        uint32_t bitDepth,
+        const ColorToYUVRowConverters& rowConverters,
+        TSample* yPlane,
         size_t yPlaneStride)
     {
+        const uint32_t maxSample = GetMaxSample(bitDepth);
+
         for (uint32_t y = 0; y < bgraImage->height; ++y)
         {
-            const ColorBgra* src = reinterpret_cast<const ColorBgra*>(bgraImage->scan0 + (static_cast<size_t>(y) * bgraImage->stride));
-            uint8_t* dst = &yPlane[y * yPlaneStride];
+            const TPixel* src = reinterpret_cast<const TPixel*>(bgraImage->scan0 + (static_cast<size_t>(y) * bgraImage->stride));
+            TSample* dst = &yPlane[y * yPlaneStride];
 
-            for (uint32_t x = 0; x < bgraImage->width; ++x)
+            const uint32_t startX = ConvertMonoRowVectorized(rowConverters, src, bgraImage->width, maxSample, dst);
+
+            src += startX;
+            dst += startX;
+
+            for (uint32_t x = startX; x < bgraImage->width; ++x)
             {
-                *dst = src->r;
+                *dst = ScaleChannel<TSample>(src->r, maxSample);
 
                 src++;
                 dst++;
@@ -293,19 +588,23 @@ namespace
         }
     }
 
-    void AlphaToY8(
+    template <typename TPixel, typename TSample>
+    void AlphaToY(
         const BitmapData* bgraImage,
-        uint8_t* yPlane,
+        uint32_t bitDepth,
+        TSample* yPlane,
         size_t yPlaneStride)
     {
+        const uint32_t maxSample = GetMaxSample(bitDepth);
+
         for (uint32_t y = 0; y < bgraImage->height; ++y)
         {
-            const ColorBgra* src = reinterpret_cast<const ColorBgra*>(bgraImage->scan0 + (static_cast<size_t>(y) * bgraImage->stride));
-            uint8_t* dst = &yPlane[y * yPlaneStride];
+            const TPixel* src = reinterpret_cast<const TPixel*>(bgraImage->scan0 + (static_cast<size_t>(y) * bgraImage->stride));
+            TSample* dst = &yPlane[y * yPlaneStride];
 
             for (uint32_t x = 0; x < bgraImage->width; ++x)
             {
-                *dst = src->a;
+                *dst = ScaleChannel<TSample>(src->a, maxSample);
 
                 src++;
                 dst++;
@@ -313,6 +612,46 @@ namespace
         }
     }
 
+    // Rounds to the nearest value, this must match the rounding used by the homogeneous tile check in AvifFile.cs.
+    uint8_t PremultiplyChannel(uint8_t value, uint8_t alpha)
+    {
+        return static_cast<uint8_t>(((static_cast<uint32_t>(value) * alpha) + 127) / 255);
+    }
+
+    uint16_t PremultiplyChannel(uint16_t value, uint16_t alpha)
+    {
+        return static_cast<uint16_t>(((static_cast<uint32_t>(value) * alpha) + 32767) / 65535);
+    }
+
+    // Premultiplies a row into dst, the alpha samples are also written to alphaDst when extractAlpha is true.
+    template <bool extractAlpha, typename TPixel, typename TSample>
+    void PremultiplyRow(
+        const TPixel* src,
+        uint32_t width,
+        uint32_t maxAlphaSample,
+        TPixel* dst,
+        TSample* alphaDst)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            const auto alpha = src->a;
+
+            dst->b = PremultiplyChannel(src->b, alpha);
+            dst->g = PremultiplyChannel(src->g, alpha);
+            dst->r = PremultiplyChannel(src->r, alpha);
+            dst->a = alpha;
+
+            if constexpr (extractAlpha)
+            {
+                *alphaDst = ScaleChannel<TSample>(alpha, maxAlphaSample);
+                alphaDst++;
+            }
+
+            src++;
+            dst++;
+        }
+    }
+
     void ZeroUVPlanes(
         uint32_t uvHeight,
         uint8_t* uPlane,
@@ -327,35 +666,374 @@ namespace
             memset(&vPlane[y * vPlaneStride], 0, vPlaneStride);
         }
     }
-}
 
+    template <typename TPixel, typename TSample>
+    void ColorToYUV(
+        const BitmapData* bgraImage,
+        const CICPColorData& colorInfo,
+        YUVChromaSubsampling yuvFormat,
+        uint32_t bitDepth,
+        const ColorToYUVRowConverters& rowConverters,
+        TSample* yPlane,
+        size_t yPlaneStride,
+        TSample* uPlane,
+        size_t uPlaneStride,
+        TSample* vPlane,
+        size_t vPlaneStride)
+    {
+        switch (yuvFormat)
+        {
+        case YUVChromaSubsampling::Subsampling420:
+            ColorToYUV<TPixel, TSample, YUVChromaSubsampling::Subsampling420>(
+                bgraImage,
+                colorInfo,
+                bitDepth,
+                rowConverters,
+                yPlane,
+                yPlaneStride,
+                uPlane,
+                uPlaneStride,
+                vPlane,
+                vPlaneStride);
+            break;
+        case YUVChromaSubsampling::Subsampling422:
+            ColorToYUV<TPixel, TSample, YUVChromaSubsampling::Subsampling422>(
+                bgraImage,
+                colorInfo,
+                bitDepth,
+                rowConverters,
+                yPlane,
+                yPlaneStride,
+                uPlane,
+                uPlaneStride,
+                vPlane,
+                vPlaneStride);
+            break;
+        case YUVChromaSubsampling::Subsampling444:
+            ColorToYUV<TPixel, TSample, YUVChromaSubsampling::Subsampling444>(
+                bgraImage,
+                colorInfo,
+                bitDepth,
+                rowConverters,
+                yPlane,
+                yPlaneStride,
+                uPlane,
+                uPlaneStride,
+                vPlane,
+                vPlaneStride);
+            break;
+        default:
+            break;
+        }
+    }
 
-aom_image_t* ConvertColorToAOMImage(
-    const BitmapData* bgraImage,
-    const CICPColorData& colorInfo,
-    YUVChromaSubsampling yuvFormat,
-    aom_img_fmt aomFormat)
-{
-    aom_image_t* aomImage = aom_img_alloc(nullptr, aomFormat, bgraImage->width, bgraImage->height, 16);
-    if (!aomImage)
+    // Returns a BitmapData that contains the rows [startRow, endRow) of the image.
+    BitmapData GetImageRows(const BitmapData* image, uint32_t startRow, uint32_t endRow)
+    {
+        BitmapData rows{};
+        rows.scan0 = image->scan0 + (static_cast<size_t>(startRow) * image->stride);
+        rows.width = image->width;
+        rows.height = endRow - startRow;
+        rows.stride = image->stride;
+        rows.pixelFormat = image->pixelFormat;
+
+        return rows;
+    }
+
+    // Returns a pointer to the plane row that contains the specified image row.
+    template <typename TSample>
+    TSample* GetPlaneRows(const aom_image_t* image, int plane, uint32_t imageRow)
     {
-        return nullptr;
+        const uint32_t planeRow = plane == AOM_PLANE_Y ? imageRow : imageRow >> image->y_chroma_shift;
+
+        return reinterpret_cast<TSample*>(image->planes[plane] + (static_cast<size_t>(planeRow) * image->stride[plane]));
     }
 
-    aomImage->cp = static_cast<aom_color_primaries_t>(colorInfo.colorPrimaries);
-    aomImage->tc = static_cast<aom_transfer_characteristics_t>(colorInfo.transferCharacteristics);
-    aomImage->mc = static_cast<aom_matrix_coefficients_t>(colorInfo.matrixCoefficients);
-    aomImage->range = AOM_CR_FULL_RANGE;
-    aomImage->monochrome = yuvFormat == YUVChromaSubsampling::Subsampling400;
+    // Returns the plane stride in samples.
+    template <typename TSample>
+    size_t GetPlaneStride(const aom_image_t* image, int plane)
+    {
+        return static_cast<size_t>(image->stride[plane]) / sizeof(TSample);
+    }
 
-    if (aomImage->monochrome)
+    // Converts bandImage into the AOM image rows that start at startRow.
+    template <typename TPixel, typename TSample>
+    void ConvertColorBandToAOMImage(
+        const BitmapData* bandImage,
+        const CICPColorData& colorInfo,
+        YUVChromaSubsampling yuvFormat,
+        const ColorToYUVRowConverters& rowConverters,
+        uint32_t startRow,
+        aom_image_t* aomImage)
     {
-        MonoToY8(
-            bgraImage,
-            reinterpret_cast<uint8_t*>(aomImage->planes[AOM_PLANE_Y]),
-            static_cast<size_t>(aomImage->stride[AOM_PLANE_Y]));
+        const size_t yPlaneStride = GetPlaneStride<TSample>(aomImage, AOM_PLANE_Y);
+        const size_t uPlaneStride = GetPlaneStride<TSample>(aomImage, AOM_PLANE_U);
+        const size_t vPlaneStride = GetPlaneStride<TSample>(aomImage, AOM_PLANE_V);
+        const uint32_t bitDepth = aomImage->bit_depth;
 
-        const uint32_t uvHeight = GetUVHeight(bgraImage->height, aomFormat);
+        if (yuvFormat == YUVChromaSubsampling::Subsampling400)
+        {
+            MonoToY<TPixel>(
+                bandImage,
+                bitDepth,
+                rowConverters,
+                GetPlaneRows<TSample>(aomImage, AOM_PLANE_Y, startRow),
+                yPlaneStride);
+        }
+        else if (yuvFormat == YUVChromaSubsampling::IdentityMatrix)
+        {
+            // The IdentityMatrix format places the RGB values into the YUV planes
+            // without any conversion.
+            // This reduces the compression efficiency, but allows for fully lossless encoding.
+            ColorToIdentity<TPixel>(
+                bandImage,
+                bitDepth,
+                rowConverters,
+                GetPlaneRows<TSample>(aomImage, AOM_PLANE_Y, startRow),
+                yPlaneStride,
+                GetPlaneRows<TSample>(aomImage, AOM_PLANE_U, startRow),
+                uPlaneStride,
+                GetPlaneRows<TSample>(aomImage, AOM_PLANE_V, startRow),
+                vPlaneStride);
+        }
+        else
+        {
+            ColorToYUV<TPixel>(
+                bandImage,
+                colorInfo,
+                yuvFormat,
+                bitDepth,
+                rowConverters,
+                GetPlaneRows<TSample>(aomImage, AOM_PLANE_Y, startRow),
+                yPlaneStride,
+                GetPlaneRows<TSample>(aomImage, AOM_PLANE_U, startRow),
+                uPlaneStride,
+                GetPlaneRows<TSample>(aomImage, AOM_PLANE_V, startRow),
+                vPlaneStride);
+        }
+    }
+
+    template <typename TPixel, typename TSample>
+    void ConvertColorRowsToAOMImage(
+        const BitmapData* bgraImage,
+        const CICPColorData& colorInfo,
+        YUVChromaSubsampling yuvFormat,
+        const ColorToYUVRowConverters& rowConverters,
+        uint32_t startRow,
+        uint32_t endRow,
+        aom_image_t* aomImage)
+    {
+        const BitmapData bandImage = GetImageRows(bgraImage, startRow, endRow);
+
+        ConvertColorBandToAOMImage<TPixel, TSample>(&bandImage, colorInfo, yuvFormat, rowConverters, startRow, aomImage);
+    }
+
+    // The high bit depth AOM image formats store each sample in 16 bits.
+    bool IsHighBitDepthImage(const aom_image_t* aomImage)
+    {
+        return (aomImage->fmt & AOM_IMG_FMT_HIGHBITDEPTH) != 0;
+    }
+
+    void ConvertColorRowsToAOMImage(
+        const BitmapData* bgraImage,
+        const CICPColorData& colorInfo,
+        YUVChromaSubsampling yuvFormat,
+        const ColorToYUVRowConverters& rowConverters,
+        uint32_t startRow,
+        uint32_t endRow,
+        aom_image_t* aomImage)
+    {
+        if (bgraImage->pixelFormat == BitmapPixelFormat::Bgra64)
+        {
+            if (IsHighBitDepthImage(aomImage))
+            {
+                ConvertColorRowsToAOMImage<ColorBgra64, uint16_t>(bgraImage, colorInfo, yuvFormat, rowConverters, startRow, endRow, aomImage);
+            }
+            else
+            {
+                ConvertColorRowsToAOMImage<ColorBgra64, uint8_t>(bgraImage, colorInfo, yuvFormat, rowConverters, startRow, endRow, aomImage);
+            }
+        }
+        else
+        {
+            if (IsHighBitDepthImage(aomImage))
+            {
+                ConvertColorRowsToAOMImage<ColorBgra, uint16_t>(bgraImage, colorInfo, yuvFormat, rowConverters, startRow, endRow, aomImage);
+            }
+            else
+            {
+                ConvertColorRowsToAOMImage<ColorBgra, uint8_t>(bgraImage, colorInfo, yuvFormat, rowConverters, startRow, endRow, aomImage);
+            }
+        }
+    }
+
+    template <typename TPixel, typename TSample>
+    void ConvertAlphaRowsToAOMImage(
+        const BitmapData* bgraImage,
+        uint32_t startRow,
+        uint32_t endRow,
+        aom_image_t* aomImage)
+    {
+        const BitmapData bandImage = GetImageRows(bgraImage, startRow, endRow);
+
+        AlphaToY<TPixel>(
+            &bandImage,
+            aomImage->bit_depth,
+            GetPlaneRows<TSample>(aomImage, AOM_PLANE_Y, startRow),
+            GetPlaneStride<TSample>(aomImage, AOM_PLANE_Y));
+    }
+
+    void ConvertAlphaRowsToAOMImage(
+        const BitmapData* bgraImage,
+        uint32_t startRow,
+        uint32_t endRow,
+        aom_image_t* aomImage)
+    {
+        if (bgraImage->pixelFormat == BitmapPixelFormat::Bgra64)
+        {
+            if (IsHighBitDepthImage(aomImage))
+            {
+                ConvertAlphaRowsToAOMImage<ColorBgra64, uint16_t>(bgraImage, startRow, endRow, aomImage);
+            }
+            else
+            {
+                ConvertAlphaRowsToAOMImage<ColorBgra64, uint8_t>(bgraImage, startRow, endRow, aomImage);
+            }
+        }
+        else
+        {
+            if (IsHighBitDepthImage(aomImage))
+            {
+                ConvertAlphaRowsToAOMImage<ColorBgra, uint16_t>(bgraImage, startRow, endRow, aomImage);
+            }
+            else
+            {
+                ConvertAlphaRowsToAOMImage<ColorBgra, uint8_t>(bgraImage, startRow, endRow, aomImage);
+            }
+        }
+    }
+
+    // Returns the number of rows that are premultiplied into the scratch buffer before they are converted,
+    // the buffer is kept small enough to stay in the CPU cache.
+    uint32_t GetPremultipliedChunkHeight(uint32_t width, size_t pixelSize, uint32_t rowAlignment)
+    {
+        constexpr size_t targetChunkSize = 64 * 1024;
+
+        const size_t rowSize = static_cast<size_t>(width) * pixelSize;
+        uint32_t chunkHeight = rowSize < targetChunkSize ? static_cast<uint32_t>(targetChunkSize / rowSize) : 1;
+
+        // The rows that are averaged into a subsampled chroma row must be in the same chunk.
+        chunkHeight -= chunkHeight % rowAlignment;
+
+        return chunkHeight > rowAlignment ? chunkHeight : rowAlignment;
+    }
+
+    // Premultiplies the rows [startRow, endRow) into a scratch buffer and converts them to the color image,
+    // the alpha channel is written to the alpha image in the same pass when it is not null.
+    template <typename TPixel, typename TSample>
+    void ConvertPremultipliedRowsToAOMImages(
+        const BitmapData* bgraImage,
+        const CICPColorData& colorInfo,
+        YUVChromaSubsampling yuvFormat,
+        const ColorToYUVRowConverters& rowConverters,
+        uint32_t startRow,
+        uint32_t endRow,
+        aom_image_t* colorImage,
+        aom_image_t* alphaImage)
+    {
+        const uint32_t width = bgraImage->width;
+        const uint32_t chunkHeight = GetPremultipliedChunkHeight(width, sizeof(TPixel), 1U << colorImage->y_chroma_shift);
+        const uint32_t maxAlphaSample = alphaImage ? GetMaxSample(alphaImage->bit_depth) : 0;
+
+        std::vector<TPixel> scratch(static_cast<size_t>(width) * chunkHeight);
+
+        BitmapData chunkImage{};
+        chunkImage.scan0 = reinterpret_cast<uint8_t*>(scratch.data());
+        chunkImage.width = width;
+        chunkImage.stride = width * static_cast<uint32_t>(sizeof(TPixel));
+        chunkImage.pixelFormat = bgraImage->pixelFormat;
+
+        for (uint32_t chunkStart = startRow; chunkStart < endRow; chunkStart += chunkHeight)
+        {
+            const uint32_t chunkEnd = (endRow - chunkStart) > chunkHeight ? chunkStart + chunkHeight : endRow;
+
+            for (uint32_t y = chunkStart; y < chunkEnd; ++y)
+            {
+                const TPixel* src = reinterpret_cast<const TPixel*>(bgraImage->scan0 + (static_cast<size_t>(y) * bgraImage->stride));
+                TPixel* dst = &scratch[static_cast<size_t>(y - chunkStart) * width];
+
+                if (alphaImage)
+                {
+                    PremultiplyRow<true>(src, width, maxAlphaSample, dst, GetPlaneRows<TSample>(alphaImage, AOM_PLANE_Y, y));
+                }
+                else
+                {
+                    PremultiplyRow<false, TPixel, TSample>(src, width, maxAlphaSample, dst, nullptr);
+                }
+            }
+
+            chunkImage.height = chunkEnd - chunkStart;
+
+            ConvertColorBandToAOMImage<TPixel, TSample>(&chunkImage, colorInfo, yuvFormat, rowConverters, chunkStart, colorImage);
+        }
+    }
+
+    void ConvertPremultipliedRowsToAOMImages(
+        const BitmapData* bgraImage,
+        const CICPColorData& colorInfo,
+        YUVChromaSubsampling yuvFormat,
+        const ColorToYUVRowConverters& rowConverters,
+        uint32_t startRow,
+        uint32_t endRow,
+        aom_image_t* colorImage,
+        aom_image_t* alphaImage)
+    {
+        if (bgraImage->pixelFormat == BitmapPixelFormat::Bgra64)
+        {
+            if (IsHighBitDepthImage(colorImage))
+            {
+                ConvertPremultipliedRowsToAOMImages<ColorBgra64, uint16_t>(bgraImage, colorInfo, yuvFormat, rowConverters, startRow, endRow, colorImage, alphaImage);
+            }
+            else
+            {
+                ConvertPremultipliedRowsToAOMImages<ColorBgra64, uint8_t>(bgraImage, colorInfo, yuvFormat, rowConverters, startRow, endRow, colorImage, alphaImage);
+            }
+        }
+        else
+        {
+            if (IsHighBitDepthImage(colorImage))
+            {
+                ConvertPremultipliedRowsToAOMImages<ColorBgra, uint16_t>(bgraImage, colorInfo, yuvFormat, rowConverters, startRow, endRow, colorImage, alphaImage);
+            }
+            else
+            {
+                ConvertPremultipliedRowsToAOMImages<ColorBgra, uint8_t>(bgraImage, colorInfo, yuvFormat, rowConverters, startRow, endRow, colorImage, alphaImage);
+            }
+        }
+    }
+
+    void SetColorImageInfo(const CICPColorData& colorInfo, YUVChromaSubsampling yuvFormat, aom_image_t* aomImage)
+    {
+        aomImage->cp = static_cast<aom_color_primaries_t>(colorInfo.colorPrimaries);
+        aomImage->tc = static_cast<aom_transfer_characteristics_t>(colorInfo.transferCharacteristics);
+        aomImage->mc = static_cast<aom_matrix_coefficients_t>(colorInfo.matrixCoefficients);
+        aomImage->range = AOM_CR_FULL_RANGE;
+        aomImage->monochrome = yuvFormat == YUVChromaSubsampling::Subsampling400;
+    }
+
+    void SetAlphaImageInfo(aom_image_t* aomImage)
+    {
+        aomImage->cp = AOM_CICP_CP_UNSPECIFIED;
+        aomImage->tc = AOM_CICP_TC_UNSPECIFIED;
+        aomImage->mc = AOM_CICP_MC_UNSPECIFIED;
+        aomImage->range = AOM_CR_FULL_RANGE;
+        aomImage->monochrome = 1;
+    }
+
+    // The monochrome images do not use the U and V planes, they are cleared to improve compression.
+    void ZeroUVPlanes(uint32_t imageHeight, aom_image_t* aomImage)
+    {
+        const uint32_t uvHeight = GetUVHeight(imageHeight, aomImage->fmt);
 
         ZeroUVPlanes(
             uvHeight,
@@ -364,73 +1042,321 @@ aom_image_t* ConvertColorToAOMImage(
             reinterpret_cast<uint8_t*>(aomImage->planes[AOM_PLANE_V]),
             static_cast<size_t>(aomImage->stride[AOM_PLANE_V]));
     }
-    else
+
+    // A xorshift random number generator, the test images must be the same on every run.
+    class VerificationRandom
     {
-        if (yuvFormat == YUVChromaSubsampling::IdentityMatrix)
+    public:
+        VerificationRandom() : state(0x2545F491)
         {
-            // The IdentityMatrix format places the RGB values into the YUV planes
-            // without any conversion.
-            // This reduces the compression efficiency, but allows for fully lossless encoding.
-            ColorToIdentity8(
-                bgraImage,
-                reinterpret_cast<uint8_t*>(aomImage->planes[AOM_PLANE_Y]),
-                static_cast<size_t>(aomImage->stride[AOM_PLANE_Y]),
-                reinterpret_cast<uint8_t*>(aomImage->planes[AOM_PLANE_U]),
-                static_cast<size_t>(aomImage->stride[AOM_PLANE_U]),
-                reinterpret_cast<uint8_t*>(aomImage->planes[AOM_PLANE_V]),
-                static_cast<size_t>(aomImage->stride[AOM_PLANE_V]));
         }
-        else
+
+        uint32_t Next()
         {
-            ColorToYUV8(
-                bgraImage,
-                colorInfo,
-                yuvFormat,
-                reinterpret_cast<uint8_t*>(aomImage->planes[AOM_PLANE_Y]),
-                static_cast<size_t>(aomImage->stride[AOM_PLANE_Y]),
-                reinterpret_cast<uint8_t*>(aomImage->planes[AOM_PLANE_U]),
-                static_cast<size_t>(aomImage->stride[AOM_PLANE_U]),
-                reinterpret_cast<uint8_t*>(aomImage->planes[AOM_PLANE_V]),
-                static_cast<size_t>(aomImage->stride[AOM_PLANE_V]));
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+
+            return state;
+        }
+
+    private:
+        uint32_t state;
+    };
+
+    template <typename TPixel, typename TSample>
+    bool VerifyRowConverters(const ColorToYUVRowConverters& rowConverters, uint32_t bitDepth)
+    {
+        static constexpr YUVChromaSubsampling yuvFormats[] =
+        {
+            YUVChromaSubsampling::Subsampling420,
+            YUVChromaSubsampling::Subsampling422,
+            YUVChromaSubsampling::Subsampling444
+        };
+        static constexpr CICPMatrixCoefficients matrixCoefficients[] =
+        {
+            CICPMatrixCoefficients::BT709,
+            CICPMatrixCoefficients::BT601,
+            CICPMatrixCoefficients::BT2020NCL,
+            CICPMatrixCoefficients::CromatNCL
+        };
+
+        const ColorToYUVRowConverters scalarConverters{};
+        const BitmapPixelFormat pixelFormat = sizeof(TPixel) == sizeof(ColorBgra64) ? BitmapPixelFormat::Bgra64 : BitmapPixelFormat::Bgra32;
+        VerificationRandom random;
+
+        // The sizes cover images that are smaller than the vector width, the scalar code that handles
+        // the end of each row and the partial chroma blocks at the right and bottom edges.
+        std::vector<uint32_t> widths;
+
+        for (uint32_t width = 1; width <= 40; width++)
+        {
+            widths.push_back(width);
         }
+        widths.push_back(67);
+
+        for (const uint32_t width : widths)
+        {
+            for (uint32_t height = 1; height <= 4; height++)
+            {
+                const uint32_t stride = width * sizeof(TPixel);
+                std::vector<uint8_t> pixels(static_cast<size_t>(stride) * height);
+
+                for (uint8_t& value : pixels)
+                {
+                    value = static_cast<uint8_t>(random.Next());
+                }
+
+                BitmapData image{ pixels.data(), width, height, stride, pixelFormat };
+
+                // The padding at the end of each row checks that the converters
+                // do not write past the end of the planes.
+                const size_t planeStride = static_cast<size_t>(width) + 5;
+                const size_t planeSize = planeStride * height;
+
+                std::vector<TSample> initialPlane(planeSize);
+
+                for (TSample& value : initialPlane)
+                {
+                    value = static_cast<TSample>(random.Next());
+                }
+
+                for (const YUVChromaSubsampling yuvFormat : yuvFormats)
+                {
+                    for (const CICPMatrixCoefficients matrix : matrixCoefficients)
+                    {
+                        CICPColorData colorInfo{};
+                        colorInfo.colorPrimaries = matrix == CICPMatrixCoefficients::CromatNCL ? CICPColorPrimaries::BT2020 : CICPColorPrimaries::BT709;
+                        colorInfo.transferCharacteristics = CICPTransferCharacteristics::Srgb;
+                        colorInfo.matrixCoefficients = matrix;
+                        colorInfo.fullRange = true;
+
+                        std::vector<TSample> expected[3] = { initialPlane, initialPlane, initialPlane };
+                        std::vector<TSample> actual[3] = { initialPlane, initialPlane, initialPlane };
+
+                        ColorToYUV<TPixel>(
+                            &image,
+                            colorInfo,
+                            yuvFormat,
+                            bitDepth,
+                            scalarConverters,
+                            expected[0].data(),
+                            planeStride,
+                            expected[1].data(),
+                            planeStride,
+                            expected[2].data(),
+                            planeStride);
+                        ColorToYUV<TPixel>(
+                            &image,
+                            colorInfo,
+                            yuvFormat,
+                            bitDepth,
+                            rowConverters,
+                            actual[0].data(),
+                            planeStride,
+                            actual[1].data(),
+                            planeStride,
+                            actual[2].data(),
+                            planeStride);
+
+                        for (size_t plane = 0; plane < 3; plane++)
+                        {
+                            if (expected[plane] != actual[plane])
+                            {
+                                return false;
+                            }
+                        }
+                    }
+                }
+
+                std::vector<TSample> expected[3] = { initialPlane, initialPlane, initialPlane };
+                std::vector<TSample> actual[3] = { initialPlane, initialPlane, initialPlane };
+
+                ColorToIdentity<TPixel>(
+                    &image,
+                    bitDepth,
+                    scalarConverters,
+                    expected[0].data(),
+                    planeStride,
+                    expected[1].data(),
+                    planeStride,
+                    expected[2].data(),
+                    planeStride);
+                ColorToIdentity<TPixel>(
+                    &image,
+                    bitDepth,
+                    rowConverters,
+                    actual[0].data(),
+                    planeStride,
+                    actual[1].data(),
+                    planeStride,
+                    actual[2].data(),
+                    planeStride);
+
+                std::vector<TSample> expectedMono = initialPlane;
+                std::vector<TSample> actualMono = initialPlane;
+
+                MonoToY<TPixel>(&image, bitDepth, scalarConverters, expectedMono.data(), planeStride);
+                MonoToY<TPixel>(&image, bitDepth, rowConverters, actualMono.data(), planeStride);
+
+                if (expected[0] != actual[0] ||
+                    expected[1] != actual[1] ||
+                    expected[2] != actual[2] ||
+                    expectedMono != actualMono)
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+}
+
+
+EncoderStatus ConvertColorToAOMImage(
+    const BitmapData* bgraImage,
+    const CICPColorData& colorInfo,
+    YUVChromaSubsampling yuvFormat,
+    bool premultiplyAlpha,
+    uint32_t maxThreads,
+    aom_image_t* aomImage)
+{
+    SetColorImageInfo(colorInfo, yuvFormat, aomImage);
+
+    const ColorToYUVRowConverters& rowConverters = GetColorToYUVRowConverters();
+
+    // The rows that are averaged into a subsampled chroma row are converted by the same thread.
+    const EncoderStatus status = ParallelForRowBands<EncoderStatus>(
+        bgraImage->height,
+        1U << aomImage->y_chroma_shift,
+        maxThreads,
+        [&](uint32_t startRow, uint32_t endRow)
+        {
+            if (premultiplyAlpha)
+            {
+                try
+                {
+                    ConvertPremultipliedRowsToAOMImages(bgraImage, colorInfo, yuvFormat, rowConverters, startRow, endRow, aomImage, nullptr);
+                }
+                catch (const std::bad_alloc&)
+                {
+                    return EncoderStatus::OutOfMemory;
+                }
+            }
+            else
+            {
+                ConvertColorRowsToAOMImage(bgraImage, colorInfo, yuvFormat, rowConverters, startRow, endRow, aomImage);
+            }
+
+            return EncoderStatus::Ok;
+        });
+
+    if (status == EncoderStatus::Ok && aomImage->monochrome)
+    {
+        ZeroUVPlanes(bgraImage->height, aomImage);
     }
 
-    return aomImage;
+    return status;
 }
 
-aom_image_t* ConvertAlphaToAOMImage(const BitmapData* bgraImage)
+EncoderStatus ConvertPremultipliedColorAndAlphaToAOMImages(
+    const BitmapData* bgraImage,
+    const CICPColorData& colorInfo,
+    YUVChromaSubsampling yuvFormat,
+    uint32_t maxThreads,
+    aom_image_t* colorImage,
+    aom_image_t* alphaImage)
 {
-    // Chroma sub-sampling does not matter for the alpha channel
-    // YUV 4:0:0 would be a better format for the alpha image than YUV 4:2:0,
-    // but it appears that libaom does not currently support it.
+    SetColorImageInfo(colorInfo, yuvFormat, colorImage);
+    SetAlphaImageInfo(alphaImage);
+
+    const ColorToYUVRowConverters& rowConverters = GetColorToYUVRowConverters();
+
+    // Each pixel is read once, the premultiplied color is kept in a per-thread scratch buffer until
+    // it has been converted to YUV.
+    const EncoderStatus status = ParallelForRowBands<EncoderStatus>(
+        bgraImage->height,
+        1U << colorImage->y_chroma_shift,
+        maxThreads,
+        [&](uint32_t startRow, uint32_t endRow)
+        {
+            try
+            {
+                ConvertPremultipliedRowsToAOMImages(bgraImage, colorInfo, yuvFormat, rowConverters, startRow, endRow, colorImage, alphaImage);
+            }
+            catch (const std::bad_alloc&)
+            {
+                return EncoderStatus::OutOfMemory;
+            }
 
-    constexpr aom_img_fmt aomFormat = AOM_IMG_FMT_I420;
+            return EncoderStatus::Ok;
+        });
 
-    aom_image_t* aomImage = aom_img_alloc(nullptr, aomFormat, bgraImage->width, bgraImage->height, 16);
-    if (!aomImage)
+    if (status == EncoderStatus::Ok)
     {
-        return nullptr;
+        if (colorImage->monochrome)
+        {
+            ZeroUVPlanes(bgraImage->height, colorImage);
+        }
+
+        ZeroUVPlanes(bgraImage->height, alphaImage);
     }
 
-    aomImage->cp = AOM_CICP_CP_UNSPECIFIED;
-    aomImage->tc = AOM_CICP_TC_UNSPECIFIED;
-    aomImage->mc = AOM_CICP_MC_UNSPECIFIED;
-    aomImage->range = AOM_CR_FULL_RANGE;
-    aomImage->monochrome = 1;
+    return status;
+}
+
+void ConvertAlphaToAOMImage(const BitmapData* bgraImage, uint32_t maxThreads, aom_image_t* aomImage)
+{
+    SetAlphaImageInfo(aomImage);
+
+    ParallelForRowBands<EncoderStatus>(
+        bgraImage->height,
+        1,
+        maxThreads,
+        [&](uint32_t startRow, uint32_t endRow)
+        {
+            ConvertAlphaRowsToAOMImage(bgraImage, startRow, endRow, aomImage);
+            return EncoderStatus::Ok;
+        });
+
+    ZeroUVPlanes(bgraImage->height, aomImage);
+}
 
-    AlphaToY8(
-        bgraImage,
-        reinterpret_cast<uint8_t*>(aomImage->planes[AOM_PLANE_Y]),
-        static_cast<size_t>(aomImage->stride[AOM_PLANE_Y]));
+bool VerifyColorToYUVRowConverters()
+{
+    std::vector<const ColorToYUVRowConverters*> supportedConverters;
 
-    const uint32_t uvHeight = GetUVHeight(bgraImage->height, aomFormat);
+#if defined(_M_IX86) || defined(_M_X64)
+    if (HasSSE41())
+    {
+        supportedConverters.push_back(&GetSSE41ColorToYUVRowConverters());
+    }
 
-    ZeroUVPlanes(
-        uvHeight,
-        reinterpret_cast<uint8_t*>(aomImage->planes[AOM_PLANE_U]),
-        static_cast<size_t>(aomImage->stride[AOM_PLANE_U]),
-        reinterpret_cast<uint8_t*>(aomImage->planes[AOM_PLANE_V]),
-        static_cast<size_t>(aomImage->stride[AOM_PLANE_V]));
+    if (HasAVX2())
+    {
+        supportedConverters.push_back(&GetAVX2ColorToYUVRowConverters());
+    }
+#elif defined(_M_ARM64)
+    supportedConverters.push_back(&GetNEONColorToYUVRowConverters());
+#endif
+
+    try
+    {
+        for (const ColorToYUVRowConverters* converters : supportedConverters)
+        {
+            if (!VerifyRowConverters<ColorBgra, uint8_t>(*converters, 8) ||
+                !VerifyRowConverters<ColorBgra64, uint16_t>(*converters, 10) ||
+                !VerifyRowConverters<ColorBgra64, uint16_t>(*converters, 12))
+            {
+                return false;
+            }
+        }
+    }
+    catch (const std::bad_alloc&)
+    {
+        return false;
+    }
 
-    return aomImage;
+    return true;
 }
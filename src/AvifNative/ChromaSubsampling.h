@@ -15,10 +15,30 @@
 #include "AvifNative.h"
 #include "aom/aom_image.h"
 
-aom_image_t* ConvertColorToAOMImage(
+// The conversion functions write into an existing image that has the same size as bgraImage,
+// this allows the caller to reuse the image planes.
+
+// The color is premultiplied by the alpha channel as it is converted when premultiplyAlpha is true.
+EncoderStatus ConvertColorToAOMImage(
+    const BitmapData* bgraImage,
+    const CICPColorData& colorInfo,
+    YUVChromaSubsampling yuvFormat,
+    bool premultiplyAlpha,
+    uint32_t maxThreads,
+    aom_image_t* aomImage);
+
+// Converts the premultiplied color and the alpha channel in a single pass over bgraImage.
+// Both images must use the same bit depth.
+EncoderStatus ConvertPremultipliedColorAndAlphaToAOMImages(
     const BitmapData* bgraImage,
     const CICPColorData& colorInfo,
     YUVChromaSubsampling yuvFormat,
-    aom_img_fmt aomFormat);
+    uint32_t maxThreads,
+    aom_image_t* colorImage,
+    aom_image_t* alphaImage);
+
+void ConvertAlphaToAOMImage(const BitmapData* bgraImage, uint32_t maxThreads, aom_image_t* aomImage);
 
-aom_image_t* ConvertAlphaToAOMImage(const BitmapData* bgraImage);
+// Checks that the vectorized converters for each instruction set that the CPU supports
+// produce the same output as the scalar code.
+bool VerifyColorToYUVRowConverters();
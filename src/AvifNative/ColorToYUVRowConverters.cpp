@@ -0,0 +1,47 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "ColorToYUVRowConverters.h"
+#include "CPUFeatures.h"
+
+namespace
+{
+    const ColorToYUVRowConverters& SelectColorToYUVRowConverters()
+    {
+#if defined(_M_ARM64)
+        // NEON is always available on ARM64.
+        return GetNEONColorToYUVRowConverters();
+#else
+#if defined(_M_IX86) || defined(_M_X64)
+        if (HasAVX2())
+        {
+            return GetAVX2ColorToYUVRowConverters();
+        }
+        else if (HasSSE41())
+        {
+            return GetSSE41ColorToYUVRowConverters();
+        }
+#endif
+
+        static const ColorToYUVRowConverters scalarConverters{};
+
+        return scalarConverters;
+#endif
+    }
+}
+
+const ColorToYUVRowConverters& GetColorToYUVRowConverters()
+{
+    static const ColorToYUVRowConverters& converters = SelectColorToYUVRowConverters();
+
+    return converters;
+}
@@ -0,0 +1,145 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AvifNative.h"
+
+struct RGBToYUVRowConstants
+{
+    float kr;
+    float kg;
+    float kb;
+    // 2 * (1 - kb)
+    float uDivisor;
+    // 2 * (1 - kr)
+    float vDivisor;
+    // The maximum value of the output samples, (1 << bitDepth) - 1.
+    float maxSample;
+};
+
+// The row converters return the number of pixels that were converted, this is always a multiple
+// of the vector width and the caller converts the remaining pixels using the scalar code.
+// The output must be identical to the scalar code in ChromaSubsampling.cpp.
+
+typedef uint32_t(*ColorToYUV444RowProc)(
+    const ColorBgra* srcPtr,
+    uint32_t width,
+    const RGBToYUVRowConstants& constants,
+    uint8_t* yPtr,
+    uint8_t* uPtr,
+    uint8_t* vPtr);
+
+// The U and V values are the average of each horizontal pair of pixels.
+typedef uint32_t(*ColorToYUV422RowProc)(
+    const ColorBgra* srcPtr,
+    uint32_t width,
+    const RGBToYUVRowConstants& constants,
+    uint8_t* yPtr,
+    uint8_t* uPtr,
+    uint8_t* vPtr);
+
+// The U and V values are the average of each 2x2 block of pixels from the two rows.
+typedef uint32_t(*ColorToYUV420RowProc)(
+    const ColorBgra* srcPtr0,
+    const ColorBgra* srcPtr1,
+    uint32_t width,
+    const RGBToYUVRowConstants& constants,
+    uint8_t* yPtr0,
+    uint8_t* yPtr1,
+    uint8_t* uPtr,
+    uint8_t* vPtr);
+
+// The high bit depth converters read 16-bit per channel images and write 16-bit samples
+// that are scaled to the maximum sample value.
+
+typedef uint32_t(*ColorToYUV444HighBitDepthRowProc)(
+    const ColorBgra64* srcPtr,
+    uint32_t width,
+    const RGBToYUVRowConstants& constants,
+    uint16_t* yPtr,
+    uint16_t* uPtr,
+    uint16_t* vPtr);
+
+typedef uint32_t(*ColorToYUV422HighBitDepthRowProc)(
+    const ColorBgra64* srcPtr,
+    uint32_t width,
+    const RGBToYUVRowConstants& constants,
+    uint16_t* yPtr,
+    uint16_t* uPtr,
+    uint16_t* vPtr);
+
+typedef uint32_t(*ColorToYUV420HighBitDepthRowProc)(
+    const ColorBgra64* srcPtr0,
+    const ColorBgra64* srcPtr1,
+    uint32_t width,
+    const RGBToYUVRowConstants& constants,
+    uint16_t* yPtr0,
+    uint16_t* yPtr1,
+    uint16_t* uPtr,
+    uint16_t* vPtr);
+
+// The Identity matrix and monochrome converters copy the channel values without any color conversion.
+
+typedef uint32_t(*ColorToIdentityRowProc)(
+    const ColorBgra* srcPtr,
+    uint32_t width,
+    uint8_t* yPtr,
+    uint8_t* uPtr,
+    uint8_t* vPtr);
+
+// The high bit depth converters scale the channel values to maxSample, which must be less than 65535.
+typedef uint32_t(*ColorToIdentityHighBitDepthRowProc)(
+    const ColorBgra64* srcPtr,
+    uint32_t width,
+    uint32_t maxSample,
+    uint16_t* yPtr,
+    uint16_t* uPtr,
+    uint16_t* vPtr);
+
+typedef uint32_t(*MonoToYRowProc)(
+    const ColorBgra* srcPtr,
+    uint32_t width,
+    uint8_t* yPtr);
+
+typedef uint32_t(*MonoToYHighBitDepthRowProc)(
+    const ColorBgra64* srcPtr,
+    uint32_t width,
+    uint32_t maxSample,
+    uint16_t* yPtr);
+
+struct ColorToYUVRowConverters
+{
+    const char* name;
+    ColorToYUV444RowProc yuv444;
+    ColorToYUV422RowProc yuv422;
+    ColorToYUV420RowProc yuv420;
+    ColorToYUV444HighBitDepthRowProc yuv444HighBitDepth;
+    ColorToYUV422HighBitDepthRowProc yuv422HighBitDepth;
+    ColorToYUV420HighBitDepthRowProc yuv420HighBitDepth;
+    ColorToIdentityRowProc identity;
+    ColorToIdentityHighBitDepthRowProc identityHighBitDepth;
+    MonoToYRowProc mono;
+    MonoToYHighBitDepthRowProc monoHighBitDepth;
+};
+
+// Returns the fastest row converters that the CPU supports, this is selected once per process.
+// The members will be null if the CPU does not support any of the vector instruction sets.
+const ColorToYUVRowConverters& GetColorToYUVRowConverters();
+
+// The instruction set specific converters, the caller must check that the CPU supports the instruction set.
+#if defined(_M_IX86) || defined(_M_X64)
+const ColorToYUVRowConverters& GetSSE41ColorToYUVRowConverters();
+const ColorToYUVRowConverters& GetAVX2ColorToYUVRowConverters();
+#elif defined(_M_ARM64)
+const ColorToYUVRowConverters& GetNEONColorToYUVRowConverters();
+#endif
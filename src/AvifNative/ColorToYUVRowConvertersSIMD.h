@@ -0,0 +1,355 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ColorToYUVRowConverters.h"
+
+// The vectorized row converters, these are instantiated once for each instruction set.
+//
+// The V template parameter provides the vector types and operations for the instruction set,
+// see the SIMDTraits headers. The floating point operations are performed in the same order
+// as the scalar code in ChromaSubsampling.cpp, this is required for the output to be identical.
+
+namespace ColorToYUVRowConvertersSIMD
+{
+    template <typename V>
+    struct VectorConstants
+    {
+        typename V::Float kr;
+        typename V::Float kg;
+        typename V::Float kb;
+        typename V::Float uDivisor;
+        typename V::Float vDivisor;
+        typename V::Float zero;
+        typename V::Float half;
+        typename V::Float one;
+        typename V::Float maxChannel;
+        typename V::Float maxChannel16;
+        typename V::Float maxSample;
+
+        VectorConstants(const RGBToYUVRowConstants& constants) :
+            kr(V::SetFloat(constants.kr)),
+            kg(V::SetFloat(constants.kg)),
+            kb(V::SetFloat(constants.kb)),
+            uDivisor(V::SetFloat(constants.uDivisor)),
+            vDivisor(V::SetFloat(constants.vDivisor)),
+            zero(V::SetFloat(0.0f)),
+            half(V::SetFloat(0.5f)),
+            one(V::SetFloat(1.0f)),
+            maxChannel(V::SetFloat(255.0f)),
+            maxChannel16(V::SetFloat(65535.0f)),
+            maxSample(V::SetFloat(constants.maxSample))
+        {
+        }
+    };
+
+    template <typename V>
+    struct YUVVector
+    {
+        typename V::Float y;
+        typename V::Float u;
+        typename V::Float v;
+    };
+
+    template <typename V>
+    inline YUVVector<V> RGBToYUV(
+        typename V::Float r,
+        typename V::Float g,
+        typename V::Float b,
+        const VectorConstants<V>& constants)
+    {
+        YUVVector<V> yuv;
+        yuv.y = V::Add(V::Add(V::Mul(constants.kr, r), V::Mul(constants.kg, g)), V::Mul(constants.kb, b));
+        yuv.u = V::Div(V::Sub(b, yuv.y), constants.uDivisor);
+        yuv.v = V::Div(V::Sub(r, yuv.y), constants.vDivisor);
+
+        return yuv;
+    }
+
+    template <typename V>
+    inline YUVVector<V> LoadYUV(const ColorBgra* srcPtr, const VectorConstants<V>& constants)
+    {
+        const typename V::Int pixels = V::LoadPixels(srcPtr);
+
+        // Unpack RGB into normalized float, this is the same as the uint8ToFloatTable values.
+        const typename V::Float r = V::Div(V::ConvertToFloat(V::template ExtractChannel<16>(pixels)), constants.maxChannel);
+        const typename V::Float g = V::Div(V::ConvertToFloat(V::template ExtractChannel<8>(pixels)), constants.maxChannel);
+        const typename V::Float b = V::Div(V::ConvertToFloat(V::template ExtractChannel<0>(pixels)), constants.maxChannel);
+
+        return RGBToYUV<V>(r, g, b, constants);
+    }
+
+    template <typename V>
+    inline YUVVector<V> LoadYUV(const ColorBgra64* srcPtr, const VectorConstants<V>& constants)
+    {
+        typename V::Int b, g, r;
+        V::LoadChannels(srcPtr, b, g, r);
+
+        // Unpack RGB into normalized float.
+        return RGBToYUV<V>(
+            V::Div(V::ConvertToFloat(r), constants.maxChannel16),
+            V::Div(V::ConvertToFloat(g), constants.maxChannel16),
+            V::Div(V::ConvertToFloat(b), constants.maxChannel16),
+            constants);
+    }
+
+    template <typename V>
+    inline void StoreSamples(uint8_t* dstPtr, typename V::Int value)
+    {
+        V::StoreBytes(dstPtr, value);
+    }
+
+    template <typename V>
+    inline void StoreSamples(uint16_t* dstPtr, typename V::Int value)
+    {
+        V::StoreWords(dstPtr, value);
+    }
+
+    // Clamps the value to [0, 1] and rounds it to the nearest integer in [0, maxSample],
+    // the value is not negative so truncation is the same as the floorf call in avifRoundf.
+    template <typename V>
+    inline typename V::Int ToUNorm(typename V::Float value, const VectorConstants<V>& constants)
+    {
+        const typename V::Float clamped = V::Max(V::Min(value, constants.one), constants.zero);
+
+        return V::Truncate(V::Add(V::Mul(clamped, constants.maxSample), constants.half));
+    }
+
+    template <typename V>
+    inline typename V::Int UVToUNorm(typename V::Float value, const VectorConstants<V>& constants)
+    {
+        return ToUNorm<V>(V::Add(value, constants.half), constants);
+    }
+
+    template <typename V, typename TPixel, typename TSample>
+    uint32_t ColorToYUV444Row(
+        const TPixel* srcPtr,
+        uint32_t width,
+        const RGBToYUVRowConstants& constants,
+        TSample* yPtr,
+        TSample* uPtr,
+        TSample* vPtr)
+    {
+        const VectorConstants<V> vectorConstants(constants);
+        const uint32_t vectorWidth = width - (width % V::Width);
+
+        for (uint32_t x = 0; x < vectorWidth; x += V::Width)
+        {
+            const YUVVector<V> yuv = LoadYUV<V>(srcPtr + x, vectorConstants);
+
+            StoreSamples<V>(yPtr + x, ToUNorm<V>(yuv.y, vectorConstants));
+            StoreSamples<V>(uPtr + x, UVToUNorm<V>(yuv.u, vectorConstants));
+            StoreSamples<V>(vPtr + x, UVToUNorm<V>(yuv.v, vectorConstants));
+        }
+
+        return vectorWidth;
+    }
+
+    template <typename V, typename TPixel, typename TSample>
+    uint32_t ColorToYUV422Row(
+        const TPixel* srcPtr,
+        uint32_t width,
+        const RGBToYUVRowConstants& constants,
+        TSample* yPtr,
+        TSample* uPtr,
+        TSample* vPtr)
+    {
+        constexpr uint32_t pixelsPerLoop = V::Width * 2;
+
+        const VectorConstants<V> vectorConstants(constants);
+        const typename V::Float sampleCount = V::SetFloat(2.0f);
+        const uint32_t vectorWidth = width - (width % pixelsPerLoop);
+
+        for (uint32_t x = 0; x < vectorWidth; x += pixelsPerLoop)
+        {
+            const YUVVector<V> yuv0 = LoadYUV<V>(srcPtr + x, vectorConstants);
+            const YUVVector<V> yuv1 = LoadYUV<V>(srcPtr + x + V::Width, vectorConstants);
+
+            StoreSamples<V>(yPtr + x, ToUNorm<V>(yuv0.y, vectorConstants));
+            StoreSamples<V>(yPtr + x + V::Width, ToUNorm<V>(yuv1.y, vectorConstants));
+
+            // YUV422, average 2 samples (1x2)
+            typename V::Float evenU, oddU, evenV, oddV;
+            V::Deinterleave(yuv0.u, yuv1.u, evenU, oddU);
+            V::Deinterleave(yuv0.v, yuv1.v, evenV, oddV);
+
+            const typename V::Float avgU = V::Div(V::Add(evenU, oddU), sampleCount);
+            const typename V::Float avgV = V::Div(V::Add(evenV, oddV), sampleCount);
+
+            StoreSamples<V>(uPtr + (x >> 1), UVToUNorm<V>(avgU, vectorConstants));
+            StoreSamples<V>(vPtr + (x >> 1), UVToUNorm<V>(avgV, vectorConstants));
+        }
+
+        return vectorWidth;
+    }
+
+    template <typename V, typename TPixel, typename TSample>
+    uint32_t ColorToYUV420Rows(
+        const TPixel* srcPtr0,
+        const TPixel* srcPtr1,
+        uint32_t width,
+        const RGBToYUVRowConstants& constants,
+        TSample* yPtr0,
+        TSample* yPtr1,
+        TSample* uPtr,
+        TSample* vPtr)
+    {
+        constexpr uint32_t pixelsPerLoop = V::Width * 2;
+
+        const VectorConstants<V> vectorConstants(constants);
+        const typename V::Float sampleCount = V::SetFloat(4.0f);
+        const uint32_t vectorWidth = width - (width % pixelsPerLoop);
+
+        for (uint32_t x = 0; x < vectorWidth; x += pixelsPerLoop)
+        {
+            const YUVVector<V> row0Yuv0 = LoadYUV<V>(srcPtr0 + x, vectorConstants);
+            const YUVVector<V> row0Yuv1 = LoadYUV<V>(srcPtr0 + x + V::Width, vectorConstants);
+            const YUVVector<V> row1Yuv0 = LoadYUV<V>(srcPtr1 + x, vectorConstants);
+            const YUVVector<V> row1Yuv1 = LoadYUV<V>(srcPtr1 + x + V::Width, vectorConstants);
+
+            StoreSamples<V>(yPtr0 + x, ToUNorm<V>(row0Yuv0.y, vectorConstants));
+            StoreSamples<V>(yPtr0 + x + V::Width, ToUNorm<V>(row0Yuv1.y, vectorConstants));
+            StoreSamples<V>(yPtr1 + x, ToUNorm<V>(row1Yuv0.y, vectorConstants));
+            StoreSamples<V>(yPtr1 + x + V::Width, ToUNorm<V>(row1Yuv1.y, vectorConstants));
+
+            // YUV420, average 4 samples (2x2)
+            // The scalar code adds the samples from left to right then top to bottom.
+            typename V::Float row0EvenU, row0OddU, row0EvenV, row0OddV;
+            typename V::Float row1EvenU, row1OddU, row1EvenV, row1OddV;
+            V::Deinterleave(row0Yuv0.u, row0Yuv1.u, row0EvenU, row0OddU);
+            V::Deinterleave(row0Yuv0.v, row0Yuv1.v, row0EvenV, row0OddV);
+            V::Deinterleave(row1Yuv0.u, row1Yuv1.u, row1EvenU, row1OddU);
+            V::Deinterleave(row1Yuv0.v, row1Yuv1.v, row1EvenV, row1OddV);
+
+            const typename V::Float sumU = V::Add(V::Add(V::Add(row0EvenU, row0OddU), row1EvenU), row1OddU);
+            const typename V::Float sumV = V::Add(V::Add(V::Add(row0EvenV, row0OddV), row1EvenV), row1OddV);
+
+            StoreSamples<V>(uPtr + (x >> 1), UVToUNorm<V>(V::Div(sumU, sampleCount), vectorConstants));
+            StoreSamples<V>(vPtr + (x >> 1), UVToUNorm<V>(V::Div(sumV, sampleCount), vectorConstants));
+        }
+
+        return vectorWidth;
+    }
+
+    // Scales the 16-bit channel values to maxSample with the same rounding as the scalar code,
+    // ((value * maxSample) + 32767) / 65535.
+    // (x + (x >> 16) + 1) >> 16 is equal to x / 65535 for all x < 2^32.
+    template <typename V>
+    inline typename V::Int ScaleChannel16(typename V::Int value, typename V::Int maxSample)
+    {
+        const typename V::Int x = V::AddInt(V::MulInt(value, maxSample), V::SetInt(32767));
+
+        return V::ShiftRightInt(V::AddInt(V::AddInt(x, V::ShiftRightInt(x, 16)), V::SetInt(1)), 16);
+    }
+
+    template <typename V>
+    uint32_t ColorToIdentityRow(
+        const ColorBgra* srcPtr,
+        uint32_t width,
+        uint8_t* yPtr,
+        uint8_t* uPtr,
+        uint8_t* vPtr)
+    {
+        const uint32_t vectorWidth = width - (width % V::Width);
+
+        for (uint32_t x = 0; x < vectorWidth; x += V::Width)
+        {
+            // RGB -> Identity GBR conversion
+            V::DeinterleaveBgr(srcPtr + x, uPtr + x, yPtr + x, vPtr + x);
+        }
+
+        return vectorWidth;
+    }
+
+    template <typename V>
+    uint32_t ColorToIdentityHighBitDepthRow(
+        const ColorBgra64* srcPtr,
+        uint32_t width,
+        uint32_t maxSample,
+        uint16_t* yPtr,
+        uint16_t* uPtr,
+        uint16_t* vPtr)
+    {
+        const typename V::Int maxSampleVector = V::SetInt(maxSample);
+        const uint32_t vectorWidth = width - (width % V::Width);
+
+        for (uint32_t x = 0; x < vectorWidth; x += V::Width)
+        {
+            typename V::Int b, g, r;
+            V::LoadChannels(srcPtr + x, b, g, r);
+
+            V::StoreWords(yPtr + x, ScaleChannel16<V>(g, maxSampleVector));
+            V::StoreWords(uPtr + x, ScaleChannel16<V>(b, maxSampleVector));
+            V::StoreWords(vPtr + x, ScaleChannel16<V>(r, maxSampleVector));
+        }
+
+        return vectorWidth;
+    }
+
+    template <typename V>
+    uint32_t MonoToYRow(
+        const ColorBgra* srcPtr,
+        uint32_t width,
+        uint8_t* yPtr)
+    {
+        const uint32_t vectorWidth = width - (width % V::Width);
+
+        for (uint32_t x = 0; x < vectorWidth; x += V::Width)
+        {
+            V::StoreBytes(yPtr + x, V::template ExtractChannel<16>(V::LoadPixels(srcPtr + x)));
+        }
+
+        return vectorWidth;
+    }
+
+    template <typename V>
+    uint32_t MonoToYHighBitDepthRow(
+        const ColorBgra64* srcPtr,
+        uint32_t width,
+        uint32_t maxSample,
+        uint16_t* yPtr)
+    {
+        const typename V::Int maxSampleVector = V::SetInt(maxSample);
+        const uint32_t vectorWidth = width - (width % V::Width);
+
+        for (uint32_t x = 0; x < vectorWidth; x += V::Width)
+        {
+            typename V::Int b, g, r;
+            V::LoadChannels(srcPtr + x, b, g, r);
+
+            V::StoreWords(yPtr + x, ScaleChannel16<V>(r, maxSampleVector));
+        }
+
+        return vectorWidth;
+    }
+
+    template <typename V>
+    ColorToYUVRowConverters CreateRowConverters(const char* name)
+    {
+        ColorToYUVRowConverters converters{};
+
+        converters.name = name;
+        converters.yuv444 = ColorToYUV444Row<V, ColorBgra, uint8_t>;
+        converters.yuv422 = ColorToYUV422Row<V, ColorBgra, uint8_t>;
+        converters.yuv420 = ColorToYUV420Rows<V, ColorBgra, uint8_t>;
+        converters.yuv444HighBitDepth = ColorToYUV444Row<V, ColorBgra64, uint16_t>;
+        converters.yuv422HighBitDepth = ColorToYUV422Row<V, ColorBgra64, uint16_t>;
+        converters.yuv420HighBitDepth = ColorToYUV420Rows<V, ColorBgra64, uint16_t>;
+        converters.identity = ColorToIdentityRow<V>;
+        converters.identityHighBitDepth = ColorToIdentityHighBitDepthRow<V>;
+        converters.mono = MonoToYRow<V>;
+        converters.monoHighBitDepth = MonoToYHighBitDepthRow<V>;
+
+        return converters;
+    }
+}
@@ -0,0 +1,25 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "ColorToYUVRowConverters.h"
+
+#if defined(_M_IX86) || defined(_M_X64)
+#include "ColorToYUVRowConvertersSIMD.h"
+#include "SIMDTraitsSSE41.h"
+
+const ColorToYUVRowConverters& GetSSE41ColorToYUVRowConverters()
+{
+    static const ColorToYUVRowConverters converters = ColorToYUVRowConvertersSIMD::CreateRowConverters<SIMD::SSE41>("SSE4.1");
+
+    return converters;
+}
+#endif
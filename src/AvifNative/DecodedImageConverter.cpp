@@ -38,12 +38,19 @@
 
 
 #include "DecodedImageConverter.h"
+#include "DecodedImageRowConverters.h"
+#include "CPUFeatures.h"
 #include "Memory.h"
+#include "ParallelFor.h"
 #include "YUVConversionHelpers.h"
 #include "CICPEnums.h"
+#include <algorithm>
 #include <array>
+#include <limits>
 #include <memory>
 #include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 namespace
 {
@@ -61,11 +68,6 @@ namespace
         return value;
     }
 
-    inline uint32_t Min(uint32_t a, uint32_t b)
-    {
-        return a < b ? a : b;
-    }
-
     void GetCopySizes(
         const aom_image_t* image,
         const DecodeInfo* decodeInfo,
@@ -73,18 +75,23 @@ namespace
         uint32_t& copyWidth,
         uint32_t& copyHeight)
     {
+        // The copy size is in decoded image pixels, a downscaled output image covers
+        // the pixels of the decoded image that are averaged into its last row and column.
+        const uint64_t outputWidth = static_cast<uint64_t>(bgraImage->width) << decodeInfo->downscaleShift;
+        const uint64_t outputHeight = static_cast<uint64_t>(bgraImage->height) << decodeInfo->downscaleShift;
+
         copyWidth = image->d_w;
-        uint32_t maxWidth = image->d_w * (decodeInfo->tileColumnIndex + 1);
-        if (maxWidth > bgraImage->width)
+        uint64_t maxWidth = static_cast<uint64_t>(image->d_w) * (decodeInfo->tileColumnIndex + 1);
+        if (maxWidth > outputWidth)
         {
-            copyWidth -= (maxWidth - bgraImage->width);
+            copyWidth -= static_cast<uint32_t>(maxWidth - outputWidth);
         }
 
         copyHeight = image->d_h;
-        uint32_t maxHeight = image->d_h * (decodeInfo->tileRowIndex + 1);
-        if (maxHeight > bgraImage->height)
+        uint64_t maxHeight = static_cast<uint64_t>(image->d_h) * (decodeInfo->tileRowIndex + 1);
+        if (maxHeight > outputHeight)
         {
-            copyHeight -= (maxHeight - bgraImage->height);
+            copyHeight -= static_cast<uint32_t>(maxHeight - outputHeight);
         }
     }
 
@@ -158,292 +165,582 @@ namespace
 
     #undef AVIF_CLAMP
     #undef LIMITED_TO_FULL
+}
+
+struct YUVLookupTables
+{
+    std::unique_ptr<float[]> unormFloatTableY;
+    std::unique_ptr<float[]> unormFloatTableUV;
 
-    struct YUVLookupTables
+    YUVLookupTables(const aom_image_t* image, bool isIdentityMatrix)
     {
-        std::unique_ptr<float[]> unormFloatTableY;
-        std::unique_ptr<float[]> unormFloatTableUV;
+        if (image->bit_depth != 8 &&
+            image->bit_depth != 10 &&
+            image->bit_depth != 12 &&
+            image->bit_depth != 16)
+        {
+            throw unknown_bit_depth_error("The image has an unsupported bit depth, must be 8, 10, 12 or 16.");
+        }
+
+        const int count = 1 << static_cast<int>(image->bit_depth);
+        const bool isColorImage = !image->monochrome;
+
+        // The high bit depth samples are stored in 16-bit values that can be larger than the
+        // maximum value for the bit depth, the extra table entries clamp those samples so that
+        // the converters do not have to.
+        const int tableSize = image->bit_depth > 8 ? 65536 : count;
+
+        unormFloatTableY = std::make_unique<float[]>(tableSize);
+        if (isColorImage)
+        {
+            unormFloatTableUV = std::make_unique<float[]>(tableSize);
+        }
+
+        float yuvMaxChannel = static_cast<float>((1 << image->bit_depth) - 1);
 
-        YUVLookupTables(const aom_image_t* image, bool isIdentityMatrix)
+        for (int i = 0; i < count; ++i)
         {
-            if (image->bit_depth != 8 &&
-                image->bit_depth != 10 &&
-                image->bit_depth != 12 &&
-                image->bit_depth != 16)
+            int unormY = i;
+            int unormUV = i;
+
+            if (image->range == AOM_CR_STUDIO_RANGE)
             {
-                throw unknown_bit_depth_error("The image has an unsupported bit depth, must be 8, 10, 12 or 16.");
+                unormY = avifLimitedToFullY(image->bit_depth, unormY);
+                if (isColorImage)
+                {
+                    unormUV = avifLimitedToFullUV(image->bit_depth, unormUV);
+                }
             }
 
-            const int count = 1 << static_cast<int>(image->bit_depth);
-            const bool isColorImage = !image->monochrome;
+            unormFloatTableY[i] = static_cast<float>(unormY) / yuvMaxChannel;
 
-            unormFloatTableY = std::make_unique<float[]>(count);
             if (isColorImage)
             {
-                unormFloatTableUV = std::make_unique<float[]>(count);
+                if (isIdentityMatrix)
+                {
+                    unormFloatTableUV[i] = unormFloatTableY[i];
+                }
+                else
+                {
+                    unormFloatTableUV[i] = static_cast<float>(unormUV) / yuvMaxChannel - 0.5f;
+                }
             }
+        }
 
-            float yuvMaxChannel = static_cast<float>((1 << image->bit_depth) - 1);
+        for (int i = count; i < tableSize; ++i)
+        {
+            unormFloatTableY[i] = unormFloatTableY[count - 1];
 
-            for (int i = 0; i < count; ++i)
+            if (isColorImage)
             {
-                int unormY = i;
-                int unormUV = i;
+                unormFloatTableUV[i] = unormFloatTableUV[count - 1];
+            }
+        }
+    }
+};
 
-                if (image->range == AOM_CR_STUDIO_RANGE)
-                {
-                    unormY = avifLimitedToFullY(image->bit_depth, unormY);
-                    if (isColorImage)
-                    {
-                        unormUV = avifLimitedToFullUV(image->bit_depth, unormUV);
-                    }
-                }
+YUVLookupTableCache::YUVLookupTableCache() : mutex(), entries()
+{
+}
 
-                unormFloatTableY[i] = static_cast<float>(unormY) / yuvMaxChannel;
+std::shared_ptr<const YUVLookupTables> YUVLookupTableCache::GetTables(const aom_image_t* image, bool isIdentityMatrix)
+{
+    const bool monochrome = image->monochrome != 0;
 
-                if (isColorImage)
-                {
-                    if (isIdentityMatrix)
-                    {
-                        unormFloatTableUV[i] = unormFloatTableY[i];
-                    }
-                    else
-                    {
-                        unormFloatTableUV[i] = static_cast<float>(unormUV) / yuvMaxChannel - 0.5f;
-                    }
-                }
-            }
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const CacheEntry& entry : entries)
+    {
+        if (entry.bitDepth == image->bit_depth &&
+            entry.range == image->range &&
+            entry.monochrome == monochrome &&
+            entry.isIdentityMatrix == isIdentityMatrix)
+        {
+            return entry.tables;
         }
-    };
+    }
+
+    // The tables are built while the lock is held so that the tiles which are decoded
+    // in parallel wait for the first tile to build them instead of building their own copy.
+    std::shared_ptr<const YUVLookupTables> tables = std::make_shared<const YUVLookupTables>(image, isIdentityMatrix);
 
-    constexpr std::array<uint8_t, 256> BuildIdentity8LimitedToFullYLookupTable()
+    entries.push_back(CacheEntry{ image->bit_depth, image->range, monochrome, isIdentityMatrix, tables });
+
+    return tables;
+}
+
+namespace
+{
+    template <typename T>
+    constexpr std::array<T, 256> BuildIdentity8LimitedToFullYLookupTable()
     {
-        std::array<uint8_t, 256> table = {};
+        std::array<T, 256> table = {};
 
         for (size_t i = 0; i < table.size(); ++i)
         {
-            table[i] = static_cast<uint8_t>(avifLimitedToFullY(8, static_cast<int>(i)));
+            table[i] = static_cast<T>(avifLimitedToFullY(8, static_cast<int>(i)));
         }
 
         return table;
     }
 
-    void Identity16ToRGB8Color(
-        const aom_image_t* image,
-        const DecodeInfo* decodeInfo,
-        const YUVLookupTables& tables,
-        BitmapData* bgraImage)
+    constexpr std::array<uint8_t, 256> identity8LimitedToFullYTable = BuildIdentity8LimitedToFullYLookupTable<uint8_t>();
+    // The vectorized row converters use 32-bit table entries.
+    constexpr std::array<uint32_t, 256> identity8LimitedToFullYVectorTable = BuildIdentity8LimitedToFullYLookupTable<uint32_t>();
+
+    YUVToRGBRowConstants GetRowConstants(
+        const YUVLookupTables* tables,
+        const YUVCoefficiants* yuvCoefficiants)
     {
-        uint32_t yuvMaxChannel = (1 << image->bit_depth) - 1;
-        constexpr float rgbMaxChannel = 255.0f;
+        YUVToRGBRowConstants constants{};
 
-        uint32_t uPlaneIndex = AOM_PLANE_U;
-        uint32_t vPlaneIndex = AOM_PLANE_V;
+        if (tables)
+        {
+            constants.unormFloatTableY = tables->unormFloatTableY.get();
+            constants.unormFloatTableUV = tables->unormFloatTableUV.get();
+        }
 
-        if (image->fmt & AOM_IMG_FMT_UV_FLIP)
+        if (yuvCoefficiants)
         {
-            uPlaneIndex = AOM_PLANE_V;
-            vPlaneIndex = AOM_PLANE_U;
+            const float kr = yuvCoefficiants->kr;
+            const float kg = yuvCoefficiants->kg;
+            const float kb = yuvCoefficiants->kb;
+
+            constants.crToR = 2 * (1 - kr);
+            constants.cbToB = 2 * (1 - kb);
+            constants.crToG = kr * (1 - kr);
+            constants.cbToG = kb * (1 - kb);
+            constants.kg = kg;
         }
 
-        uint32_t copyWidth;
-        uint32_t copyHeight;
-        GetCopySizes(image, decodeInfo, bgraImage, copyWidth, copyHeight);
+        return constants;
+    }
 
-        for (uint32_t y = 0; y < copyHeight; ++y)
-        {
-            const uint32_t uvJ = y >> image->y_chroma_shift;
-            uint16_t* ptrY = reinterpret_cast<uint16_t*>(&image->planes[AOM_PLANE_Y][(y * image->stride[AOM_PLANE_Y])]);
-            uint16_t* ptrU = reinterpret_cast<uint16_t*>(&image->planes[uPlaneIndex][(uvJ * image->stride[uPlaneIndex])]);
-            uint16_t* ptrV = reinterpret_cast<uint16_t*>(&image->planes[vPlaneIndex][(uvJ * image->stride[vPlaneIndex])]);
+    // The state that is shared by all rows of the image.
+    struct ImageConverterContext
+    {
+        YUVToRGBRowConstants rowConstants;
+        const DecodedImageRowConverters& rowConverters;
+    };
+
+    // The channel type of the output pixel, ColorBgra has 8-bit channels and ColorBgra64 has 16-bit channels.
+    template <typename TPixel>
+    using PixelChannel = decltype(TPixel::r);
+
+    template <typename TChannel>
+    inline TChannel UnormFloatToChannel(float value)
+    {
+        constexpr float rgbMaxChannel = static_cast<float>(std::numeric_limits<TChannel>::max());
 
-            const size_t destX = static_cast<size_t>(decodeInfo->tileColumnIndex) * decodeInfo->expectedWidth;
-            const size_t destY = static_cast<size_t>(y) + (static_cast<size_t>(decodeInfo->tileRowIndex) * decodeInfo->expectedHeight);
+        return static_cast<TChannel>(0.5f + (Clamp(value, 0.0f, 1.0f) * rgbMaxChannel));
+    }
 
-            ColorBgra* dstPtr = reinterpret_cast<ColorBgra*>(bgraImage->scan0 + (destY * bgraImage->stride) + (destX * sizeof(ColorBgra)));
+    // The pixel converters provide the per-pixel conversion and the matching vectorized row converter
+    // for each sample type, output pixel type and matrix, the image loops below are specialized on them
+    // at compile time.
 
-            for (uint32_t x = 0; x < copyWidth; ++x)
+    template <typename TSample, typename TPixel>
+    struct YUVColorConverter
+    {
+        static uint32_t ConvertRow(
+            const TSample* ptrY,
+            const TSample* ptrU,
+            const TSample* ptrV,
+            uint32_t xChromaShift,
+            uint32_t width,
+            const ImageConverterContext& context,
+            TPixel* dstPtr)
+        {
+            if constexpr (std::is_same_v<TPixel, ColorBgra>)
+            {
+                if constexpr (std::is_same_v<TSample, uint8_t>)
+                {
+                    if (context.rowConverters.yuv8ToRGB8Color)
+                    {
+                        return context.rowConverters.yuv8ToRGB8Color(ptrY, ptrU, ptrV, xChromaShift, width, context.rowConstants, dstPtr);
+                    }
+                }
+                else
+                {
+                    if (context.rowConverters.yuv16ToRGB8Color)
+                    {
+                        return context.rowConverters.yuv16ToRGB8Color(ptrY, ptrU, ptrV, xChromaShift, width, context.rowConstants, dstPtr);
+                    }
+                }
+            }
+            else if constexpr (std::is_same_v<TSample, uint16_t>)
             {
-                // Unpack Identity into unorm
-                uint32_t uvI = x >> image->x_chroma_shift;
-
-                // Clamp the values to the lookup table range
-                uint32_t unormY = Min(ptrY[x], yuvMaxChannel);
-                uint32_t unormU = Min(ptrU[uvI], yuvMaxChannel);
-                uint32_t unormV = Min(ptrV[uvI], yuvMaxChannel);
-
-                // Convert unorm to float
-                const float Y = tables.unormFloatTableY[unormY];
-                const float Cb = tables.unormFloatTableUV[unormU];
-                const float Cr = tables.unormFloatTableUV[unormV];
-
-                float G = Y;
-                float B = Cb;
-                float R = Cr;
-                R = Clamp(R, 0.0f, 1.0f);
-                G = Clamp(G, 0.0f, 1.0f);
-                B = Clamp(B, 0.0f, 1.0f);
-
-                dstPtr->r = static_cast<uint8_t>(0.5f + (R * rgbMaxChannel));
-                dstPtr->g = static_cast<uint8_t>(0.5f + (G * rgbMaxChannel));
-                dstPtr->b = static_cast<uint8_t>(0.5f + (B * rgbMaxChannel));
-                ++dstPtr;
+                if (context.rowConverters.yuv16ToRGB16Color)
+                {
+                    return context.rowConverters.yuv16ToRGB16Color(ptrY, ptrU, ptrV, xChromaShift, width, context.rowConstants, dstPtr);
+                }
             }
+
+            return 0;
         }
-    }
 
-    void Identity16ToRGB8Mono(
-        const aom_image_t* image,
-        const DecodeInfo* decodeInfo,
-        const YUVLookupTables& tables,
-        BitmapData* bgraImage)
-    {
-        uint32_t yuvMaxChannel = (1 << image->bit_depth) - 1;
-        constexpr float rgbMaxChannel = 255.0f;
+        static inline void ConvertPixel(
+            TSample unormY,
+            TSample unormU,
+            TSample unormV,
+            const ImageConverterContext& context,
+            TPixel* dstPtr)
+        {
+            const YUVToRGBRowConstants& constants = context.rowConstants;
 
-        uint32_t copyWidth;
-        uint32_t copyHeight;
-        GetCopySizes(image, decodeInfo, bgraImage, copyWidth, copyHeight);
+            // Convert unorm to float
+            const float Y = constants.unormFloatTableY[unormY];
+            const float Cb = constants.unormFloatTableUV[unormU];
+            const float Cr = constants.unormFloatTableUV[unormV];
+
+            const float R = Y + constants.crToR * Cr;
+            const float B = Y + constants.cbToB * Cb;
+            const float G = Y - ((2 * ((constants.crToG * Cr) + (constants.cbToG * Cb))) / constants.kg);
+
+            dstPtr->r = UnormFloatToChannel<PixelChannel<TPixel>>(R);
+            dstPtr->g = UnormFloatToChannel<PixelChannel<TPixel>>(G);
+            dstPtr->b = UnormFloatToChannel<PixelChannel<TPixel>>(B);
+        }
+    };
 
-        for (uint32_t y = 0; y < copyHeight; ++y)
+    // This is used for the limited range high bit depth Identity matrix images and for the Identity matrix
+    // images that are converted to 16-bit per channel output.
+    template <typename TSample, typename TPixel>
+    struct IdentityColorConverter
+    {
+        static uint32_t ConvertRow(
+            const TSample* ptrY,
+            const TSample* ptrU,
+            const TSample* ptrV,
+            uint32_t xChromaShift,
+            uint32_t width,
+            const ImageConverterContext& context,
+            TPixel* dstPtr)
         {
-            uint16_t* ptrY = reinterpret_cast<uint16_t*>(&image->planes[AOM_PLANE_Y][(y * image->stride[AOM_PLANE_Y])]);
+            if constexpr (std::is_same_v<TSample, uint16_t>)
+            {
+                if constexpr (std::is_same_v<TPixel, ColorBgra>)
+                {
+                    if (context.rowConverters.identity16ToRGB8Color)
+                    {
+                        return context.rowConverters.identity16ToRGB8Color(ptrY, ptrU, ptrV, xChromaShift, width, context.rowConstants, dstPtr);
+                    }
+                }
+                else
+                {
+                    if (context.rowConverters.identity16ToRGB16Color)
+                    {
+                        return context.rowConverters.identity16ToRGB16Color(ptrY, ptrU, ptrV, xChromaShift, width, context.rowConstants, dstPtr);
+                    }
+                }
+            }
 
-            const size_t destX = static_cast<size_t>(decodeInfo->tileColumnIndex) * decodeInfo->expectedWidth;
-            const size_t destY = static_cast<size_t>(y) + (static_cast<size_t>(decodeInfo->tileRowIndex) * decodeInfo->expectedHeight);
+            return 0;
+        }
 
-            ColorBgra* dstPtr = reinterpret_cast<ColorBgra*>(bgraImage->scan0 + (destY * bgraImage->stride) + (destX * sizeof(ColorBgra)));
+        static inline void ConvertPixel(
+            TSample unormY,
+            TSample unormU,
+            TSample unormV,
+            const ImageConverterContext& context,
+            TPixel* dstPtr)
+        {
+            // The Identity matrix stores G in Y, B in U and R in V.
+            dstPtr->r = UnormFloatToChannel<PixelChannel<TPixel>>(context.rowConstants.unormFloatTableUV[unormV]);
+            dstPtr->g = UnormFloatToChannel<PixelChannel<TPixel>>(context.rowConstants.unormFloatTableY[unormY]);
+            dstPtr->b = UnormFloatToChannel<PixelChannel<TPixel>>(context.rowConstants.unormFloatTableUV[unormU]);
+        }
+    };
 
-            for (uint32_t x = 0; x < copyWidth; ++x)
+    template <bool limitedRange>
+    struct Identity8ColorConverter
+    {
+        static uint32_t ConvertRow(
+            const uint8_t* ptrY,
+            const uint8_t* ptrU,
+            const uint8_t* ptrV,
+            uint32_t xChromaShift,
+            uint32_t width,
+            const ImageConverterContext& context,
+            ColorBgra* dstPtr)
+        {
+            if (context.rowConverters.identity8ToRGB8Color)
             {
-                // Clamp the value to the lookup table range
-                uint32_t unormY = Min(ptrY[x], yuvMaxChannel);
+                const uint32_t* limitedToFullY = limitedRange ? identity8LimitedToFullYVectorTable.data() : nullptr;
 
-                // Convert unorm to float
-                const float Y = Clamp(tables.unormFloatTableY[unormY], 0.0f, 1.0f);
+                return context.rowConverters.identity8ToRGB8Color(ptrY, ptrU, ptrV, xChromaShift, width, limitedToFullY, dstPtr);
+            }
 
-                const uint8_t gray = static_cast<uint8_t>(0.5f + (Y * rgbMaxChannel));
+            return 0;
+        }
 
-                dstPtr->g = gray;
-                dstPtr->b = gray;
-                dstPtr->r = gray;
-                ++dstPtr;
+        static inline void ConvertPixel(
+            uint8_t unormY,
+            uint8_t unormU,
+            uint8_t unormV,
+            const ImageConverterContext&,
+            ColorBgra* dstPtr)
+        {
+            if constexpr (limitedRange)
+            {
+                // The identity matrix uses the Y plane range for U and V.
+                unormY = identity8LimitedToFullYTable[unormY];
+                unormU = identity8LimitedToFullYTable[unormU];
+                unormV = identity8LimitedToFullYTable[unormV];
             }
+
+            dstPtr->g = unormY;
+            dstPtr->b = unormU;
+            dstPtr->r = unormV;
         }
+    };
+
+    // Narrows a full range high bit depth sample to 8 bits without the lookup tables, the result is
+    // the same as the lookup table conversion, round(sample * 255 / maxSample).
+    // (x + (x >> bitDepth) + 1) >> bitDepth is equal to x / maxSample for all x < 2^(2 * bitDepth).
+    template <uint32_t bitDepth>
+    inline uint8_t NarrowFullRangeSample(uint16_t sample)
+    {
+        constexpr uint32_t maxSample = (1U << bitDepth) - 1;
+
+        const uint32_t x = (std::min(static_cast<uint32_t>(sample), maxSample) * 255) + (maxSample >> 1);
+
+        return static_cast<uint8_t>((x + (x >> bitDepth) + 1) >> bitDepth);
     }
 
-    void Identity8ToRGB8Color(
-        const aom_image_t* image,
-        const DecodeInfo* decodeInfo,
-        BitmapData* bgraImage)
+    // The full range high bit depth Identity matrix images that are converted to 8-bit per channel output.
+    template <uint32_t bitDepth>
+    struct FullRangeIdentity16ColorConverter
     {
-        uint32_t uPlaneIndex = AOM_PLANE_U;
-        uint32_t vPlaneIndex = AOM_PLANE_V;
+        static uint32_t ConvertRow(
+            const uint16_t* ptrY,
+            const uint16_t* ptrU,
+            const uint16_t* ptrV,
+            uint32_t xChromaShift,
+            uint32_t width,
+            const ImageConverterContext& context,
+            ColorBgra* dstPtr)
+        {
+            if (context.rowConverters.fullRangeIdentity16ToRGB8Color)
+            {
+                return context.rowConverters.fullRangeIdentity16ToRGB8Color(ptrY, ptrU, ptrV, xChromaShift, width, bitDepth, dstPtr);
+            }
 
-        if (image->fmt & AOM_IMG_FMT_UV_FLIP)
+            return 0;
+        }
+
+        static inline void ConvertPixel(
+            uint16_t unormY,
+            uint16_t unormU,
+            uint16_t unormV,
+            const ImageConverterContext&,
+            ColorBgra* dstPtr)
         {
-            uPlaneIndex = AOM_PLANE_V;
-            vPlaneIndex = AOM_PLANE_U;
+            dstPtr->g = NarrowFullRangeSample<bitDepth>(unormY);
+            dstPtr->b = NarrowFullRangeSample<bitDepth>(unormU);
+            dstPtr->r = NarrowFullRangeSample<bitDepth>(unormV);
         }
+    };
 
-        uint32_t copyWidth;
-        uint32_t copyHeight;
-        GetCopySizes(image, decodeInfo, bgraImage, copyWidth, copyHeight);
+    // The full range high bit depth monochrome images that are converted to 8-bit per channel output.
+    template <uint32_t bitDepth>
+    struct FullRangeMonochrome16Converter
+    {
+        static uint32_t ConvertRow(
+            const uint16_t* ptrY,
+            uint32_t width,
+            const ImageConverterContext& context,
+            ColorBgra* dstPtr)
+        {
+            if (context.rowConverters.fullRangeY16ToRGB8Mono)
+            {
+                return context.rowConverters.fullRangeY16ToRGB8Mono(ptrY, width, bitDepth, dstPtr);
+            }
 
-        static constexpr std::array<uint8_t, 256> limitedToFullY = BuildIdentity8LimitedToFullYLookupTable();
+            return 0;
+        }
 
-        for (uint32_t y = 0; y < copyHeight; ++y)
+        static inline void ConvertPixel(uint16_t unormY, const ImageConverterContext&, ColorBgra* dstPtr)
         {
-            const uint32_t uvJ = y >> image->y_chroma_shift;
-            uint8_t* ptrY = &image->planes[AOM_PLANE_Y][(y * image->stride[AOM_PLANE_Y])];
-            uint8_t* ptrU = &image->planes[uPlaneIndex][(uvJ * image->stride[uPlaneIndex])];
-            uint8_t* ptrV = &image->planes[vPlaneIndex][(uvJ * image->stride[vPlaneIndex])];
+            const uint8_t gray = NarrowFullRangeSample<bitDepth>(unormY);
 
-            const size_t destX = static_cast<size_t>(decodeInfo->tileColumnIndex) * decodeInfo->expectedWidth;
-            const size_t destY = static_cast<size_t>(y) + (static_cast<size_t>(decodeInfo->tileRowIndex) * decodeInfo->expectedHeight);
-
-            ColorBgra* dstPtr = reinterpret_cast<ColorBgra*>(bgraImage->scan0 + (destY * bgraImage->stride) + (destX * sizeof(ColorBgra)));
+            dstPtr->r = gray;
+            dstPtr->g = gray;
+            dstPtr->b = gray;
+        }
+    };
 
-            for (uint32_t x = 0; x < copyWidth; ++x)
+    // A monochrome YUV image has zero chroma, so the color conversion reduces to the clamped Y value.
+    // This is also used for the monochrome images that use the Identity matrix, except for the images
+    // that are converted to 8-bit per channel output by the integer converters.
+    template <typename TSample, typename TPixel>
+    struct MonochromeConverter
+    {
+        static uint32_t ConvertRow(
+            const TSample* ptrY,
+            uint32_t width,
+            const ImageConverterContext& context,
+            TPixel* dstPtr)
+        {
+            if constexpr (std::is_same_v<TPixel, ColorBgra>)
             {
-                // Unpack Identity into unorm
-                uint32_t uvI = x >> image->x_chroma_shift;
-                uint8_t unormY = ptrY[x];
-                uint8_t unormU = ptrU[uvI];
-                uint8_t unormV = ptrV[uvI];
-
-                // adjust for limited/full color range, if need be
-                if (image->range == AOM_CR_STUDIO_RANGE)
+                if constexpr (std::is_same_v<TSample, uint8_t>)
                 {
-                    // The identity matrix uses the Y plane range for U and V.
-                    unormY = limitedToFullY[unormY];
-                    unormU = limitedToFullY[unormU];
-                    unormV = limitedToFullY[unormV];
+                    if (context.rowConverters.y8ToRGB8Mono)
+                    {
+                        return context.rowConverters.y8ToRGB8Mono(ptrY, width, context.rowConstants, dstPtr);
+                    }
+                }
+                else
+                {
+                    if (context.rowConverters.y16ToRGB8Mono)
+                    {
+                        return context.rowConverters.y16ToRGB8Mono(ptrY, width, context.rowConstants, dstPtr);
+                    }
+                }
+            }
+            else if constexpr (std::is_same_v<TSample, uint16_t>)
+            {
+                if (context.rowConverters.y16ToRGB16Mono)
+                {
+                    return context.rowConverters.y16ToRGB16Mono(ptrY, width, context.rowConstants, dstPtr);
                 }
-
-                dstPtr->g = unormY;
-                dstPtr->b = unormU;
-                dstPtr->r = unormV;
-                ++dstPtr;
             }
+
+            return 0;
         }
-    }
 
-    void Identity8ToRGB8Mono(
-        const aom_image_t* image,
-        const DecodeInfo* decodeInfo,
-        BitmapData* bgraImage)
-    {
-        uint32_t copyWidth;
-        uint32_t copyHeight;
-        GetCopySizes(image, decodeInfo, bgraImage, copyWidth, copyHeight);
+        static inline void ConvertPixel(TSample unormY, const ImageConverterContext& context, TPixel* dstPtr)
+        {
+            const PixelChannel<TPixel> gray = UnormFloatToChannel<PixelChannel<TPixel>>(context.rowConstants.unormFloatTableY[unormY]);
 
-        static constexpr std::array<uint8_t, 256> limitedToFullY = BuildIdentity8LimitedToFullYLookupTable();
+            dstPtr->r = gray;
+            dstPtr->g = gray;
+            dstPtr->b = gray;
+        }
+    };
 
-        for (uint32_t y = 0; y < copyHeight; ++y)
+    template <bool limitedRange>
+    struct Identity8MonochromeConverter
+    {
+        static uint32_t ConvertRow(
+            const uint8_t* ptrY,
+            uint32_t width,
+            const ImageConverterContext& context,
+            ColorBgra* dstPtr)
         {
-            uint8_t* ptrY = &image->planes[AOM_PLANE_Y][(y * image->stride[AOM_PLANE_Y])];
+            if (context.rowConverters.identity8ToRGB8Mono)
+            {
+                const uint32_t* limitedToFullY = limitedRange ? identity8LimitedToFullYVectorTable.data() : nullptr;
 
-            const size_t destX = static_cast<size_t>(decodeInfo->tileColumnIndex) * decodeInfo->expectedWidth;
-            const size_t destY = static_cast<size_t>(y) + (static_cast<size_t>(decodeInfo->tileRowIndex) * decodeInfo->expectedHeight);
+                return context.rowConverters.identity8ToRGB8Mono(ptrY, width, limitedToFullY, dstPtr);
+            }
 
-            ColorBgra* dstPtr = reinterpret_cast<ColorBgra*>(bgraImage->scan0 + (destY * bgraImage->stride) + (destX * sizeof(ColorBgra)));
+            return 0;
+        }
 
-            for (uint32_t x = 0; x < copyWidth; ++x)
-            {
-                // Unpack Identity into unorm
-                uint8_t unormY = ptrY[x];
+        static inline void ConvertPixel(uint8_t unormY, const ImageConverterContext&, ColorBgra* dstPtr)
+        {
+            const uint8_t gray = limitedRange ? identity8LimitedToFullYTable[unormY] : unormY;
+
+            dstPtr->r = gray;
+            dstPtr->g = gray;
+            dstPtr->b = gray;
+        }
+    };
 
-                // adjust for limited/full color range, if need be
-                if (image->range == AOM_CR_STUDIO_RANGE)
+    template <typename TSample, typename TPixel>
+    struct AlphaConverter
+    {
+        static uint32_t ConvertRow(
+            const TSample* ptrY,
+            uint32_t width,
+            const ImageConverterContext& context,
+            TPixel* dstPtr)
+        {
+            if constexpr (std::is_same_v<TPixel, ColorBgra>)
+            {
+                if constexpr (std::is_same_v<TSample, uint8_t>)
+                {
+                    if (context.rowConverters.y8ToAlpha8)
+                    {
+                        return context.rowConverters.y8ToAlpha8(ptrY, width, context.rowConstants, dstPtr);
+                    }
+                }
+                else
+                {
+                    if (context.rowConverters.y16ToAlpha8)
+                    {
+                        return context.rowConverters.y16ToAlpha8(ptrY, width, context.rowConstants, dstPtr);
+                    }
+                }
+            }
+            else if constexpr (std::is_same_v<TSample, uint16_t>)
+            {
+                if (context.rowConverters.y16ToAlpha16)
                 {
-                    unormY = limitedToFullY[unormY];
+                    return context.rowConverters.y16ToAlpha16(ptrY, width, context.rowConstants, dstPtr);
                 }
+            }
 
-                const uint8_t gray = unormY;
+            return 0;
+        }
 
-                dstPtr->r = gray;
-                dstPtr->g = gray;
-                dstPtr->b = gray;
-                ++dstPtr;
-            }
+        static inline void ConvertPixel(TSample unormY, const ImageConverterContext& context, TPixel* dstPtr)
+        {
+            dstPtr->a = UnormFloatToChannel<PixelChannel<TPixel>>(context.rowConstants.unormFloatTableY[unormY]);
         }
+    };
+
+    template <typename TSample>
+    inline const TSample* GetPlaneRow(const aom_image_t* image, uint32_t plane, uint32_t row)
+    {
+        return reinterpret_cast<const TSample*>(&image->planes[plane][(row * image->stride[plane])]);
     }
 
-    void YUV16ToRGB8Color(
-        const aom_image_t* image,
-        const YUVCoefficiants& yuvCoefficiants,
-        const YUVLookupTables& tables,
-        const DecodeInfo* decodeInfo,
-        BitmapData* bgraImage)
+    // The rows that an image converter writes to, row y of the decoded image is stored at scan0 + ((y - firstRow) * stride).
+    struct ImageDestination
+    {
+        uint8_t* scan0;
+        size_t stride;
+        uint32_t firstRow;
+
+        template <typename TPixel>
+        inline TPixel* GetRow(uint32_t y) const
+        {
+            return reinterpret_cast<TPixel*>(scan0 + (static_cast<size_t>(y - firstRow) * stride));
+        }
+    };
+
+    // Gets the region of the output image that the tile is written to.
+    template <typename TPixel>
+    ImageDestination GetTileDestination(const DecodeInfo* decodeInfo, const BitmapData* bgraImage)
     {
-        const float kr = yuvCoefficiants.kr;
-        const float kg = yuvCoefficiants.kg;
-        const float kb = yuvCoefficiants.kb;
+        const uint32_t shift = decodeInfo->downscaleShift;
+        const size_t destX = (static_cast<size_t>(decodeInfo->tileColumnIndex) * decodeInfo->expectedWidth) >> shift;
+        const size_t destY = (static_cast<size_t>(decodeInfo->tileRowIndex) * decodeInfo->expectedHeight) >> shift;
 
-        uint32_t yuvMaxChannel = (1 << image->bit_depth) - 1;
-        constexpr float rgbMaxChannel = 255.0f;
+        return ImageDestination{ bgraImage->scan0 + (destY * bgraImage->stride) + (destX * sizeof(TPixel)), bgraImage->stride, 0 };
+    }
 
+    // Converts the rows [startRow, endRow) of the image.
+    typedef void (*ImageConverterProc)(
+        const aom_image_t* image,
+        const ImageConverterContext& context,
+        const ImageDestination& destination,
+        uint32_t copyWidth,
+        uint32_t startRow,
+        uint32_t endRow);
+
+    template <typename TSample, typename TPixel, uint32_t xChromaShift, uint32_t yChromaShift, typename TConverter>
+    void ConvertPlanarImage(
+        const aom_image_t* image,
+        const ImageConverterContext& context,
+        const ImageDestination& destination,
+        uint32_t copyWidth,
+        uint32_t startRow,
+        uint32_t endRow)
+    {
         uint32_t uPlaneIndex = AOM_PLANE_U;
         uint32_t vPlaneIndex = AOM_PLANE_V;
 
@@ -453,522 +750,1108 @@ namespace
             vPlaneIndex = AOM_PLANE_U;
         }
 
-        uint32_t copyWidth;
-        uint32_t copyHeight;
-        GetCopySizes(image, decodeInfo, bgraImage, copyWidth, copyHeight);
-
-        for (uint32_t y = 0; y < copyHeight; ++y)
+        for (uint32_t y = startRow; y < endRow; ++y)
         {
-            const uint32_t uvJ = y >> image->y_chroma_shift;
-            uint16_t* ptrY = reinterpret_cast<uint16_t*>(&image->planes[AOM_PLANE_Y][(y * image->stride[AOM_PLANE_Y])]);
-            uint16_t* ptrU = reinterpret_cast<uint16_t*>(&image->planes[uPlaneIndex][(uvJ * image->stride[uPlaneIndex])]);
-            uint16_t* ptrV = reinterpret_cast<uint16_t*>(&image->planes[vPlaneIndex][(uvJ * image->stride[vPlaneIndex])]);
+            const uint32_t uvJ = y >> yChromaShift;
+            const TSample* ptrY = GetPlaneRow<TSample>(image, AOM_PLANE_Y, y);
+            const TSample* ptrU = GetPlaneRow<TSample>(image, uPlaneIndex, uvJ);
+            const TSample* ptrV = GetPlaneRow<TSample>(image, vPlaneIndex, uvJ);
 
-            const size_t destX = static_cast<size_t>(decodeInfo->tileColumnIndex) * decodeInfo->expectedWidth;
-            const size_t destY = static_cast<size_t>(y) + (static_cast<size_t>(decodeInfo->tileRowIndex) * decodeInfo->expectedHeight);
+            TPixel* dstPtr = destination.GetRow<TPixel>(y);
 
-            ColorBgra* dstPtr = reinterpret_cast<ColorBgra*>(bgraImage->scan0 + (destY * bgraImage->stride) + (destX * sizeof(ColorBgra)));
+            // The vectorized converter always returns a multiple of the vector width, so x is even.
+            uint32_t x = TConverter::ConvertRow(ptrY, ptrU, ptrV, xChromaShift, copyWidth, context, dstPtr);
 
-            for (uint32_t x = 0; x < copyWidth; ++x)
+            if constexpr (xChromaShift == 0)
             {
-                // Unpack YUV into unorm
-                uint32_t uvI = x >> image->x_chroma_shift;
-
-                // Clamp the values to the lookup table range
-                uint32_t unormY = Min(ptrY[x], yuvMaxChannel);
-                uint32_t unormU = Min(ptrU[uvI], yuvMaxChannel);
-                uint32_t unormV = Min(ptrV[uvI], yuvMaxChannel);
-
-                // Convert unorm to float
-                const float Y = tables.unormFloatTableY[unormY];
-                const float Cb = tables.unormFloatTableUV[unormU];
-                const float Cr = tables.unormFloatTableUV[unormV];
-
-                float R = Y + (2 * (1 - kr)) * Cr;
-                float B = Y + (2 * (1 - kb)) * Cb;
-                float G = Y - ((2 * ((kr * (1 - kr) * Cr) + (kb * (1 - kb) * Cb))) / kg);
-                R = Clamp(R, 0.0f, 1.0f);
-                G = Clamp(G, 0.0f, 1.0f);
-                B = Clamp(B, 0.0f, 1.0f);
-
-                dstPtr->r = static_cast<uint8_t>(0.5f + (R * rgbMaxChannel));
-                dstPtr->g = static_cast<uint8_t>(0.5f + (G * rgbMaxChannel));
-                dstPtr->b = static_cast<uint8_t>(0.5f + (B * rgbMaxChannel));
-                ++dstPtr;
+                for (; x < copyWidth; ++x)
+                {
+                    TConverter::ConvertPixel(ptrY[x], ptrU[x], ptrV[x], context, dstPtr + x);
+                }
+            }
+            else
+            {
+                // Each chroma sample is shared by a pair of horizontal pixels.
+                for (; (x + 1) < copyWidth; x += 2)
+                {
+                    const uint32_t uvI = x >> 1;
+                    const TSample unormU = ptrU[uvI];
+                    const TSample unormV = ptrV[uvI];
+
+                    TConverter::ConvertPixel(ptrY[x], unormU, unormV, context, dstPtr + x);
+                    TConverter::ConvertPixel(ptrY[x + 1], unormU, unormV, context, dstPtr + x + 1);
+                }
+
+                if (x < copyWidth)
+                {
+                    const uint32_t uvI = x >> 1;
+
+                    TConverter::ConvertPixel(ptrY[x], ptrU[uvI], ptrV[uvI], context, dstPtr + x);
+                }
             }
         }
     }
 
-    void YUV16ToRGB8Mono(
+    template <typename TSample, typename TPixel, typename TConverter>
+    void ConvertSinglePlaneImage(
         const aom_image_t* image,
-        const YUVCoefficiants& yuvCoefficiants,
-        const YUVLookupTables& tables,
-        const DecodeInfo* decodeInfo,
-        BitmapData* bgraImage)
+        const ImageConverterContext& context,
+        const ImageDestination& destination,
+        uint32_t copyWidth,
+        uint32_t startRow,
+        uint32_t endRow)
     {
-        const float kr = yuvCoefficiants.kr;
-        const float kg = yuvCoefficiants.kg;
-        const float kb = yuvCoefficiants.kb;
-
-        uint32_t yuvMaxChannel = (1 << image->bit_depth) - 1;
-        constexpr float rgbMaxChannel = 255.0f;
-
-        uint32_t copyWidth;
-        uint32_t copyHeight;
-        GetCopySizes(image, decodeInfo, bgraImage, copyWidth, copyHeight);
-
-        for (uint32_t y = 0; y < copyHeight; ++y)
+        for (uint32_t y = startRow; y < endRow; ++y)
         {
-            uint16_t* ptrY = reinterpret_cast<uint16_t*>(&image->planes[AOM_PLANE_Y][(y * image->stride[AOM_PLANE_Y])]);
+            const TSample* ptrY = GetPlaneRow<TSample>(image, AOM_PLANE_Y, y);
 
-            const size_t destX = static_cast<size_t>(decodeInfo->tileColumnIndex) * decodeInfo->expectedWidth;
-            const size_t destY = static_cast<size_t>(y) + (static_cast<size_t>(decodeInfo->tileRowIndex) * decodeInfo->expectedHeight);
+            TPixel* dstPtr = destination.GetRow<TPixel>(y);
 
-            ColorBgra* dstPtr = reinterpret_cast<ColorBgra*>(bgraImage->scan0 + (destY * bgraImage->stride) + (destX * sizeof(ColorBgra)));
-
-            for (uint32_t x = 0; x < copyWidth; ++x)
+            for (uint32_t x = TConverter::ConvertRow(ptrY, copyWidth, context, dstPtr); x < copyWidth; ++x)
             {
-                // Clamp the value to the lookup table range
-                uint32_t unormY = Min(ptrY[x], yuvMaxChannel);
-
-                // Convert unorm to float
-                const float Y = Clamp(tables.unormFloatTableY[unormY], 0.0f, 1.0f);
-                const float Cb = 0.0f;
-                const float Cr = 0.0f;
-
-                float R = Y + (2 * (1 - kr)) * Cr;
-                float B = Y + (2 * (1 - kb)) * Cb;
-                float G = Y - ((2 * ((kr * (1 - kr) * Cr) + (kb * (1 - kb) * Cb))) / kg);
-                R = Clamp(R, 0.0f, 1.0f);
-                G = Clamp(G, 0.0f, 1.0f);
-                B = Clamp(B, 0.0f, 1.0f);
-
-                dstPtr->r = static_cast<uint8_t>(0.5f + (R * rgbMaxChannel));
-                dstPtr->g = static_cast<uint8_t>(0.5f + (G * rgbMaxChannel));
-                dstPtr->b = static_cast<uint8_t>(0.5f + (B * rgbMaxChannel));
-                ++dstPtr;
+                TConverter::ConvertPixel(ptrY[x], context, dstPtr + x);
             }
         }
     }
 
-    void YUV8ToRGB8Color(
-        const aom_image_t* image,
-        const YUVCoefficiants& yuvCoefficiants,
-        const YUVLookupTables& tables,
-        const DecodeInfo* decodeInfo,
-        BitmapData* bgraImage)
+    template <typename TSample, typename TPixel, typename TConverter>
+    ImageConverterProc SelectPlanarImageConverter(const aom_image_t* frame)
     {
-        const float kr = yuvCoefficiants.kr;
-        const float kg = yuvCoefficiants.kg;
-        const float kb = yuvCoefficiants.kb;
-
-        constexpr float rgbMaxChannel = 255.0f;
-
-        uint32_t uPlaneIndex = AOM_PLANE_U;
-        uint32_t vPlaneIndex = AOM_PLANE_V;
-
-        if (image->fmt & AOM_IMG_FMT_UV_FLIP)
+        if (frame->x_chroma_shift == 0 && frame->y_chroma_shift == 0)
         {
-            uPlaneIndex = AOM_PLANE_V;
-            vPlaneIndex = AOM_PLANE_U;
+            return ConvertPlanarImage<TSample, TPixel, 0, 0, TConverter>;
+        }
+        else if (frame->x_chroma_shift == 1 && frame->y_chroma_shift == 0)
+        {
+            return ConvertPlanarImage<TSample, TPixel, 1, 0, TConverter>;
+        }
+        else if (frame->x_chroma_shift == 1 && frame->y_chroma_shift == 1)
+        {
+            return ConvertPlanarImage<TSample, TPixel, 1, 1, TConverter>;
+        }
+
+        return nullptr;
+    }
+
+    // The integer converters do not use the lookup tables, they are used for the images that are converted
+    // to 8-bit per channel output when the samples can be copied or narrowed without the float math.
+    // This is the case for the 8-bit Identity matrix images and the full range Identity matrix or monochrome images.
+    template <typename TPixel>
+    bool UsesIntegerConverters(const aom_image_t* frame, bool isIdentityMatrix)
+    {
+        if constexpr (std::is_same_v<TPixel, ColorBgra>)
+        {
+            if (isIdentityMatrix && frame->bit_depth == 8)
+            {
+                return true;
+            }
+
+            if ((isIdentityMatrix || frame->monochrome) && frame->range != AOM_CR_STUDIO_RANGE)
+            {
+                switch (frame->bit_depth)
+                {
+                case 8:
+                case 10:
+                case 12:
+                case 16:
+                    return true;
+                default:
+                    return false;
+                }
+            }
         }
 
-        uint32_t copyWidth;
-        uint32_t copyHeight;
-        GetCopySizes(image, decodeInfo, bgraImage, copyWidth, copyHeight);
-
-        for (uint32_t y = 0; y < copyHeight; ++y)
+        return false;
+    }
+
+    template <uint32_t bitDepth>
+    ImageConverterProc SelectFullRangeHighBitDepthConverter(const aom_image_t* frame)
+    {
+        if (frame->monochrome)
         {
-            const uint32_t uvJ = y >> image->y_chroma_shift;
-            uint8_t* ptrY = &image->planes[AOM_PLANE_Y][(y * image->stride[AOM_PLANE_Y])];
-            uint8_t* ptrU = &image->planes[uPlaneIndex][(uvJ * image->stride[uPlaneIndex])];
-            uint8_t* ptrV = &image->planes[vPlaneIndex][(uvJ * image->stride[vPlaneIndex])];
+            return ConvertSinglePlaneImage<uint16_t, ColorBgra, FullRangeMonochrome16Converter<bitDepth>>;
+        }
 
-            const size_t destX = static_cast<size_t>(decodeInfo->tileColumnIndex) * decodeInfo->expectedWidth;
-            const size_t destY = static_cast<size_t>(y) + (static_cast<size_t>(decodeInfo->tileRowIndex) * decodeInfo->expectedHeight);
+        return SelectPlanarImageConverter<uint16_t, ColorBgra, FullRangeIdentity16ColorConverter<bitDepth>>(frame);
+    }
 
-            ColorBgra* dstPtr = reinterpret_cast<ColorBgra*>(bgraImage->scan0 + (destY * bgraImage->stride) + (destX * sizeof(ColorBgra)));
+    template <typename TPixel>
+    ImageConverterProc SelectColorImageConverter(const aom_image_t* frame, bool isIdentityMatrix)
+    {
+        const bool highBitDepth = frame->bit_depth > 8;
+        const bool limitedRange = frame->range == AOM_CR_STUDIO_RANGE;
 
-            for (uint32_t x = 0; x < copyWidth; ++x)
+        if constexpr (std::is_same_v<TPixel, ColorBgra>)
+        {
+            if (UsesIntegerConverters<TPixel>(frame, isIdentityMatrix))
             {
-                // Unpack YUV into unorm
-                uint32_t uvI = x >> image->x_chroma_shift;
-                uint8_t unormY = ptrY[x];
-                uint8_t unormU = ptrU[uvI];
-                uint8_t unormV = ptrV[uvI];
-
-                // Convert unorm to float
-                const float Y = tables.unormFloatTableY[unormY];
-                const float Cb = tables.unormFloatTableUV[unormU];
-                const float Cr = tables.unormFloatTableUV[unormV];
-
-                float R = Y + (2 * (1 - kr)) * Cr;
-                float B = Y + (2 * (1 - kb)) * Cb;
-                float G = Y - ((2 * ((kr * (1 - kr) * Cr) + (kb * (1 - kb) * Cb))) / kg);
-                R = Clamp(R, 0.0f, 1.0f);
-                G = Clamp(G, 0.0f, 1.0f);
-                B = Clamp(B, 0.0f, 1.0f);
-
-                dstPtr->r = static_cast<uint8_t>(0.5f + (R * rgbMaxChannel));
-                dstPtr->g = static_cast<uint8_t>(0.5f + (G * rgbMaxChannel));
-                dstPtr->b = static_cast<uint8_t>(0.5f + (B * rgbMaxChannel));
-                ++dstPtr;
+                switch (frame->bit_depth)
+                {
+                case 10:
+                    return SelectFullRangeHighBitDepthConverter<10>(frame);
+                case 12:
+                    return SelectFullRangeHighBitDepthConverter<12>(frame);
+                case 16:
+                    return SelectFullRangeHighBitDepthConverter<16>(frame);
+                }
+
+                // The full range 8-bit monochrome samples are the output values for both the YUV and Identity matrix.
+                if (frame->monochrome)
+                {
+                    return limitedRange ? ConvertSinglePlaneImage<uint8_t, ColorBgra, Identity8MonochromeConverter<true>>
+                                        : ConvertSinglePlaneImage<uint8_t, ColorBgra, Identity8MonochromeConverter<false>>;
+                }
+
+                return limitedRange ? SelectPlanarImageConverter<uint8_t, ColorBgra, Identity8ColorConverter<true>>(frame)
+                                    : SelectPlanarImageConverter<uint8_t, ColorBgra, Identity8ColorConverter<false>>(frame);
             }
         }
+
+        if (frame->monochrome)
+        {
+            return highBitDepth ? ConvertSinglePlaneImage<uint16_t, TPixel, MonochromeConverter<uint16_t, TPixel>>
+                                : ConvertSinglePlaneImage<uint8_t, TPixel, MonochromeConverter<uint8_t, TPixel>>;
+        }
+
+        if (isIdentityMatrix)
+        {
+            return highBitDepth ? SelectPlanarImageConverter<uint16_t, TPixel, IdentityColorConverter<uint16_t, TPixel>>(frame)
+                                : SelectPlanarImageConverter<uint8_t, TPixel, IdentityColorConverter<uint8_t, TPixel>>(frame);
+        }
+        else
+        {
+            return highBitDepth ? SelectPlanarImageConverter<uint16_t, TPixel, YUVColorConverter<uint16_t, TPixel>>(frame)
+                                : SelectPlanarImageConverter<uint8_t, TPixel, YUVColorConverter<uint8_t, TPixel>>(frame);
+        }
     }
 
-    void YUV8ToRGB8Mono(
-        const aom_image_t* image,
-        const YUVCoefficiants& yuvCoefficiants,
-        const YUVLookupTables& tables,
-        const DecodeInfo* decodeInfo,
-        BitmapData* bgraImage)
+    std::shared_ptr<const YUVLookupTables> GetLookupTables(
+        const aom_image_t* frame,
+        bool isIdentityMatrix,
+        YUVLookupTableCache* lookupTableCache)
     {
-        const float kr = yuvCoefficiants.kr;
-        const float kg = yuvCoefficiants.kg;
-        const float kb = yuvCoefficiants.kb;
+        if (lookupTableCache)
+        {
+            return lookupTableCache->GetTables(frame, isIdentityMatrix);
+        }
 
-        constexpr float rgbMaxChannel = 255.0f;
+        return std::make_shared<const YUVLookupTables>(frame, isIdentityMatrix);
+    }
 
-        uint32_t copyWidth;
-        uint32_t copyHeight;
-        GetCopySizes(image, decodeInfo, bgraImage, copyWidth, copyHeight);
+    // The converter and the lookup tables that are shared by all rows of an image.
+    struct PreparedImageConverter
+    {
+        ImageConverterProc converter;
+        std::shared_ptr<const YUVLookupTables> lookupTable;
+        YUVToRGBRowConstants rowConstants;
+    };
+
+    template <typename TPixel>
+    DecoderStatus PrepareColorImageConverter(
+        const aom_image_t* frame,
+        const CICPColorData& colorInfo,
+        YUVLookupTableCache* lookupTableCache,
+        PreparedImageConverter& prepared)
+    {
+        // The Identity matrix coefficient contains RGB color values.
+        const bool isIdentityMatrix = colorInfo.matrixCoefficients == CICPMatrixCoefficients::Identity;
 
-        for (uint32_t y = 0; y < copyHeight; ++y)
+        prepared.converter = SelectColorImageConverter<TPixel>(frame, isIdentityMatrix);
+
+        if (!prepared.converter)
         {
-            uint8_t* ptrY = &image->planes[AOM_PLANE_Y][(y * image->stride[AOM_PLANE_Y])];
+            return DecoderStatus::UnknownYUVFormat;
+        }
 
-            const size_t destX = static_cast<size_t>(decodeInfo->tileColumnIndex) * decodeInfo->expectedWidth;
-            const size_t destY = static_cast<size_t>(y) + (static_cast<size_t>(decodeInfo->tileRowIndex) * decodeInfo->expectedHeight);
+        YUVCoefficiants yuvCoefficiants;
 
-            ColorBgra* dstPtr = reinterpret_cast<ColorBgra*>(bgraImage->scan0 + (destY * bgraImage->stride) + (destX * sizeof(ColorBgra)));
+        // The integer converters use the sample values directly.
+        if (!UsesIntegerConverters<TPixel>(frame, isIdentityMatrix))
+        {
+            prepared.lookupTable = GetLookupTables(frame, isIdentityMatrix, lookupTableCache);
+        }
+
+        if (!isIdentityMatrix)
+        {
+            GetYUVCoefficiants(colorInfo, yuvCoefficiants);
+        }
+
+        prepared.rowConstants = GetRowConstants(prepared.lookupTable.get(), isIdentityMatrix ? nullptr : &yuvCoefficiants);
+
+        return DecoderStatus::Ok;
+    }
+
+    template <typename TPixel>
+    void PrepareAlphaImageConverter(
+        const aom_image_t* frame,
+        YUVLookupTableCache* lookupTableCache,
+        PreparedImageConverter& prepared)
+    {
+        prepared.converter = frame->bit_depth > 8 ? ConvertSinglePlaneImage<uint16_t, TPixel, AlphaConverter<uint16_t, TPixel>>
+                                                  : ConvertSinglePlaneImage<uint8_t, TPixel, AlphaConverter<uint8_t, TPixel>>;
+        prepared.lookupTable = GetLookupTables(frame, false, lookupTableCache);
+        prepared.rowConstants = GetRowConstants(prepared.lookupTable.get(), nullptr);
+    }
+
+    template <typename TPixel>
+    void UnpremultiplyAlphaRow(TPixel* dstPtr, uint32_t width)
+    {
+        typedef PixelChannel<TPixel> TChannel;
+        constexpr uint32_t maxChannel = std::numeric_limits<TChannel>::max();
 
-            for (uint32_t x = 0; x < copyWidth; ++x)
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            TPixel& pixel = dstPtr[x];
+            const uint32_t alpha = pixel.a;
+
+            if (alpha == 0)
             {
-                // Unpack YUV into unorm
-                uint8_t unormY = ptrY[x];
-
-                // Convert unorm to float
-                const float Y = tables.unormFloatTableY[unormY];
-                const float Cb = 0.0f;
-                const float Cr = 0.0f;
-
-                float R = Y + (2 * (1 - kr)) * Cr;
-                float B = Y + (2 * (1 - kb)) * Cb;
-                float G = Y - ((2 * ((kr * (1 - kr) * Cr) + (kb * (1 - kb) * Cb))) / kg);
-                R = Clamp(R, 0.0f, 1.0f);
-                G = Clamp(G, 0.0f, 1.0f);
-                B = Clamp(B, 0.0f, 1.0f);
-
-                dstPtr->r = static_cast<uint8_t>(0.5f + (R * rgbMaxChannel));
-                dstPtr->g = static_cast<uint8_t>(0.5f + (G * rgbMaxChannel));
-                dstPtr->b = static_cast<uint8_t>(0.5f + (B * rgbMaxChannel));
-                ++dstPtr;
+                pixel.b = 0;
+                pixel.g = 0;
+                pixel.r = 0;
+            }
+            else if (alpha < maxChannel)
+            {
+                const uint32_t halfAlpha = alpha / 2;
+
+                pixel.b = static_cast<TChannel>(std::min((pixel.b * maxChannel + halfAlpha) / alpha, maxChannel));
+                pixel.g = static_cast<TChannel>(std::min((pixel.g * maxChannel + halfAlpha) / alpha, maxChannel));
+                pixel.r = static_cast<TChannel>(std::min((pixel.r * maxChannel + halfAlpha) / alpha, maxChannel));
             }
         }
     }
 
-    void YUV16ToAlpha8(
-        const aom_image_t* image,
-        const DecodeInfo* decodeInfo,
-        const YUVLookupTables& tables,
-        BitmapData* bgraImage)
+    // The channels of the output image that are written by the downscaled converters.
+    enum class DownscaledChannels
     {
-        uint32_t yuvMaxChannel = (1 << image->bit_depth) - 1;
-        constexpr float rgbMaxChannel = 255.0f;
+        Color,
+        Alpha,
+        ColorAlpha
+    };
 
-        uint32_t copyWidth;
-        uint32_t copyHeight;
-        GetCopySizes(image, decodeInfo, bgraImage, copyWidth, copyHeight);
+    // Averages each block of (2^shift x 2^shift) source pixels into one output pixel, the blocks at the
+    // right and bottom edges of the source image average the pixels that they contain.
+    // The columnSums buffer must have room for four values per source pixel.
+    template <typename TPixel>
+    void DownscaleRows(
+        const TPixel* source,
+        uint32_t sourceWidth,
+        uint32_t sourceRowCount,
+        uint32_t shift,
+        DownscaledChannels channels,
+        uint32_t* columnSums,
+        TPixel* dstPtr,
+        uint32_t outputWidth)
+    {
+        typedef PixelChannel<TPixel> TChannel;
 
-        for (uint32_t y = 0; y < copyHeight; ++y)
+        for (uint32_t x = 0; x < sourceWidth; ++x)
         {
-            uint16_t* ptrY = reinterpret_cast<uint16_t*>(&image->planes[AOM_PLANE_Y][(y * image->stride[AOM_PLANE_Y])]);
+            const TPixel& pixel = source[x];
+            uint32_t* sums = columnSums + (static_cast<size_t>(x) * 4);
 
-            const size_t destX = static_cast<size_t>(decodeInfo->tileColumnIndex) * decodeInfo->expectedWidth;
-            const size_t destY = static_cast<size_t>(y) + (static_cast<size_t>(decodeInfo->tileRowIndex) * decodeInfo->expectedHeight);
+            sums[0] = pixel.b;
+            sums[1] = pixel.g;
+            sums[2] = pixel.r;
+            sums[3] = pixel.a;
+        }
 
-            ColorBgra* dstPtr = reinterpret_cast<ColorBgra*>(bgraImage->scan0 + (destY * bgraImage->stride) + (destX * sizeof(ColorBgra)));
+        for (uint32_t y = 1; y < sourceRowCount; ++y)
+        {
+            const TPixel* srcPtr = source + (static_cast<size_t>(y) * sourceWidth);
 
-            for (uint32_t x = 0; x < copyWidth; ++x)
+            for (uint32_t x = 0; x < sourceWidth; ++x)
             {
-                // Clamp the value to the lookup table range
-                uint32_t unormY = Min(ptrY[x], yuvMaxChannel);
+                const TPixel& pixel = srcPtr[x];
+                uint32_t* sums = columnSums + (static_cast<size_t>(x) * 4);
 
-                // Convert unorm to float
-                const float Y = tables.unormFloatTableY[unormY];
+                sums[0] += pixel.b;
+                sums[1] += pixel.g;
+                sums[2] += pixel.r;
+                sums[3] += pixel.a;
+            }
+        }
+
+        const uint32_t blockWidth = 1U << shift;
+
+        for (uint32_t x = 0; x < outputWidth; ++x)
+        {
+            const uint32_t startColumn = x << shift;
+            const uint32_t endColumn = std::min(sourceWidth - startColumn, blockWidth) + startColumn;
+
+            uint32_t b = 0;
+            uint32_t g = 0;
+            uint32_t r = 0;
+            uint32_t a = 0;
+
+            for (uint32_t column = startColumn; column < endColumn; ++column)
+            {
+                const uint32_t* sums = columnSums + (static_cast<size_t>(column) * 4);
 
-                float A = Clamp(Y, 0.0f, 1.0f);
+                b += sums[0];
+                g += sums[1];
+                r += sums[2];
+                a += sums[3];
+            }
+
+            const uint32_t count = (endColumn - startColumn) * sourceRowCount;
+            const uint32_t halfCount = count / 2;
 
-                dstPtr->a = static_cast<uint8_t>(0.5f + (A * rgbMaxChannel));
-                ++dstPtr;
+            TPixel& pixel = dstPtr[x];
+
+            if (channels != DownscaledChannels::Alpha)
+            {
+                pixel.b = static_cast<TChannel>((b + halfCount) / count);
+                pixel.g = static_cast<TChannel>((g + halfCount) / count);
+                pixel.r = static_cast<TChannel>((r + halfCount) / count);
+            }
+
+            if (channels != DownscaledChannels::Color)
+            {
+                pixel.a = static_cast<TChannel>((a + halfCount) / count);
             }
         }
     }
 
-    void YUV8ToAlpha8(
-        const aom_image_t* image,
+    // Converts the image one block of 2^downscaleShift rows at a time into a scratch buffer and
+    // averages each block into a row of the output image, the decoded image is never converted
+    // into a full size BGRA image.
+    // convertRows(destination, startRow, endRow) converts the rows [startRow, endRow) of the decoded image.
+    template <typename TPixel, typename TConvertRows>
+    DecoderStatus ConvertDownscaledImageData(
+        const DecodeInfo* decodeInfo,
+        const BitmapData* outputImage,
+        uint32_t copyWidth,
+        uint32_t copyHeight,
+        DownscaledChannels channels,
+        bool unpremultiplyAlpha,
+        TConvertRows convertRows)
+    {
+        const uint32_t shift = decodeInfo->downscaleShift;
+        const uint32_t blockSize = 1U << shift;
+        const uint32_t outputWidth = (copyWidth + blockSize - 1) >> shift;
+        const uint32_t outputHeight = (copyHeight + blockSize - 1) >> shift;
+
+        const ImageDestination destination = GetTileDestination<TPixel>(decodeInfo, outputImage);
+
+        return ParallelForRowBands<DecoderStatus>(
+            outputHeight,
+            1,
+            decodeInfo->maxConversionThreads,
+            [&](uint32_t startRow, uint32_t endRow)
+            {
+                const size_t scratchPixelCount = static_cast<size_t>(copyWidth) * blockSize;
+
+                std::unique_ptr<TPixel[]> scratch(new (std::nothrow) TPixel[scratchPixelCount]);
+                std::unique_ptr<uint32_t[]> columnSums(new (std::nothrow) uint32_t[static_cast<size_t>(copyWidth) * 4]);
+
+                if (!scratch || !columnSums)
+                {
+                    return DecoderStatus::OutOfMemory;
+                }
+
+                for (uint32_t y = startRow; y < endRow; ++y)
+                {
+                    const uint32_t sourceStartRow = y << shift;
+                    const uint32_t sourceEndRow = std::min(copyHeight - sourceStartRow, blockSize) + sourceStartRow;
+
+                    const ImageDestination scratchDestination
+                    {
+                        reinterpret_cast<uint8_t*>(scratch.get()),
+                        static_cast<size_t>(copyWidth) * sizeof(TPixel),
+                        sourceStartRow
+                    };
+
+                    convertRows(scratchDestination, sourceStartRow, sourceEndRow);
+
+                    TPixel* dstPtr = destination.GetRow<TPixel>(y);
+
+                    DownscaleRows(
+                        scratch.get(),
+                        copyWidth,
+                        sourceEndRow - sourceStartRow,
+                        shift,
+                        channels,
+                        columnSums.get(),
+                        dstPtr,
+                        outputWidth);
+
+                    if (unpremultiplyAlpha)
+                    {
+                        UnpremultiplyAlphaRow(dstPtr, outputWidth);
+                    }
+                }
+
+                return DecoderStatus::Ok;
+            });
+    }
+
+    template <typename TPixel>
+    DecoderStatus ConvertColorImageData(
+        const aom_image_t* frame,
+        const CICPColorData& colorInfo,
         const DecodeInfo* decodeInfo,
-        const YUVLookupTables& tables,
-        BitmapData* bgraImage)
+        YUVLookupTableCache* lookupTableCache,
+        const DecodedImageRowConverters& rowConverters,
+        BitmapData* outputImage)
     {
-        constexpr float rgbMaxChannel = 255.0f;
+        PreparedImageConverter color;
+
+        const DecoderStatus status = PrepareColorImageConverter<TPixel>(frame, colorInfo, lookupTableCache, color);
+
+        if (status != DecoderStatus::Ok)
+        {
+            return status;
+        }
+
+        const ImageConverterContext context{ color.rowConstants, rowConverters };
 
         uint32_t copyWidth;
         uint32_t copyHeight;
-        GetCopySizes(image, decodeInfo, bgraImage, copyWidth, copyHeight);
+        GetCopySizes(frame, decodeInfo, outputImage, copyWidth, copyHeight);
 
-        for (uint32_t y = 0; y < copyHeight; ++y)
+        if (decodeInfo->downscaleShift != 0)
         {
-            uint8_t* ptrY = &image->planes[AOM_PLANE_Y][(y * image->stride[AOM_PLANE_Y])];
-
-            const size_t destX = static_cast<size_t>(decodeInfo->tileColumnIndex) * decodeInfo->expectedWidth;
-            const size_t destY = static_cast<size_t>(y) + (static_cast<size_t>(decodeInfo->tileRowIndex) * decodeInfo->expectedHeight);
+            return ConvertDownscaledImageData<TPixel>(
+                decodeInfo,
+                outputImage,
+                copyWidth,
+                copyHeight,
+                DownscaledChannels::Color,
+                false,
+                [&](const ImageDestination& destination, uint32_t startRow, uint32_t endRow)
+                {
+                    color.converter(frame, context, destination, copyWidth, startRow, endRow);
+                });
+        }
 
-            ColorBgra* dstPtr = reinterpret_cast<ColorBgra*>(bgraImage->scan0 + (destY * bgraImage->stride) + (destX * sizeof(ColorBgra)));
+        const ImageDestination destination = GetTileDestination<TPixel>(decodeInfo, outputImage);
 
-            for (uint32_t x = 0; x < copyWidth; ++x)
+        // The rows that share a subsampled chroma row are converted by the same thread.
+        return ParallelForRowBands<DecoderStatus>(
+            copyHeight,
+            1U << frame->y_chroma_shift,
+            decodeInfo->maxConversionThreads,
+            [&](uint32_t startRow, uint32_t endRow)
             {
-                // Unpack YUV into unorm
-                uint8_t unormY = ptrY[x];
+                color.converter(frame, context, destination, copyWidth, startRow, endRow);
+                return DecoderStatus::Ok;
+            });
+    }
 
-                // Convert unorm to float
-                const float Y = tables.unormFloatTableY[unormY];
+    template <typename TPixel>
+    DecoderStatus ConvertAlphaImageData(
+        const aom_image_t* frame,
+        const DecodeInfo* decodeInfo,
+        YUVLookupTableCache* lookupTableCache,
+        const DecodedImageRowConverters& rowConverters,
+        BitmapData* outputImage)
+    {
+        PreparedImageConverter alpha;
+        PrepareAlphaImageConverter<TPixel>(frame, lookupTableCache, alpha);
 
-                float A = Clamp(Y, 0.0f, 1.0f);
+        const ImageConverterContext context{ alpha.rowConstants, rowConverters };
 
-                dstPtr->a = static_cast<uint8_t>(0.5f + (A * rgbMaxChannel));
-                ++dstPtr;
-            }
+        uint32_t copyWidth;
+        uint32_t copyHeight;
+        GetCopySizes(frame, decodeInfo, outputImage, copyWidth, copyHeight);
+
+        if (decodeInfo->downscaleShift != 0)
+        {
+            return ConvertDownscaledImageData<TPixel>(
+                decodeInfo,
+                outputImage,
+                copyWidth,
+                copyHeight,
+                DownscaledChannels::Alpha,
+                false,
+                [&](const ImageDestination& destination, uint32_t startRow, uint32_t endRow)
+                {
+                    alpha.converter(frame, context, destination, copyWidth, startRow, endRow);
+                });
         }
+
+        const ImageDestination destination = GetTileDestination<TPixel>(decodeInfo, outputImage);
+
+        return ParallelForRowBands<DecoderStatus>(
+            copyHeight,
+            1,
+            decodeInfo->maxConversionThreads,
+            [&](uint32_t startRow, uint32_t endRow)
+            {
+                alpha.converter(frame, context, destination, copyWidth, startRow, endRow);
+                return DecoderStatus::Ok;
+            });
     }
-}
 
-DecoderStatus ConvertColorImage(
-    const aom_image_t* frame,
-    const CICPColorData* containerColorInfo,
-    DecodeInfo* decodeInfo,
-    BitmapData* outputImage)
-{
-    if (!frame || !outputImage)
+    // The number of rows that are converted at a time when the color and alpha images are
+    // combined, the rows should still be in the CPU cache when the alpha image is converted.
+    uint32_t GetCacheBlockRowCount(uint32_t copyWidth, size_t pixelSize, uint32_t rowAlignment)
     {
-        return DecoderStatus::NullParameter;
-    }
+        constexpr size_t cacheBlockSize = 256 * 1024;
 
-    const bool isFirstTile = decodeInfo->tileColumnIndex == 0 && decodeInfo->tileRowIndex == 0;
+        const size_t rowSize = static_cast<size_t>(copyWidth) * pixelSize;
+        const size_t rowCount = rowSize > 0 ? cacheBlockSize / rowSize : 0;
 
-    if (isFirstTile)
-    {
-        if (decodeInfo->expectedWidth == 0 && decodeInfo->expectedHeight == 0)
+        if (rowCount <= rowAlignment)
         {
-            decodeInfo->expectedWidth = frame->d_w;
-            decodeInfo->expectedHeight = frame->d_h;
+            return rowAlignment;
         }
 
-        decodeInfo->bitDepth = frame->bit_depth;
-        if (frame->monochrome)
+        return static_cast<uint32_t>(std::min<size_t>(rowCount, UINT32_MAX) & ~static_cast<size_t>(rowAlignment - 1));
+    }
+
+    template <typename TPixel>
+    DecoderStatus ConvertColorAlphaImageData(
+        const aom_image_t* colorFrame,
+        const CICPColorData& colorInfo,
+        const DecodeInfo* colorDecodeInfo,
+        const aom_image_t* alphaFrame,
+        bool unpremultiplyAlpha,
+        YUVLookupTableCache* lookupTableCache,
+        const DecodedImageRowConverters& rowConverters,
+        BitmapData* outputImage)
+    {
+        PreparedImageConverter color;
+
+        const DecoderStatus status = PrepareColorImageConverter<TPixel>(colorFrame, colorInfo, lookupTableCache, color);
+
+        if (status != DecoderStatus::Ok)
         {
-            decodeInfo->chromaSubsampling = YUVChromaSubsampling::Subsampling400;
+            return status;
         }
-        else if (containerColorInfo && containerColorInfo->matrixCoefficients == CICPMatrixCoefficients::Identity
-                 || !containerColorInfo && frame->mc == AOM_CICP_MC_IDENTITY)
+
+        PreparedImageConverter alpha;
+        PrepareAlphaImageConverter<TPixel>(alphaFrame, lookupTableCache, alpha);
+
+        const ImageConverterContext colorContext{ color.rowConstants, rowConverters };
+        const ImageConverterContext alphaContext{ alpha.rowConstants, rowConverters };
+
+        uint32_t copyWidth;
+        uint32_t copyHeight;
+        GetCopySizes(colorFrame, colorDecodeInfo, outputImage, copyWidth, copyHeight);
+
+        if (colorDecodeInfo->downscaleShift != 0)
         {
-            decodeInfo->chromaSubsampling = YUVChromaSubsampling::IdentityMatrix;
+            // The pixels are averaged before the alpha is un-premultiplied, averaging the premultiplied
+            // values weights each color by its alpha.
+            return ConvertDownscaledImageData<TPixel>(
+                colorDecodeInfo,
+                outputImage,
+                copyWidth,
+                copyHeight,
+                DownscaledChannels::ColorAlpha,
+                unpremultiplyAlpha,
+                [&](const ImageDestination& destination, uint32_t startRow, uint32_t endRow)
+                {
+                    color.converter(colorFrame, colorContext, destination, copyWidth, startRow, endRow);
+                    alpha.converter(alphaFrame, alphaContext, destination, copyWidth, startRow, endRow);
+                });
         }
-        else
-        {
-            switch (frame->fmt)
+
+        const ImageDestination destination = GetTileDestination<TPixel>(colorDecodeInfo, outputImage);
+        const uint32_t rowAlignment = 1U << colorFrame->y_chroma_shift;
+        const uint32_t cacheBlockRowCount = GetCacheBlockRowCount(copyWidth, sizeof(TPixel), rowAlignment);
+
+        // Each block of rows is written by the color converter, the alpha converter and the
+        // alpha un-premultiply step before moving on to the next block.
+        return ParallelForRowBands<DecoderStatus>(
+            copyHeight,
+            rowAlignment,
+            colorDecodeInfo->maxConversionThreads,
+            [&](uint32_t startRow, uint32_t endRow)
             {
-            case AOM_IMG_FMT_I420:
-            case AOM_IMG_FMT_AOMI420:
-            case AOM_IMG_FMT_I42016:
-            case AOM_IMG_FMT_YV12:
-            case AOM_IMG_FMT_AOMYV12:
-            case AOM_IMG_FMT_YV1216:
-                decodeInfo->chromaSubsampling = YUVChromaSubsampling::Subsampling420;
-                break;
-            case AOM_IMG_FMT_I422:
-            case AOM_IMG_FMT_I42216:
-                decodeInfo->chromaSubsampling = YUVChromaSubsampling::Subsampling422;
-                break;
-            case AOM_IMG_FMT_I444:
-            case AOM_IMG_FMT_I44416:
-                decodeInfo->chromaSubsampling = YUVChromaSubsampling::Subsampling444;
-                break;
-            case AOM_IMG_FMT_NONE:
-            default:
-                return DecoderStatus::UnknownYUVFormat;
-            }
-        }
+                for (uint32_t blockStart = startRow; blockStart < endRow; blockStart += cacheBlockRowCount)
+                {
+                    const uint32_t blockEnd = std::min(endRow - blockStart, cacheBlockRowCount) + blockStart;
+
+                    color.converter(colorFrame, colorContext, destination, copyWidth, blockStart, blockEnd);
+                    alpha.converter(alphaFrame, alphaContext, destination, copyWidth, blockStart, blockEnd);
+
+                    if (unpremultiplyAlpha)
+                    {
+                        for (uint32_t y = blockStart; y < blockEnd; ++y)
+                        {
+                            UnpremultiplyAlphaRow(destination.GetRow<TPixel>(y), copyWidth);
+                        }
+                    }
+                }
+
+                return DecoderStatus::Ok;
+            });
     }
-    else
+
+    // A xorshift random number generator, the test images must be the same on every run.
+    class VerificationRandom
     {
-        if (frame->bit_depth != decodeInfo->bitDepth)
+    public:
+        VerificationRandom() : state(0x2545F491)
         {
-            return DecoderStatus::TileFormatMismatch;
         }
 
-        switch (decodeInfo->chromaSubsampling)
+        uint32_t Next()
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+
+            return state;
+        }
+
+    private:
+        uint32_t state;
+    };
+
+    struct VerificationImage
+    {
+        aom_image_t image;
+        std::vector<uint8_t> planes[3];
+
+        VerificationImage(
+            uint32_t width,
+            uint32_t height,
+            uint32_t bitDepth,
+            YUVChromaSubsampling yuvFormat,
+            bool fullRange,
+            VerificationRandom& random) : image(), planes()
         {
-        case YUVChromaSubsampling::Subsampling400:
-            if (!frame->monochrome)
+            const bool highBitDepth = bitDepth > 8;
+            const uint32_t bytesPerSample = highBitDepth ? 2 : 1;
+            const uint32_t yuvMaxChannel = (1U << bitDepth) - 1;
+
+            image.bit_depth = bitDepth;
+            image.d_w = width;
+            image.d_h = height;
+            image.w = width;
+            image.h = height;
+            image.range = fullRange ? AOM_CR_FULL_RANGE : AOM_CR_STUDIO_RANGE;
+            image.monochrome = yuvFormat == YUVChromaSubsampling::Subsampling400;
+
+            switch (yuvFormat)
             {
-                return DecoderStatus::TileFormatMismatch;
+            case YUVChromaSubsampling::Subsampling400:
+            case YUVChromaSubsampling::Subsampling420:
+                image.fmt = AOM_IMG_FMT_I420;
+                image.x_chroma_shift = 1;
+                image.y_chroma_shift = 1;
+                break;
+            case YUVChromaSubsampling::Subsampling422:
+                image.fmt = AOM_IMG_FMT_I422;
+                image.x_chroma_shift = 1;
+                break;
+            default:
+                image.fmt = AOM_IMG_FMT_I444;
+                break;
             }
-            break;
-        case YUVChromaSubsampling::Subsampling420:
-            if (frame->fmt != AOM_IMG_FMT_I420
-                && frame->fmt != AOM_IMG_FMT_AOMI420
-                && frame->fmt != AOM_IMG_FMT_I42016
-                && frame->fmt != AOM_IMG_FMT_YV12
-                && frame->fmt != AOM_IMG_FMT_AOMYV12
-                && frame->fmt != AOM_IMG_FMT_YV1216)
+
+            if (highBitDepth)
             {
-                return DecoderStatus::TileFormatMismatch;
+                image.fmt = static_cast<aom_img_fmt_t>(image.fmt | AOM_IMG_FMT_HIGHBITDEPTH);
             }
-            break;
-        case YUVChromaSubsampling::Subsampling422:
-            if (frame->fmt != AOM_IMG_FMT_I422 && frame->fmt != AOM_IMG_FMT_I42216)
+
+            for (int plane = AOM_PLANE_Y; plane <= AOM_PLANE_V; plane++)
             {
-                return DecoderStatus::TileFormatMismatch;
+                const uint32_t planeWidth = plane == AOM_PLANE_Y ? width : (width + image.x_chroma_shift) >> image.x_chroma_shift;
+                const uint32_t planeHeight = plane == AOM_PLANE_Y ? height : (height + image.y_chroma_shift) >> image.y_chroma_shift;
+
+                planes[plane].resize(static_cast<size_t>(planeWidth) * planeHeight * bytesPerSample);
+
+                for (uint32_t y = 0; y < planeHeight; y++)
+                {
+                    for (uint32_t x = 0; x < planeWidth; x++)
+                    {
+                        const size_t index = (static_cast<size_t>(y) * planeWidth) + x;
+
+                        if (highBitDepth)
+                        {
+                            // The last row contains values that are outside of the bit depth range.
+                            const uint32_t value = random.Next() & 0xffff;
+
+                            reinterpret_cast<uint16_t*>(planes[plane].data())[index] =
+                                static_cast<uint16_t>(y == planeHeight - 1 ? value : value % (yuvMaxChannel + 1));
+                        }
+                        else
+                        {
+                            planes[plane][index] = static_cast<uint8_t>(random.Next());
+                        }
+                    }
+                }
+
+                image.planes[plane] = planes[plane].data();
+                image.stride[plane] = static_cast<int>(planeWidth * bytesPerSample);
             }
-            break;
-        case YUVChromaSubsampling::Subsampling444:
-            if (frame->fmt != AOM_IMG_FMT_I444 && frame->fmt != AOM_IMG_FMT_I44416)
+        }
+
+        VerificationImage(const VerificationImage&) = delete;
+        VerificationImage& operator=(const VerificationImage&) = delete;
+    };
+
+    template <typename TPixel>
+    bool VerifyRowConverters(const DecodedImageRowConverters& rowConverters)
+    {
+        static constexpr uint32_t bitDepths[] = { 8, 10, 12, 16 };
+        static constexpr YUVChromaSubsampling yuvFormats[] =
+        {
+            YUVChromaSubsampling::Subsampling400,
+            YUVChromaSubsampling::Subsampling420,
+            YUVChromaSubsampling::Subsampling422,
+            YUVChromaSubsampling::Subsampling444
+        };
+        static constexpr CICPMatrixCoefficients matrixCoefficients[] =
+        {
+            CICPMatrixCoefficients::Identity,
+            CICPMatrixCoefficients::BT709,
+            CICPMatrixCoefficients::BT601,
+            CICPMatrixCoefficients::BT2020NCL,
+            CICPMatrixCoefficients::CromatNCL
+        };
+
+        const DecodedImageRowConverters scalarConverters{};
+        const BitmapPixelFormat pixelFormat = std::is_same_v<TPixel, ColorBgra64> ? BitmapPixelFormat::Bgra64 : BitmapPixelFormat::Bgra32;
+        VerificationRandom random;
+
+        // The widths cover images that are smaller than the vector width and the scalar code
+        // that handles the end of each row.
+        std::vector<uint32_t> widths;
+
+        for (uint32_t width = 1; width <= 40; width++)
+        {
+            widths.push_back(width);
+        }
+        widths.push_back(67);
+
+        constexpr uint32_t height = 3;
+
+        for (const uint32_t bitDepth : bitDepths)
+        {
+            // The 16-bit per channel output only has vectorized converters for the high bit depth images.
+            if (pixelFormat == BitmapPixelFormat::Bgra64 && bitDepth == 8)
             {
-                return DecoderStatus::TileFormatMismatch;
+                continue;
             }
-            break;
-        case YUVChromaSubsampling::IdentityMatrix:
-            if (!containerColorInfo && frame->mc != AOM_CICP_MC_IDENTITY)
+
+            for (const YUVChromaSubsampling yuvFormat : yuvFormats)
             {
-                return DecoderStatus::TileFormatMismatch;
+                for (int range = 0; range < 2; range++)
+                {
+                    const bool fullRange = range != 0;
+
+                    for (const uint32_t width : widths)
+                    {
+                        VerificationImage source(width, height, bitDepth, yuvFormat, fullRange, random);
+
+                        DecodeInfo decodeInfo{};
+                        decodeInfo.expectedWidth = width;
+                        decodeInfo.expectedHeight = height;
+
+                        // The padding at the end of each row checks that the converters
+                        // do not write past the end of the image.
+                        const uint32_t stride = (width + 3) * sizeof(TPixel);
+                        const size_t bufferSize = static_cast<size_t>(stride) * height;
+
+                        std::vector<uint8_t> initialPixels(bufferSize);
+
+                        for (uint8_t& value : initialPixels)
+                        {
+                            value = static_cast<uint8_t>(random.Next());
+                        }
+
+                        std::vector<uint8_t> expected(bufferSize);
+                        std::vector<uint8_t> actual(bufferSize);
+
+                        BitmapData expectedImage{ expected.data(), width, height, stride, pixelFormat };
+                        BitmapData actualImage{ actual.data(), width, height, stride, pixelFormat };
+
+                        for (const CICPMatrixCoefficients matrix : matrixCoefficients)
+                        {
+                            CICPColorData colorInfo{};
+                            colorInfo.colorPrimaries = matrix == CICPMatrixCoefficients::CromatNCL ? CICPColorPrimaries::BT2020 : CICPColorPrimaries::BT709;
+                            colorInfo.transferCharacteristics = CICPTransferCharacteristics::Srgb;
+                            colorInfo.matrixCoefficients = matrix;
+                            colorInfo.fullRange = fullRange;
+
+                            expected = initialPixels;
+                            actual = initialPixels;
+
+                            if (ConvertColorImageData<TPixel>(&source.image, colorInfo, &decodeInfo, nullptr, scalarConverters, &expectedImage) != DecoderStatus::Ok ||
+                                ConvertColorImageData<TPixel>(&source.image, colorInfo, &decodeInfo, nullptr, rowConverters, &actualImage) != DecoderStatus::Ok ||
+                                expected != actual)
+                            {
+                                return false;
+                            }
+                        }
+
+                        if (yuvFormat == YUVChromaSubsampling::Subsampling400)
+                        {
+                            expected = initialPixels;
+                            actual = initialPixels;
+
+                            if (ConvertAlphaImageData<TPixel>(&source.image, &decodeInfo, nullptr, scalarConverters, &expectedImage) != DecoderStatus::Ok ||
+                                ConvertAlphaImageData<TPixel>(&source.image, &decodeInfo, nullptr, rowConverters, &actualImage) != DecoderStatus::Ok ||
+                                expected != actual)
+                            {
+                                return false;
+                            }
+                        }
+                    }
+                }
             }
-            break;
-        default:
-            return DecoderStatus::UnknownYUVFormat;
         }
-    }
-
-    CICPColorData colorInfo = {};
 
-    if (containerColorInfo)
-    {
-        colorInfo = *containerColorInfo;
+        return true;
     }
-    else
+}
+
+namespace
+{
+    // Checks that the color image format matches the first tile and gets the color information
+    // that is used to convert it, the first tile sets the format of the image.
+    DecoderStatus GetColorImageInfo(
+        const aom_image_t* frame,
+        const CICPColorData* containerColorInfo,
+        DecodeInfo* decodeInfo,
+        CICPColorData& colorInfo)
     {
-        colorInfo.colorPrimaries = static_cast<CICPColorPrimaries>(frame->cp);
-        colorInfo.transferCharacteristics = static_cast<CICPTransferCharacteristics>(frame->tc);
-        colorInfo.matrixCoefficients = static_cast<CICPMatrixCoefficients>(frame->mc);
-        colorInfo.fullRange = frame->range == aom_color_range::AOM_CR_FULL_RANGE;
+        const bool isFirstTile = decodeInfo->tileColumnIndex == 0 && decodeInfo->tileRowIndex == 0;
 
         if (isFirstTile)
         {
-            decodeInfo->firstTileColorData.colorPrimaries = colorInfo.colorPrimaries;
-            decodeInfo->firstTileColorData.transferCharacteristics = colorInfo.transferCharacteristics;
-            decodeInfo->firstTileColorData.matrixCoefficients = colorInfo.matrixCoefficients;
-            decodeInfo->firstTileColorData.fullRange = colorInfo.fullRange;
+            if (decodeInfo->expectedWidth == 0 && decodeInfo->expectedHeight == 0)
+            {
+                decodeInfo->expectedWidth = frame->d_w;
+                decodeInfo->expectedHeight = frame->d_h;
+            }
+
+            decodeInfo->bitDepth = frame->bit_depth;
+            if (frame->monochrome)
+            {
+                decodeInfo->chromaSubsampling = YUVChromaSubsampling::Subsampling400;
+            }
+            else if ((containerColorInfo && containerColorInfo->matrixCoefficients == CICPMatrixCoefficients::Identity)
+                     || (!containerColorInfo && frame->mc == AOM_CICP_MC_IDENTITY))
+            {
+                decodeInfo->chromaSubsampling = YUVChromaSubsampling::IdentityMatrix;
+            }
+            else
+            {
+                switch (frame->fmt)
+                {
+                case AOM_IMG_FMT_I420:
+                case AOM_IMG_FMT_AOMI420:
+                case AOM_IMG_FMT_I42016:
+                case AOM_IMG_FMT_YV12:
+                case AOM_IMG_FMT_AOMYV12:
+                case AOM_IMG_FMT_YV1216:
+                    decodeInfo->chromaSubsampling = YUVChromaSubsampling::Subsampling420;
+                    break;
+                case AOM_IMG_FMT_I422:
+                case AOM_IMG_FMT_I42216:
+                    decodeInfo->chromaSubsampling = YUVChromaSubsampling::Subsampling422;
+                    break;
+                case AOM_IMG_FMT_I444:
+                case AOM_IMG_FMT_I44416:
+                    decodeInfo->chromaSubsampling = YUVChromaSubsampling::Subsampling444;
+                    break;
+                case AOM_IMG_FMT_NONE:
+                default:
+                    return DecoderStatus::UnknownYUVFormat;
+                }
+            }
         }
         else
         {
-            if (decodeInfo->firstTileColorData.colorPrimaries != colorInfo.colorPrimaries ||
-                decodeInfo->firstTileColorData.transferCharacteristics != colorInfo.transferCharacteristics ||
-                decodeInfo->firstTileColorData.matrixCoefficients != colorInfo.matrixCoefficients ||
-                decodeInfo->firstTileColorData.fullRange != colorInfo.fullRange)
+            if (frame->bit_depth != decodeInfo->bitDepth)
             {
-                return DecoderStatus::TileNclxProfileMismatch;
+                return DecoderStatus::TileFormatMismatch;
             }
-        }
-    }
-
-    try
-    {
-        if (colorInfo.matrixCoefficients == CICPMatrixCoefficients::Identity)
-        {
-            // The Identity matrix coefficient contains RGB color values.
 
-            if (frame->bit_depth > 8)
+            switch (decodeInfo->chromaSubsampling)
             {
-                std::unique_ptr<YUVLookupTables> lookupTable = std::make_unique<YUVLookupTables>(frame, true);
-
-                if (frame->monochrome)
+            case YUVChromaSubsampling::Subsampling400:
+                if (!frame->monochrome)
                 {
-                    Identity16ToRGB8Mono(frame,
-                        decodeInfo,
-                        *lookupTable,
-                        outputImage);
+                    return DecoderStatus::TileFormatMismatch;
                 }
-                else
+                break;
+            case YUVChromaSubsampling::Subsampling420:
+                if (frame->fmt != AOM_IMG_FMT_I420
+                    && frame->fmt != AOM_IMG_FMT_AOMI420
+                    && frame->fmt != AOM_IMG_FMT_I42016
+                    && frame->fmt != AOM_IMG_FMT_YV12
+                    && frame->fmt != AOM_IMG_FMT_AOMYV12
+                    && frame->fmt != AOM_IMG_FMT_YV1216)
                 {
-                    Identity16ToRGB8Color(frame,
-                        decodeInfo,
-                        *lookupTable,
-                        outputImage);
+                    return DecoderStatus::TileFormatMismatch;
                 }
-            }
-            else
-            {
-                if (frame->monochrome)
+                break;
+            case YUVChromaSubsampling::Subsampling422:
+                if (frame->fmt != AOM_IMG_FMT_I422 && frame->fmt != AOM_IMG_FMT_I42216)
                 {
-                    Identity8ToRGB8Mono(frame,
-                        decodeInfo,
-                        outputImage);
+                    return DecoderStatus::TileFormatMismatch;
                 }
-                else
+                break;
+            case YUVChromaSubsampling::Subsampling444:
+                if (frame->fmt != AOM_IMG_FMT_I444 && frame->fmt != AOM_IMG_FMT_I44416)
                 {
-                    Identity8ToRGB8Color(frame,
-                        decodeInfo,
-                        outputImage);
+                    return DecoderStatus::TileFormatMismatch;
                 }
+                break;
+            case YUVChromaSubsampling::IdentityMatrix:
+                if (!containerColorInfo && frame->mc != AOM_CICP_MC_IDENTITY)
+                {
+                    return DecoderStatus::TileFormatMismatch;
+                }
+                break;
+            default:
+                return DecoderStatus::UnknownYUVFormat;
             }
         }
+
+        if (containerColorInfo)
+        {
+            colorInfo = *containerColorInfo;
+        }
         else
         {
-            std::unique_ptr<YUVLookupTables> lookupTable = std::make_unique<YUVLookupTables>(frame, false);
-
-            YUVCoefficiants yuvCoefficiants;
-            GetYUVCoefficiants(colorInfo, yuvCoefficiants);
+            colorInfo.colorPrimaries = static_cast<CICPColorPrimaries>(frame->cp);
+            colorInfo.transferCharacteristics = static_cast<CICPTransferCharacteristics>(frame->tc);
+            colorInfo.matrixCoefficients = static_cast<CICPMatrixCoefficients>(frame->mc);
+            colorInfo.fullRange = frame->range == aom_color_range::AOM_CR_FULL_RANGE;
 
-            if (frame->bit_depth > 8)
+            if (isFirstTile)
             {
-                if (frame->monochrome)
-                {
-                    YUV16ToRGB8Mono(frame,
-                        yuvCoefficiants,
-                        *lookupTable,
-                        decodeInfo,
-                        outputImage);
-                }
-                else
-                {
-                    YUV16ToRGB8Color(frame,
-                        yuvCoefficiants,
-                        *lookupTable,
-                        decodeInfo,
-                        outputImage);
-                }
+                decodeInfo->firstTileColorData.colorPrimaries = colorInfo.colorPrimaries;
+                decodeInfo->firstTileColorData.transferCharacteristics = colorInfo.transferCharacteristics;
+                decodeInfo->firstTileColorData.matrixCoefficients = colorInfo.matrixCoefficients;
+                decodeInfo->firstTileColorData.fullRange = colorInfo.fullRange;
             }
             else
             {
-                if (frame->monochrome)
-                {
-                    YUV8ToRGB8Mono(frame,
-                        yuvCoefficiants,
-                        *lookupTable,
-                        decodeInfo,
-                        outputImage);
-                }
-                else
+                if (decodeInfo->firstTileColorData.colorPrimaries != colorInfo.colorPrimaries ||
+                    decodeInfo->firstTileColorData.transferCharacteristics != colorInfo.transferCharacteristics ||
+                    decodeInfo->firstTileColorData.matrixCoefficients != colorInfo.matrixCoefficients ||
+                    decodeInfo->firstTileColorData.fullRange != colorInfo.fullRange)
                 {
-                    YUV8ToRGB8Color(frame,
-                        yuvCoefficiants,
-                        *lookupTable,
-                        decodeInfo,
-                        outputImage);
+                    return DecoderStatus::TileNclxProfileMismatch;
                 }
             }
         }
+
+        return DecoderStatus::Ok;
+    }
+
+    DecoderStatus CheckAlphaImageFormat(const aom_image_t* frame, DecodeInfo* decodeInfo)
+    {
+        const bool isFirstTile = decodeInfo->tileColumnIndex == 0 && decodeInfo->tileRowIndex == 0;
+
+        if (isFirstTile)
+        {
+            if (decodeInfo->expectedWidth == 0 && decodeInfo->expectedHeight == 0)
+            {
+                decodeInfo->expectedWidth = frame->d_w;
+                decodeInfo->expectedHeight = frame->d_h;
+            }
+            decodeInfo->bitDepth = frame->bit_depth;
+            decodeInfo->chromaSubsampling = YUVChromaSubsampling::Subsampling400;
+        }
+        else
+        {
+            if (frame->bit_depth != decodeInfo->bitDepth)
+            {
+                return DecoderStatus::TileFormatMismatch;
+            }
+        }
+
+        return DecoderStatus::Ok;
+    }
+
+    DecoderStatus CheckOutputImageFormat(const BitmapData* outputImage)
+    {
+        if (outputImage->pixelFormat != BitmapPixelFormat::Bgra32 &&
+            outputImage->pixelFormat != BitmapPixelFormat::Bgra64)
+        {
+            return DecoderStatus::UnsupportedBitDepth;
+        }
+
+        return DecoderStatus::Ok;
+    }
+
+    // Each tile of a downscaled image grid must start on a pixel of the output image,
+    // this requires the tile size to be a multiple of the downscale factor.
+    DecoderStatus CheckDownscaleShift(const DecodeInfo* decodeInfo)
+    {
+        const uint32_t shift = decodeInfo->downscaleShift;
+
+        if (shift > MaxDecodeDownscaleShift)
+        {
+            return DecoderStatus::UnsupportedDownscaleFactor;
+        }
+
+        const uint32_t mask = (1U << shift) - 1;
+
+        if ((decodeInfo->tileColumnIndex != 0 && (decodeInfo->expectedWidth & mask) != 0) ||
+            (decodeInfo->tileRowIndex != 0 && (decodeInfo->expectedHeight & mask) != 0))
+        {
+            return DecoderStatus::UnsupportedDownscaleFactor;
+        }
+
+        return DecoderStatus::Ok;
+    }
+}
+
+DecoderStatus ConvertColorImage(
+    const aom_image_t* frame,
+    const CICPColorData* containerColorInfo,
+    DecodeInfo* decodeInfo,
+    YUVLookupTableCache* lookupTableCache,
+    BitmapData* outputImage)
+{
+    if (!frame || !outputImage)
+    {
+        return DecoderStatus::NullParameter;
+    }
+
+    CICPColorData colorInfo = {};
+
+    DecoderStatus status = GetColorImageInfo(frame, containerColorInfo, decodeInfo, colorInfo);
+
+    if (status != DecoderStatus::Ok)
+    {
+        return status;
+    }
+
+    status = CheckDownscaleShift(decodeInfo);
+
+    if (status != DecoderStatus::Ok)
+    {
+        return status;
+    }
+
+    status = CheckOutputImageFormat(outputImage);
+
+    if (status != DecoderStatus::Ok)
+    {
+        return status;
+    }
+
+    try
+    {
+        if (outputImage->pixelFormat == BitmapPixelFormat::Bgra64)
+        {
+            return ConvertColorImageData<ColorBgra64>(frame,
+                colorInfo,
+                decodeInfo,
+                lookupTableCache,
+                GetDecodedImageRowConverters(),
+                outputImage);
+        }
+
+        return ConvertColorImageData<ColorBgra>(frame,
+            colorInfo,
+            decodeInfo,
+            lookupTableCache,
+            GetDecodedImageRowConverters(),
+            outputImage);
     }
     catch (const std::bad_alloc&)
     {
@@ -979,13 +1862,12 @@ DecoderStatus ConvertColorImage(
         // The YUVLookupTables constructor throws this for unsupported image bit depths.
         return DecoderStatus::UnsupportedBitDepth;
     }
-
-    return DecoderStatus::Ok;
 }
 
 DecoderStatus ConvertAlphaImage(
     const aom_image_t* frame,
     DecodeInfo* decodeInfo,
+    YUVLookupTableCache* lookupTableCache,
     BitmapData* outputBGRAImageData)
 {
     if (!frame || !outputBGRAImageData)
@@ -993,45 +1875,135 @@ DecoderStatus ConvertAlphaImage(
         return DecoderStatus::NullParameter;
     }
 
-    const bool isFirstTile = decodeInfo->tileColumnIndex == 0 && decodeInfo->tileRowIndex == 0;
+    DecoderStatus status = CheckAlphaImageFormat(frame, decodeInfo);
 
-    if (isFirstTile)
+    if (status != DecoderStatus::Ok)
     {
-        if (decodeInfo->expectedWidth == 0 && decodeInfo->expectedHeight == 0)
-        {
-            decodeInfo->expectedWidth = frame->d_w;
-            decodeInfo->expectedHeight = frame->d_h;
-        }
-        decodeInfo->bitDepth = frame->bit_depth;
-        decodeInfo->chromaSubsampling = YUVChromaSubsampling::Subsampling400;
+        return status;
     }
-    else
+
+    status = CheckDownscaleShift(decodeInfo);
+
+    if (status != DecoderStatus::Ok)
     {
-        if (frame->bit_depth != decodeInfo->bitDepth)
-        {
-            return DecoderStatus::TileFormatMismatch;
-        }
+        return status;
     }
 
-    try
+    status = CheckOutputImageFormat(outputBGRAImageData);
+
+    if (status != DecoderStatus::Ok)
     {
-        std::unique_ptr<YUVLookupTables> lookupTable = std::make_unique<YUVLookupTables>(frame, false);
+        return status;
+    }
 
-        if (frame->bit_depth > 8)
+    try
+    {
+        if (outputBGRAImageData->pixelFormat == BitmapPixelFormat::Bgra64)
         {
-            YUV16ToAlpha8(frame,
+            return ConvertAlphaImageData<ColorBgra64>(frame,
                 decodeInfo,
-                *lookupTable,
+                lookupTableCache,
+                GetDecodedImageRowConverters(),
                 outputBGRAImageData);
         }
-        else
-        {
-            YUV8ToAlpha8(frame,
-                decodeInfo,
-                *lookupTable,
-                outputBGRAImageData);
 
+        return ConvertAlphaImageData<ColorBgra>(frame,
+            decodeInfo,
+            lookupTableCache,
+            GetDecodedImageRowConverters(),
+            outputBGRAImageData);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return DecoderStatus::OutOfMemory;
+    }
+    catch (const unknown_bit_depth_error&)
+    {
+        // The YUVLookupTables constructor throws this for unsupported image bit depths.
+        return DecoderStatus::UnsupportedBitDepth;
+    }
+}
+
+DecoderStatus ConvertColorAlphaImage(
+    const aom_image_t* colorFrame,
+    const CICPColorData* containerColorInfo,
+    DecodeInfo* colorDecodeInfo,
+    const aom_image_t* alphaFrame,
+    DecodeInfo* alphaDecodeInfo,
+    bool unpremultiplyAlpha,
+    YUVLookupTableCache* lookupTableCache,
+    BitmapData* outputImage)
+{
+    if (!colorFrame || !alphaFrame || !outputImage)
+    {
+        return DecoderStatus::NullParameter;
+    }
+
+    CICPColorData colorInfo = {};
+
+    DecoderStatus status = GetColorImageInfo(colorFrame, containerColorInfo, colorDecodeInfo, colorInfo);
+
+    if (status != DecoderStatus::Ok)
+    {
+        return status;
+    }
+
+    status = CheckAlphaImageFormat(alphaFrame, alphaDecodeInfo);
+
+    if (status != DecoderStatus::Ok)
+    {
+        return status;
+    }
+
+    // The color and alpha images are converted together, so they must cover the same region of the output image.
+    if (colorDecodeInfo->expectedWidth != alphaDecodeInfo->expectedWidth ||
+        colorDecodeInfo->expectedHeight != alphaDecodeInfo->expectedHeight)
+    {
+        return DecoderStatus::AlphaSizeMismatch;
+    }
+
+    // The color and alpha images are written to the same output pixels.
+    if (colorDecodeInfo->downscaleShift != alphaDecodeInfo->downscaleShift)
+    {
+        return DecoderStatus::UnsupportedDownscaleFactor;
+    }
+
+    status = CheckDownscaleShift(colorDecodeInfo);
+
+    if (status != DecoderStatus::Ok)
+    {
+        return status;
+    }
+
+    status = CheckOutputImageFormat(outputImage);
+
+    if (status != DecoderStatus::Ok)
+    {
+        return status;
+    }
+
+    try
+    {
+        if (outputImage->pixelFormat == BitmapPixelFormat::Bgra64)
+        {
+            return ConvertColorAlphaImageData<ColorBgra64>(colorFrame,
+                colorInfo,
+                colorDecodeInfo,
+                alphaFrame,
+                unpremultiplyAlpha,
+                lookupTableCache,
+                GetDecodedImageRowConverters(),
+                outputImage);
         }
+
+        return ConvertColorAlphaImageData<ColorBgra>(colorFrame,
+            colorInfo,
+            colorDecodeInfo,
+            alphaFrame,
+            unpremultiplyAlpha,
+            lookupTableCache,
+            GetDecodedImageRowConverters(),
+            outputImage);
     }
     catch (const std::bad_alloc&)
     {
@@ -1042,6 +2014,40 @@ DecoderStatus ConvertAlphaImage(
         // The YUVLookupTables constructor throws this for unsupported image bit depths.
         return DecoderStatus::UnsupportedBitDepth;
     }
+}
+
+bool VerifyDecodedImageRowConverters()
+{
+    std::vector<const DecodedImageRowConverters*> supportedConverters;
+
+#if defined(_M_IX86) || defined(_M_X64)
+    if (HasSSE41())
+    {
+        supportedConverters.push_back(&GetSSE41DecodedImageRowConverters());
+    }
+
+    if (HasAVX2())
+    {
+        supportedConverters.push_back(&GetAVX2DecodedImageRowConverters());
+    }
+#elif defined(_M_ARM64)
+    supportedConverters.push_back(&GetNEONDecodedImageRowConverters());
+#endif
+
+    try
+    {
+        for (const DecodedImageRowConverters* converters : supportedConverters)
+        {
+            if (!VerifyRowConverters<ColorBgra>(*converters) || !VerifyRowConverters<ColorBgra64>(*converters))
+            {
+                return false;
+            }
+        }
+    }
+    catch (const std::bad_alloc&)
+    {
+        return false;
+    }
 
-    return DecoderStatus::Ok;
+    return true;
 }
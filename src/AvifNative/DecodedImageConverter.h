@@ -14,14 +14,69 @@
 
 #include "AvifNative.h"
 #include <aom/aom_image.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// The largest value of DecodeInfo::downscaleShift, the image is downscaled to 1/8 of its size.
+constexpr uint32_t MaxDecodeDownscaleShift = 3;
+
+struct YUVLookupTables;
+
+// Keeps the YUV lookup tables that have been built for the images of a decoder session,
+// the tiles of an image grid and the alpha images that use the same bit depth and range
+// share one set of tables instead of building them for every tile.
+class YUVLookupTableCache
+{
+public:
+    YUVLookupTableCache();
+
+    YUVLookupTableCache(const YUVLookupTableCache&) = delete;
+    YUVLookupTableCache& operator=(const YUVLookupTableCache&) = delete;
+
+    std::shared_ptr<const YUVLookupTables> GetTables(const aom_image_t* image, bool isIdentityMatrix);
+
+private:
+    struct CacheEntry
+    {
+        uint32_t bitDepth;
+        aom_color_range_t range;
+        bool monochrome;
+        bool isIdentityMatrix;
+        std::shared_ptr<const YUVLookupTables> tables;
+    };
+
+    std::mutex mutex;
+    std::vector<CacheEntry> entries;
+};
+
+// The lookup tables are built for each call when lookupTableCache is null.
 
 DecoderStatus ConvertColorImage(
     const aom_image_t* frame,
     const CICPColorData* containerColorInfo,
     DecodeInfo* decodeInfo,
+    YUVLookupTableCache* lookupTableCache,
     BitmapData* outputBGRAImageData);
 
 DecoderStatus ConvertAlphaImage(
     const aom_image_t* frame,
     DecodeInfo* decodeInfo,
+    YUVLookupTableCache* lookupTableCache,
     BitmapData* outputBGRAImageData);
+
+// Converts the color and alpha images of a tile in a single pass over the output image,
+// the alpha image must be the same size as the color image.
+DecoderStatus ConvertColorAlphaImage(
+    const aom_image_t* colorFrame,
+    const CICPColorData* containerColorInfo,
+    DecodeInfo* colorDecodeInfo,
+    const aom_image_t* alphaFrame,
+    DecodeInfo* alphaDecodeInfo,
+    bool unpremultiplyAlpha,
+    YUVLookupTableCache* lookupTableCache,
+    BitmapData* outputImage);
+
+// Checks that the vectorized converters for each instruction set that the CPU supports
+// produce the same output as the scalar code.
+bool VerifyDecodedImageRowConverters();
@@ -0,0 +1,151 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AvifNative.h"
+
+struct YUVToRGBRowConstants
+{
+    // The high bit depth tables have an entry for every 16-bit value, the samples that are
+    // outside of the bit depth range map to the clamped value.
+    const float* unormFloatTableY;
+    const float* unormFloatTableUV;
+    // 2 * (1 - kr)
+    float crToR;
+    // 2 * (1 - kb)
+    float cbToB;
+    // kr * (1 - kr)
+    float crToG;
+    // kb * (1 - kb)
+    float cbToG;
+    float kg;
+};
+
+// The row converters return the number of pixels that were converted, this is always a multiple
+// of the vector width and the caller converts the remaining pixels using the scalar code.
+// The output must be identical to the scalar code in DecodedImageConverter.cpp, the color converters
+// preserve the existing alpha channel and the alpha converters only write the alpha channel.
+
+typedef uint32_t(*YUV8ToBgraRowProc)(
+    const uint8_t* ptrY,
+    const uint8_t* ptrU,
+    const uint8_t* ptrV,
+    uint32_t xChromaShift,
+    uint32_t width,
+    const YUVToRGBRowConstants& constants,
+    ColorBgra* dstPtr);
+
+typedef uint32_t(*YUV16ToBgraRowProc)(
+    const uint16_t* ptrY,
+    const uint16_t* ptrU,
+    const uint16_t* ptrV,
+    uint32_t xChromaShift,
+    uint32_t width,
+    const YUVToRGBRowConstants& constants,
+    ColorBgra* dstPtr);
+
+typedef uint32_t(*Y8ToBgraRowProc)(
+    const uint8_t* ptrY,
+    uint32_t width,
+    const YUVToRGBRowConstants& constants,
+    ColorBgra* dstPtr);
+
+typedef uint32_t(*Y16ToBgraRowProc)(
+    const uint16_t* ptrY,
+    uint32_t width,
+    const YUVToRGBRowConstants& constants,
+    ColorBgra* dstPtr);
+
+// The limitedToFullTable parameter is null for full range images.
+typedef uint32_t(*Identity8ToBgraRowProc)(
+    const uint8_t* ptrY,
+    const uint8_t* ptrU,
+    const uint8_t* ptrV,
+    uint32_t xChromaShift,
+    uint32_t width,
+    const uint32_t* limitedToFullTable,
+    ColorBgra* dstPtr);
+
+typedef uint32_t(*Identity8MonoToBgraRowProc)(
+    const uint8_t* ptrY,
+    uint32_t width,
+    const uint32_t* limitedToFullTable,
+    ColorBgra* dstPtr);
+
+// The full range high bit depth converters narrow the samples to 8 bits with integer math,
+// the samples that are larger than the maximum value for the bit depth are clamped.
+typedef uint32_t(*FullRangeIdentity16ToBgraRowProc)(
+    const uint16_t* ptrY,
+    const uint16_t* ptrU,
+    const uint16_t* ptrV,
+    uint32_t xChromaShift,
+    uint32_t width,
+    uint32_t bitDepth,
+    ColorBgra* dstPtr);
+
+typedef uint32_t(*FullRangeY16ToBgraRowProc)(
+    const uint16_t* ptrY,
+    uint32_t width,
+    uint32_t bitDepth,
+    ColorBgra* dstPtr);
+
+// The 16-bit per channel converters scale the output to the full 16-bit range.
+
+typedef uint32_t(*YUV16ToBgra64RowProc)(
+    const uint16_t* ptrY,
+    const uint16_t* ptrU,
+    const uint16_t* ptrV,
+    uint32_t xChromaShift,
+    uint32_t width,
+    const YUVToRGBRowConstants& constants,
+    ColorBgra64* dstPtr);
+
+typedef uint32_t(*Y16ToBgra64RowProc)(
+    const uint16_t* ptrY,
+    uint32_t width,
+    const YUVToRGBRowConstants& constants,
+    ColorBgra64* dstPtr);
+
+struct DecodedImageRowConverters
+{
+    const char* name;
+    YUV8ToBgraRowProc yuv8ToRGB8Color;
+    YUV16ToBgraRowProc yuv16ToRGB8Color;
+    YUV16ToBgraRowProc identity16ToRGB8Color;
+    Identity8ToBgraRowProc identity8ToRGB8Color;
+    Identity8MonoToBgraRowProc identity8ToRGB8Mono;
+    // The full range Identity matrix and monochrome images that are converted to 8-bit per channel output.
+    FullRangeIdentity16ToBgraRowProc fullRangeIdentity16ToRGB8Color;
+    FullRangeY16ToBgraRowProc fullRangeY16ToRGB8Mono;
+    // The monochrome converters are used for the YUV and Identity monochrome images.
+    Y8ToBgraRowProc y8ToRGB8Mono;
+    Y16ToBgraRowProc y16ToRGB8Mono;
+    Y8ToBgraRowProc y8ToAlpha8;
+    Y16ToBgraRowProc y16ToAlpha8;
+    YUV16ToBgra64RowProc yuv16ToRGB16Color;
+    YUV16ToBgra64RowProc identity16ToRGB16Color;
+    Y16ToBgra64RowProc y16ToRGB16Mono;
+    Y16ToBgra64RowProc y16ToAlpha16;
+};
+
+// Returns the fastest row converters that the CPU supports, this is selected once per process.
+// The members will be null if the CPU does not support any of the vector instruction sets.
+const DecodedImageRowConverters& GetDecodedImageRowConverters();
+
+// The instruction set specific converters, the caller must check that the CPU supports the instruction set.
+#if defined(_M_IX86) || defined(_M_X64)
+const DecodedImageRowConverters& GetSSE41DecodedImageRowConverters();
+const DecodedImageRowConverters& GetAVX2DecodedImageRowConverters();
+#elif defined(_M_ARM64)
+const DecodedImageRowConverters& GetNEONDecodedImageRowConverters();
+#endif
@@ -0,0 +1,28 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+// This file is compiled with /arch:AVX2, it must not contain any code that can be called
+// before the CPU has been checked for AVX2 support.
+
+#include "DecodedImageRowConverters.h"
+
+#if defined(_M_IX86) || defined(_M_X64)
+#include "DecodedImageRowConvertersSIMD.h"
+#include "SIMDTraitsAVX2.h"
+
+const DecodedImageRowConverters& GetAVX2DecodedImageRowConverters()
+{
+    static const DecodedImageRowConverters converters = DecodedImageRowConvertersSIMD::CreateRowConverters<SIMD::AVX2>("AVX2");
+
+    return converters;
+}
+#endif
@@ -0,0 +1,25 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "DecodedImageRowConverters.h"
+
+#if defined(_M_ARM64)
+#include "DecodedImageRowConvertersSIMD.h"
+#include "SIMDTraitsNEON.h"
+
+const DecodedImageRowConverters& GetNEONDecodedImageRowConverters()
+{
+    static const DecodedImageRowConverters converters = DecodedImageRowConvertersSIMD::CreateRowConverters<SIMD::NEON>("NEON");
+
+    return converters;
+}
+#endif
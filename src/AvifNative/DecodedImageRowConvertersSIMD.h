@@ -0,0 +1,441 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "DecodedImageRowConverters.h"
+
+// The vectorized row converters, these are instantiated once for each instruction set.
+//
+// The V template parameter provides the vector types and operations for the instruction set,
+// the templates only use functions from V so that each instruction set gets its own copy of the code.
+// The floating point operations are performed in the same order as the scalar code in
+// DecodedImageConverter.cpp, this is required for the output to be identical.
+
+namespace DecodedImageRowConvertersSIMD
+{
+    template <typename V>
+    struct FloatConstants
+    {
+        typename V::Float zero;
+        typename V::Float one;
+        typename V::Float half;
+        typename V::Float rgbMaxChannel;
+        typename V::Float rgbMaxChannel16;
+
+        FloatConstants() :
+            zero(V::SetFloat(0.0f)),
+            one(V::SetFloat(1.0f)),
+            half(V::SetFloat(0.5f)),
+            rgbMaxChannel(V::SetFloat(255.0f)),
+            rgbMaxChannel16(V::SetFloat(65535.0f))
+        {
+        }
+    };
+
+    template <typename V>
+    inline typename V::Int ToUnorm8(typename V::Float value, const FloatConstants<V>& constants)
+    {
+        // Clamp(value, 0.0f, 1.0f) followed by static_cast<uint8_t>(0.5f + (value * 255.0f)).
+        const typename V::Float clamped = V::Max(V::Min(value, constants.one), constants.zero);
+
+        return V::Truncate(V::Add(constants.half, V::Mul(clamped, constants.rgbMaxChannel)));
+    }
+
+    template <typename V>
+    inline typename V::Int ToUnorm16(typename V::Float value, const FloatConstants<V>& constants)
+    {
+        // Clamp(value, 0.0f, 1.0f) followed by static_cast<uint16_t>(0.5f + (value * 65535.0f)).
+        const typename V::Float clamped = V::Max(V::Min(value, constants.one), constants.zero);
+
+        return V::Truncate(V::Add(constants.half, V::Mul(clamped, constants.rgbMaxChannel16)));
+    }
+
+    // Converts the normalized value to the channel range of the output pixel.
+    template <typename V>
+    inline typename V::Int ToUnorm(typename V::Float value, const FloatConstants<V>& constants, const ColorBgra*)
+    {
+        return ToUnorm8<V>(value, constants);
+    }
+
+    template <typename V>
+    inline typename V::Int ToUnorm(typename V::Float value, const FloatConstants<V>& constants, const ColorBgra64*)
+    {
+        return ToUnorm16<V>(value, constants);
+    }
+
+    template <typename V>
+    inline typename V::Int LoadChroma(const uint8_t* ptr, uint32_t x, uint32_t xChromaShift)
+    {
+        return xChromaShift != 0 ? V::LoadSubsampled(ptr + (x >> 1)) : V::Load(ptr + x);
+    }
+
+    template <typename V>
+    inline typename V::Int LoadChroma(const uint16_t* ptr, uint32_t x, uint32_t xChromaShift)
+    {
+        return xChromaShift != 0 ? V::LoadSubsampled(ptr + (x >> 1)) : V::Load(ptr + x);
+    }
+
+    template <typename V, typename TPixel>
+    inline void StoreYUVToBgra(
+        typename V::Int unormY,
+        typename V::Int unormU,
+        typename V::Int unormV,
+        const YUVToRGBRowConstants& constants,
+        const FloatConstants<V>& floatConstants,
+        TPixel* dstPtr)
+    {
+        const typename V::Float crToR = V::SetFloat(constants.crToR);
+        const typename V::Float cbToB = V::SetFloat(constants.cbToB);
+        const typename V::Float crToG = V::SetFloat(constants.crToG);
+        const typename V::Float cbToG = V::SetFloat(constants.cbToG);
+        const typename V::Float kg = V::SetFloat(constants.kg);
+        const typename V::Float two = V::SetFloat(2.0f);
+
+        const typename V::Float Y = V::Gather(constants.unormFloatTableY, unormY);
+        const typename V::Float Cb = V::Gather(constants.unormFloatTableUV, unormU);
+        const typename V::Float Cr = V::Gather(constants.unormFloatTableUV, unormV);
+
+        // R = Y + (2 * (1 - kr)) * Cr
+        // B = Y + (2 * (1 - kb)) * Cb
+        // G = Y - ((2 * ((kr * (1 - kr) * Cr) + (kb * (1 - kb) * Cb))) / kg)
+        const typename V::Float R = V::Add(Y, V::Mul(crToR, Cr));
+        const typename V::Float B = V::Add(Y, V::Mul(cbToB, Cb));
+        const typename V::Float G = V::Sub(Y, V::Div(V::Mul(two, V::Add(V::Mul(crToG, Cr), V::Mul(cbToG, Cb))), kg));
+
+        V::StoreBgr(dstPtr,
+                    ToUnorm<V>(B, floatConstants, dstPtr),
+                    ToUnorm<V>(G, floatConstants, dstPtr),
+                    ToUnorm<V>(R, floatConstants, dstPtr));
+    }
+
+    template <typename V>
+    uint32_t YUV8ToRGB8Color(
+        const uint8_t* ptrY,
+        const uint8_t* ptrU,
+        const uint8_t* ptrV,
+        uint32_t xChromaShift,
+        uint32_t width,
+        const YUVToRGBRowConstants& constants,
+        ColorBgra* dstPtr)
+    {
+        const FloatConstants<V> floatConstants;
+        const uint32_t vectorWidth = width - (width % V::Width);
+
+        for (uint32_t x = 0; x < vectorWidth; x += V::Width)
+        {
+            StoreYUVToBgra<V>(V::Load(ptrY + x),
+                              LoadChroma<V>(ptrU, x, xChromaShift),
+                              LoadChroma<V>(ptrV, x, xChromaShift),
+                              constants,
+                              floatConstants,
+                              dstPtr + x);
+        }
+
+        return vectorWidth;
+    }
+
+    // The high bit depth converters are used for both the 8-bit and 16-bit per channel output.
+
+    template <typename V, typename TPixel>
+    uint32_t YUV16ToRGBColor(
+        const uint16_t* ptrY,
+        const uint16_t* ptrU,
+        const uint16_t* ptrV,
+        uint32_t xChromaShift,
+        uint32_t width,
+        const YUVToRGBRowConstants& constants,
+        TPixel* dstPtr)
+    {
+        const FloatConstants<V> floatConstants;
+        const uint32_t vectorWidth = width - (width % V::Width);
+
+        for (uint32_t x = 0; x < vectorWidth; x += V::Width)
+        {
+            StoreYUVToBgra<V>(V::Load(ptrY + x),
+                              LoadChroma<V>(ptrU, x, xChromaShift),
+                              LoadChroma<V>(ptrV, x, xChromaShift),
+                              constants,
+                              floatConstants,
+                              dstPtr + x);
+        }
+
+        return vectorWidth;
+    }
+
+    template <typename V, typename TPixel>
+    uint32_t Identity16ToRGBColor(
+        const uint16_t* ptrY,
+        const uint16_t* ptrU,
+        const uint16_t* ptrV,
+        uint32_t xChromaShift,
+        uint32_t width,
+        const YUVToRGBRowConstants& constants,
+        TPixel* dstPtr)
+    {
+        const FloatConstants<V> floatConstants;
+        const uint32_t vectorWidth = width - (width % V::Width);
+
+        for (uint32_t x = 0; x < vectorWidth; x += V::Width)
+        {
+            const typename V::Int unormY = V::Load(ptrY + x);
+            const typename V::Int unormU = LoadChroma<V>(ptrU, x, xChromaShift);
+            const typename V::Int unormV = LoadChroma<V>(ptrV, x, xChromaShift);
+
+            // The Identity matrix stores G in Y, B in U and R in V.
+            V::StoreBgr(dstPtr + x,
+                        ToUnorm<V>(V::Gather(constants.unormFloatTableUV, unormU), floatConstants, dstPtr),
+                        ToUnorm<V>(V::Gather(constants.unormFloatTableY, unormY), floatConstants, dstPtr),
+                        ToUnorm<V>(V::Gather(constants.unormFloatTableUV, unormV), floatConstants, dstPtr));
+        }
+
+        return vectorWidth;
+    }
+
+    template <typename V>
+    uint32_t Identity8ToRGB8Color(
+        const uint8_t* ptrY,
+        const uint8_t* ptrU,
+        const uint8_t* ptrV,
+        uint32_t xChromaShift,
+        uint32_t width,
+        const uint32_t* limitedToFullTable,
+        ColorBgra* dstPtr)
+    {
+        const uint32_t vectorWidth = width - (width % V::Width);
+
+        for (uint32_t x = 0; x < vectorWidth; x += V::Width)
+        {
+            typename V::Int unormY = V::Load(ptrY + x);
+            typename V::Int unormU = LoadChroma<V>(ptrU, x, xChromaShift);
+            typename V::Int unormV = LoadChroma<V>(ptrV, x, xChromaShift);
+
+            if (limitedToFullTable)
+            {
+                unormY = V::GatherInt(limitedToFullTable, unormY);
+                unormU = V::GatherInt(limitedToFullTable, unormU);
+                unormV = V::GatherInt(limitedToFullTable, unormV);
+            }
+
+            V::StoreBgr(dstPtr + x, unormU, unormY, unormV);
+        }
+
+        return vectorWidth;
+    }
+
+    template <typename V>
+    uint32_t Identity8ToRGB8Mono(
+        const uint8_t* ptrY,
+        uint32_t width,
+        const uint32_t* limitedToFullTable,
+        ColorBgra* dstPtr)
+    {
+        const uint32_t vectorWidth = width - (width % V::Width);
+
+        for (uint32_t x = 0; x < vectorWidth; x += V::Width)
+        {
+            typename V::Int gray = V::Load(ptrY + x);
+
+            if (limitedToFullTable)
+            {
+                gray = V::GatherInt(limitedToFullTable, gray);
+            }
+
+            V::StoreBgr(dstPtr + x, gray, gray, gray);
+        }
+
+        return vectorWidth;
+    }
+
+    // Narrows the full range samples to 8 bits, this produces the same value as the lookup table conversion,
+    // which is round(sample * 255 / maxSample).
+    // (x + (x >> bitDepth) + 1) >> bitDepth is equal to x / ((1 << bitDepth) - 1) for all x < 2^(2 * bitDepth).
+    template <typename V>
+    struct SampleNarrowingConstants
+    {
+        typename V::Int maxSample;
+        typename V::Int halfMaxSample;
+        typename V::Int rgbMaxChannel;
+        typename V::Int one;
+        uint32_t bitDepth;
+
+        SampleNarrowingConstants(uint32_t bitDepth) :
+            maxSample(V::SetInt((1U << bitDepth) - 1)),
+            halfMaxSample(V::SetInt(((1U << bitDepth) - 1) >> 1)),
+            rgbMaxChannel(V::SetInt(255)),
+            one(V::SetInt(1)),
+            bitDepth(bitDepth)
+        {
+        }
+    };
+
+    template <typename V>
+    inline typename V::Int NarrowFullRangeSamples(typename V::Int samples, const SampleNarrowingConstants<V>& constants)
+    {
+        const typename V::Int x = V::AddInt(V::MulInt(V::MinInt(samples, constants.maxSample), constants.rgbMaxChannel), constants.halfMaxSample);
+
+        return V::ShiftRightInt(V::AddInt(V::AddInt(x, V::ShiftRightInt(x, constants.bitDepth)), constants.one), constants.bitDepth);
+    }
+
+    template <typename V>
+    uint32_t FullRangeIdentity16ToRGB8Color(
+        const uint16_t* ptrY,
+        const uint16_t* ptrU,
+        const uint16_t* ptrV,
+        uint32_t xChromaShift,
+        uint32_t width,
+        uint32_t bitDepth,
+        ColorBgra* dstPtr)
+    {
+        const SampleNarrowingConstants<V> constants(bitDepth);
+        const uint32_t vectorWidth = width - (width % V::Width);
+
+        for (uint32_t x = 0; x < vectorWidth; x += V::Width)
+        {
+            const typename V::Int g = NarrowFullRangeSamples<V>(V::Load(ptrY + x), constants);
+            const typename V::Int b = NarrowFullRangeSamples<V>(LoadChroma<V>(ptrU, x, xChromaShift), constants);
+            const typename V::Int r = NarrowFullRangeSamples<V>(LoadChroma<V>(ptrV, x, xChromaShift), constants);
+
+            // The Identity matrix stores G in Y, B in U and R in V.
+            V::StoreBgr(dstPtr + x, b, g, r);
+        }
+
+        return vectorWidth;
+    }
+
+    template <typename V>
+    uint32_t FullRangeY16ToRGB8Mono(
+        const uint16_t* ptrY,
+        uint32_t width,
+        uint32_t bitDepth,
+        ColorBgra* dstPtr)
+    {
+        const SampleNarrowingConstants<V> constants(bitDepth);
+        const uint32_t vectorWidth = width - (width % V::Width);
+
+        for (uint32_t x = 0; x < vectorWidth; x += V::Width)
+        {
+            const typename V::Int gray = NarrowFullRangeSamples<V>(V::Load(ptrY + x), constants);
+
+            V::StoreBgr(dstPtr + x, gray, gray, gray);
+        }
+
+        return vectorWidth;
+    }
+
+    // The YUV to RGB conversion of a monochrome image produces R = G = B = Y because Cb and Cr are zero,
+    // so the monochrome converters only need to clamp and scale the Y value.
+
+    template <typename V>
+    uint32_t Y8ToRGB8Mono(
+        const uint8_t* ptrY,
+        uint32_t width,
+        const YUVToRGBRowConstants& constants,
+        ColorBgra* dstPtr)
+    {
+        const FloatConstants<V> floatConstants;
+        const uint32_t vectorWidth = width - (width % V::Width);
+
+        for (uint32_t x = 0; x < vectorWidth; x += V::Width)
+        {
+            const typename V::Int gray = ToUnorm8<V>(V::Gather(constants.unormFloatTableY, V::Load(ptrY + x)), floatConstants);
+
+            V::StoreBgr(dstPtr + x, gray, gray, gray);
+        }
+
+        return vectorWidth;
+    }
+
+    template <typename V, typename TPixel>
+    uint32_t Y16ToRGBMono(
+        const uint16_t* ptrY,
+        uint32_t width,
+        const YUVToRGBRowConstants& constants,
+        TPixel* dstPtr)
+    {
+        const FloatConstants<V> floatConstants;
+        const uint32_t vectorWidth = width - (width % V::Width);
+
+        for (uint32_t x = 0; x < vectorWidth; x += V::Width)
+        {
+            const typename V::Int unormY = V::Load(ptrY + x);
+            const typename V::Int gray = ToUnorm<V>(V::Gather(constants.unormFloatTableY, unormY), floatConstants, dstPtr);
+
+            V::StoreBgr(dstPtr + x, gray, gray, gray);
+        }
+
+        return vectorWidth;
+    }
+
+    template <typename V>
+    uint32_t Y8ToAlpha8(
+        const uint8_t* ptrY,
+        uint32_t width,
+        const YUVToRGBRowConstants& constants,
+        ColorBgra* dstPtr)
+    {
+        const FloatConstants<V> floatConstants;
+        const uint32_t vectorWidth = width - (width % V::Width);
+
+        for (uint32_t x = 0; x < vectorWidth; x += V::Width)
+        {
+            V::StoreAlpha(dstPtr + x, ToUnorm8<V>(V::Gather(constants.unormFloatTableY, V::Load(ptrY + x)), floatConstants));
+        }
+
+        return vectorWidth;
+    }
+
+    template <typename V, typename TPixel>
+    uint32_t Y16ToAlpha(
+        const uint16_t* ptrY,
+        uint32_t width,
+        const YUVToRGBRowConstants& constants,
+        TPixel* dstPtr)
+    {
+        const FloatConstants<V> floatConstants;
+        const uint32_t vectorWidth = width - (width % V::Width);
+
+        for (uint32_t x = 0; x < vectorWidth; x += V::Width)
+        {
+            const typename V::Int unormY = V::Load(ptrY + x);
+
+            V::StoreAlpha(dstPtr + x, ToUnorm<V>(V::Gather(constants.unormFloatTableY, unormY), floatConstants, dstPtr));
+        }
+
+        return vectorWidth;
+    }
+
+    template <typename V>
+    DecodedImageRowConverters CreateRowConverters(const char* name)
+    {
+        DecodedImageRowConverters converters{};
+
+        converters.name = name;
+        converters.yuv8ToRGB8Color = YUV8ToRGB8Color<V>;
+        converters.yuv16ToRGB8Color = YUV16ToRGBColor<V, ColorBgra>;
+        converters.identity16ToRGB8Color = Identity16ToRGBColor<V, ColorBgra>;
+        converters.identity8ToRGB8Color = Identity8ToRGB8Color<V>;
+        converters.identity8ToRGB8Mono = Identity8ToRGB8Mono<V>;
+        converters.fullRangeIdentity16ToRGB8Color = FullRangeIdentity16ToRGB8Color<V>;
+        converters.fullRangeY16ToRGB8Mono = FullRangeY16ToRGB8Mono<V>;
+        converters.y8ToRGB8Mono = Y8ToRGB8Mono<V>;
+        converters.y16ToRGB8Mono = Y16ToRGBMono<V, ColorBgra>;
+        converters.y8ToAlpha8 = Y8ToAlpha8<V>;
+        converters.y16ToAlpha8 = Y16ToAlpha<V, ColorBgra>;
+        converters.yuv16ToRGB16Color = YUV16ToRGBColor<V, ColorBgra64>;
+        converters.identity16ToRGB16Color = Identity16ToRGBColor<V, ColorBgra64>;
+        converters.y16ToRGB16Mono = Y16ToRGBMono<V, ColorBgra64>;
+        converters.y16ToAlpha16 = Y16ToAlpha<V, ColorBgra64>;
+
+        return converters;
+    }
+}
@@ -0,0 +1,259 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "DecoderSession.h"
+#include "Instrumentation.h"
+#include "ParallelFor.h"
+#include <aom/aom_decoder.h>
+#include <aom/aomdx.h>
+#include <iterator>
+
+AOMFrameBufferPool::AOMFrameBufferPool() : mutex(), buffers(), retainedBytes(0)
+{
+}
+
+int AOMFrameBufferPool::GetFrameBuffer(void* priv, size_t minSize, aom_codec_frame_buffer_t* fb) noexcept
+{
+    return static_cast<AOMFrameBufferPool*>(priv)->Acquire(minSize, fb);
+}
+
+int AOMFrameBufferPool::ReleaseFrameBuffer(void* priv, aom_codec_frame_buffer_t* fb) noexcept
+{
+    return static_cast<AOMFrameBufferPool*>(priv)->Release(fb);
+}
+
+int AOMFrameBufferPool::Acquire(size_t minSize, aom_codec_frame_buffer_t* fb) noexcept
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // The smallest idle buffer that is large enough is used, the tiles of an image grid
+    // have the same size so this is normally a buffer that was used for a previous tile.
+    FrameBuffer* selected = nullptr;
+
+    for (const std::unique_ptr<FrameBuffer>& buffer : buffers)
+    {
+        if (!buffer->inUse && buffer->size >= minSize && (!selected || buffer->size < selected->size))
+        {
+            selected = buffer.get();
+        }
+    }
+
+    if (!selected)
+    {
+        try
+        {
+            std::unique_ptr<FrameBuffer> buffer = std::make_unique<FrameBuffer>();
+
+            // The decoder requires new buffers to be zero filled, the reused buffers are not cleared
+            // which matches the behavior of the internal libaom frame buffer pool.
+            buffer->data = std::make_unique<uint8_t[]>(minSize);
+            buffer->size = minSize;
+            buffer->inUse = false;
+
+            buffers.push_back(std::move(buffer));
+            selected = buffers.back().get();
+            retainedBytes += minSize;
+
+            Instrumentation::AddBytesAllocated(minSize);
+        }
+        catch (const std::bad_alloc&)
+        {
+            return -1;
+        }
+    }
+
+    selected->inUse = true;
+
+    fb->data = selected->data.get();
+    fb->size = selected->size;
+    fb->priv = selected;
+
+    return 0;
+}
+
+int AOMFrameBufferPool::Release(aom_codec_frame_buffer_t* fb) noexcept
+{
+    FrameBuffer* buffer = static_cast<FrameBuffer*>(fb->priv);
+
+    if (!buffer)
+    {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    buffer->inUse = false;
+
+    if (retainedBytes > MaxRetainedBytes)
+    {
+        TrimIdleBuffers();
+    }
+
+    return 0;
+}
+
+size_t AOMFrameBufferPool::GetRetainedBytes() noexcept
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return retainedBytes;
+}
+
+void AOMFrameBufferPool::TrimIdleBuffers() noexcept
+{
+    while (retainedBytes > MaxRetainedBytes)
+    {
+        auto largest = buffers.end();
+
+        for (auto it = buffers.begin(); it != buffers.end(); ++it)
+        {
+            if (!(*it)->inUse && (largest == buffers.end() || (*it)->size > (*largest)->size))
+            {
+                largest = it;
+            }
+        }
+
+        if (largest == buffers.end())
+        {
+            // The remaining buffers are in use, they will be trimmed when they are released.
+            break;
+        }
+
+        retainedBytes -= (*largest)->size;
+        buffers.erase(largest);
+    }
+}
+
+ScopedAOMDecoder::ScopedAOMDecoder(uint32_t threadCount, AOMFrameBufferPool* frameBufferPool)
+    : ScopedAOMCodec(), threadCount(ClampThreadCount(threadCount)), inputBuffer(), inputBufferSize(0)
+{
+    aom_codec_iface_t* iface = aom_codec_av1_dx();
+
+    aom_codec_dec_cfg_t cfg{};
+    cfg.threads = this->threadCount;
+    cfg.allow_lowbitdepth = 1;
+
+    throw_on_error(aom_codec_dec_init(&codec, iface, &cfg, 0));
+    initialized = true;
+
+    Instrumentation::Increment(Instrumentation::Counter::DecoderInitCount);
+
+    // The row based multi-threading allows an image without AV1 tiles to use more than one thread.
+    throw_on_error(aom_codec_control(&codec, AV1D_SET_ROW_MT, this->threadCount > 1 ? 1u : 0u));
+
+    if (frameBufferPool)
+    {
+        throw_on_error(aom_codec_set_frame_buffer_functions(
+            &codec,
+            AOMFrameBufferPool::GetFrameBuffer,
+            AOMFrameBufferPool::ReleaseFrameBuffer,
+            frameBufferPool));
+    }
+}
+
+uint32_t ScopedAOMDecoder::ClampThreadCount(uint32_t maxThreads) noexcept
+{
+    // AOM limits decoders to this many threads
+    // See MAX_NUM_THREADS in aom_util/aom_thread.h
+    constexpr uint32_t aomMaxThreadCount = 64;
+
+    if (maxThreads < 1)
+    {
+        return 1;
+    }
+    else if (maxThreads > aomMaxThreadCount)
+    {
+        return aomMaxThreadCount;
+    }
+
+    return maxThreads;
+}
+
+uint8_t* ScopedAOMDecoder::GetInputBuffer(size_t size)
+{
+    if (size > inputBufferSize)
+    {
+        // The old buffer is freed first to reduce the peak memory usage.
+        inputBuffer.reset();
+        inputBufferSize = 0;
+
+        inputBuffer = std::make_unique<uint8_t[]>(size);
+        inputBufferSize = size;
+
+        Instrumentation::AddBytesAllocated(size);
+    }
+
+    return inputBuffer.get();
+}
+
+DecoderSession::DecoderSession()
+    : mutex(), frameBufferPool(), idleDecoders(), maxIdleDecoders(GetProcessorCount()), lookupTableCache()
+{
+    // Reserving the space up front allows ReleaseDecoder to add decoders to the pool without allocating.
+    idleDecoders.reserve(maxIdleDecoders);
+}
+
+std::unique_ptr<ScopedAOMDecoder> DecoderSession::AcquireDecoder(uint32_t threadCount)
+{
+    threadCount = ScopedAOMDecoder::ClampThreadCount(threadCount);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // The decoder thread count cannot be changed after it has been initialized.
+        for (auto it = idleDecoders.rbegin(); it != idleDecoders.rend(); ++it)
+        {
+            if ((*it)->GetThreadCount() == threadCount)
+            {
+                std::unique_ptr<ScopedAOMDecoder> decoder = std::move(*it);
+                idleDecoders.erase(std::next(it).base());
+
+                return decoder;
+            }
+        }
+    }
+
+    return std::make_unique<ScopedAOMDecoder>(threadCount, &frameBufferPool);
+}
+
+void DecoderSession::ReleaseDecoder(std::unique_ptr<ScopedAOMDecoder> decoder) noexcept
+{
+    // An idle decoder keeps the frame buffers of the last image that it decoded, destroying the
+    // decoder returns those buffers to the frame buffer pool so that they can be trimmed.
+    if (frameBufferPool.GetRetainedBytes() > AOMFrameBufferPool::MaxRetainedBytes)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Any decoders that do not fit in the pool are destroyed when this method returns.
+    if (idleDecoders.size() < maxIdleDecoders)
+    {
+        idleDecoders.push_back(std::move(decoder));
+    }
+}
+
+PooledAOMDecoder::PooledAOMDecoder(DecoderSession* session, const DecodeInfo* decodeInfo)
+    : session(session),
+      decoder(session ? session->AcquireDecoder(decodeInfo->maxDecoderThreads)
+                      : std::make_unique<ScopedAOMDecoder>(decodeInfo->maxDecoderThreads))
+{
+}
+
+PooledAOMDecoder::~PooledAOMDecoder()
+{
+    if (session && decoder)
+    {
+        session->ReleaseDecoder(std::move(decoder));
+    }
+}
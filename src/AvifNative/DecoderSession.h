@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AvifNative.h"
+#include "DecodedImageConverter.h"
+#include "ScopedAOMCodec.h"
+#include <aom/aom_frame_buffer.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// A pool of the frame buffers that the AV1 decoders write the decoded images into,
+// the buffers are reused for the following tiles and images instead of being freed.
+// The idle buffers are freed when the pool holds more than MaxRetainedBytes, so that
+// a large image does not keep its frame buffers for the lifetime of the session.
+class AOMFrameBufferPool
+{
+public:
+    static constexpr size_t MaxRetainedBytes = 256 * 1024 * 1024;
+
+    AOMFrameBufferPool();
+
+    AOMFrameBufferPool(const AOMFrameBufferPool&) = delete;
+    AOMFrameBufferPool& operator=(const AOMFrameBufferPool&) = delete;
+
+    static int GetFrameBuffer(void* priv, size_t minSize, aom_codec_frame_buffer_t* fb) noexcept;
+
+    static int ReleaseFrameBuffer(void* priv, aom_codec_frame_buffer_t* fb) noexcept;
+
+    // Gets the total size of the buffers in the pool, including the buffers that are in use.
+    size_t GetRetainedBytes() noexcept;
+
+private:
+    struct FrameBuffer
+    {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size;
+        bool inUse;
+    };
+
+    int Acquire(size_t minSize, aom_codec_frame_buffer_t* fb) noexcept;
+
+    int Release(aom_codec_frame_buffer_t* fb) noexcept;
+
+    // Frees the largest idle buffers until the pool is within MaxRetainedBytes.
+    // The caller must hold the mutex.
+    void TrimIdleBuffers() noexcept;
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<FrameBuffer>> buffers;
+    size_t retainedBytes;
+};
+
+class ScopedAOMDecoder : public ScopedAOMCodec
+{
+public:
+    // When frameBufferPool is null the decoder uses its own frame buffers.
+    explicit ScopedAOMDecoder(uint32_t threadCount, AOMFrameBufferPool* frameBufferPool = nullptr);
+
+    // Gets a buffer that holds the compressed data of an image that is stored in more than one segment,
+    // the buffer is reused for each image that is decoded by this decoder.
+    uint8_t* GetInputBuffer(size_t size);
+
+    uint32_t GetThreadCount() const noexcept
+    {
+        return threadCount;
+    }
+
+    // Clamps the requested thread count to the range that the decoder supports.
+    static uint32_t ClampThreadCount(uint32_t maxThreads) noexcept;
+
+private:
+    uint32_t threadCount;
+    std::unique_ptr<uint8_t[]> inputBuffer;
+    size_t inputBufferSize;
+};
+
+// Keeps a pool of initialized AV1 decoders and the YUV lookup tables that are reused for the tiles
+// of an image grid and for any other images that are decoded while the session is alive.
+struct DecoderSession
+{
+public:
+    DecoderSession();
+
+    DecoderSession(const DecoderSession&) = delete;
+    DecoderSession& operator=(const DecoderSession&) = delete;
+
+    // Gets an idle decoder that uses the specified number of threads, or creates a new decoder.
+    std::unique_ptr<ScopedAOMDecoder> AcquireDecoder(uint32_t threadCount);
+
+    // Returns the decoder to the pool, the decoder is destroyed when the pool is full or when the
+    // frame buffer pool is over its limit because an idle decoder keeps its last frame buffers.
+    void ReleaseDecoder(std::unique_ptr<ScopedAOMDecoder> decoder) noexcept;
+
+    YUVLookupTableCache* GetLookupTableCache() noexcept
+    {
+        return &lookupTableCache;
+    }
+
+private:
+    std::mutex mutex;
+    // The frame buffer pool must be declared before the decoders, the decoders
+    // release their frame buffers into the pool when they are destroyed.
+    AOMFrameBufferPool frameBufferPool;
+    std::vector<std::unique_ptr<ScopedAOMDecoder>> idleDecoders;
+    const size_t maxIdleDecoders;
+    YUVLookupTableCache lookupTableCache;
+};
+
+// Borrows a decoder from the session for the lifetime of this object.
+// When the session is null a new decoder is created and destroyed with this object.
+class PooledAOMDecoder
+{
+public:
+    PooledAOMDecoder(DecoderSession* session, const DecodeInfo* decodeInfo);
+
+    PooledAOMDecoder(const PooledAOMDecoder&) = delete;
+    PooledAOMDecoder& operator=(const PooledAOMDecoder&) = delete;
+
+    ~PooledAOMDecoder();
+
+    aom_codec_ctx_t* get() noexcept
+    {
+        return decoder->get();
+    }
+
+    uint8_t* GetInputBuffer(size_t size)
+    {
+        return decoder->GetInputBuffer(size);
+    }
+
+    // Prevents the decoder from being returned to the session, this is used when
+    // the decoder may have been left in an invalid state.
+    void Discard() noexcept
+    {
+        session = nullptr;
+    }
+
+private:
+    DecoderSession* session;
+    std::unique_ptr<ScopedAOMDecoder> decoder;
+};
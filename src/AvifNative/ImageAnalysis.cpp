@@ -0,0 +1,309 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "ImageAnalysis.h"
+#include "ParallelFor.h"
+#include <memory>
+#include <new>
+#include <string.h>
+
+#if defined(_M_IX86) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(_M_ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+    constexpr uint32_t ColorMask = 0x00ffffff;
+    constexpr uint32_t AlphaMask = 0xff000000;
+    // The B to G and G to R differences that are produced by XORing a pixel with itself shifted right by 8 bits.
+    constexpr uint32_t GrayscaleMask = 0x0000ffff;
+
+    // The minimum number of rows that a band contains, small bands do not have enough
+    // work to offset the cost of handing them to another thread.
+    constexpr uint32_t MinimumBandHeight = 64;
+
+    // The pixel bits that the analysis of a band accumulates, the bands of a tile are merged by
+    // combining these values.
+    struct BandAccumulators
+    {
+        // The bits that differ from the first pixel of the tile.
+        uint32_t differenceBits;
+        // The bits that differ between the B, G and R values of a pixel.
+        uint32_t grayscaleBits;
+        // The bits that are set in every pixel.
+        uint32_t commonBits;
+    };
+
+    inline uint32_t ReadPixel(const uint8_t* ptr)
+    {
+        uint32_t value;
+        memcpy(&value, ptr, sizeof(value));
+
+        return value;
+    }
+
+    inline bool AnalysisIsComplete(const BandAccumulators& accumulators)
+    {
+        // The scan can stop early when none of the results can change.
+        return (accumulators.differenceBits & ColorMask) != 0
+            && (accumulators.differenceBits & AlphaMask) != 0
+            && (accumulators.grayscaleBits & GrayscaleMask) != 0
+            && (accumulators.commonBits & AlphaMask) != AlphaMask;
+    }
+
+    void AnalyzeRow(const uint8_t* row, uint32_t width, uint32_t firstPixel, BandAccumulators& accumulators)
+    {
+        uint32_t differenceBits = 0;
+        uint32_t grayscaleBits = 0;
+        uint32_t commonBits = 0xffffffff;
+        uint32_t x = 0;
+
+#if defined(_M_IX86) || defined(_M_X64)
+        if (width >= 4)
+        {
+            const __m128i firstPixelVector = _mm_set1_epi32(static_cast<int>(firstPixel));
+
+            __m128i difference = _mm_setzero_si128();
+            __m128i grayscale = _mm_setzero_si128();
+            __m128i common = _mm_set1_epi32(-1);
+
+            for (; x + 4 <= width; x += 4)
+            {
+                const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + (static_cast<size_t>(x) * 4)));
+
+                difference = _mm_or_si128(difference, _mm_xor_si128(pixels, firstPixelVector));
+                grayscale = _mm_or_si128(grayscale, _mm_xor_si128(pixels, _mm_srli_epi32(pixels, 8)));
+                common = _mm_and_si128(common, pixels);
+            }
+
+            difference = _mm_or_si128(difference, _mm_shuffle_epi32(difference, _MM_SHUFFLE(1, 0, 3, 2)));
+            difference = _mm_or_si128(difference, _mm_shuffle_epi32(difference, _MM_SHUFFLE(2, 3, 0, 1)));
+            grayscale = _mm_or_si128(grayscale, _mm_shuffle_epi32(grayscale, _MM_SHUFFLE(1, 0, 3, 2)));
+            grayscale = _mm_or_si128(grayscale, _mm_shuffle_epi32(grayscale, _MM_SHUFFLE(2, 3, 0, 1)));
+            common = _mm_and_si128(common, _mm_shuffle_epi32(common, _MM_SHUFFLE(1, 0, 3, 2)));
+            common = _mm_and_si128(common, _mm_shuffle_epi32(common, _MM_SHUFFLE(2, 3, 0, 1)));
+
+            differenceBits = static_cast<uint32_t>(_mm_cvtsi128_si32(difference));
+            grayscaleBits = static_cast<uint32_t>(_mm_cvtsi128_si32(grayscale));
+            commonBits = static_cast<uint32_t>(_mm_cvtsi128_si32(common));
+        }
+#elif defined(_M_ARM64)
+        if (width >= 4)
+        {
+            const uint32x4_t firstPixelVector = vdupq_n_u32(firstPixel);
+
+            uint32x4_t difference = vdupq_n_u32(0);
+            uint32x4_t grayscale = vdupq_n_u32(0);
+            uint32x4_t common = vdupq_n_u32(0xffffffff);
+
+            for (; x + 4 <= width; x += 4)
+            {
+                const uint32x4_t pixels = vld1q_u32(reinterpret_cast<const uint32_t*>(row + (static_cast<size_t>(x) * 4)));
+
+                difference = vorrq_u32(difference, veorq_u32(pixels, firstPixelVector));
+                grayscale = vorrq_u32(grayscale, veorq_u32(pixels, vshrq_n_u32(pixels, 8)));
+                common = vandq_u32(common, pixels);
+            }
+
+            uint32_t lanes[4];
+
+            vst1q_u32(lanes, difference);
+            differenceBits = lanes[0] | lanes[1] | lanes[2] | lanes[3];
+            vst1q_u32(lanes, grayscale);
+            grayscaleBits = lanes[0] | lanes[1] | lanes[2] | lanes[3];
+            vst1q_u32(lanes, common);
+            commonBits = lanes[0] & lanes[1] & lanes[2] & lanes[3];
+        }
+#endif
+
+        for (; x < width; x++)
+        {
+            const uint32_t pixel = ReadPixel(row + (static_cast<size_t>(x) * 4));
+
+            differenceBits |= pixel ^ firstPixel;
+            grayscaleBits |= pixel ^ (pixel >> 8);
+            commonBits &= pixel;
+        }
+
+        accumulators.differenceBits |= differenceBits;
+        accumulators.grayscaleBits |= grayscaleBits;
+        accumulators.commonBits &= commonBits;
+    }
+
+    void AnalyzeBand(const BitmapData& tile, uint32_t startRow, uint32_t endRow, BandAccumulators& accumulators)
+    {
+        const uint32_t firstPixel = ReadPixel(tile.scan0);
+
+        accumulators.differenceBits = 0;
+        accumulators.grayscaleBits = 0;
+        accumulators.commonBits = 0xffffffff;
+
+        for (uint32_t y = startRow; y < endRow; y++)
+        {
+            AnalyzeRow(tile.scan0 + (static_cast<size_t>(y) * tile.stride), tile.width, firstPixel, accumulators);
+
+            if (AnalysisIsComplete(accumulators))
+            {
+                break;
+            }
+        }
+    }
+
+    uint32_t GetBandHeight(const BitmapData* tiles, uint32_t tileCount, uint32_t threadCount)
+    {
+        if (threadCount <= 1)
+        {
+            return UINT32_MAX;
+        }
+
+        uint64_t totalHeight = 0;
+
+        for (uint32_t i = 0; i < tileCount; i++)
+        {
+            totalHeight += tiles[i].height;
+        }
+
+        // Split the tiles into enough bands to give each thread a few bands, this
+        // balances the load when some bands stop early.
+        const uint64_t targetBandCount = static_cast<uint64_t>(threadCount) * 4;
+        const uint64_t bandHeight = (totalHeight + targetBandCount - 1) / targetBandCount;
+
+        if (bandHeight < MinimumBandHeight)
+        {
+            return MinimumBandHeight;
+        }
+
+        return bandHeight > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(bandHeight);
+    }
+
+    inline uint32_t GetTileBandCount(const BitmapData& tile, uint32_t bandHeight)
+    {
+        return static_cast<uint32_t>((static_cast<uint64_t>(tile.height) + bandHeight - 1) / bandHeight);
+    }
+}
+
+EncoderStatus AnalyzeTiles(
+    const BitmapData* tiles,
+    uint32_t tileCount,
+    uint32_t maxThreads,
+    TileAnalysis* results)
+{
+    if (!tiles || !results)
+    {
+        return EncoderStatus::NullParameter;
+    }
+
+    if (tileCount == 0)
+    {
+        return EncoderStatus::Ok;
+    }
+
+    for (uint32_t i = 0; i < tileCount; i++)
+    {
+        if (tiles[i].pixelFormat != BitmapPixelFormat::Bgra32)
+        {
+            return EncoderStatus::UnsupportedBitDepth;
+        }
+    }
+
+    const uint32_t threadCount = maxThreads > 0 ? maxThreads : GetProcessorCount();
+    const uint32_t bandHeight = GetBandHeight(tiles, tileCount, threadCount);
+
+    std::unique_ptr<uint32_t[]> firstBandIndexes(new (std::nothrow) uint32_t[static_cast<size_t>(tileCount) + 1]);
+    if (!firstBandIndexes)
+    {
+        return EncoderStatus::OutOfMemory;
+    }
+
+    uint64_t bandCount = 0;
+
+    for (uint32_t i = 0; i < tileCount; i++)
+    {
+        if (tiles[i].width == 0 || tiles[i].height == 0)
+        {
+            return EncoderStatus::NullParameter;
+        }
+
+        firstBandIndexes[i] = static_cast<uint32_t>(bandCount);
+        bandCount += GetTileBandCount(tiles[i], bandHeight);
+
+        if (bandCount > UINT32_MAX)
+        {
+            return EncoderStatus::OutOfMemory;
+        }
+    }
+
+    firstBandIndexes[tileCount] = static_cast<uint32_t>(bandCount);
+
+    std::unique_ptr<BandAccumulators[]> bands(new (std::nothrow) BandAccumulators[bandCount]);
+    std::unique_ptr<uint32_t[]> bandTileIndexes(new (std::nothrow) uint32_t[bandCount]);
+    if (!bands || !bandTileIndexes)
+    {
+        return EncoderStatus::OutOfMemory;
+    }
+
+    for (uint32_t i = 0; i < tileCount; i++)
+    {
+        for (uint32_t band = firstBandIndexes[i]; band < firstBandIndexes[i + 1]; band++)
+        {
+            bandTileIndexes[band] = i;
+        }
+    }
+
+    const EncoderStatus status = ParallelFor<EncoderStatus>(
+        static_cast<uint32_t>(bandCount),
+        GetWorkerThreadCount(static_cast<uint32_t>(bandCount), threadCount),
+        [&](uint32_t index)
+        {
+            const uint32_t tileIndex = bandTileIndexes[index];
+            const BitmapData& tile = tiles[tileIndex];
+
+            const uint64_t startRow = static_cast<uint64_t>(index - firstBandIndexes[tileIndex]) * bandHeight;
+            const uint64_t endRow = startRow + bandHeight;
+
+            AnalyzeBand(tile,
+                        static_cast<uint32_t>(startRow),
+                        endRow < tile.height ? static_cast<uint32_t>(endRow) : tile.height,
+                        bands[index]);
+
+            return EncoderStatus::Ok;
+        });
+
+    if (status != EncoderStatus::Ok)
+    {
+        return status;
+    }
+
+    for (uint32_t i = 0; i < tileCount; i++)
+    {
+        BandAccumulators tileAccumulators{ 0, 0, 0xffffffff };
+
+        for (uint32_t band = firstBandIndexes[i]; band < firstBandIndexes[i + 1]; band++)
+        {
+            tileAccumulators.differenceBits |= bands[band].differenceBits;
+            tileAccumulators.grayscaleBits |= bands[band].grayscaleBits;
+            tileAccumulators.commonBits &= bands[band].commonBits;
+        }
+
+        TileAnalysis& result = results[i];
+
+        result.firstPixel = ReadPixel(tiles[i].scan0);
+        result.isGrayscale = (tileAccumulators.grayscaleBits & GrayscaleMask) == 0;
+        result.hasTransparency = (tileAccumulators.commonBits & AlphaMask) != AlphaMask;
+        result.isHomogeneousColor = (tileAccumulators.differenceBits & ColorMask) == 0;
+        result.isHomogeneousAlpha = (tileAccumulators.differenceBits & AlphaMask) == 0;
+    }
+
+    return EncoderStatus::Ok;
+}
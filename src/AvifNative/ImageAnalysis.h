@@ -0,0 +1,21 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AvifNative.h"
+
+EncoderStatus AnalyzeTiles(
+    const BitmapData* tiles,
+    uint32_t tileCount,
+    uint32_t maxThreads,
+    TileAnalysis* results);
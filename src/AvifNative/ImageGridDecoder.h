@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AvifNative.h"
+#include "Instrumentation.h"
+#include "ParallelFor.h"
+#include <stdint.h>
+#include <algorithm>
+
+// Decodes the tiles of an image grid, decodeTile(tileIndex, decodeInfo, alphaDecodeInfo) decodes and converts a single tile.
+// The alpha decode info is optional, it is used when each tile contains both a color and an alpha image.
+template<typename TDecodeTile>
+DecoderStatus DecodeImageGrid(
+    uint32_t tileColumnCount,
+    uint32_t tileRowCount,
+    DecodeInfo* decodeInfo,
+    DecodeInfo* alphaDecodeInfo,
+    TDecodeTile decodeTile)
+{
+    if (!decodeInfo)
+    {
+        return DecoderStatus::NullParameter;
+    }
+
+    const uint64_t tileCount = static_cast<uint64_t>(tileColumnCount) * tileRowCount;
+
+    if (tileCount == 0 || tileCount > UINT32_MAX)
+    {
+        return DecoderStatus::NullParameter;
+    }
+
+    // The first tile is decoded on the calling thread, it sets the expected tile size and format
+    // that the remaining tiles are checked against after they have been decoded.
+    decodeInfo->tileColumnIndex = 0;
+    decodeInfo->tileRowIndex = 0;
+
+    if (alphaDecodeInfo)
+    {
+        alphaDecodeInfo->tileColumnIndex = 0;
+        alphaDecodeInfo->tileRowIndex = 0;
+    }
+
+    DecoderStatus status = decodeTile(0, decodeInfo, alphaDecodeInfo);
+
+    if (status == DecoderStatus::Ok && tileCount > 1)
+    {
+        DecodeInfo firstTileInfo = *decodeInfo;
+        DecodeInfo firstAlphaTileInfo = alphaDecodeInfo ? *alphaDecodeInfo : DecodeInfo{};
+        const uint32_t remainingTileCount = static_cast<uint32_t>(tileCount - 1);
+        // The decoder thread limit is the thread budget of the whole image, a batch decode
+        // leases a part of the processors to each image. A limit of zero uses all of the processors.
+        const uint32_t threadLimit = decodeInfo->maxDecoderThreads > 0 ? decodeInfo->maxDecoderThreads : GetProcessorCount();
+        const uint32_t threadCount = GetWorkerThreadCount(remainingTileCount, threadLimit);
+
+        if (threadCount > 1)
+        {
+            // The tiles already use all of the threads, so each tile is converted on the
+            // thread that decoded it.
+            firstTileInfo.maxConversionThreads = 1;
+            firstAlphaTileInfo.maxConversionThreads = 1;
+
+            // The decoder threads are split between the tiles that are decoded at the same time.
+            firstTileInfo.maxDecoderThreads = std::max(threadLimit / threadCount, 1u);
+            firstAlphaTileInfo.maxDecoderThreads = std::max(threadLimit / threadCount, 1u);
+        }
+
+        Instrumentation::ScopedParallelTimer parallelTimer(threadCount);
+
+        // Each tile writes to its own region of the output image, so the tiles can be
+        // decoded in any order.
+        status = ParallelFor<DecoderStatus>(
+            remainingTileCount,
+            threadCount,
+            [&](uint32_t index)
+            {
+                Instrumentation::ScopedTimer workTimer(Instrumentation::Counter::ParallelWorkTime);
+
+                const uint32_t tileIndex = index + 1;
+
+                DecodeInfo tileInfo = firstTileInfo;
+                tileInfo.tileColumnIndex = tileIndex % tileColumnCount;
+                tileInfo.tileRowIndex = tileIndex / tileColumnCount;
+
+                DecodeInfo alphaTileInfo = firstAlphaTileInfo;
+                alphaTileInfo.tileColumnIndex = tileInfo.tileColumnIndex;
+                alphaTileInfo.tileRowIndex = tileInfo.tileRowIndex;
+
+                return decodeTile(tileIndex, &tileInfo, alphaDecodeInfo ? &alphaTileInfo : nullptr);
+            });
+    }
+
+    return status;
+}
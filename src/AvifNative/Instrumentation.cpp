@@ -0,0 +1,125 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "Instrumentation.h"
+
+namespace
+{
+    std::atomic<bool> instrumentationEnabled(false);
+    // The process-wide totals of the calls that were made while the instrumentation was enabled.
+    Instrumentation::Counters totals;
+    thread_local Instrumentation::Counters* currentCounters = nullptr;
+}
+
+Instrumentation::Counters::Counters() noexcept
+{
+    Reset();
+}
+
+void Instrumentation::Counters::AddTo(InstrumentationStatistics& statistics) const noexcept
+{
+    statistics.colorConversionTime += GetValue(Counter::ColorConversionTime);
+    statistics.encodeTime += GetValue(Counter::EncodeTime);
+    statistics.outputCopyTime += GetValue(Counter::OutputCopyTime);
+    statistics.progressCallbackTime += GetValue(Counter::ProgressCallbackTime);
+    statistics.progressCallbackCount += GetValue(Counter::ProgressCallbackCount);
+    statistics.decodeTime += GetValue(Counter::DecodeTime);
+    statistics.decodedImageConversionTime += GetValue(Counter::DecodedImageConversionTime);
+    statistics.bytesAllocated += GetValue(Counter::BytesAllocated);
+    statistics.encoderInitCount += GetValue(Counter::EncoderInitCount);
+    statistics.decoderInitCount += GetValue(Counter::DecoderInitCount);
+    statistics.imagesEncoded += GetValue(Counter::ImagesEncoded);
+    statistics.imagesDecoded += GetValue(Counter::ImagesDecoded);
+    statistics.parallelElapsedTime += GetValue(Counter::ParallelElapsedTime);
+    statistics.parallelWorkTime += GetValue(Counter::ParallelWorkTime);
+    statistics.parallelThreadTime += GetValue(Counter::ParallelThreadTime);
+}
+
+void Instrumentation::Counters::AddTo(Counters& other) const noexcept
+{
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        other.values[i].fetch_add(values[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+void Instrumentation::Counters::Reset() noexcept
+{
+    for (std::atomic<uint64_t>& value : values)
+    {
+        value.store(0, std::memory_order_relaxed);
+    }
+}
+
+void Instrumentation::SetEnabled(bool enabled) noexcept
+{
+    instrumentationEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Instrumentation::IsEnabled() noexcept
+{
+    return instrumentationEnabled.load(std::memory_order_relaxed);
+}
+
+void Instrumentation::Reset() noexcept
+{
+    totals.Reset();
+}
+
+void Instrumentation::GetStatistics(InstrumentationStatistics& statistics) noexcept
+{
+    statistics = {};
+    totals.AddTo(statistics);
+}
+
+Instrumentation::Counters* Instrumentation::GetCurrentCounters() noexcept
+{
+    return currentCounters;
+}
+
+Instrumentation::ScopedCurrentCounters::ScopedCurrentCounters(Counters* counters) noexcept
+    : previous(currentCounters)
+{
+    currentCounters = counters;
+}
+
+Instrumentation::ScopedCurrentCounters::~ScopedCurrentCounters()
+{
+    currentCounters = previous;
+}
+
+Instrumentation::CallScope::CallScope(InstrumentationStatistics* statistics) noexcept
+    : statistics(statistics), enabled(statistics != nullptr || IsEnabled()), counters(), previous(currentCounters)
+{
+    if (enabled)
+    {
+        currentCounters = &counters;
+    }
+}
+
+Instrumentation::CallScope::~CallScope()
+{
+    if (enabled)
+    {
+        currentCounters = previous;
+
+        if (statistics)
+        {
+            counters.AddTo(*statistics);
+        }
+
+        if (IsEnabled())
+        {
+            counters.AddTo(totals);
+        }
+    }
+}
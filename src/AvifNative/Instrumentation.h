@@ -0,0 +1,213 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AvifNative.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+
+// Collects the InstrumentationStatistics of each exported encode or decode call, the statistics of a call
+// are returned to the caller and added to the process-wide totals when the instrumentation is enabled.
+namespace Instrumentation
+{
+    enum class Counter
+    {
+        ColorConversionTime,
+        EncodeTime,
+        OutputCopyTime,
+        ProgressCallbackTime,
+        ProgressCallbackCount,
+        DecodeTime,
+        DecodedImageConversionTime,
+        BytesAllocated,
+        EncoderInitCount,
+        DecoderInitCount,
+        ImagesEncoded,
+        ImagesDecoded,
+        ParallelElapsedTime,
+        ParallelWorkTime,
+        ParallelThreadTime,
+        Count
+    };
+
+    // The counters are updated by every thread that works on the call.
+    class Counters
+    {
+    public:
+        Counters() noexcept;
+
+        Counters(const Counters&) = delete;
+        Counters& operator=(const Counters&) = delete;
+
+        void Add(Counter counter, uint64_t value) noexcept
+        {
+            values[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+        }
+
+        // Adds the counter values to the statistics.
+        void AddTo(InstrumentationStatistics& statistics) const noexcept;
+
+        // Adds the counter values to the other counters.
+        void AddTo(Counters& other) const noexcept;
+
+        void Reset() noexcept;
+
+    private:
+        uint64_t GetValue(Counter counter) const noexcept
+        {
+            return values[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+        }
+
+        std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::Count)> values;
+    };
+
+    void SetEnabled(bool enabled) noexcept;
+
+    bool IsEnabled() noexcept;
+
+    void Reset() noexcept;
+
+    void GetStatistics(InstrumentationStatistics& statistics) noexcept;
+
+    // Gets the counters of the call that the current thread is working on,
+    // this is null when the statistics of the call are not being collected.
+    Counters* GetCurrentCounters() noexcept;
+
+    // Makes the counters current on the calling thread for the lifetime of this object,
+    // this is used by the worker threads of a call.
+    class ScopedCurrentCounters
+    {
+    public:
+        explicit ScopedCurrentCounters(Counters* counters) noexcept;
+
+        ScopedCurrentCounters(const ScopedCurrentCounters&) = delete;
+        ScopedCurrentCounters& operator=(const ScopedCurrentCounters&) = delete;
+
+        ~ScopedCurrentCounters();
+
+    private:
+        Counters* previous;
+    };
+
+    // Collects the statistics of an exported encode or decode call, the statistics are collected when the
+    // caller provides a statistics structure or when the process-wide instrumentation is enabled.
+    // The collected values are added to the caller's statistics when this object is destroyed.
+    class CallScope
+    {
+    public:
+        explicit CallScope(InstrumentationStatistics* statistics) noexcept;
+
+        CallScope(const CallScope&) = delete;
+        CallScope& operator=(const CallScope&) = delete;
+
+        ~CallScope();
+
+    private:
+        InstrumentationStatistics* statistics;
+        bool enabled;
+        Counters counters;
+        Counters* previous;
+    };
+
+    inline void Add(Counter counter, uint64_t value) noexcept
+    {
+        Counters* counters = GetCurrentCounters();
+
+        if (counters)
+        {
+            counters->Add(counter, value);
+        }
+    }
+
+    inline void Increment(Counter counter) noexcept
+    {
+        Add(counter, 1);
+    }
+
+    inline void AddBytesAllocated(size_t size) noexcept
+    {
+        Add(Counter::BytesAllocated, size);
+    }
+
+    // Adds the time between the constructor and the destructor to a counter,
+    // the clock is not read when the statistics are not being collected.
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Counter counter) noexcept
+            : counter(counter), counters(GetCurrentCounters()), start()
+        {
+            if (counters)
+            {
+                start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        ~ScopedTimer()
+        {
+            if (counters)
+            {
+                counters->Add(counter, GetElapsedNanoseconds());
+            }
+        }
+
+        uint64_t GetElapsedNanoseconds() const noexcept
+        {
+            if (!counters)
+            {
+                return 0;
+            }
+
+            const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+
+    private:
+        Counter counter;
+        Counters* counters;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    // Records the elapsed time and the available thread time of work that is split between threadCount threads,
+    // the work items use a ScopedTimer with Counter::ParallelWorkTime.
+    class ScopedParallelTimer
+    {
+    public:
+        explicit ScopedParallelTimer(uint32_t threadCount) noexcept
+            : timer(Counter::ParallelElapsedTime), threadCount(threadCount)
+        {
+        }
+
+        ScopedParallelTimer(const ScopedParallelTimer&) = delete;
+        ScopedParallelTimer& operator=(const ScopedParallelTimer&) = delete;
+
+        ~ScopedParallelTimer()
+        {
+            const uint64_t elapsed = timer.GetElapsedNanoseconds();
+
+            if (elapsed > 0)
+            {
+                Add(Counter::ParallelThreadTime, elapsed * threadCount);
+            }
+        }
+
+    private:
+        ScopedTimer timer;
+        uint32_t threadCount;
+    };
+}
@@ -0,0 +1,167 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Instrumentation.h"
+#include <stdint.h>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+inline uint32_t GetProcessorCount()
+{
+    const unsigned int processorCount = std::thread::hardware_concurrency();
+
+    return processorCount > 0 ? processorCount : 1;
+}
+
+inline uint32_t GetWorkerThreadCount(uint32_t workItemCount, uint32_t maxThreads)
+{
+    uint32_t threadCount = maxThreads > 0 ? maxThreads : GetProcessorCount();
+
+    if (threadCount > workItemCount)
+    {
+        threadCount = workItemCount;
+    }
+
+    return threadCount > 0 ? threadCount : 1;
+}
+
+// Calls body(workerIndex, index) for each index in [0, itemCount) using up to threadCount threads,
+// the calling thread is always one of them and uses a workerIndex of 0.
+// Each thread has a unique workerIndex in [0, threadCount), this allows the body to use per-thread state.
+// The indexes are handed out in ascending order, after the first call that returns a status
+// other than TStatus::Ok no new work will be started and that status is returned to the caller.
+// The body must not throw exceptions.
+// The worker threads record their instrumentation statistics in the counters of the calling thread.
+template <typename TStatus, typename TBody>
+TStatus ParallelForWithWorkerIndex(uint32_t itemCount, uint32_t threadCount, TBody body)
+{
+    std::atomic<uint32_t> nextIndex(0);
+    std::atomic<bool> failed(false);
+    std::mutex statusMutex;
+    TStatus status = TStatus::Ok;
+
+    auto worker = [&](uint32_t workerIndex)
+    {
+        while (!failed.load(std::memory_order_relaxed))
+        {
+            const uint32_t index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+            if (index >= itemCount)
+            {
+                break;
+            }
+
+            const TStatus itemStatus = body(workerIndex, index);
+            if (itemStatus != TStatus::Ok)
+            {
+                std::lock_guard<std::mutex> lock(statusMutex);
+
+                if (!failed.load(std::memory_order_relaxed))
+                {
+                    status = itemStatus;
+                    failed.store(true, std::memory_order_relaxed);
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    if (threadCount > 1 && itemCount > 1)
+    {
+        try
+        {
+            threads.reserve(static_cast<size_t>(threadCount) - 1);
+
+            Instrumentation::Counters* counters = Instrumentation::GetCurrentCounters();
+
+            for (uint32_t i = 1; i < threadCount; i++)
+            {
+                threads.emplace_back(
+                    [&worker, counters](uint32_t workerIndex)
+                    {
+                        Instrumentation::ScopedCurrentCounters currentCounters(counters);
+
+                        worker(workerIndex);
+                    },
+                    i);
+            }
+        }
+        catch (const std::exception&)
+        {
+            // Run the remaining work on the threads that were started, the calling
+            // thread will always process work items.
+        }
+    }
+
+    worker(0);
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    return status;
+}
+
+// Calls body(index) for each index in [0, itemCount) using up to threadCount threads,
+// see ParallelForWithWorkerIndex for details.
+template <typename TStatus, typename TBody>
+TStatus ParallelFor(uint32_t itemCount, uint32_t threadCount, TBody body)
+{
+    return ParallelForWithWorkerIndex<TStatus>(
+        itemCount,
+        threadCount,
+        [&body](uint32_t, uint32_t index)
+        {
+            return body(index);
+        });
+}
+
+// Splits the rows [0, height) into bands and calls body(startRow, endRow) for each band using up to
+// maxThreads threads, see ParallelForWithWorkerIndex for details.
+// The band boundaries are a multiple of rowAlignment, this keeps the rows that share a subsampled
+// chroma row in the same band. Images that are too small to benefit from multiple threads are
+// processed on the calling thread as a single band.
+template <typename TStatus, typename TBody>
+TStatus ParallelForRowBands(uint32_t height, uint32_t rowAlignment, uint32_t maxThreads, TBody body)
+{
+    constexpr uint32_t minimumBandHeight = 64;
+
+    const uint32_t maxBandCount = (height + minimumBandHeight - 1) / minimumBandHeight;
+    const uint32_t threadCount = maxThreads < maxBandCount ? maxThreads : maxBandCount;
+
+    if (threadCount <= 1 || rowAlignment == 0)
+    {
+        return body(0, height);
+    }
+
+    uint32_t bandHeight = (height + threadCount - 1) / threadCount;
+    bandHeight = ((bandHeight + rowAlignment - 1) / rowAlignment) * rowAlignment;
+
+    const uint32_t bandCount = (height + bandHeight - 1) / bandHeight;
+
+    return ParallelFor<TStatus>(
+        bandCount,
+        bandCount,
+        [&](uint32_t index)
+        {
+            const uint32_t startRow = index * bandHeight;
+            const uint32_t endRow = (height - startRow) > bandHeight ? startRow + bandHeight : height;
+
+            return body(startRow, endRow);
+        });
+}
@@ -0,0 +1,264 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// This header must only be included by files that are compiled with /arch:AVX2.
+
+#include "AvifNative.h"
+#include <immintrin.h>
+#include <string.h>
+
+// The vector types and operations that are used by the AVX2 image converters.
+namespace SIMD
+{
+    struct AVX2
+    {
+        static constexpr uint32_t Width = 8;
+
+        typedef __m256 Float;
+        typedef __m256i Int;
+
+        static inline Float SetFloat(float value)
+        {
+            return _mm256_set1_ps(value);
+        }
+
+        static inline Int SetInt(uint32_t value)
+        {
+            return _mm256_set1_epi32(static_cast<int>(value));
+        }
+
+        static inline Int Load(const uint8_t* ptr)
+        {
+            return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr)));
+        }
+
+        static inline Int Load(const uint16_t* ptr)
+        {
+            return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)));
+        }
+
+        // Loads Width / 2 samples and duplicates each sample for the horizontally subsampled chroma planes.
+        static inline Int LoadSubsampled(const uint8_t* ptr)
+        {
+            int32_t value;
+            memcpy(&value, ptr, sizeof(value));
+
+            return _mm256_permutevar8x32_epi32(_mm256_cvtepu8_epi32(_mm_cvtsi32_si128(value)),
+                                               _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3));
+        }
+
+        static inline Int LoadSubsampled(const uint16_t* ptr)
+        {
+            return _mm256_permutevar8x32_epi32(_mm256_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr))),
+                                               _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3));
+        }
+
+        static inline Float Gather(const float* table, Int indices)
+        {
+            return _mm256_i32gather_ps(table, indices, sizeof(float));
+        }
+
+        static inline Int GatherInt(const uint32_t* table, Int indices)
+        {
+            return _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), indices, sizeof(uint32_t));
+        }
+
+        static inline Float Add(Float a, Float b)
+        {
+            return _mm256_add_ps(a, b);
+        }
+
+        static inline Float Sub(Float a, Float b)
+        {
+            return _mm256_sub_ps(a, b);
+        }
+
+        static inline Float Mul(Float a, Float b)
+        {
+            return _mm256_mul_ps(a, b);
+        }
+
+        static inline Float Div(Float a, Float b)
+        {
+            return _mm256_div_ps(a, b);
+        }
+
+        static inline Float Min(Float a, Float b)
+        {
+            return _mm256_min_ps(a, b);
+        }
+
+        static inline Float Max(Float a, Float b)
+        {
+            return _mm256_max_ps(a, b);
+        }
+
+        static inline Int AddInt(Int a, Int b)
+        {
+            return _mm256_add_epi32(a, b);
+        }
+
+        // Returns the low 32 bits of each product.
+        static inline Int MulInt(Int a, Int b)
+        {
+            return _mm256_mullo_epi32(a, b);
+        }
+
+        static inline Int MinInt(Int a, Int b)
+        {
+            return _mm256_min_epu32(a, b);
+        }
+
+        static inline Int ShiftRightInt(Int value, uint32_t count)
+        {
+            return _mm256_srl_epi32(value, _mm_cvtsi32_si128(static_cast<int>(count)));
+        }
+
+        static inline Int Truncate(Float value)
+        {
+            return _mm256_cvttps_epi32(value);
+        }
+
+        // Writes the B, G and R channels and preserves the existing alpha channel.
+        static inline void StoreBgr(ColorBgra* dstPtr, Int b, Int g, Int r)
+        {
+            __m256i* ptr = reinterpret_cast<__m256i*>(dstPtr);
+
+            const __m256i alpha = _mm256_and_si256(_mm256_loadu_si256(ptr), _mm256_set1_epi32(static_cast<int>(0xFF000000)));
+            const __m256i bgr = _mm256_or_si256(_mm256_or_si256(b, _mm256_slli_epi32(g, 8)), _mm256_slli_epi32(r, 16));
+
+            _mm256_storeu_si256(ptr, _mm256_or_si256(alpha, bgr));
+        }
+
+        // Writes the alpha channel and preserves the existing B, G and R channels.
+        static inline void StoreAlpha(ColorBgra* dstPtr, Int a)
+        {
+            __m256i* ptr = reinterpret_cast<__m256i*>(dstPtr);
+
+            const __m256i bgr = _mm256_and_si256(_mm256_loadu_si256(ptr), _mm256_set1_epi32(0x00FFFFFF));
+
+            _mm256_storeu_si256(ptr, _mm256_or_si256(bgr, _mm256_slli_epi32(a, 24)));
+        }
+
+        // Writes the B, G and R channels of Width 16-bit per channel pixels and preserves the existing alpha channel.
+        static inline void StoreBgr(ColorBgra64* dstPtr, Int b, Int g, Int r)
+        {
+            __m256i* ptr = reinterpret_cast<__m256i*>(dstPtr);
+
+            const __m256i alphaMask = _mm256_set1_epi64x(static_cast<long long>(0xFFFF000000000000));
+            const __m256i bg = _mm256_or_si256(b, _mm256_slli_epi32(g, 16));
+
+            // Each pixel is the B and G word pair followed by the R and A word pair, the unpack
+            // operates on each 128-bit lane and the permute restores the pixel order.
+            const __m256i low = _mm256_unpacklo_epi32(bg, r);
+            const __m256i high = _mm256_unpackhi_epi32(bg, r);
+            const __m256i pixels0 = _mm256_permute2x128_si256(low, high, 0x20);
+            const __m256i pixels1 = _mm256_permute2x128_si256(low, high, 0x31);
+
+            _mm256_storeu_si256(ptr, _mm256_or_si256(_mm256_and_si256(_mm256_loadu_si256(ptr), alphaMask), pixels0));
+            _mm256_storeu_si256(ptr + 1, _mm256_or_si256(_mm256_and_si256(_mm256_loadu_si256(ptr + 1), alphaMask), pixels1));
+        }
+
+        // Writes the alpha channel of Width 16-bit per channel pixels and preserves the existing B, G and R channels.
+        static inline void StoreAlpha(ColorBgra64* dstPtr, Int a)
+        {
+            __m256i* ptr = reinterpret_cast<__m256i*>(dstPtr);
+
+            const __m256i bgrMask = _mm256_set1_epi64x(0x0000FFFFFFFFFFFF);
+            const __m256i alpha = _mm256_slli_epi32(a, 16);
+
+            const __m256i low = _mm256_unpacklo_epi32(_mm256_setzero_si256(), alpha);
+            const __m256i high = _mm256_unpackhi_epi32(_mm256_setzero_si256(), alpha);
+            const __m256i pixels0 = _mm256_permute2x128_si256(low, high, 0x20);
+            const __m256i pixels1 = _mm256_permute2x128_si256(low, high, 0x31);
+
+            _mm256_storeu_si256(ptr, _mm256_or_si256(_mm256_and_si256(_mm256_loadu_si256(ptr), bgrMask), pixels0));
+            _mm256_storeu_si256(ptr + 1, _mm256_or_si256(_mm256_and_si256(_mm256_loadu_si256(ptr + 1), bgrMask), pixels1));
+        }
+
+        static inline Int LoadPixels(const ColorBgra* srcPtr)
+        {
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcPtr));
+        }
+
+        // Returns the 8-bit channel that starts at the specified bit offset of each pixel.
+        template <int shift>
+        static inline Int ExtractChannel(Int pixels)
+        {
+            return _mm256_and_si256(_mm256_srli_epi32(pixels, shift), _mm256_set1_epi32(0xFF));
+        }
+
+        // Writes the B, G and R channels of Width pixels to separate planes.
+        static inline void DeinterleaveBgr(const ColorBgra* srcPtr, uint8_t* bPtr, uint8_t* gPtr, uint8_t* rPtr)
+        {
+            // The shuffle gathers the bytes of each channel into a 32-bit element of each 128-bit lane,
+            // the permute places the elements of each channel in the same 64-bit element.
+            const __m256i shuffle = _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15,
+                                                     0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+            const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcPtr));
+            const __m256i planar = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(pixels, shuffle), _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+
+            const __m128i bg = _mm256_castsi256_si128(planar);
+
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(bPtr), bg);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(gPtr), _mm_unpackhi_epi64(bg, bg));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(rPtr), _mm256_extracti128_si256(planar, 1));
+        }
+
+        // Loads the B, G and R channels of Width pixels.
+        static inline void LoadChannels(const ColorBgra64* srcPtr, Int& b, Int& g, Int& r)
+        {
+            const __m256 pixels0 = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcPtr)));
+            const __m256 pixels1 = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcPtr + 4)));
+
+            // The low 32 bits of each pixel contain B and G, the high 32 bits contain R and A.
+            // The shuffle operates on each 128-bit lane, the permute restores the pixel order.
+            const __m256i bg = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(pixels0, pixels1, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0));
+            const __m256i ra = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(pixels0, pixels1, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0));
+
+            b = _mm256_and_si256(bg, _mm256_set1_epi32(0xFFFF));
+            g = _mm256_srli_epi32(bg, 16);
+            r = _mm256_and_si256(ra, _mm256_set1_epi32(0xFFFF));
+        }
+
+        static inline Float ConvertToFloat(Int value)
+        {
+            return _mm256_cvtepi32_ps(value);
+        }
+
+        // Splits the values of two vectors into the even and odd elements.
+        static inline void Deinterleave(Float a, Float b, Float& evens, Float& odds)
+        {
+            // The shuffle operates on each 128-bit lane, the permute restores the element order.
+            evens = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+            odds = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+
+        // Writes Width bytes, the values must be in the range of [0, 255].
+        static inline void StoreBytes(uint8_t* dstPtr, Int value)
+        {
+            const __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dstPtr), _mm_packus_epi16(words, words));
+        }
+
+        // Writes Width 16-bit values, the values must be in the range of [0, 65535].
+        static inline void StoreWords(uint16_t* dstPtr, Int value)
+        {
+            const __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dstPtr), words);
+        }
+    };
+}
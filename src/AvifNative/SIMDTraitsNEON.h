@@ -0,0 +1,265 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AvifNative.h"
+#include <arm_neon.h>
+#include <string.h>
+
+// The vector types and operations that are used by the NEON image converters.
+namespace SIMD
+{
+    struct NEON
+    {
+        static constexpr uint32_t Width = 4;
+
+        typedef float32x4_t Float;
+        typedef uint32x4_t Int;
+
+        static inline Float SetFloat(float value)
+        {
+            return vdupq_n_f32(value);
+        }
+
+        static inline Int SetInt(uint32_t value)
+        {
+            return vdupq_n_u32(value);
+        }
+
+        static inline Int Load(const uint8_t* ptr)
+        {
+            uint32_t value;
+            memcpy(&value, ptr, sizeof(value));
+
+            return vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(value)))));
+        }
+
+        static inline Int Load(const uint16_t* ptr)
+        {
+            return vmovl_u16(vld1_u16(ptr));
+        }
+
+        // Loads Width / 2 samples and duplicates each sample for the horizontally subsampled chroma planes.
+        static inline Int LoadSubsampled(const uint8_t* ptr)
+        {
+            uint16_t value;
+            memcpy(&value, ptr, sizeof(value));
+
+            const uint8x8_t samples = vreinterpret_u8_u16(vdup_n_u16(value));
+
+            return vmovl_u16(vget_low_u16(vmovl_u8(vzip1_u8(samples, samples))));
+        }
+
+        static inline Int LoadSubsampled(const uint16_t* ptr)
+        {
+            uint32_t value;
+            memcpy(&value, ptr, sizeof(value));
+
+            const uint16x4_t samples = vreinterpret_u16_u32(vdup_n_u32(value));
+
+            return vmovl_u16(vzip1_u16(samples, samples));
+        }
+
+        // NEON does not have a gather instruction, the indices are extracted and the values loaded individually.
+        static inline Float Gather(const float* table, Int indices)
+        {
+            const float values[4] =
+            {
+                table[vgetq_lane_u32(indices, 0)],
+                table[vgetq_lane_u32(indices, 1)],
+                table[vgetq_lane_u32(indices, 2)],
+                table[vgetq_lane_u32(indices, 3)]
+            };
+
+            return vld1q_f32(values);
+        }
+
+        static inline Int GatherInt(const uint32_t* table, Int indices)
+        {
+            const uint32_t values[4] =
+            {
+                table[vgetq_lane_u32(indices, 0)],
+                table[vgetq_lane_u32(indices, 1)],
+                table[vgetq_lane_u32(indices, 2)],
+                table[vgetq_lane_u32(indices, 3)]
+            };
+
+            return vld1q_u32(values);
+        }
+
+        // The multiply and add operations are not fused, the scalar code rounds after each operation.
+
+        static inline Float Add(Float a, Float b)
+        {
+            return vaddq_f32(a, b);
+        }
+
+        static inline Float Sub(Float a, Float b)
+        {
+            return vsubq_f32(a, b);
+        }
+
+        static inline Float Mul(Float a, Float b)
+        {
+            return vmulq_f32(a, b);
+        }
+
+        static inline Float Div(Float a, Float b)
+        {
+            return vdivq_f32(a, b);
+        }
+
+        static inline Float Min(Float a, Float b)
+        {
+            return vminq_f32(a, b);
+        }
+
+        static inline Float Max(Float a, Float b)
+        {
+            return vmaxq_f32(a, b);
+        }
+
+        static inline Int AddInt(Int a, Int b)
+        {
+            return vaddq_u32(a, b);
+        }
+
+        // Returns the low 32 bits of each product.
+        static inline Int MulInt(Int a, Int b)
+        {
+            return vmulq_u32(a, b);
+        }
+
+        static inline Int MinInt(Int a, Int b)
+        {
+            return vminq_u32(a, b);
+        }
+
+        static inline Int ShiftRightInt(Int value, uint32_t count)
+        {
+            return vshlq_u32(value, vdupq_n_s32(-static_cast<int32_t>(count)));
+        }
+
+        static inline Int Truncate(Float value)
+        {
+            return vcvtq_u32_f32(value);
+        }
+
+        // Writes the B, G and R channels and preserves the existing alpha channel.
+        static inline void StoreBgr(ColorBgra* dstPtr, Int b, Int g, Int r)
+        {
+            uint32_t* ptr = reinterpret_cast<uint32_t*>(dstPtr);
+
+            const uint32x4_t alpha = vandq_u32(vld1q_u32(ptr), vdupq_n_u32(0xFF000000));
+            const uint32x4_t bgr = vorrq_u32(vorrq_u32(b, vshlq_n_u32(g, 8)), vshlq_n_u32(r, 16));
+
+            vst1q_u32(ptr, vorrq_u32(alpha, bgr));
+        }
+
+        // Writes the alpha channel and preserves the existing B, G and R channels.
+        static inline void StoreAlpha(ColorBgra* dstPtr, Int a)
+        {
+            uint32_t* ptr = reinterpret_cast<uint32_t*>(dstPtr);
+
+            const uint32x4_t bgr = vandq_u32(vld1q_u32(ptr), vdupq_n_u32(0x00FFFFFF));
+
+            vst1q_u32(ptr, vorrq_u32(bgr, vshlq_n_u32(a, 24)));
+        }
+
+        // Writes the B, G and R channels of Width 16-bit per channel pixels and preserves the existing alpha channel.
+        static inline void StoreBgr(ColorBgra64* dstPtr, Int b, Int g, Int r)
+        {
+            uint16_t* ptr = reinterpret_cast<uint16_t*>(dstPtr);
+
+            uint16x4x4_t pixels = vld4_u16(ptr);
+            pixels.val[0] = vmovn_u32(b);
+            pixels.val[1] = vmovn_u32(g);
+            pixels.val[2] = vmovn_u32(r);
+
+            vst4_u16(ptr, pixels);
+        }
+
+        // Writes the alpha channel of Width 16-bit per channel pixels and preserves the existing B, G and R channels.
+        static inline void StoreAlpha(ColorBgra64* dstPtr, Int a)
+        {
+            uint16_t* ptr = reinterpret_cast<uint16_t*>(dstPtr);
+
+            uint16x4x4_t pixels = vld4_u16(ptr);
+            pixels.val[3] = vmovn_u32(a);
+
+            vst4_u16(ptr, pixels);
+        }
+
+        static inline Int LoadPixels(const ColorBgra* srcPtr)
+        {
+            return vld1q_u32(reinterpret_cast<const uint32_t*>(srcPtr));
+        }
+
+        // Returns the 8-bit channel that starts at the specified bit offset of each pixel.
+        template <int shift>
+        static inline Int ExtractChannel(Int pixels)
+        {
+            return vandq_u32(vshrq_n_u32(pixels, shift), vdupq_n_u32(0xFF));
+        }
+
+        // Writes the B, G and R channels of Width pixels to separate planes.
+        static inline void DeinterleaveBgr(const ColorBgra* srcPtr, uint8_t* bPtr, uint8_t* gPtr, uint8_t* rPtr)
+        {
+            // Gathers the bytes of each channel into a 32-bit element.
+            static const uint8_t shuffle[16] = { 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15 };
+
+            const uint32x4_t planar = vreinterpretq_u32_u8(vqtbl1q_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(srcPtr)), vld1q_u8(shuffle)));
+
+            vst1q_lane_u32(reinterpret_cast<uint32_t*>(bPtr), planar, 0);
+            vst1q_lane_u32(reinterpret_cast<uint32_t*>(gPtr), planar, 1);
+            vst1q_lane_u32(reinterpret_cast<uint32_t*>(rPtr), planar, 2);
+        }
+
+        // Loads the B, G and R channels of Width pixels.
+        static inline void LoadChannels(const ColorBgra64* srcPtr, Int& b, Int& g, Int& r)
+        {
+            const uint16x4x4_t pixels = vld4_u16(reinterpret_cast<const uint16_t*>(srcPtr));
+
+            b = vmovl_u16(pixels.val[0]);
+            g = vmovl_u16(pixels.val[1]);
+            r = vmovl_u16(pixels.val[2]);
+        }
+
+        static inline Float ConvertToFloat(Int value)
+        {
+            return vcvtq_f32_u32(value);
+        }
+
+        // Splits the values of two vectors into the even and odd elements.
+        static inline void Deinterleave(Float a, Float b, Float& evens, Float& odds)
+        {
+            evens = vuzp1q_f32(a, b);
+            odds = vuzp2q_f32(a, b);
+        }
+
+        // Writes Width bytes, the values must be in the range of [0, 255].
+        static inline void StoreBytes(uint8_t* dstPtr, Int value)
+        {
+            const uint16x4_t words = vmovn_u32(value);
+            const uint8x8_t bytes = vmovn_u16(vcombine_u16(words, words));
+
+            vst1_lane_u32(reinterpret_cast<uint32_t*>(dstPtr), vreinterpret_u32_u8(bytes), 0);
+        }
+
+        // Writes Width 16-bit values, the values must be in the range of [0, 65535].
+        static inline void StoreWords(uint16_t* dstPtr, Int value)
+        {
+            vst1_u16(dstPtr, vmovn_u32(value));
+        }
+    };
+}
@@ -0,0 +1,264 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AvifNative.h"
+#include <smmintrin.h>
+#include <string.h>
+
+// The vector types and operations that are used by the SSE4.1 image converters.
+namespace SIMD
+{
+    struct SSE41
+    {
+        static constexpr uint32_t Width = 4;
+
+        typedef __m128 Float;
+        typedef __m128i Int;
+
+        static inline Float SetFloat(float value)
+        {
+            return _mm_set1_ps(value);
+        }
+
+        static inline Int SetInt(uint32_t value)
+        {
+            return _mm_set1_epi32(static_cast<int>(value));
+        }
+
+        static inline Int Load(const uint8_t* ptr)
+        {
+            int32_t value;
+            memcpy(&value, ptr, sizeof(value));
+
+            return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(value));
+        }
+
+        static inline Int Load(const uint16_t* ptr)
+        {
+            return _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr)));
+        }
+
+        // Loads Width / 2 samples and duplicates each sample for the horizontally subsampled chroma planes.
+        static inline Int LoadSubsampled(const uint8_t* ptr)
+        {
+            uint16_t value;
+            memcpy(&value, ptr, sizeof(value));
+
+            return _mm_shuffle_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(value)), _MM_SHUFFLE(1, 1, 0, 0));
+        }
+
+        static inline Int LoadSubsampled(const uint16_t* ptr)
+        {
+            int32_t value;
+            memcpy(&value, ptr, sizeof(value));
+
+            return _mm_shuffle_epi32(_mm_cvtepu16_epi32(_mm_cvtsi32_si128(value)), _MM_SHUFFLE(1, 1, 0, 0));
+        }
+
+        // SSE4.1 does not have a gather instruction, the indices are extracted and the values loaded individually.
+        static inline Float Gather(const float* table, Int indices)
+        {
+            return _mm_setr_ps(table[static_cast<uint32_t>(_mm_cvtsi128_si32(indices))],
+                               table[static_cast<uint32_t>(_mm_extract_epi32(indices, 1))],
+                               table[static_cast<uint32_t>(_mm_extract_epi32(indices, 2))],
+                               table[static_cast<uint32_t>(_mm_extract_epi32(indices, 3))]);
+        }
+
+        static inline Int GatherInt(const uint32_t* table, Int indices)
+        {
+            return _mm_setr_epi32(static_cast<int>(table[static_cast<uint32_t>(_mm_cvtsi128_si32(indices))]),
+                                  static_cast<int>(table[static_cast<uint32_t>(_mm_extract_epi32(indices, 1))]),
+                                  static_cast<int>(table[static_cast<uint32_t>(_mm_extract_epi32(indices, 2))]),
+                                  static_cast<int>(table[static_cast<uint32_t>(_mm_extract_epi32(indices, 3))]));
+        }
+
+        static inline Float Add(Float a, Float b)
+        {
+            return _mm_add_ps(a, b);
+        }
+
+        static inline Float Sub(Float a, Float b)
+        {
+            return _mm_sub_ps(a, b);
+        }
+
+        static inline Float Mul(Float a, Float b)
+        {
+            return _mm_mul_ps(a, b);
+        }
+
+        static inline Float Div(Float a, Float b)
+        {
+            return _mm_div_ps(a, b);
+        }
+
+        static inline Float Min(Float a, Float b)
+        {
+            return _mm_min_ps(a, b);
+        }
+
+        static inline Float Max(Float a, Float b)
+        {
+            return _mm_max_ps(a, b);
+        }
+
+        static inline Int AddInt(Int a, Int b)
+        {
+            return _mm_add_epi32(a, b);
+        }
+
+        // Returns the low 32 bits of each product.
+        static inline Int MulInt(Int a, Int b)
+        {
+            return _mm_mullo_epi32(a, b);
+        }
+
+        static inline Int MinInt(Int a, Int b)
+        {
+            return _mm_min_epu32(a, b);
+        }
+
+        static inline Int ShiftRightInt(Int value, uint32_t count)
+        {
+            return _mm_srl_epi32(value, _mm_cvtsi32_si128(static_cast<int>(count)));
+        }
+
+        static inline Int Truncate(Float value)
+        {
+            return _mm_cvttps_epi32(value);
+        }
+
+        // Writes the B, G and R channels and preserves the existing alpha channel.
+        static inline void StoreBgr(ColorBgra* dstPtr, Int b, Int g, Int r)
+        {
+            __m128i* ptr = reinterpret_cast<__m128i*>(dstPtr);
+
+            const __m128i alpha = _mm_and_si128(_mm_loadu_si128(ptr), _mm_set1_epi32(static_cast<int>(0xFF000000)));
+            const __m128i bgr = _mm_or_si128(_mm_or_si128(b, _mm_slli_epi32(g, 8)), _mm_slli_epi32(r, 16));
+
+            _mm_storeu_si128(ptr, _mm_or_si128(alpha, bgr));
+        }
+
+        // Writes the alpha channel and preserves the existing B, G and R channels.
+        static inline void StoreAlpha(ColorBgra* dstPtr, Int a)
+        {
+            __m128i* ptr = reinterpret_cast<__m128i*>(dstPtr);
+
+            const __m128i bgr = _mm_and_si128(_mm_loadu_si128(ptr), _mm_set1_epi32(0x00FFFFFF));
+
+            _mm_storeu_si128(ptr, _mm_or_si128(bgr, _mm_slli_epi32(a, 24)));
+        }
+
+        // Writes the B, G and R channels of Width 16-bit per channel pixels and preserves the existing alpha channel.
+        static inline void StoreBgr(ColorBgra64* dstPtr, Int b, Int g, Int r)
+        {
+            __m128i* ptr = reinterpret_cast<__m128i*>(dstPtr);
+
+            const __m128i alphaMask = _mm_set1_epi64x(static_cast<long long>(0xFFFF000000000000));
+            const __m128i bg = _mm_or_si128(b, _mm_slli_epi32(g, 16));
+
+            // Each pixel is the B and G word pair followed by the R and A word pair.
+            const __m128i pixels0 = _mm_unpacklo_epi32(bg, r);
+            const __m128i pixels1 = _mm_unpackhi_epi32(bg, r);
+
+            _mm_storeu_si128(ptr, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(ptr), alphaMask), pixels0));
+            _mm_storeu_si128(ptr + 1, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(ptr + 1), alphaMask), pixels1));
+        }
+
+        // Writes the alpha channel of Width 16-bit per channel pixels and preserves the existing B, G and R channels.
+        static inline void StoreAlpha(ColorBgra64* dstPtr, Int a)
+        {
+            __m128i* ptr = reinterpret_cast<__m128i*>(dstPtr);
+
+            const __m128i bgrMask = _mm_set1_epi64x(0x0000FFFFFFFFFFFF);
+            const __m128i alpha = _mm_slli_epi32(a, 16);
+
+            const __m128i pixels0 = _mm_unpacklo_epi32(_mm_setzero_si128(), alpha);
+            const __m128i pixels1 = _mm_unpackhi_epi32(_mm_setzero_si128(), alpha);
+
+            _mm_storeu_si128(ptr, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(ptr), bgrMask), pixels0));
+            _mm_storeu_si128(ptr + 1, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(ptr + 1), bgrMask), pixels1));
+        }
+
+        static inline Int LoadPixels(const ColorBgra* srcPtr)
+        {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcPtr));
+        }
+
+        // Returns the 8-bit channel that starts at the specified bit offset of each pixel.
+        template <int shift>
+        static inline Int ExtractChannel(Int pixels)
+        {
+            return _mm_and_si128(_mm_srli_epi32(pixels, shift), _mm_set1_epi32(0xFF));
+        }
+
+        // Writes the B, G and R channels of Width pixels to separate planes.
+        static inline void DeinterleaveBgr(const ColorBgra* srcPtr, uint8_t* bPtr, uint8_t* gPtr, uint8_t* rPtr)
+        {
+            // Gathers the bytes of each channel into a 32-bit element.
+            const __m128i shuffle = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+            const __m128i planar = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(srcPtr)), shuffle);
+
+            const int32_t b = _mm_cvtsi128_si32(planar);
+            const int32_t g = _mm_extract_epi32(planar, 1);
+            const int32_t r = _mm_extract_epi32(planar, 2);
+
+            memcpy(bPtr, &b, sizeof(b));
+            memcpy(gPtr, &g, sizeof(g));
+            memcpy(rPtr, &r, sizeof(r));
+        }
+
+        // Loads the B, G and R channels of Width pixels.
+        static inline void LoadChannels(const ColorBgra64* srcPtr, Int& b, Int& g, Int& r)
+        {
+            const __m128 pixels0 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(srcPtr)));
+            const __m128 pixels1 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(srcPtr + 2)));
+
+            // The low 32 bits of each pixel contain B and G, the high 32 bits contain R and A.
+            const __m128i bg = _mm_castps_si128(_mm_shuffle_ps(pixels0, pixels1, _MM_SHUFFLE(2, 0, 2, 0)));
+            const __m128i ra = _mm_castps_si128(_mm_shuffle_ps(pixels0, pixels1, _MM_SHUFFLE(3, 1, 3, 1)));
+
+            b = _mm_and_si128(bg, _mm_set1_epi32(0xFFFF));
+            g = _mm_srli_epi32(bg, 16);
+            r = _mm_and_si128(ra, _mm_set1_epi32(0xFFFF));
+        }
+
+        static inline Float ConvertToFloat(Int value)
+        {
+            return _mm_cvtepi32_ps(value);
+        }
+
+        // Splits the values of two vectors into the even and odd elements.
+        static inline void Deinterleave(Float a, Float b, Float& evens, Float& odds)
+        {
+            evens = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            odds = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        }
+
+        // Writes Width bytes, the values must be in the range of [0, 255].
+        static inline void StoreBytes(uint8_t* dstPtr, Int value)
+        {
+            const __m128i packed = _mm_packus_epi16(_mm_packus_epi32(value, value), _mm_setzero_si128());
+            const int32_t bytes = _mm_cvtsi128_si32(packed);
+
+            memcpy(dstPtr, &bytes, sizeof(bytes));
+        }
+
+        // Writes Width 16-bit values, the values must be in the range of [0, 65535].
+        static inline void StoreWords(uint16_t* dstPtr, Int value)
+        {
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dstPtr), _mm_packus_epi32(value, value));
+        }
+    };
+}
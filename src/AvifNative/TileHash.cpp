@@ -0,0 +1,204 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "TileHash.h"
+#include <string.h>
+
+namespace
+{
+    constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr uint64_t Prime3 = 0x165667B19E3779F9ULL;
+    constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ULL;
+
+    constexpr size_t StripeSize = 32;
+
+    inline uint64_t RotateLeft(uint64_t value, int count)
+    {
+        return (value << count) | (value >> (64 - count));
+    }
+
+    inline uint64_t Read64(const uint8_t* ptr)
+    {
+        uint64_t value;
+        memcpy(&value, ptr, sizeof(value));
+
+        return value;
+    }
+
+    inline uint32_t Read32(const uint8_t* ptr)
+    {
+        uint32_t value;
+        memcpy(&value, ptr, sizeof(value));
+
+        return value;
+    }
+
+    inline uint64_t Round(uint64_t accumulator, uint64_t lane)
+    {
+        accumulator += lane * Prime2;
+        accumulator = RotateLeft(accumulator, 31);
+
+        return accumulator * Prime1;
+    }
+
+    inline uint64_t MergeAccumulator(uint64_t hash, uint64_t accumulator)
+    {
+        hash ^= Round(0, accumulator);
+
+        return hash * Prime1 + Prime4;
+    }
+
+    // An incremental XXH64 hash with a seed of zero.
+    // The data is assumed to be little-endian, which is true for all of the platforms we support.
+    class HashState
+    {
+    public:
+        HashState() : accumulators{ Prime1 + Prime2, Prime2, 0, 0ULL - Prime1 }, buffer(), bufferSize(0), totalSize(0)
+        {
+        }
+
+        void Update(const uint8_t* data, size_t size)
+        {
+            totalSize += size;
+
+            if (bufferSize > 0)
+            {
+                const size_t copySize = size < StripeSize - bufferSize ? size : StripeSize - bufferSize;
+
+                memcpy(buffer + bufferSize, data, copySize);
+                bufferSize += copySize;
+                data += copySize;
+                size -= copySize;
+
+                if (bufferSize < StripeSize)
+                {
+                    return;
+                }
+
+                ProcessStripe(buffer);
+                bufferSize = 0;
+            }
+
+            while (size >= StripeSize)
+            {
+                ProcessStripe(data);
+                data += StripeSize;
+                size -= StripeSize;
+            }
+
+            if (size > 0)
+            {
+                memcpy(buffer, data, size);
+                bufferSize = size;
+            }
+        }
+
+        uint64_t Finish() const
+        {
+            uint64_t hash;
+
+            if (totalSize >= StripeSize)
+            {
+                hash = RotateLeft(accumulators[0], 1)
+                     + RotateLeft(accumulators[1], 7)
+                     + RotateLeft(accumulators[2], 12)
+                     + RotateLeft(accumulators[3], 18);
+
+                for (int i = 0; i < 4; i++)
+                {
+                    hash = MergeAccumulator(hash, accumulators[i]);
+                }
+            }
+            else
+            {
+                hash = Prime5;
+            }
+
+            hash += totalSize;
+
+            const uint8_t* ptr = buffer;
+            size_t remaining = bufferSize;
+
+            while (remaining >= 8)
+            {
+                hash ^= Round(0, Read64(ptr));
+                hash = RotateLeft(hash, 27) * Prime1 + Prime4;
+                ptr += 8;
+                remaining -= 8;
+            }
+
+            if (remaining >= 4)
+            {
+                hash ^= static_cast<uint64_t>(Read32(ptr)) * Prime1;
+                hash = RotateLeft(hash, 23) * Prime2 + Prime3;
+                ptr += 4;
+                remaining -= 4;
+            }
+
+            while (remaining > 0)
+            {
+                hash ^= static_cast<uint64_t>(*ptr) * Prime5;
+                hash = RotateLeft(hash, 11) * Prime1;
+                ptr++;
+                remaining--;
+            }
+
+            hash ^= hash >> 33;
+            hash *= Prime2;
+            hash ^= hash >> 29;
+            hash *= Prime3;
+            hash ^= hash >> 32;
+
+            return hash;
+        }
+
+    private:
+        void ProcessStripe(const uint8_t* stripe)
+        {
+            accumulators[0] = Round(accumulators[0], Read64(stripe));
+            accumulators[1] = Round(accumulators[1], Read64(stripe + 8));
+            accumulators[2] = Round(accumulators[2], Read64(stripe + 16));
+            accumulators[3] = Round(accumulators[3], Read64(stripe + 24));
+        }
+
+        uint64_t accumulators[4];
+        uint8_t buffer[StripeSize];
+        size_t bufferSize;
+        uint64_t totalSize;
+    };
+}
+
+uint64_t HashBuffer(const void* buffer, size_t size)
+{
+    HashState state;
+
+    state.Update(static_cast<const uint8_t*>(buffer), size);
+
+    return state.Finish();
+}
+
+uint64_t HashBitmapPixels(const BitmapData& image)
+{
+    HashState state;
+
+    const size_t pixelSize = image.pixelFormat == BitmapPixelFormat::Bgra64 ? sizeof(ColorBgra64) : sizeof(ColorBgra);
+    const size_t rowSize = static_cast<size_t>(image.width) * pixelSize;
+
+    for (uint32_t y = 0; y < image.height; y++)
+    {
+        state.Update(image.scan0 + (static_cast<size_t>(y) * image.stride), rowSize);
+    }
+
+    return state.Finish();
+}
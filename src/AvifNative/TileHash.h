@@ -0,0 +1,24 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AvifNative.h"
+#include <stddef.h>
+
+// The hashes use the XXH64 algorithm, see https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+// They are only used to find candidate duplicates, callers must compare the data to confirm a match.
+
+uint64_t HashBuffer(const void* buffer, size_t size);
+
+// Hashes the BGRA pixels of the image, the row padding is not included in the hash.
+uint64_t HashBitmapPixels(const BitmapData& image);
@@ -0,0 +1,728 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+// Measures the throughput of the native encode, decode and conversion stages over a synthetic corpus.
+// Each result is written as a single line JSON object so that the output can be compared across
+// libaom upgrades and plugin releases.
+//
+// Usage: AvifNativeBenchmark [--quick] [--iterations N] [--encode-iterations N] [--threads N] [--output file]
+
+#include "AvifNative.h"
+#include "ChromaSubsampling.h"
+#include "DecodedImageConverter.h"
+#include "ImageGridDecoder.h"
+#include "ParallelFor.h"
+#include <aom/aom_decoder.h>
+#include <aom/aomdx.h>
+#include <aom/aom_image.h>
+#include <Windows.h>
+#include <Psapi.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct BenchmarkOptions
+    {
+        uint32_t iterations;
+        uint32_t encodeIterations;
+        uint32_t threadCount;
+        bool quick;
+        const char* outputPath;
+    };
+
+    struct ImageFormat
+    {
+        YUVChromaSubsampling yuvFormat;
+        const char* name;
+    };
+
+    constexpr ImageFormat imageFormats[] =
+    {
+        { YUVChromaSubsampling::Subsampling400, "400" },
+        { YUVChromaSubsampling::Subsampling420, "420" },
+        { YUVChromaSubsampling::Subsampling422, "422" },
+        { YUVChromaSubsampling::Subsampling444, "444" },
+        { YUVChromaSubsampling::IdentityMatrix, "identity" },
+    };
+
+    struct CompressionSpeedInfo
+    {
+        CompressionSpeed speed;
+        const char* name;
+    };
+
+    constexpr CompressionSpeedInfo compressionSpeeds[] =
+    {
+        { CompressionSpeed::Fast, "Fast" },
+        { CompressionSpeed::Medium, "Medium" },
+        { CompressionSpeed::Slow, "Slow" },
+        { CompressionSpeed::VerySlow, "VerySlow" },
+    };
+
+    constexpr uint32_t bitDepths[] = { 8, 10, 12 };
+
+    constexpr uint32_t tileSizes[] = { 64, 128, 256, 512, 1024, 1920 };
+    constexpr uint32_t quickTileSizes[] = { 64, 256 };
+
+    // The image that is used for a benchmark, the BGRA pixels are generated once for each size.
+    // The 16 bits per channel copy is used to encode the higher bit depths.
+    class BenchmarkImage
+    {
+    public:
+        BenchmarkImage(uint32_t width, uint32_t height)
+            : pixels(static_cast<size_t>(width) * height * sizeof(ColorBgra)),
+              pixels64(static_cast<size_t>(width) * height * sizeof(ColorBgra64)),
+              width(width),
+              height(height)
+        {
+            // A mix of smooth gradients, hard edges and noise that is closer to a photograph
+            // than a random or solid color image.
+            uint32_t state = 0x9E3779B9 ^ (width * 31 + height);
+
+            for (uint32_t y = 0; y < height; y++)
+            {
+                ColorBgra* row = reinterpret_cast<ColorBgra*>(pixels.data() + static_cast<size_t>(y) * width * sizeof(ColorBgra));
+
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    state ^= state << 13;
+                    state ^= state >> 17;
+                    state ^= state << 5;
+
+                    const uint32_t noise = state & 15;
+                    const bool edge = ((x / 48) + (y / 48)) & 1;
+
+                    row[x].b = static_cast<uint8_t>((x * 255 / width + noise) & 0xff);
+                    row[x].g = static_cast<uint8_t>((y * 255 / height + (edge ? 64 : 0)) & 0xff);
+                    row[x].r = static_cast<uint8_t>(((x + y) * 127 / (width + height) + noise * 2) & 0xff);
+                    row[x].a = static_cast<uint8_t>(edge ? 255 : 128 + (x & 127));
+                }
+            }
+
+            const ColorBgra* source = reinterpret_cast<const ColorBgra*>(pixels.data());
+            ColorBgra64* destination = reinterpret_cast<ColorBgra64*>(pixels64.data());
+            const size_t pixelCount = static_cast<size_t>(width) * height;
+
+            for (size_t i = 0; i < pixelCount; i++)
+            {
+                // The noise fills the low bits that an 8-bit image does not have.
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+
+                const uint16_t noise = static_cast<uint16_t>(state & 0xff);
+
+                destination[i].b = static_cast<uint16_t>((source[i].b << 8) | noise);
+                destination[i].g = static_cast<uint16_t>((source[i].g << 8) | noise);
+                destination[i].r = static_cast<uint16_t>((source[i].r << 8) | noise);
+                destination[i].a = static_cast<uint16_t>(source[i].a * 257);
+            }
+        }
+
+        BitmapData GetBitmapData()
+        {
+            return BitmapData{ pixels.data(), width, height, width * static_cast<uint32_t>(sizeof(ColorBgra)), BitmapPixelFormat::Bgra32 };
+        }
+
+        BitmapData GetBitmapData64()
+        {
+            return BitmapData{ pixels64.data(), width, height, width * static_cast<uint32_t>(sizeof(ColorBgra64)), BitmapPixelFormat::Bgra64 };
+        }
+
+    private:
+        std::vector<uint8_t> pixels;
+        std::vector<uint8_t> pixels64;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    struct AOMImageDeleter
+    {
+        void operator()(aom_image_t* image) const noexcept
+        {
+            aom_img_free(image);
+        }
+    };
+
+    using ScopedAOMImage = std::unique_ptr<aom_image_t, AOMImageDeleter>;
+
+    // The encoder output is copied into a single buffer that is reused for each image.
+    std::vector<uint8_t> compressedOutput;
+
+    void* __stdcall AllocateCompressedOutput(size_t sizeInBytes)
+    {
+        try
+        {
+            compressedOutput.resize(sizeInBytes);
+        }
+        catch (const std::bad_alloc&)
+        {
+            return nullptr;
+        }
+
+        return compressedOutput.data();
+    }
+
+    bool __stdcall ReportProgress(uint32_t, uint32_t)
+    {
+        return true;
+    }
+
+    size_t GetPeakWorkingSetSize()
+    {
+        PROCESS_MEMORY_COUNTERS counters{};
+        counters.cb = sizeof(counters);
+
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        {
+            return 0;
+        }
+
+        return counters.PeakWorkingSetSize;
+    }
+
+    // Runs the body once to warm up the caches, then returns the duration of each iteration in milliseconds.
+    template <typename TBody>
+    std::vector<double> Measure(uint32_t iterations, TBody body)
+    {
+        std::vector<double> durations;
+        durations.reserve(iterations);
+
+        if (!body())
+        {
+            return durations;
+        }
+
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+            if (!body())
+            {
+                durations.clear();
+                break;
+            }
+
+            const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+            durations.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+
+        return durations;
+    }
+
+    // Uses the nearest-rank method, the durations must be sorted in ascending order.
+    double GetPercentile(const std::vector<double>& sortedDurations, double percentile)
+    {
+        const size_t rank = static_cast<size_t>(std::ceil((percentile / 100.0) * static_cast<double>(sortedDurations.size())));
+        const size_t index = rank > 0 ? rank - 1 : 0;
+
+        return sortedDurations[std::min(index, sortedDurations.size() - 1)];
+    }
+
+    class ResultWriter
+    {
+    public:
+        explicit ResultWriter(FILE* output) : output(output)
+        {
+        }
+
+        void WriteHeader(const BenchmarkOptions& options)
+        {
+            fprintf(output,
+                "{\"type\":\"header\",\"aomVersion\":\"%s\",\"threads\":%u,\"iterations\":%u,\"encodeIterations\":%u}\n",
+                aom_codec_version_str(),
+                options.threadCount,
+                options.iterations,
+                options.encodeIterations);
+        }
+
+        // Writes the result of a stage, the speed is only used for the encode and decode stages.
+        void WriteResult(
+            const char* stage,
+            uint32_t bitDepth,
+            const char* format,
+            const char* speed,
+            uint32_t width,
+            uint32_t height,
+            std::vector<double> durations)
+        {
+            if (durations.empty())
+            {
+                fprintf(output,
+                    "{\"type\":\"result\",\"stage\":\"%s\",\"bitDepth\":%u,\"format\":\"%s\",\"speed\":\"%s\",\"width\":%u,\"height\":%u,\"error\":true}\n",
+                    stage,
+                    bitDepth,
+                    format,
+                    speed,
+                    width,
+                    height);
+                fflush(output);
+                return;
+            }
+
+            std::sort(durations.begin(), durations.end());
+
+            double totalMilliseconds = 0;
+
+            for (const double duration : durations)
+            {
+                totalMilliseconds += duration;
+            }
+
+            const double megapixels = (static_cast<double>(width) * height) / 1000000.0;
+            const double averageMilliseconds = totalMilliseconds / static_cast<double>(durations.size());
+            const double megapixelsPerSecond = averageMilliseconds > 0 ? megapixels / (averageMilliseconds / 1000.0) : 0;
+
+            fprintf(output,
+                "{\"type\":\"result\",\"stage\":\"%s\",\"bitDepth\":%u,\"format\":\"%s\",\"speed\":\"%s\",\"width\":%u,\"height\":%u,"
+                "\"iterations\":%zu,\"mpixPerSecond\":%.3f,\"p50Ms\":%.4f,\"p90Ms\":%.4f,\"p99Ms\":%.4f,\"maxMs\":%.4f,"
+                "\"peakWorkingSetBytes\":%zu}\n",
+                stage,
+                bitDepth,
+                format,
+                speed,
+                width,
+                height,
+                durations.size(),
+                megapixelsPerSecond,
+                GetPercentile(durations, 50),
+                GetPercentile(durations, 90),
+                GetPercentile(durations, 99),
+                durations.back(),
+                GetPeakWorkingSetSize());
+            fflush(output);
+        }
+
+    private:
+        FILE* output;
+    };
+
+    CICPColorData GetColorInfo(YUVChromaSubsampling yuvFormat)
+    {
+        const CICPMatrixCoefficients matrixCoefficients = yuvFormat == YUVChromaSubsampling::IdentityMatrix
+            ? CICPMatrixCoefficients::Identity
+            : CICPMatrixCoefficients::BT601;
+
+        return CICPColorData{ CICPColorPrimaries::BT709, CICPTransferCharacteristics::Srgb, matrixCoefficients, true };
+    }
+
+    aom_img_fmt_t GetAOMImageFormat(YUVChromaSubsampling yuvFormat, uint32_t bitDepth)
+    {
+        aom_img_fmt_t format;
+
+        switch (yuvFormat)
+        {
+        case YUVChromaSubsampling::Subsampling422:
+            format = AOM_IMG_FMT_I422;
+            break;
+        case YUVChromaSubsampling::Subsampling444:
+        case YUVChromaSubsampling::IdentityMatrix:
+            format = AOM_IMG_FMT_I444;
+            break;
+        case YUVChromaSubsampling::Subsampling400:
+        case YUVChromaSubsampling::Subsampling420:
+        default:
+            format = AOM_IMG_FMT_I420;
+            break;
+        }
+
+        return bitDepth > 8 ? static_cast<aom_img_fmt_t>(format | AOM_IMG_FMT_HIGHBITDEPTH) : format;
+    }
+
+    // The conversion to BGRA is measured with YUV images that contain pseudo-random samples,
+    // so each bit depth can be measured without running the encoder first.
+    ScopedAOMImage CreateYUVImage(YUVChromaSubsampling yuvFormat, uint32_t bitDepth, uint32_t width, uint32_t height)
+    {
+        ScopedAOMImage image(aom_img_alloc(nullptr, GetAOMImageFormat(yuvFormat, bitDepth), width, height, 16));
+
+        if (!image)
+        {
+            return image;
+        }
+
+        const CICPColorData colorInfo = GetColorInfo(yuvFormat);
+
+        image->bit_depth = bitDepth;
+        image->monochrome = yuvFormat == YUVChromaSubsampling::Subsampling400;
+        image->cp = static_cast<aom_color_primaries_t>(colorInfo.colorPrimaries);
+        image->tc = static_cast<aom_transfer_characteristics_t>(colorInfo.transferCharacteristics);
+        image->mc = static_cast<aom_matrix_coefficients_t>(colorInfo.matrixCoefficients);
+        image->range = AOM_CR_FULL_RANGE;
+
+        const uint32_t maxSample = (1U << bitDepth) - 1;
+        const int planeCount = image->monochrome ? 1 : 3;
+        uint32_t state = 0x2545F491;
+
+        for (int plane = 0; plane < planeCount; plane++)
+        {
+            const uint32_t planeWidth = plane > 0 ? (width + image->x_chroma_shift) >> image->x_chroma_shift : width;
+            const uint32_t planeHeight = plane > 0 ? (height + image->y_chroma_shift) >> image->y_chroma_shift : height;
+
+            for (uint32_t y = 0; y < planeHeight; y++)
+            {
+                uint8_t* row = image->planes[plane] + static_cast<size_t>(y) * image->stride[plane];
+
+                for (uint32_t x = 0; x < planeWidth; x++)
+                {
+                    state ^= state << 13;
+                    state ^= state >> 17;
+                    state ^= state << 5;
+
+                    const uint32_t sample = ((x + y) * maxSample / (planeWidth + planeHeight) + (state & 7)) & maxSample;
+
+                    if (bitDepth > 8)
+                    {
+                        reinterpret_cast<uint16_t*>(row)[x] = static_cast<uint16_t>(sample);
+                    }
+                    else
+                    {
+                        row[x] = static_cast<uint8_t>(sample);
+                    }
+                }
+            }
+        }
+
+        return image;
+    }
+
+    void RunColorToYUVBenchmark(
+        const BenchmarkOptions& options,
+        ResultWriter& writer,
+        BenchmarkImage& bgraImage,
+        const ImageFormat& format,
+        uint32_t width,
+        uint32_t height)
+    {
+        const BitmapData bitmap = bgraImage.GetBitmapData();
+        const CICPColorData colorInfo = GetColorInfo(format.yuvFormat);
+        ScopedAOMImage yuvImage(aom_img_alloc(nullptr, GetAOMImageFormat(format.yuvFormat, 8), width, height, 16));
+
+        std::vector<double> durations;
+
+        if (yuvImage)
+        {
+            durations = Measure(
+                options.iterations,
+                [&]()
+                {
+                    return ConvertColorToAOMImage(&bitmap, colorInfo, format.yuvFormat, false, options.threadCount, yuvImage.get()) == EncoderStatus::Ok;
+                });
+        }
+
+        writer.WriteResult("bgra-to-yuv", 8, format.name, "", width, height, durations);
+    }
+
+    void RunYUVToBGRABenchmark(
+        const BenchmarkOptions& options,
+        ResultWriter& writer,
+        const ImageFormat& format,
+        uint32_t bitDepth,
+        uint32_t width,
+        uint32_t height)
+    {
+        std::vector<uint8_t> outputPixels(static_cast<size_t>(width) * height * sizeof(ColorBgra));
+        BitmapData output{ outputPixels.data(), width, height, width * static_cast<uint32_t>(sizeof(ColorBgra)), BitmapPixelFormat::Bgra32 };
+        ScopedAOMImage yuvImage = CreateYUVImage(format.yuvFormat, bitDepth, width, height);
+        const CICPColorData colorInfo = GetColorInfo(format.yuvFormat);
+        // The lookup tables are cached by the decoder session, so the benchmark also reuses them.
+        YUVLookupTableCache lookupTableCache;
+
+        std::vector<double> durations;
+
+        if (yuvImage)
+        {
+            durations = Measure(
+                options.iterations,
+                [&]()
+                {
+                    DecodeInfo decodeInfo{};
+                    decodeInfo.expectedWidth = width;
+                    decodeInfo.expectedHeight = height;
+                    decodeInfo.maxConversionThreads = options.threadCount;
+
+                    return ConvertColorImage(yuvImage.get(), &colorInfo, &decodeInfo, &lookupTableCache, &output) == DecoderStatus::Ok;
+                });
+        }
+
+        writer.WriteResult("yuv-to-bgra", bitDepth, format.name, "", width, height, durations);
+    }
+
+    void RunEncodeDecodeBenchmark(
+        const BenchmarkOptions& options,
+        ResultWriter& writer,
+        BenchmarkImage& bgraImage,
+        const ImageFormat& format,
+        const CompressionSpeedInfo& speed,
+        uint32_t bitDepth,
+        uint32_t width,
+        uint32_t height)
+    {
+        // The higher bit depths are encoded from the 16 bits per channel image.
+        const BitmapData bitmap = bitDepth > 8 ? bgraImage.GetBitmapData64() : bgraImage.GetBitmapData();
+        const CICPColorData colorInfo = GetColorInfo(format.yuvFormat);
+
+        EncoderOptions encodeOptions{};
+        encodeOptions.colorQuality = format.yuvFormat == YUVChromaSubsampling::IdentityMatrix ? 100 : 85;
+        encodeOptions.alphaQuality = 85;
+        encodeOptions.compressionSpeed = speed.speed;
+        encodeOptions.yuvFormat = format.yuvFormat;
+        encodeOptions.maxThreads = static_cast<int32_t>(options.threadCount);
+        encodeOptions.maxConversionThreads = static_cast<int32_t>(options.threadCount);
+        encodeOptions.bitDepth = bitDepth;
+
+        // The session keeps the encoder between iterations, which matches the tiles of an image grid.
+        EncoderSession* session = CreateEncoderSession();
+
+        const std::vector<double> encodeDurations = Measure(
+            options.encodeIterations,
+            [&]()
+            {
+                ProgressContext progressContext{ ReportProgress, 0, 1 };
+                void* compressedImage = nullptr;
+
+                return CompressColorImage(
+                    session,
+                    &bitmap,
+                    &encodeOptions,
+                    &progressContext,
+                    colorInfo,
+                    AllocateCompressedOutput,
+                    &compressedImage,
+                    nullptr) == EncoderStatus::Ok;
+            });
+
+        DestroyEncoderSession(session);
+
+        writer.WriteResult("encode", bitDepth, format.name, speed.name, width, height, encodeDurations);
+
+        if (encodeDurations.empty())
+        {
+            return;
+        }
+
+        // The last encoded image is still in the output buffer.
+        const std::vector<uint8_t> compressedImage = compressedOutput;
+
+        aom_codec_ctx_t codec{};
+        aom_codec_dec_cfg_t config{};
+        config.threads = options.threadCount;
+
+        std::vector<double> decodeDurations;
+
+        if (aom_codec_dec_init(&codec, aom_codec_av1_dx(), &config, 0) == AOM_CODEC_OK)
+        {
+            decodeDurations = Measure(
+                options.iterations,
+                [&]()
+                {
+                    if (aom_codec_decode(&codec, compressedImage.data(), compressedImage.size(), nullptr) != AOM_CODEC_OK)
+                    {
+                        return false;
+                    }
+
+                    aom_codec_iter_t iter = nullptr;
+
+                    return aom_codec_get_frame(&codec, &iter) != nullptr;
+                });
+
+            aom_codec_destroy(&codec);
+        }
+
+        writer.WriteResult("decode", bitDepth, format.name, speed.name, width, height, decodeDurations);
+    }
+
+    // Checks that the tiles of an image grid are not decoded with more threads than the decoder thread limit.
+    bool VerifyImageGridThreadLimit()
+    {
+        constexpr uint32_t threadLimit = 2;
+
+        std::atomic<uint32_t> activeThreads(0);
+        std::atomic<bool> limitExceeded(false);
+
+        DecodeInfo decodeInfo{};
+        decodeInfo.maxConversionThreads = threadLimit;
+        decodeInfo.maxDecoderThreads = threadLimit;
+
+        // The tiles only record the threads that they would use, no image is decoded.
+        const DecoderStatus status = DecodeImageGrid(
+            8,
+            8,
+            &decodeInfo,
+            nullptr,
+            [&](uint32_t, DecodeInfo* tileInfo, DecodeInfo*)
+            {
+                const uint32_t tileThreads = std::max({ tileInfo->maxDecoderThreads, tileInfo->maxConversionThreads, 1u });
+
+                if (activeThreads.fetch_add(tileThreads) + tileThreads > threadLimit)
+                {
+                    limitExceeded = true;
+                }
+
+                // Gives the other workers a chance to overlap with this tile.
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+                activeThreads.fetch_sub(tileThreads);
+
+                return DecoderStatus::Ok;
+            });
+
+        return status == DecoderStatus::Ok && !limitExceeded;
+    }
+
+    bool ParseUInt32(const char* value, uint32_t& result)
+    {
+        char* end = nullptr;
+        const unsigned long parsed = strtoul(value, &end, 10);
+
+        if (end == value || *end != '\0' || parsed == 0 || parsed > UINT32_MAX)
+        {
+            return false;
+        }
+
+        result = static_cast<uint32_t>(parsed);
+        return true;
+    }
+
+    bool ParseOptions(int argc, char** argv, BenchmarkOptions& options)
+    {
+        options.iterations = 50;
+        options.encodeIterations = 5;
+        options.threadCount = GetProcessorCount();
+        options.quick = false;
+        options.outputPath = nullptr;
+
+        for (int i = 1; i < argc; i++)
+        {
+            const char* arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+            if (strcmp(arg, "--quick") == 0)
+            {
+                options.quick = true;
+                options.iterations = 5;
+                options.encodeIterations = 1;
+            }
+            else if (strcmp(arg, "--iterations") == 0 && value && ParseUInt32(value, options.iterations))
+            {
+                i++;
+            }
+            else if (strcmp(arg, "--encode-iterations") == 0 && value && ParseUInt32(value, options.encodeIterations))
+            {
+                i++;
+            }
+            else if (strcmp(arg, "--threads") == 0 && value && ParseUInt32(value, options.threadCount))
+            {
+                i++;
+            }
+            else if (strcmp(arg, "--output") == 0 && value)
+            {
+                options.outputPath = value;
+                i++;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+
+    if (!ParseOptions(argc, argv, options))
+    {
+        fprintf(stderr, "Usage: AvifNativeBenchmark [--quick] [--iterations N] [--encode-iterations N] [--threads N] [--output file]\n");
+        return 1;
+    }
+
+    FILE* output = stdout;
+
+    if (options.outputPath)
+    {
+        if (fopen_s(&output, options.outputPath, "w") != 0 || !output)
+        {
+            fprintf(stderr, "Unable to open the output file: %s\n", options.outputPath);
+            return 1;
+        }
+    }
+
+    if (!VerifyImageConverters())
+    {
+        fprintf(stderr, "The vectorized image converters do not match the scalar code.\n");
+        return 1;
+    }
+
+    if (!VerifyImageGridThreadLimit())
+    {
+        fprintf(stderr, "The image grid decoder uses more threads than its thread limit.\n");
+        return 1;
+    }
+
+    ResultWriter writer(output);
+    writer.WriteHeader(options);
+
+    std::vector<uint32_t> sizes;
+
+    if (options.quick)
+    {
+        sizes.assign(std::begin(quickTileSizes), std::end(quickTileSizes));
+    }
+    else
+    {
+        sizes.assign(std::begin(tileSizes), std::end(tileSizes));
+    }
+
+    for (const uint32_t size : sizes)
+    {
+        BenchmarkImage bgraImage(size, size);
+
+        for (const ImageFormat& format : imageFormats)
+        {
+            RunColorToYUVBenchmark(options, writer, bgraImage, format, size, size);
+
+            for (const uint32_t bitDepth : bitDepths)
+            {
+                RunYUVToBGRABenchmark(options, writer, format, bitDepth, size, size);
+            }
+
+            for (const CompressionSpeedInfo& speed : compressionSpeeds)
+            {
+                for (const uint32_t bitDepth : bitDepths)
+                {
+                    RunEncodeDecodeBenchmark(options, writer, bgraImage, format, speed, bitDepth, size, size);
+                }
+            }
+        }
+    }
+
+    if (output != stdout)
+    {
+        fclose(output);
+    }
+
+    return 0;
+}
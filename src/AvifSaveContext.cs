@@ -0,0 +1,114 @@
+﻿////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+using AvifFileType.AvifContainer;
+using AvifFileType.Interop;
+using PaintDotNet;
+using System;
+using System.Drawing;
+
+namespace AvifFileType
+{
+    /// <summary>
+    /// The state of an image that is being saved, it is passed between the prepare, compress and write stages.
+    /// </summary>
+    internal sealed class AvifSaveContext
+        : IDisposable
+    {
+        private CompressedAV1ImageCollection colorImages;
+        private CompressedAV1ImageCollection alphaImages;
+
+        public AvifSaveContext(Document document,
+                               Surface image,
+                               ImageGridMetadata imageGridMetadata,
+                               Rectangle[] windowRectangles,
+                               AvifMetadata metadata,
+                               EncoderOptions options,
+                               CICPColorData colorConversionInfo,
+                               bool hasTransparency,
+                               bool premultipliedAlpha,
+                               HomogeneousTileInfo homogeneousTileInfo,
+                               uint initialProgressDone,
+                               uint progressTotal)
+        {
+            this.Document = document;
+            this.Image = image;
+            this.ImageGridMetadata = imageGridMetadata;
+            this.WindowRectangles = windowRectangles;
+            this.Metadata = metadata;
+            this.Options = options;
+            this.ColorConversionInfo = colorConversionInfo;
+            this.HasTransparency = hasTransparency;
+            this.PremultipliedAlpha = premultipliedAlpha;
+            this.HomogeneousTileInfo = homogeneousTileInfo;
+            this.InitialProgressDone = initialProgressDone;
+            this.ProgressTotal = progressTotal;
+
+            int tileCount = imageGridMetadata?.TileCount ?? 1;
+
+            this.colorImages = new CompressedAV1ImageCollection(tileCount);
+            this.alphaImages = hasTransparency ? new CompressedAV1ImageCollection(tileCount) : null;
+        }
+
+        public Document Document { get; }
+
+        /// <summary>
+        /// Gets the image that is compressed, the color channels are premultiplied by the native code when <see cref="PremultipliedAlpha"/> is true.
+        /// </summary>
+        public Surface Image { get; }
+
+        public ImageGridMetadata ImageGridMetadata { get; }
+
+        public Rectangle[] WindowRectangles { get; }
+
+        public AvifMetadata Metadata { get; }
+
+        /// <summary>
+        /// Gets the encoder options, the thread counts are set when the image is compressed.
+        /// </summary>
+        public EncoderOptions Options { get; }
+
+        public CICPColorData ColorConversionInfo { get; }
+
+        public bool HasTransparency { get; }
+
+        public bool PremultipliedAlpha { get; }
+
+        public HomogeneousTileInfo HomogeneousTileInfo { get; }
+
+        /// <summary>
+        /// Gets the progress that is reported for the duplicate tiles, which are never compressed.
+        /// </summary>
+        public uint InitialProgressDone { get; }
+
+        public uint ProgressTotal { get; }
+
+        public CompressedAV1ImageCollection ColorImages => this.colorImages;
+
+        public CompressedAV1ImageCollection AlphaImages => this.alphaImages;
+
+        public void Dispose()
+        {
+            if (this.colorImages != null)
+            {
+                this.colorImages.Dispose();
+                this.colorImages = null;
+            }
+
+            if (this.alphaImages != null)
+            {
+                this.alphaImages.Dispose();
+                this.alphaImages = null;
+            }
+        }
+    }
+}
@@ -0,0 +1,22 @@
+﻿////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+namespace AvifFileType
+{
+    // The values are the number of bits per sample, they are passed to the native encoder.
+    internal enum EncoderBitDepth
+    {
+        EightBit = 8,
+        TenBit = 10,
+        TwelveBit = 12
+    }
+}
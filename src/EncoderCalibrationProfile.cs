@@ -0,0 +1,328 @@
+﻿////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Runtime.Serialization;
+using System.Runtime.Serialization.Json;
+using System.Text;
+
+namespace AvifFileType
+{
+    /// <summary>
+    /// The encoder throughput that was measured by the AvifNativeBenchmark encode stage.
+    /// </summary>
+    internal sealed class EncoderCalibrationProfile
+    {
+        private const string ProfileFileName = "AvifFileType.Calibration.jsonl";
+
+        private static readonly Lazy<EncoderCalibrationProfile> installedProfile = new Lazy<EncoderCalibrationProfile>(LoadInstalledProfile);
+
+        // The cost models are grouped by the bit depth of the encoded image.
+        private readonly Dictionary<int, Dictionary<CompressionSpeed, EncoderCostModel>> costModels;
+
+        private EncoderCalibrationProfile(Dictionary<int, Dictionary<CompressionSpeed, EncoderCostModel>> costModels)
+        {
+            this.costModels = costModels;
+        }
+
+        /// <summary>
+        /// Gets the profile that is installed in the plugin directory.
+        /// </summary>
+        /// <value>
+        /// The installed profile, or <see langword="null"/> if the plugin directory does not contain a valid profile.
+        /// </value>
+        public static EncoderCalibrationProfile Installed => installedProfile.Value;
+
+        /// <summary>
+        /// Reads the encode stage results from the output of the benchmark.
+        /// </summary>
+        /// <param name="reader">The reader.</param>
+        /// <returns>The profile, or <see langword="null"/> if the benchmark output does not contain enough encode results.</returns>
+        /// <exception cref="ArgumentNullException"><paramref name="reader"/> is null.</exception>
+        public static EncoderCalibrationProfile Parse(TextReader reader)
+        {
+            if (reader is null)
+            {
+                ExceptionUtil.ThrowArgumentNullException(nameof(reader));
+            }
+
+            int threadCount = 0;
+            Dictionary<int, Dictionary<CompressionSpeed, List<EncodeSample>>> samples = new Dictionary<int, Dictionary<CompressionSpeed, List<EncodeSample>>>();
+            // The serializer is part of the .NET Framework, so the profile can be read without
+            // deploying any other assemblies with the plugin.
+            DataContractJsonSerializer serializer = new DataContractJsonSerializer(typeof(BenchmarkRecord));
+
+            string line;
+
+            while ((line = reader.ReadLine()) != null)
+            {
+                if (string.IsNullOrWhiteSpace(line))
+                {
+                    continue;
+                }
+
+                BenchmarkRecord record;
+
+                try
+                {
+                    using (MemoryStream stream = new MemoryStream(Encoding.UTF8.GetBytes(line), false))
+                    {
+                        record = serializer.ReadObject(stream) as BenchmarkRecord;
+                    }
+                }
+                catch (SerializationException)
+                {
+                    // The malformed lines are ignored, the profile uses the remaining results.
+                    continue;
+                }
+
+                if (record is null)
+                {
+                    continue;
+                }
+
+                if (record.Type == "header")
+                {
+                    threadCount = record.Threads ?? 0;
+                }
+                else if (record.Type == "result"
+                         && record.Stage == "encode"
+                         && record.Error is null
+                         && Enum.TryParse(record.Speed, out CompressionSpeed speed)
+                         && record.Width is int width
+                         && record.Height is int height
+                         && record.MedianMilliseconds is double medianMilliseconds
+                         && width > 0 && height > 0 && medianMilliseconds > 0)
+                {
+                    // Older benchmark output does not include the bit depth, it only measured 8-bit images.
+                    int bitDepth = record.BitDepth ?? 8;
+
+                    if (!samples.TryGetValue(bitDepth, out Dictionary<CompressionSpeed, List<EncodeSample>> bitDepthSamples))
+                    {
+                        bitDepthSamples = new Dictionary<CompressionSpeed, List<EncodeSample>>();
+                        samples.Add(bitDepth, bitDepthSamples);
+                    }
+
+                    if (!bitDepthSamples.TryGetValue(speed, out List<EncodeSample> speedSamples))
+                    {
+                        speedSamples = new List<EncodeSample>();
+                        bitDepthSamples.Add(speed, speedSamples);
+                    }
+
+                    speedSamples.Add(new EncodeSample(record.Format, width, height, medianMilliseconds));
+                }
+            }
+
+            if (threadCount < 1)
+            {
+                return null;
+            }
+
+            Dictionary<int, Dictionary<CompressionSpeed, EncoderCostModel>> costModels = new Dictionary<int, Dictionary<CompressionSpeed, EncoderCostModel>>();
+
+            foreach (KeyValuePair<int, Dictionary<CompressionSpeed, List<EncodeSample>>> bitDepthSamples in samples)
+            {
+                Dictionary<CompressionSpeed, EncoderCostModel> bitDepthModels = new Dictionary<CompressionSpeed, EncoderCostModel>();
+
+                foreach (KeyValuePair<CompressionSpeed, List<EncodeSample>> item in bitDepthSamples.Value)
+                {
+                    EncoderCostModel model = FitCostModel(item.Value, threadCount);
+
+                    if (model != null)
+                    {
+                        bitDepthModels.Add(item.Key, model);
+                    }
+                }
+
+                if (bitDepthModels.Count > 0)
+                {
+                    costModels.Add(bitDepthSamples.Key, bitDepthModels);
+                }
+            }
+
+            return costModels.Count > 0 ? new EncoderCalibrationProfile(costModels) : null;
+        }
+
+        /// <summary>
+        /// Gets the measured cost model for the specified compression speed and bit depth.
+        /// </summary>
+        /// <param name="compressionSpeed">The compression speed.</param>
+        /// <param name="bitDepth">The bit depth of the encoded image.</param>
+        /// <returns>
+        /// The cost model, or <see langword="null"/> if the profile does not contain the compression speed.
+        /// The 8-bit cost model is used when the profile does not contain results for the bit depth.
+        /// </returns>
+        public EncoderCostModel TryGetCostModel(CompressionSpeed compressionSpeed, EncoderBitDepth bitDepth)
+        {
+            EncoderCostModel model = null;
+
+            if (this.costModels.TryGetValue((int)bitDepth, out Dictionary<CompressionSpeed, EncoderCostModel> bitDepthModels))
+            {
+                bitDepthModels.TryGetValue(compressionSpeed, out model);
+            }
+
+            if (model is null
+                && bitDepth != EncoderBitDepth.EightBit
+                && this.costModels.TryGetValue((int)EncoderBitDepth.EightBit, out bitDepthModels))
+            {
+                // The relative cost of the tile layouts is similar at every bit depth, so the
+                // 8-bit results are a better estimate than the built-in cost model.
+                bitDepthModels.TryGetValue(compressionSpeed, out model);
+            }
+
+            return model;
+        }
+
+        private static EncoderCostModel FitCostModel(List<EncodeSample> samples, int threadCount)
+        {
+            // The 4:2:0 results are used when they are available, the other formats
+            // only change the throughput by a small amount.
+            List<EncodeSample> fitSamples = samples.FindAll(s => s.Format == "420");
+
+            if (fitSamples.Count < 2)
+            {
+                fitSamples = samples;
+            }
+
+            // Least squares fit of: time = overhead + singleThreadTime * megapixels / speedup
+            // The speedup removes the threading that the benchmark used from the measured time.
+            int count = 0;
+            double sumX = 0;
+            double sumY = 0;
+            double sumXX = 0;
+            double sumXY = 0;
+
+            foreach (EncodeSample sample in fitSamples)
+            {
+                double x = sample.Megapixels / EncoderCostModel.GetThreadingSpeedup(threadCount, sample.Height);
+                double y = sample.MedianMilliseconds;
+
+                count++;
+                sumX += x;
+                sumY += y;
+                sumXX += x * x;
+                sumXY += x * y;
+            }
+
+            double denominator = (count * sumXX) - (sumX * sumX);
+
+            if (count < 2 || denominator <= 0)
+            {
+                return null;
+            }
+
+            double millisecondsPerMegapixel = ((count * sumXY) - (sumX * sumY)) / denominator;
+            double overheadMilliseconds = (sumY - (millisecondsPerMegapixel * sumX)) / count;
+
+            if (millisecondsPerMegapixel <= 0)
+            {
+                return null;
+            }
+
+            return new EncoderCostModel(Math.Max(overheadMilliseconds, 0), millisecondsPerMegapixel);
+        }
+
+        private static EncoderCalibrationProfile LoadInstalledProfile()
+        {
+            string text = null;
+
+            try
+            {
+                string directory = Path.GetDirectoryName(typeof(EncoderCalibrationProfile).Assembly.Location);
+
+                if (!string.IsNullOrEmpty(directory))
+                {
+                    string path = Path.Combine(directory, ProfileFileName);
+
+                    if (File.Exists(path))
+                    {
+                        text = File.ReadAllText(path);
+                    }
+                }
+            }
+            catch (IOException)
+            {
+            }
+            catch (UnauthorizedAccessException)
+            {
+            }
+
+            // The built-in cost models are used when the profile cannot be read.
+            // Only the file access errors are handled, any other failure is not hidden as a missing profile.
+            if (text is null)
+            {
+                return null;
+            }
+
+            using (StringReader reader = new StringReader(text))
+            {
+                return Parse(reader);
+            }
+        }
+
+        // A line of the benchmark output, the members that a line does not contain are null.
+        [DataContract]
+        private sealed class BenchmarkRecord
+        {
+            [DataMember(Name = "type")]
+            public string Type { get; set; }
+
+            [DataMember(Name = "threads")]
+            public int? Threads { get; set; }
+
+            [DataMember(Name = "stage")]
+            public string Stage { get; set; }
+
+            [DataMember(Name = "bitDepth")]
+            public int? BitDepth { get; set; }
+
+            [DataMember(Name = "format")]
+            public string Format { get; set; }
+
+            [DataMember(Name = "speed")]
+            public string Speed { get; set; }
+
+            [DataMember(Name = "width")]
+            public int? Width { get; set; }
+
+            [DataMember(Name = "height")]
+            public int? Height { get; set; }
+
+            [DataMember(Name = "p50Ms")]
+            public double? MedianMilliseconds { get; set; }
+
+            [DataMember(Name = "error")]
+            public bool? Error { get; set; }
+        }
+
+        private readonly struct EncodeSample
+        {
+            public EncodeSample(string format, int width, int height, double medianMilliseconds)
+            {
+                this.Format = format;
+                this.Height = height;
+                this.Megapixels = ((double)width * height) / 1000000.0;
+                this.MedianMilliseconds = medianMilliseconds;
+            }
+
+            public string Format { get; }
+
+            public int Height { get; }
+
+            public double Megapixels { get; }
+
+            public double MedianMilliseconds { get; }
+        }
+    }
+}
@@ -0,0 +1,176 @@
+﻿////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+using System;
+
+namespace AvifFileType
+{
+    /// <summary>
+    /// Estimates the time that the AV1 encoder takes to compress a single image.
+    /// </summary>
+    internal sealed class EncoderCostModel
+    {
+        // The superblock height that the AOM multi-threaded row encoding splits the image on.
+        private const int SuperblockSize = 64;
+        // The AOM encoder does not scale linearly with the thread count, the threads
+        // share the entropy coding and loop filter stages.
+        private const double ThreadingEfficiencyExponent = 0.7;
+        // The AV1 tiles are encoded independently, so they scale better than the superblock rows.
+        // The benchmark does not measure internal tiling, this value is an estimate.
+        private const double TileEfficiencyExponent = 0.9;
+        // See MAX_TILE_COLS and MAX_TILE_ROWS in the AV1 specification.
+        private const int MaxInternalTileLog2 = 6;
+        // The native encoder does not split an AV1 tile that is smaller than twice this size.
+        private const int MinInternalTileSize = 256;
+
+        public EncoderCostModel(double overheadMilliseconds, double millisecondsPerMegapixel)
+        {
+            this.OverheadMilliseconds = overheadMilliseconds;
+            this.MillisecondsPerMegapixel = millisecondsPerMegapixel;
+        }
+
+        /// <summary>
+        /// Gets the fixed cost of encoding an image, independent of its size.
+        /// </summary>
+        public double OverheadMilliseconds { get; }
+
+        /// <summary>
+        /// Gets the single-threaded cost of encoding one million pixels.
+        /// </summary>
+        public double MillisecondsPerMegapixel { get; }
+
+        /// <summary>
+        /// Gets the built-in cost model for the specified compression speed.
+        /// </summary>
+        /// <param name="compressionSpeed">The compression speed.</param>
+        /// <returns>The cost model.</returns>
+        public static EncoderCostModel GetDefault(CompressionSpeed compressionSpeed)
+        {
+            // These values were measured with the 8-bit 4:2:0 benchmark results on a desktop CPU.
+            // They are also used for the high bit depths, the planner only compares the tile layouts
+            // with each other and that comparison does not depend on the absolute encoding time.
+            switch (compressionSpeed)
+            {
+                case CompressionSpeed.Fast:
+                    return new EncoderCostModel(2.0, 150.0);
+                case CompressionSpeed.Medium:
+                    return new EncoderCostModel(4.0, 1500.0);
+                case CompressionSpeed.Slow:
+                case CompressionSpeed.VerySlow:
+                default:
+                    return new EncoderCostModel(8.0, 12000.0);
+            }
+        }
+
+        /// <summary>
+        /// Determines whether a single image should be split into AV1 tiles by the encoder.
+        /// </summary>
+        /// <param name="width">The image width.</param>
+        /// <param name="height">The image height.</param>
+        /// <param name="threadCount">The number of threads used by the encoder.</param>
+        /// <returns>
+        /// <see langword="true"/> if the image is large enough to give each thread its own AV1 tile; otherwise, <see langword="false"/>.
+        /// </returns>
+        public static bool UsesInternalTiling(int width, int height, int threadCount)
+        {
+            if (threadCount <= 1 || Math.Max(width, height) < MinInternalTileSize * 2)
+            {
+                return false;
+            }
+
+            // The AV1 tiles reduce the compression efficiency, so they are only used when the image
+            // spans more than one superblock row per thread.
+            return GetSuperblockRowCount(height) > threadCount;
+        }
+
+        /// <summary>
+        /// Gets the speedup of an encoder that uses the specified number of threads.
+        /// </summary>
+        /// <param name="threadCount">The number of threads used by the encoder.</param>
+        /// <param name="imageHeight">The height of the image.</param>
+        /// <returns>The speedup relative to a single-threaded encoder.</returns>
+        public static double GetThreadingSpeedup(int threadCount, int imageHeight)
+        {
+            // The encoder cannot use more threads than the image has superblock rows.
+            int usableThreads = Math.Max(Math.Min(threadCount, GetSuperblockRowCount(imageHeight)), 1);
+
+            return Math.Pow(usableThreads, ThreadingEfficiencyExponent);
+        }
+
+        /// <summary>
+        /// Estimates the time that is required to encode an image.
+        /// </summary>
+        /// <param name="width">The image width.</param>
+        /// <param name="height">The image height.</param>
+        /// <param name="threadCount">The number of threads used by the encoder.</param>
+        /// <param name="internalTiling"><see langword="true"/> if the encoder splits the image into AV1 tiles.</param>
+        /// <returns>The estimated time in milliseconds.</returns>
+        public double EstimateMilliseconds(int width, int height, int threadCount, bool internalTiling)
+        {
+            double megapixels = ((double)width * height) / 1000000.0;
+            double speedup;
+
+            if (internalTiling)
+            {
+                GetInternalTileLayout(threadCount, width, height, out int tileColumnCount, out int tileRowCount);
+
+                int tileCount = tileColumnCount * tileRowCount;
+                int threadsPerTile = Math.Max(threadCount / tileCount, 1);
+
+                speedup = Math.Pow(tileCount, TileEfficiencyExponent) * GetThreadingSpeedup(threadsPerTile, height / tileRowCount);
+            }
+            else
+            {
+                speedup = GetThreadingSpeedup(threadCount, height);
+            }
+
+            return this.OverheadMilliseconds + (this.MillisecondsPerMegapixel * megapixels / speedup);
+        }
+
+        // This mirrors the tile layout that the native encoder selects when internal tiling is enabled.
+        private static void GetInternalTileLayout(int threadCount, int width, int height, out int tileColumnCount, out int tileRowCount)
+        {
+            int tileColumnsLog2 = 0;
+            int tileRowsLog2 = 0;
+
+            while ((1 << (tileColumnsLog2 + tileRowsLog2)) < threadCount)
+            {
+                int tileWidth = width >> tileColumnsLog2;
+                int tileHeight = height >> tileRowsLog2;
+
+                bool canSplitColumns = tileColumnsLog2 < MaxInternalTileLog2 && tileWidth >= MinInternalTileSize * 2;
+                bool canSplitRows = tileRowsLog2 < MaxInternalTileLog2 && tileHeight >= MinInternalTileSize * 2;
+
+                if (canSplitColumns && (tileWidth >= tileHeight || !canSplitRows))
+                {
+                    tileColumnsLog2++;
+                }
+                else if (canSplitRows)
+                {
+                    tileRowsLog2++;
+                }
+                else
+                {
+                    break;
+                }
+            }
+
+            tileColumnCount = 1 << tileColumnsLog2;
+            tileRowCount = 1 << tileRowsLog2;
+        }
+
+        private static int GetSuperblockRowCount(int imageHeight)
+        {
+            return Math.Max((imageHeight + SuperblockSize - 1) / SuperblockSize, 1);
+        }
+    }
+}
@@ -23,47 +23,195 @@ namespace AvifFileType.Interop
 
         [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
         internal static extern unsafe EncoderStatus CompressColorImage(
+            SafeEncoderSessionHandle session,
             [In] ref BitmapData image,
             EncoderOptions options,
             [In, Out] ProgressContext progressContext,
             [In] ref CICPColorData colorInfo,
             [MarshalAs(UnmanagedType.FunctionPtr)] CompressedAV1OutputAlloc outputAllocator,
-            out IntPtr colorImage);
+            out IntPtr colorImage,
+            [In, Out] InstrumentationStatistics statistics);
 
         [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
         internal static extern unsafe EncoderStatus CompressAlphaImage(
+            SafeEncoderSessionHandle session,
             [In] ref BitmapData image,
             EncoderOptions options,
             [In, Out] ProgressContext progressContext,
             [MarshalAs(UnmanagedType.FunctionPtr)] CompressedAV1OutputAlloc outputAllocator,
-            out IntPtr alphaImage);
+            out IntPtr alphaImage,
+            [In, Out] InstrumentationStatistics statistics);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern unsafe EncoderStatus CompressImageGrid(
+            SafeEncoderSessionHandle session,
+            [In] TileEncodeInfo[] tiles,
+            uint tileCount,
+            EncoderOptions options,
+            [In, Out] ProgressContext progressContext,
+            [In] ref CICPColorData colorInfo,
+            [MarshalAs(UnmanagedType.FunctionPtr)] CompressedAV1OutputAlloc outputAllocator,
+            [Out] IntPtr[] colorImages,
+            [Out] IntPtr[] alphaImages,
+            [In, Out] InstrumentationStatistics statistics);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern SafeEncoderSessionHandle CreateEncoderSession();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern void DestroyEncoderSession(IntPtr session);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern SafeDecoderSessionHandle CreateDecoderSession();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern void DestroyDecoderSession(IntPtr session);
 
         [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
         internal static extern unsafe DecoderStatus DecompressColorImage(
+            SafeDecoderSessionHandle session,
             byte* compressedColorImage,
             UIntPtr compressedColorImageSize,
             [In] ref CICPColorData colorInfo,
             [In, Out] DecodeInfo decodeInfo,
-            [In] ref BitmapData fullImage);
+            [In] ref BitmapData fullImage,
+            [In, Out] InstrumentationStatistics statistics);
 
         [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
         internal static extern unsafe DecoderStatus DecompressColorImage(
+            SafeDecoderSessionHandle session,
             byte* compressedColorImage,
             UIntPtr compressedColorImageSize,
             IntPtr colorInfo_MustBeZero,
             [In, Out] DecodeInfo decodeInfo,
-            [In] ref BitmapData fullImage);
+            [In] ref BitmapData fullImage,
+            [In, Out] InstrumentationStatistics statistics);
 
         [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
         internal static extern unsafe DecoderStatus DecompressAlphaImage(
+            SafeDecoderSessionHandle session,
             byte* compressedAlphaImage,
             UIntPtr compressedAlphaImageSize,
             [In, Out] DecodeInfo decodeInfo,
-            [In] ref BitmapData fullImage);
+            [In] ref BitmapData fullImage,
+            [In, Out] InstrumentationStatistics statistics);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern unsafe DecoderStatus DecompressColorImageSegments(
+            SafeDecoderSessionHandle session,
+            [In] CompressedTileData[] segments,
+            uint segmentCount,
+            [In] ref CICPColorData colorInfo,
+            [In, Out] DecodeInfo decodeInfo,
+            [In] ref BitmapData fullImage,
+            [In, Out] InstrumentationStatistics statistics);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern unsafe DecoderStatus DecompressColorImageSegments(
+            SafeDecoderSessionHandle session,
+            [In] CompressedTileData[] segments,
+            uint segmentCount,
+            IntPtr colorInfo_MustBeZero,
+            [In, Out] DecodeInfo decodeInfo,
+            [In] ref BitmapData fullImage,
+            [In, Out] InstrumentationStatistics statistics);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern unsafe DecoderStatus DecompressAlphaImageSegments(
+            SafeDecoderSessionHandle session,
+            [In] CompressedTileData[] segments,
+            uint segmentCount,
+            [In, Out] DecodeInfo decodeInfo,
+            [In] ref BitmapData fullImage,
+            [In, Out] InstrumentationStatistics statistics);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern unsafe DecoderStatus DecompressColorImageGrid(
+            SafeDecoderSessionHandle session,
+            [In] CompressedTileData[] tiles,
+            uint tileColumnCount,
+            uint tileRowCount,
+            [In] ref CICPColorData colorInfo,
+            [In, Out] DecodeInfo decodeInfo,
+            [In] ref BitmapData fullImage,
+            [In, Out] InstrumentationStatistics statistics);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern unsafe DecoderStatus DecompressColorImageGrid(
+            SafeDecoderSessionHandle session,
+            [In] CompressedTileData[] tiles,
+            uint tileColumnCount,
+            uint tileRowCount,
+            IntPtr colorInfo_MustBeZero,
+            [In, Out] DecodeInfo decodeInfo,
+            [In] ref BitmapData fullImage,
+            [In, Out] InstrumentationStatistics statistics);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern unsafe DecoderStatus DecompressAlphaImageGrid(
+            SafeDecoderSessionHandle session,
+            [In] CompressedTileData[] tiles,
+            uint tileColumnCount,
+            uint tileRowCount,
+            [In, Out] DecodeInfo decodeInfo,
+            [In] ref BitmapData fullImage,
+            [In, Out] InstrumentationStatistics statistics);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern unsafe DecoderStatus DecompressColorAlphaImageGrid(
+            SafeDecoderSessionHandle session,
+            [In] CompressedTileData[] colorTiles,
+            [In] CompressedTileData[] alphaTiles,
+            uint tileColumnCount,
+            uint tileRowCount,
+            [In] ref CICPColorData colorInfo,
+            [In, Out] DecodeInfo colorDecodeInfo,
+            [In, Out] DecodeInfo alphaDecodeInfo,
+            [MarshalAs(UnmanagedType.U1)] bool unpremultiplyAlpha,
+            [In] ref BitmapData fullImage,
+            [In, Out] InstrumentationStatistics statistics);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern unsafe DecoderStatus DecompressColorAlphaImageGrid(
+            SafeDecoderSessionHandle session,
+            [In] CompressedTileData[] colorTiles,
+            [In] CompressedTileData[] alphaTiles,
+            uint tileColumnCount,
+            uint tileRowCount,
+            IntPtr colorInfo_MustBeZero,
+            [In, Out] DecodeInfo colorDecodeInfo,
+            [In, Out] DecodeInfo alphaDecodeInfo,
+            [MarshalAs(UnmanagedType.U1)] bool unpremultiplyAlpha,
+            [In] ref BitmapData fullImage,
+            [In, Out] InstrumentationStatistics statistics);
 
         [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
         [return: MarshalAs(UnmanagedType.U1)]
         internal static extern bool MemoryBlocksAreEqual(IntPtr buffer1, IntPtr buffer2, UIntPtr length);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern EncoderStatus HashImageTiles([In] BitmapData[] tiles,
+                                                            uint tileCount,
+                                                            uint maxThreads,
+                                                            [Out] ulong[] hashes);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern ulong HashMemoryBlock(IntPtr buffer, UIntPtr length);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern EncoderStatus AnalyzeImageTiles([In] BitmapData[] tiles,
+                                                               uint tileCount,
+                                                               uint maxThreads,
+                                                               [Out] TileAnalysis[] results);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern void SetInstrumentationEnabled([MarshalAs(UnmanagedType.U1)] bool enabled);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern void ResetInstrumentationStatistics();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.StdCall)]
+        internal static extern void GetInstrumentationStatistics([Out] InstrumentationStatistics statistics);
     }
 }
 #endif
@@ -22,5 +22,6 @@ namespace AvifFileType.Interop
         public uint width;
         public uint height;
         public uint stride;
+        public BitmapPixelFormat pixelFormat;
     }
 }
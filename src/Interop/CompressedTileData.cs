@@ -0,0 +1,24 @@
+﻿////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+using System;
+using System.Runtime.InteropServices;
+
+namespace AvifFileType.Interop
+{
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct CompressedTileData
+    {
+        public IntPtr data;
+        public UIntPtr size;
+    }
+}
@@ -24,5 +24,8 @@ namespace AvifFileType.Interop
         public YUVChromaSubsampling chromaSubsampling;
         public uint bitDepth;
         public CICPColorData firstTileColorData;
+        public uint maxConversionThreads;
+        public uint downscaleShift;
+        public uint maxDecoderThreads;
     }
 }
@@ -22,5 +22,13 @@ namespace AvifFileType.Interop
         public CompressionSpeed compressionSpeed;
         public YUVChromaSubsampling yuvFormat;
         public int maxThreads;
+        public int maxConversionThreads;
+        [MarshalAs(UnmanagedType.U1)]
+        public bool enableInternalTiling;
+        [MarshalAs(UnmanagedType.U1)]
+        public bool reducedIntraTools;
+        public uint bitDepth;
+        [MarshalAs(UnmanagedType.U1)]
+        public bool premultiplyAlpha;
     }
 }
@@ -20,6 +20,7 @@ namespace AvifFileType.Interop
         UnknownYUVFormat,
         CodecInitFailed,
         EncodeFailed,
-        UserCancelled
+        UserCancelled,
+        UnsupportedBitDepth
     }
 }
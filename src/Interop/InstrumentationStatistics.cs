@@ -0,0 +1,43 @@
+﻿////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+
+using System.Runtime.InteropServices;
+
+namespace AvifFileType.Interop
+{
+    /// <summary>
+    /// The native instrumentation statistics, the times are in nanoseconds.
+    /// </summary>
+    /// <remarks>
+    /// The encode and decode methods add the statistics of each call to the instance that they are given.
+    /// </remarks>
+    [StructLayout(LayoutKind.Sequential)]
+    internal sealed class InstrumentationStatistics
+    {
+        public ulong colorConversionTime;
+        public ulong encodeTime;
+        public ulong outputCopyTime;
+        public ulong progressCallbackTime;
+        public ulong progressCallbackCount;
+        public ulong decodeTime;
+        public ulong decodedImageConversionTime;
+        public ulong bytesAllocated;
+        public ulong encoderInitCount;
+        public ulong decoderInitCount;
+        public ulong imagesEncoded;
+        public ulong imagesDecoded;
+        public ulong parallelElapsedTime;
+        public ulong parallelWorkTime;
+        public ulong parallelThreadTime;
+    }
+}
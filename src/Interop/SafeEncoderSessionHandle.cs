@@ -0,0 +1,60 @@
+﻿////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+using Microsoft.Win32.SafeHandles;
+using System;
+#if !NET47
+using System.Runtime.InteropServices;
+#endif
+
+namespace AvifFileType.Interop
+{
+    internal sealed class SafeEncoderSessionHandle
+        : SafeHandleZeroOrMinusOneIsInvalid
+    {
+        private SafeEncoderSessionHandle() : base(true)
+        {
+        }
+
+        protected override bool ReleaseHandle()
+        {
+#if NET47
+            if (IntPtr.Size == 8)
+#else
+            if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
+#endif
+            {
+                AvifNative_64.DestroyEncoderSession(this.handle);
+            }
+#if NET47
+            else if (IntPtr.Size == 4)
+#else
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.X86)
+#endif
+            {
+                AvifNative_86.DestroyEncoderSession(this.handle);
+            }
+#if !NET47
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+            {
+                AvifNative_ARM64.DestroyEncoderSession(this.handle);
+            }
+#endif
+            else
+            {
+                return false;
+            }
+
+            return true;
+        }
+    }
+}
@@ -0,0 +1,26 @@
+﻿////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+using System.Runtime.InteropServices;
+
+namespace AvifFileType.Interop
+{
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct TileEncodeInfo
+    {
+        public BitmapData image;
+        [MarshalAs(UnmanagedType.U1)]
+        public bool encodeColor;
+        [MarshalAs(UnmanagedType.U1)]
+        public bool encodeAlpha;
+    }
+}
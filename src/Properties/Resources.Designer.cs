@@ -60,6 +60,42 @@ namespace AvifFileType.Properties {
             }
         }
         
+        /// <summary>
+        ///   Looks up a localized string similar to 10-bit.
+        /// </summary>
+        internal static string BitDepth_10_DisplayName {
+            get {
+                return ResourceManager.GetString("BitDepth_10_DisplayName", resourceCulture);
+            }
+        }
+        
+        /// <summary>
+        ///   Looks up a localized string similar to 12-bit.
+        /// </summary>
+        internal static string BitDepth_12_DisplayName {
+            get {
+                return ResourceManager.GetString("BitDepth_12_DisplayName", resourceCulture);
+            }
+        }
+        
+        /// <summary>
+        ///   Looks up a localized string similar to 8-bit.
+        /// </summary>
+        internal static string BitDepth_8_DisplayName {
+            get {
+                return ResourceManager.GetString("BitDepth_8_DisplayName", resourceCulture);
+            }
+        }
+        
+        /// <summary>
+        ///   Looks up a localized string similar to Bit Depth.
+        /// </summary>
+        internal static string BitDepth_DisplayName {
+            get {
+                return ResourceManager.GetString("BitDepth_DisplayName", resourceCulture);
+            }
+        }
+        
         /// <summary>
         ///   Looks up a localized string similar to 4:2:0 (Best Compression).
         /// </summary>
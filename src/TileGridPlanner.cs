@@ -0,0 +1,259 @@
+﻿////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-avif, a FileType plugin for Paint.NET
+// that loads and saves AVIF images.
+//
+// Copyright (c) 2020, 2021 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+using AvifFileType.AvifContainer;
+using System;
+using System.Collections.Generic;
+using System.ComponentModel;
+
+namespace AvifFileType
+{
+    /// <summary>
+    /// Selects the image grid layout that minimizes the estimated encoding time.
+    /// </summary>
+    internal static class TileGridPlanner
+    {
+        // Although the HEIF specification (ISO/IEC 23008-12:2017) allows an image grid to have up to 256 tiles
+        // in each direction (65536 total), the ISO base media file format (ISO/IEC 14496-12:2015) limits
+        // an item reference box to 65535 items.
+        // Because of this we limit the maximum number of tiles to 250.
+        //
+        // While this would result in the image using 62500 tiles in the worst case, it allows
+        // memory usage to be minimized when encoding extremely wide and/or tall images.
+        //
+        // For example, a 65536x65536 pixel image would use a 128x128 grid of 512x512 pixel tiles.
+        private const int MaxTileCount = 250;
+        // The MIAF specification (ISO/IEC 23000-22:2019) requires that the tile size be at least 64x64 pixels.
+        private const int MinTileSize = 64;
+        // Each tile edge costs some compression efficiency, so a layout with fewer tiles is used when
+        // its estimated time is within this fraction of the fastest layout.
+        private const double FewerTilesTolerance = 0.05;
+
+        /// <summary>
+        /// Selects the image grid layout for the specified image.
+        /// </summary>
+        /// <param name="imageWidth">The image width.</param>
+        /// <param name="imageHeight">The image height.</param>
+        /// <param name="compressionSpeed">The compression speed.</param>
+        /// <param name="bitDepth">The bit depth of the encoded image.</param>
+        /// <param name="threadCount">The number of threads that are available to the encoder.</param>
+        /// <returns>The image grid layout, or <see langword="null"/> if the image should be encoded as a single tile.</returns>
+        public static ImageGridMetadata TryPlanImageGrid(
+            int imageWidth,
+            int imageHeight,
+            CompressionSpeed compressionSpeed,
+            EncoderBitDepth bitDepth,
+            int threadCount)
+        {
+            return TryPlanImageGrid(imageWidth,
+                                    imageHeight,
+                                    compressionSpeed,
+                                    bitDepth,
+                                    threadCount,
+                                    EncoderCalibrationProfile.Installed);
+        }
+
+        /// <summary>
+        /// Selects the image grid layout for the specified image.
+        /// </summary>
+        /// <param name="imageWidth">The image width.</param>
+        /// <param name="imageHeight">The image height.</param>
+        /// <param name="compressionSpeed">The compression speed.</param>
+        /// <param name="bitDepth">The bit depth of the encoded image.</param>
+        /// <param name="threadCount">The number of threads that are available to the encoder.</param>
+        /// <param name="profile">The calibration profile, or <see langword="null"/> to use the built-in cost model.</param>
+        /// <returns>The image grid layout, or <see langword="null"/> if the image should be encoded as a single tile.</returns>
+        public static ImageGridMetadata TryPlanImageGrid(
+            int imageWidth,
+            int imageHeight,
+            CompressionSpeed compressionSpeed,
+            EncoderBitDepth bitDepth,
+            int threadCount,
+            EncoderCalibrationProfile profile)
+        {
+            int maxTileSize;
+
+            // The maximum tile size limits the memory that each encoder uses, these are the limits
+            // that were used before the planner was added. The planner is free to pick any smaller
+            // tile size that reduces the encoding time.
+            switch (compressionSpeed)
+            {
+                case CompressionSpeed.Fast:
+                    maxTileSize = 512;
+                    break;
+                case CompressionSpeed.Medium:
+                    maxTileSize = 1280;
+                    break;
+                case CompressionSpeed.Slow:
+                    maxTileSize = 1920;
+                    break;
+                case CompressionSpeed.VerySlow:
+                    // Tiles are not used for the very slow compression speed.
+                    return null;
+                default:
+                    throw new InvalidEnumArgumentException(nameof(compressionSpeed), (int)compressionSpeed, typeof(CompressionSpeed));
+            }
+
+            EncoderCostModel costModel = profile?.TryGetCostModel(compressionSpeed, bitDepth) ?? EncoderCostModel.GetDefault(compressionSpeed);
+
+            List<int> columnCounts = GetTileCounts(imageWidth, maxTileSize);
+            List<int> rowCounts = GetTileCounts(imageHeight, maxTileSize);
+            int totalThreadCount = Math.Max(threadCount, 1);
+
+            int bestTileColumnCount = 1;
+            int bestTileRowCount = 1;
+            double bestEstimate = double.MaxValue;
+            List<GridCandidate> candidates = new List<GridCandidate>(columnCounts.Count * rowCounts.Count);
+
+            foreach (int tileColumnCount in columnCounts)
+            {
+                foreach (int tileRowCount in rowCounts)
+                {
+                    double estimate = EstimateGridMilliseconds(costModel,
+                                                               imageWidth / tileColumnCount,
+                                                               imageHeight / tileRowCount,
+                                                               tileColumnCount * tileRowCount,
+                                                               totalThreadCount);
+
+                    candidates.Add(new GridCandidate(tileColumnCount, tileRowCount, estimate));
+
+                    if (estimate < bestEstimate)
+                    {
+                        bestEstimate = estimate;
+                    }
+                }
+            }
+
+            int bestTileCount = int.MaxValue;
+            int bestAspectDifference = int.MaxValue;
+            double fewerTilesLimit = bestEstimate * (1.0 + FewerTilesTolerance);
+
+            foreach (GridCandidate candidate in candidates)
+            {
+                if (candidate.EstimatedMilliseconds > fewerTilesLimit)
+                {
+                    continue;
+                }
+
+                int tileCount = candidate.TileColumnCount * candidate.TileRowCount;
+                // Square tiles are preferred when the tile counts are equal.
+                int aspectDifference = Math.Abs((imageWidth / candidate.TileColumnCount) - (imageHeight / candidate.TileRowCount));
+
+                if (tileCount < bestTileCount || (tileCount == bestTileCount && aspectDifference < bestAspectDifference))
+                {
+                    bestTileCount = tileCount;
+                    bestAspectDifference = aspectDifference;
+                    bestTileColumnCount = candidate.TileColumnCount;
+                    bestTileRowCount = candidate.TileRowCount;
+                }
+            }
+
+            ImageGridMetadata metadata = null;
+
+            if (bestTileColumnCount > 1 || bestTileRowCount > 1)
+            {
+                metadata = new ImageGridMetadata(bestTileColumnCount,
+                                                 bestTileRowCount,
+                                                 (uint)imageHeight,
+                                                 (uint)imageWidth,
+                                                 (uint)(imageHeight / bestTileRowCount),
+                                                 (uint)(imageWidth / bestTileColumnCount));
+            }
+
+            return metadata;
+        }
+
+        private static double EstimateGridMilliseconds(
+            EncoderCostModel costModel,
+            int tileWidth,
+            int tileHeight,
+            int tileCount,
+            int totalThreadCount)
+        {
+            // This mirrors the native encoder, which runs the square root of the thread count
+            // encoders at the same time and splits the threads between them.
+            int encoderCount = 1;
+
+            while ((encoderCount + 1) * (encoderCount + 1) <= totalThreadCount)
+            {
+                encoderCount++;
+            }
+
+            encoderCount = Math.Min(encoderCount, tileCount);
+
+            int threadsPerEncoder = Math.Max(totalThreadCount / encoderCount, 1);
+            int passCount = (tileCount + encoderCount - 1) / encoderCount;
+
+            // An image that is not split into a grid can use AV1 tiles to encode in parallel.
+            bool internalTiling = tileCount == 1 && EncoderCostModel.UsesInternalTiling(tileWidth, tileHeight, threadsPerEncoder);
+
+            return passCount * costModel.EstimateMilliseconds(tileWidth, tileHeight, threadsPerEncoder, internalTiling);
+        }
+
+        private static List<int> GetTileCounts(int imageSize, int maxTileSize)
+        {
+            List<int> tileCounts = new List<int>();
+
+            if (imageSize <= maxTileSize)
+            {
+                tileCounts.Add(1);
+            }
+
+            int smallestTileCount = 1;
+
+            for (int tileCount = 2; tileCount <= MaxTileCount; tileCount++)
+            {
+                int tileSize = imageSize / tileCount;
+
+                if (tileSize < MinTileSize)
+                {
+                    break;
+                }
+
+                if ((tileSize & 1) == 0 && (tileSize * tileCount) == imageSize)
+                {
+                    smallestTileCount = tileCount;
+
+                    if (tileSize <= maxTileSize)
+                    {
+                        tileCounts.Add(tileCount);
+                    }
+                }
+            }
+
+            if (tileCounts.Count == 0)
+            {
+                // The image cannot be split into tiles that fit within the maximum tile size,
+                // use the smallest tiles that are available.
+                tileCounts.Add(smallestTileCount);
+            }
+
+            return tileCounts;
+        }
+
+        private readonly struct GridCandidate
+        {
+            public GridCandidate(int tileColumnCount, int tileRowCount, double estimatedMilliseconds)
+            {
+                this.TileColumnCount = tileColumnCount;
+                this.TileRowCount = tileRowCount;
+                this.EstimatedMilliseconds = estimatedMilliseconds;
+            }
+
+            public int TileColumnCount { get; }
+
+            public int TileRowCount { get; }
+
+            public double EstimatedMilliseconds { get; }
+        }
+    }
+}